@@ -0,0 +1,1101 @@
+/***********************************************************************
+ * Header:
+ *    ART
+ * Summary:
+ *    An adaptive radix tree to hold the elements of a set. The tree
+ *    branches on one byte of the key at a time, so a search costs one
+ *    step per byte of the key rather than one whole-key comparison per
+ *    level. Inner nodes come in four sizes and grow or shrink with
+ *    the number of children, and runs of bytes that do not branch are
+ *    kept as a prefix in the node below them
+ *
+ *    This will contain the class definition of:
+ *        ArtKey              : How to see a key as a string of bytes
+ *        ART                 : A class that represents an adaptive radix tree
+ *        ART::iterator       : An iterator through ART
+ *        ArtEngine           : Pick ART as the engine behind a set
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>     // for size_t
+#include <cstring>     // for memset
+#include <string>      // for std::string
+#include <type_traits> // for std::is_integral
+#include <utility>     // for std::pair and std::move
+#include <initializer_list>
+
+class TestART;         // forward declaration for unit tests
+
+namespace custom
+{
+
+/*****************************************************************
+ * ART ENGINE
+ * Name this as the second parameter of a set to keep its elements
+ * in an ART:
+ *       custom::set <std::string, custom::ArtEngine>
+ *****************************************************************/
+struct ArtEngine { };
+
+/*****************************************************************
+ * ART KEY
+ * The bytes of a key, ordered so that comparing them one at a time
+ * agrees with operator <. An integer is its bytes from the most
+ * significant down, with the sign bit flipped so negatives come first
+ *****************************************************************/
+template <typename T>
+struct ArtKey
+{
+   static_assert(std::is_integral<T>::value, "ART keys are integers or strings");
+
+   static size_t size(const T & t) { return sizeof(T); }
+   static unsigned char at(const T & t, size_t i)
+   {
+      typedef typename std::make_unsigned<T>::type U;
+      U u = (U)t;
+      if (std::is_signed<T>::value)
+         u ^= (U)((U)1 << (sizeof(T) * 8 - 1));
+      return (unsigned char)(u >> ((sizeof(T) - 1 - i) * 8));
+   }
+};
+
+template <>
+struct ArtKey <std::string>
+{
+   static size_t size(const std::string & t) { return t.size(); }
+   static unsigned char at(const std::string & t, size_t i) { return (unsigned char)t[i]; }
+};
+
+/*****************************************************************
+ * ART
+ * Leaves hold the elements. Each inner node covers the keys that
+ * share its prefix, then branches on the next byte. A key that
+ * ends right after the prefix (a string that is the prefix of
+ * another) lives in the node's pEnd slot, ahead of the children
+ *****************************************************************/
+template <typename T>
+class ART
+{
+   friend class ::TestART; // give unit tests access to the privates
+public:
+   //
+   // Construct
+   //
+
+   ART() : root(nullptr), numElements(0) { }
+   ART(const ART &  rhs) : root(nullptr), numElements(0) { *this = rhs;            }
+   ART(      ART && rhs) : root(nullptr), numElements(0) { *this = std::move(rhs); }
+   ART(const std::initializer_list<T> & il) : root(nullptr), numElements(0)
+   {
+      for (auto & element : il)
+         insert(element);
+   }
+   ~ART() { clear(); }
+
+   //
+   // Assign
+   //
+
+   ART & operator = (const ART &  rhs);
+   ART & operator = (      ART && rhs);
+   ART & operator = (const std::initializer_list<T> & il);
+   void swap(ART & rhs) noexcept
+   {
+      std::swap(root,        rhs.root);
+      std::swap(numElements, rhs.numElements);
+   }
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   iterator begin() const noexcept { return iterator(root ? minimum(root) : nullptr); }
+   iterator end()   const noexcept { return iterator();                               }
+
+   //
+   // Access
+   //
+
+   iterator find(const T & t) const;
+
+   //
+   // Insert. Each key is held once, whatever keepUnique says
+   //
+
+   std::pair<iterator, bool> insert(const T &  t, bool keepUnique = false);
+   std::pair<iterator, bool> insert(      T && t, bool keepUnique = false);
+
+   //
+   // Remove
+   //
+
+   iterator erase(iterator & it);
+   void clear() noexcept
+   {
+      _clear(root);
+      root = nullptr;
+      numElements = 0;
+   }
+
+   //
+   // Status
+   //
+
+   bool   empty()  const noexcept { return (numElements == 0); }
+   size_t size()   const noexcept { return numElements;        }
+   size_t height() const noexcept { return _height(root);      }
+
+private:
+
+   typedef ArtKey<T> Key;
+   enum Type : unsigned char { LEAF, NODE4, NODE16, NODE48, NODE256 };
+
+   struct Node;
+   struct Leaf;
+   struct Inner;
+   struct Node4;
+   struct Node16;
+   struct Node48;
+   struct Node256;
+
+   Node * root;               // root node of the radix tree
+   size_t numElements;        // number of elements currently in the tree
+
+   // the children of an inner node, whatever its size
+   static Node * * findChild (Inner * pNode, unsigned char byte);
+   static Node *   childAfter (const Inner * pNode, int byte);
+   static Node *   childBefore(const Inner * pNode, int byte);
+   static void     addChild   (Node * & pRef, unsigned char byte, Node * pChild);
+   static void     removeChild(Node * & pRef, unsigned char byte);
+   static void     replace    (Node * & pRef, Inner * pOld, Inner * pNew);
+
+   static Leaf * minimum(Node * pNode);
+   static Leaf * maximum(Node * pNode);
+   Node * & slotOf(Node * pNode);
+
+   template <class U>
+   std::pair<iterator, bool> _insert(U && t);
+   void _collapse(Inner * pNode);
+   static Node * _copy(const Node * pSrc);
+   static void _clear(Node * pNode);
+   static void _delete(Node * pNode);
+   static size_t _height(const Node * pNode);
+};
+
+/*****************************************************************
+ * ART NODES
+ * Every node knows its parent and which byte leads to it there,
+ * so the iterator can find the next leaf without a stack
+ *****************************************************************/
+template <typename T>
+struct ART <T> :: Node
+{
+   Node(Type type) : type(type), byte(0), isEnd(false), pParent(nullptr) { }
+
+   Type type;                 // LEAF or which size of inner node
+   unsigned char byte;        // the byte that leads here from pParent
+   bool isEnd;                // we are pParent->pEnd rather than a child
+   Inner * pParent;           // nullptr for the root
+};
+
+template <typename T>
+struct ART <T> :: Leaf : public Node
+{
+   Leaf(const T &  t) : Node(LEAF), data(t)            { }
+   Leaf(      T && t) : Node(LEAF), data(std::move(t)) { }
+
+   T data;                    // Actual data stored in the leaf
+};
+
+template <typename T>
+struct ART <T> :: Inner : public Node
+{
+   Inner(Type type) : Node(type), pEnd(nullptr), numChildren(0) { }
+
+   std::string prefix;        // the bytes every key below shares
+   Leaf * pEnd;               // the key that ends right after prefix
+   unsigned short numChildren;
+};
+
+// up to 4 children, bytes sorted
+template <typename T>
+struct ART <T> :: Node4 : public Inner
+{
+   Node4() : Inner(NODE4) { }
+   unsigned char bytes[4];
+   Node * children[4];
+};
+
+// up to 16 children, bytes sorted
+template <typename T>
+struct ART <T> :: Node16 : public Inner
+{
+   Node16() : Inner(NODE16) { }
+   unsigned char bytes[16];
+   Node * children[16];
+};
+
+// up to 48 children, found through a 256-entry index. 0 is empty
+template <typename T>
+struct ART <T> :: Node48 : public Inner
+{
+   Node48() : Inner(NODE48)
+   {
+      memset(index, 0, sizeof(index));
+      for (size_t i = 0; i < 48; i++)
+         children[i] = nullptr;
+   }
+   unsigned char index[256];  // slot in children plus one
+   Node * children[48];
+};
+
+// a child for every byte
+template <typename T>
+struct ART <T> :: Node256 : public Inner
+{
+   Node256() : Inner(NODE256)
+   {
+      for (size_t i = 0; i < 256; i++)
+         children[i] = nullptr;
+   }
+   Node * children[256];
+};
+
+/**********************************************************
+ * ART ITERATOR
+ * A leaf. Moving on climbs to the first ancestor with
+ * something after us and takes its smallest leaf
+ *********************************************************/
+template <typename T>
+class ART <T> :: iterator
+{
+   friend class ::TestART; // give unit tests access to the privates
+   friend class ART <T>;
+public:
+   // constructors and assignment
+   iterator(Leaf * p = nullptr) : pLeaf(p)       { }
+
+   // compare
+   bool operator == (const iterator & rhs) const { return (pLeaf == rhs.pLeaf);                   }
+   bool operator != (const iterator & rhs) const { return (pLeaf != rhs.pLeaf);                   }
+
+   // de-reference. Cannot change because it will invalidate the ART
+   const T & operator * () const                 { return pLeaf->data;                            }
+
+   // increment and decrement
+   iterator & operator ++ ();
+   iterator   operator ++ (int postfix)          { iterator itOld(*this); ++*this; return itOld;  }
+   iterator & operator -- ();
+   iterator   operator -- (int postfix)          { iterator itOld(*this); --*this; return itOld;  }
+
+private:
+
+   Leaf * pLeaf;              // the leaf, nullptr for end()
+};
+
+/*********************************************
+ *********************************************
+ ******************** ART ********************
+ *********************************************
+ *********************************************/
+
+/*********************************************
+ * ART :: ASSIGNMENT OPERATOR
+ * Copy one tree to another
+ ********************************************/
+template <typename T>
+ART <T> & ART <T> :: operator = (const ART & rhs)
+{
+   if (this != &rhs)
+   {
+      clear();
+      if (rhs.root)
+         root = _copy(rhs.root);
+      numElements = rhs.numElements;
+   }
+   return *this;
+}
+
+/*********************************************
+ * ART :: MOVE ASSIGNMENT
+ * Steal the nodes from another tree
+ ********************************************/
+template <typename T>
+ART <T> & ART <T> :: operator = (ART && rhs)
+{
+   clear();
+   swap(rhs);
+   return *this;
+}
+
+/*********************************************
+ * ART :: ASSIGNMENT with INITIALIZATION LIST
+ ********************************************/
+template <typename T>
+ART <T> & ART <T> :: operator = (const std::initializer_list<T> & il)
+{
+   clear();
+   for (auto & element : il)
+      insert(element);
+   return *this;
+}
+
+/*********************************************
+ * ART :: FIND CHILD
+ * The slot holding the child for this byte, or nullptr
+ ********************************************/
+template <typename T>
+typename ART <T> :: Node * * ART <T> :: findChild(Inner * pNode, unsigned char byte)
+{
+   switch (pNode->type)
+   {
+      case NODE4:
+      {
+         Node4 * p = static_cast<Node4 *>(pNode);
+         for (size_t i = 0; i < p->numChildren; i++)
+            if (p->bytes[i] == byte)
+               return &p->children[i];
+         return nullptr;
+      }
+      case NODE16:
+      {
+         Node16 * p = static_cast<Node16 *>(pNode);
+         for (size_t i = 0; i < p->numChildren && p->bytes[i] <= byte; i++)
+            if (p->bytes[i] == byte)
+               return &p->children[i];
+         return nullptr;
+      }
+      case NODE48:
+      {
+         Node48 * p = static_cast<Node48 *>(pNode);
+         return (p->index[byte] ? &p->children[p->index[byte] - 1] : nullptr);
+      }
+      default:
+      {
+         Node256 * p = static_cast<Node256 *>(pNode);
+         return (p->children[byte] ? &p->children[byte] : nullptr);
+      }
+   }
+}
+
+/*********************************************
+ * ART :: CHILD AFTER and CHILD BEFORE
+ * The child with the smallest byte above this one (-1 for
+ * the first child), or the largest below it (256 for the last)
+ ********************************************/
+template <typename T>
+typename ART <T> :: Node * ART <T> :: childAfter(const Inner * pNode, int byte)
+{
+   switch (pNode->type)
+   {
+      case NODE4:
+      case NODE16:
+      {
+         const unsigned char * bytes = (pNode->type == NODE4 ? static_cast<const Node4 *>(pNode)->bytes
+                                                             : static_cast<const Node16 *>(pNode)->bytes);
+         Node * const * children = (pNode->type == NODE4 ? static_cast<const Node4 *>(pNode)->children
+                                                         : static_cast<const Node16 *>(pNode)->children);
+         for (size_t i = 0; i < pNode->numChildren; i++)
+            if ((int)bytes[i] > byte)
+               return children[i];
+         return nullptr;
+      }
+      case NODE48:
+      {
+         const Node48 * p = static_cast<const Node48 *>(pNode);
+         for (int i = byte + 1; i < 256; i++)
+            if (p->index[i])
+               return p->children[p->index[i] - 1];
+         return nullptr;
+      }
+      default:
+      {
+         const Node256 * p = static_cast<const Node256 *>(pNode);
+         for (int i = byte + 1; i < 256; i++)
+            if (p->children[i])
+               return p->children[i];
+         return nullptr;
+      }
+   }
+}
+
+template <typename T>
+typename ART <T> :: Node * ART <T> :: childBefore(const Inner * pNode, int byte)
+{
+   switch (pNode->type)
+   {
+      case NODE4:
+      case NODE16:
+      {
+         const unsigned char * bytes = (pNode->type == NODE4 ? static_cast<const Node4 *>(pNode)->bytes
+                                                             : static_cast<const Node16 *>(pNode)->bytes);
+         Node * const * children = (pNode->type == NODE4 ? static_cast<const Node4 *>(pNode)->children
+                                                         : static_cast<const Node16 *>(pNode)->children);
+         for (size_t i = pNode->numChildren; i-- > 0; )
+            if ((int)bytes[i] < byte)
+               return children[i];
+         return nullptr;
+      }
+      case NODE48:
+      {
+         const Node48 * p = static_cast<const Node48 *>(pNode);
+         for (int i = byte - 1; i >= 0; i--)
+            if (p->index[i])
+               return p->children[p->index[i] - 1];
+         return nullptr;
+      }
+      default:
+      {
+         const Node256 * p = static_cast<const Node256 *>(pNode);
+         for (int i = byte - 1; i >= 0; i--)
+            if (p->children[i])
+               return p->children[i];
+         return nullptr;
+      }
+   }
+}
+
+/*********************************************
+ * ART :: REPLACE
+ * Put pNew where pOld was, handing over the prefix, the
+ * end slot and the parent. The children are moved by the caller
+ ********************************************/
+template <typename T>
+void ART <T> :: replace(Node * & pRef, Inner * pOld, Inner * pNew)
+{
+   pNew->prefix.swap(pOld->prefix);
+   pNew->pEnd = pOld->pEnd;
+   if (pNew->pEnd)
+      pNew->pEnd->pParent = pNew;
+   pNew->numChildren = pOld->numChildren;
+   pNew->byte = pOld->byte;
+   pNew->pParent = pOld->pParent;
+   pRef = pNew;
+   _delete(pOld);
+}
+
+/*********************************************
+ * ART :: ADD CHILD
+ * Hang pChild off the inner node in pRef under byte,
+ * moving up to the next size of node if this one is full
+ ********************************************/
+template <typename T>
+void ART <T> :: addChild(Node * & pRef, unsigned char byte, Node * pChild)
+{
+   Inner * pNode = static_cast<Inner *>(pRef);
+   pChild->byte = byte;
+   pChild->isEnd = false;
+
+   switch (pNode->type)
+   {
+      case NODE4:
+      case NODE16:
+      {
+         size_t capacity = (pNode->type == NODE4 ? 4 : 16);
+         if (pNode->numChildren == capacity)
+         {
+            // grow to the next size, then add to that
+            unsigned char * bytes = (pNode->type == NODE4 ? static_cast<Node4 *>(pNode)->bytes
+                                                          : static_cast<Node16 *>(pNode)->bytes);
+            Node * * children = (pNode->type == NODE4 ? static_cast<Node4 *>(pNode)->children
+                                                      : static_cast<Node16 *>(pNode)->children);
+            if (pNode->type == NODE4)
+            {
+               Node16 * pNew = new Node16;
+               for (size_t i = 0; i < 4; i++)
+               {
+                  pNew->bytes[i] = bytes[i];
+                  pNew->children[i] = children[i];
+                  children[i]->pParent = pNew;
+               }
+               replace(pRef, pNode, pNew);
+            }
+            else
+            {
+               Node48 * pNew = new Node48;
+               for (size_t i = 0; i < 16; i++)
+               {
+                  pNew->index[bytes[i]] = (unsigned char)(i + 1);
+                  pNew->children[i] = children[i];
+                  children[i]->pParent = pNew;
+               }
+               replace(pRef, pNode, pNew);
+            }
+            addChild(pRef, byte, pChild);
+            return;
+         }
+
+         // keep the bytes sorted
+         unsigned char * bytes = (pNode->type == NODE4 ? static_cast<Node4 *>(pNode)->bytes
+                                                       : static_cast<Node16 *>(pNode)->bytes);
+         Node * * children = (pNode->type == NODE4 ? static_cast<Node4 *>(pNode)->children
+                                                   : static_cast<Node16 *>(pNode)->children);
+         size_t i = pNode->numChildren;
+         for (; i > 0 && bytes[i - 1] > byte; i--)
+         {
+            bytes[i] = bytes[i - 1];
+            children[i] = children[i - 1];
+         }
+         bytes[i] = byte;
+         children[i] = pChild;
+         break;
+      }
+      case NODE48:
+      {
+         Node48 * p = static_cast<Node48 *>(pNode);
+         if (p->numChildren == 48)
+         {
+            Node256 * pNew = new Node256;
+            for (size_t i = 0; i < 256; i++)
+               if (p->index[i])
+               {
+                  pNew->children[i] = p->children[p->index[i] - 1];
+                  pNew->children[i]->pParent = pNew;
+               }
+            replace(pRef, pNode, pNew);
+            addChild(pRef, byte, pChild);
+            return;
+         }
+         size_t iSlot = 0;
+         while (p->children[iSlot])
+            iSlot++;
+         p->children[iSlot] = pChild;
+         p->index[byte] = (unsigned char)(iSlot + 1);
+         break;
+      }
+      default:
+         static_cast<Node256 *>(pNode)->children[byte] = pChild;
+         break;
+   }
+   pNode->numChildren++;
+   pChild->pParent = pNode;
+}
+
+/*********************************************
+ * ART :: REMOVE CHILD
+ * Take the child under byte off the inner node in pRef,
+ * moving down to the next size of node when it gets sparse
+ ********************************************/
+template <typename T>
+void ART <T> :: removeChild(Node * & pRef, unsigned char byte)
+{
+   Inner * pNode = static_cast<Inner *>(pRef);
+   switch (pNode->type)
+   {
+      case NODE4:
+      case NODE16:
+      {
+         unsigned char * bytes = (pNode->type == NODE4 ? static_cast<Node4 *>(pNode)->bytes
+                                                       : static_cast<Node16 *>(pNode)->bytes);
+         Node * * children = (pNode->type == NODE4 ? static_cast<Node4 *>(pNode)->children
+                                                   : static_cast<Node16 *>(pNode)->children);
+         size_t i = 0;
+         while (bytes[i] != byte)
+            i++;
+         for (pNode->numChildren--; i < pNode->numChildren; i++)
+         {
+            bytes[i] = bytes[i + 1];
+            children[i] = children[i + 1];
+         }
+
+         if (pNode->type == NODE16 && pNode->numChildren <= 3)
+         {
+            Node4 * pNew = new Node4;
+            for (size_t i = 0; i < pNode->numChildren; i++)
+            {
+               pNew->bytes[i] = bytes[i];
+               pNew->children[i] = children[i];
+               children[i]->pParent = pNew;
+            }
+            replace(pRef, pNode, pNew);
+         }
+         break;
+      }
+      case NODE48:
+      {
+         Node48 * p = static_cast<Node48 *>(pNode);
+         p->children[p->index[byte] - 1] = nullptr;
+         p->index[byte] = 0;
+         p->numChildren--;
+
+         if (p->numChildren <= 12)
+         {
+            Node16 * pNew = new Node16;
+            size_t iNew = 0;
+            for (size_t i = 0; i < 256; i++)
+               if (p->index[i])
+               {
+                  pNew->bytes[iNew] = (unsigned char)i;
+                  pNew->children[iNew] = p->children[p->index[i] - 1];
+                  pNew->children[iNew]->pParent = pNew;
+                  iNew++;
+               }
+            replace(pRef, pNode, pNew);
+         }
+         break;
+      }
+      default:
+      {
+         Node256 * p = static_cast<Node256 *>(pNode);
+         p->children[byte] = nullptr;
+         p->numChildren--;
+
+         if (p->numChildren <= 37)
+         {
+            Node48 * pNew = new Node48;
+            size_t iNew = 0;
+            for (size_t i = 0; i < 256; i++)
+               if (p->children[i])
+               {
+                  pNew->index[i] = (unsigned char)(iNew + 1);
+                  pNew->children[iNew] = p->children[i];
+                  pNew->children[iNew]->pParent = pNew;
+                  iNew++;
+               }
+            replace(pRef, pNode, pNew);
+         }
+         break;
+      }
+   }
+}
+
+/*********************************************
+ * ART :: MINIMUM and MAXIMUM
+ * The first and last leaves under a node. The end
+ * slot comes before all the children
+ ********************************************/
+template <typename T>
+typename ART <T> :: Leaf * ART <T> :: minimum(Node * pNode)
+{
+   while (pNode->type != LEAF)
+   {
+      Inner * pInner = static_cast<Inner *>(pNode);
+      pNode = (pInner->pEnd ? pInner->pEnd : childAfter(pInner, -1));
+   }
+   return static_cast<Leaf *>(pNode);
+}
+
+template <typename T>
+typename ART <T> :: Leaf * ART <T> :: maximum(Node * pNode)
+{
+   while (pNode->type != LEAF)
+   {
+      Inner * pInner = static_cast<Inner *>(pNode);
+      Node * pLast = childBefore(pInner, 256);
+      pNode = (pLast ? pLast : pInner->pEnd);
+   }
+   return static_cast<Leaf *>(pNode);
+}
+
+/*********************************************
+ * ART :: SLOT OF
+ * Where the pointer to this inner node lives
+ ********************************************/
+template <typename T>
+typename ART <T> :: Node * & ART <T> :: slotOf(Node * pNode)
+{
+   assert(!pNode->isEnd);
+   if (pNode->pParent == nullptr)
+      return root;
+   return *findChild(pNode->pParent, pNode->byte);
+}
+
+/*********************************************
+ * ART :: FIND
+ * Follow the key a byte at a time, checking each prefix
+ * along the way. The leaf holds the whole key
+ ********************************************/
+template <typename T>
+typename ART <T> :: iterator ART <T> :: find(const T & t) const
+{
+   const size_t size = Key::size(t);
+   size_t depth = 0;
+   Node * pNode = root;
+   while (pNode && pNode->type != LEAF)
+   {
+      Inner * pInner = static_cast<Inner *>(pNode);
+      const std::string & prefix = pInner->prefix;
+      if (size - depth < prefix.size())
+         return end();
+      for (size_t i = 0; i < prefix.size(); i++)
+         if ((unsigned char)prefix[i] != Key::at(t, depth + i))
+            return end();
+      depth += prefix.size();
+
+      if (depth == size)
+         pNode = pInner->pEnd;
+      else
+      {
+         Node * * ppChild = findChild(pInner, Key::at(t, depth++));
+         pNode = (ppChild ? *ppChild : nullptr);
+      }
+   }
+   if (pNode && static_cast<Leaf *>(pNode)->data == t)
+      return iterator(static_cast<Leaf *>(pNode));
+   return end();
+}
+
+/*********************************************
+ * ART :: INSERT
+ * Insert a new element into the tree
+ ********************************************/
+template <typename T>
+std::pair<typename ART <T> :: iterator, bool> ART <T> :: insert(const T & t, bool keepUnique)
+{
+   return _insert(t);
+}
+
+template <typename T>
+std::pair<typename ART <T> :: iterator, bool> ART <T> :: insert(T && t, bool keepUnique)
+{
+   return _insert(std::move(t));
+}
+
+/*********************************************
+ * ART :: _INSERT
+ * Walk down as find does. Where the key parts ways with
+ * a prefix or a leaf, a new Node4 goes in to branch there
+ ********************************************/
+template <typename T>
+template <class U>
+std::pair<typename ART <T> :: iterator, bool> ART <T> :: _insert(U && t)
+{
+   const size_t size = Key::size(t);
+   size_t depth = 0;
+   Node * * ppNode = &root;
+
+   while (*ppNode)
+   {
+      Node * pNode = *ppNode;
+
+      // a leaf: the keys agree up to somewhere past here
+      if (pNode->type == LEAF)
+      {
+         Leaf * pOld = static_cast<Leaf *>(pNode);
+         if (pOld->data == t)
+            return std::make_pair(iterator(pOld), false);
+
+         const T & old = pOld->data;
+         const size_t sizeOld = Key::size(old);
+         size_t iSplit = depth;
+         while (iSplit < size && iSplit < sizeOld && Key::at(t, iSplit) == Key::at(old, iSplit))
+            iSplit++;
+
+         Node4 * pBranch = new Node4;
+         for (size_t i = depth; i < iSplit; i++)
+            pBranch->prefix.push_back((char)Key::at(t, i));
+         pBranch->byte = pOld->byte;
+         pBranch->isEnd = false;
+         pBranch->pParent = pOld->pParent;
+         *ppNode = pBranch;
+
+         Leaf * pNew = new Leaf(std::forward<U>(t));
+         Node * pRef = pBranch;
+         for (Leaf * pLeaf : { pOld, pNew })
+         {
+            const T & key = pLeaf->data;
+            if (Key::size(key) == iSplit)
+            {
+               pBranch->pEnd = pLeaf;
+               pLeaf->isEnd = true;
+               pLeaf->pParent = pBranch;
+            }
+            else
+               addChild(pRef, Key::at(key, iSplit), pLeaf);
+         }
+         numElements++;
+         return std::make_pair(iterator(pNew), true);
+      }
+
+      // an inner node: see how much of its prefix we share
+      Inner * pInner = static_cast<Inner *>(pNode);
+      const std::string & prefix = pInner->prefix;
+      size_t iSplit = 0;
+      while (iSplit < prefix.size() && depth + iSplit < size &&
+             (unsigned char)prefix[iSplit] == Key::at(t, depth + iSplit))
+         iSplit++;
+
+      if (iSplit < prefix.size())
+      {
+         // the key leaves the prefix part way: branch there
+         Node4 * pBranch = new Node4;
+         pBranch->prefix = prefix.substr(0, iSplit);
+         pBranch->byte = pInner->byte;
+         pBranch->pParent = pInner->pParent;
+         *ppNode = pBranch;
+
+         unsigned char byteOld = (unsigned char)prefix[iSplit];
+         pInner->prefix.erase(0, iSplit + 1);
+         Node * pRef = pBranch;
+         addChild(pRef, byteOld, pInner);
+
+         Leaf * pNew = new Leaf(std::forward<U>(t));
+         if (depth + iSplit == size)
+         {
+            pBranch->pEnd = pNew;
+            pNew->isEnd = true;
+            pNew->pParent = pBranch;
+         }
+         else
+            addChild(pRef, Key::at(pNew->data, depth + iSplit), pNew);
+         numElements++;
+         return std::make_pair(iterator(pNew), true);
+      }
+      depth += prefix.size();
+
+      // the key ends here
+      if (depth == size)
+      {
+         if (pInner->pEnd)
+            return std::make_pair(iterator(pInner->pEnd), false);
+         Leaf * pNew = new Leaf(std::forward<U>(t));
+         pInner->pEnd = pNew;
+         pNew->isEnd = true;
+         pNew->pParent = pInner;
+         numElements++;
+         return std::make_pair(iterator(pNew), true);
+      }
+
+      // on to the child for the next byte, if there is one
+      unsigned char byte = Key::at(t, depth);
+      Node * * ppChild = findChild(pInner, byte);
+      if (ppChild == nullptr)
+      {
+         Leaf * pNew = new Leaf(std::forward<U>(t));
+         addChild(*ppNode, byte, pNew);
+         numElements++;
+         return std::make_pair(iterator(pNew), true);
+      }
+      ppNode = ppChild;
+      depth++;
+   }
+
+   // the tree is empty
+   Leaf * pNew = new Leaf(std::forward<U>(t));
+   root = pNew;
+   numElements++;
+   return std::make_pair(iterator(pNew), true);
+}
+
+/*********************************************
+ * ART :: ERASE
+ * Take the leaf off its parent, then fold the parent
+ * away if that leaves it with only one thing under it
+ ********************************************/
+template <typename T>
+typename ART <T> :: iterator ART <T> :: erase(iterator & it)
+{
+   Leaf * pLeaf = it.pLeaf;
+   if (pLeaf == nullptr)
+      return end();
+   iterator itNext = it;
+   ++itNext;
+
+   Inner * pParent = pLeaf->pParent;
+   if (pParent == nullptr)
+      root = nullptr;
+   else if (pLeaf->isEnd)
+      pParent->pEnd = nullptr;
+   else
+   {
+      Node * & pRef = slotOf(pParent);
+      removeChild(pRef, pLeaf->byte);
+      pParent = static_cast<Inner *>(pRef);
+   }
+   _delete(pLeaf);
+   numElements--;
+
+   if (pParent)
+      _collapse(pParent);
+   return itNext;
+}
+
+/*********************************************
+ * ART :: _COLLAPSE
+ * An inner node with one thing left under it is not
+ * branching, so that thing takes its place. An inner
+ * child soaks up the prefix and byte that led to it
+ ********************************************/
+template <typename T>
+void ART <T> :: _collapse(Inner * pNode)
+{
+   if (pNode->numChildren + (pNode->pEnd ? 1 : 0) != 1)
+      return;
+
+   Node * pOnly = (pNode->pEnd ? pNode->pEnd : childAfter(pNode, -1));
+   if (pOnly->type != LEAF)
+   {
+      Inner * pChild = static_cast<Inner *>(pOnly);
+      pChild->prefix = pNode->prefix + (char)pChild->byte + pChild->prefix;
+   }
+
+   Node * & pRef = slotOf(pNode);
+   pOnly->byte = pNode->byte;
+   pOnly->isEnd = pNode->isEnd;
+   pOnly->pParent = pNode->pParent;
+   pRef = pOnly;
+   _delete(pNode);
+}
+
+/*********************************************
+ * ART :: _COPY
+ * Make a copy of a subtree
+ ********************************************/
+template <typename T>
+typename ART <T> :: Node * ART <T> :: _copy(const Node * pSrc)
+{
+   if (pSrc->type == LEAF)
+   {
+      Leaf * pLeaf = new Leaf(static_cast<const Leaf *>(pSrc)->data);
+      pLeaf->byte = pSrc->byte;
+      pLeaf->isEnd = pSrc->isEnd;
+      return pLeaf;
+   }
+
+   const Inner * pInner = static_cast<const Inner *>(pSrc);
+   Node * pDest = new Node4;
+   static_cast<Inner *>(pDest)->prefix = pInner->prefix;
+   pDest->byte = pSrc->byte;
+   if (pInner->pEnd)
+   {
+      Leaf * pEnd = static_cast<Leaf *>(_copy(pInner->pEnd));
+      pEnd->pParent = static_cast<Inner *>(pDest);
+      static_cast<Inner *>(pDest)->pEnd = pEnd;
+   }
+   for (Node * pChild = childAfter(pInner, -1); pChild; pChild = childAfter(pInner, pChild->byte))
+      addChild(pDest, pChild->byte, _copy(pChild));
+   return pDest;
+}
+
+/*********************************************
+ * ART :: _CLEAR and _DELETE
+ * Free a subtree, or just one node
+ ********************************************/
+template <typename T>
+void ART <T> :: _clear(Node * pNode)
+{
+   if (pNode == nullptr)
+      return;
+   if (pNode->type != LEAF)
+   {
+      Inner * pInner = static_cast<Inner *>(pNode);
+      _clear(pInner->pEnd);
+      for (Node * pChild = childAfter(pInner, -1); pChild; )
+      {
+         Node * pNext = childAfter(pInner, pChild->byte);
+         _clear(pChild);
+         pChild = pNext;
+      }
+   }
+   _delete(pNode);
+}
+
+template <typename T>
+void ART <T> :: _delete(Node * pNode)
+{
+   switch (pNode->type)
+   {
+      case LEAF:    delete static_cast<Leaf    *>(pNode); break;
+      case NODE4:   delete static_cast<Node4   *>(pNode); break;
+      case NODE16:  delete static_cast<Node16  *>(pNode); break;
+      case NODE48:  delete static_cast<Node48  *>(pNode); break;
+      case NODE256: delete static_cast<Node256 *>(pNode); break;
+   }
+}
+
+/*********************************************
+ * ART :: _HEIGHT
+ * Number of levels of nodes, leaves included
+ ********************************************/
+template <typename T>
+size_t ART <T> :: _height(const Node * pNode)
+{
+   if (pNode == nullptr)
+      return 0;
+   if (pNode->type == LEAF)
+      return 1;
+   const Inner * pInner = static_cast<const Inner *>(pNode);
+   size_t heightMax = _height(pInner->pEnd);
+   for (Node * pChild = childAfter(pInner, -1); pChild; pChild = childAfter(pInner, pChild->byte))
+   {
+      size_t height = _height(pChild);
+      if (height > heightMax)
+         heightMax = height;
+   }
+   return 1 + heightMax;
+}
+
+/*********************************************
+ *********************************************
+ *************** ART ITERATOR ****************
+ *********************************************
+ *********************************************/
+
+/**************************************************
+ * ART ITERATOR :: INCREMENT PREFIX
+ * The smallest leaf after us under the nearest
+ * ancestor that has anything after us
+ *************************************************/
+template <typename T>
+typename ART <T> :: iterator & ART <T> :: iterator :: operator ++ ()
+{
+   if (pLeaf == nullptr)
+      return *this;
+
+   Node * pNode = pLeaf;
+   while (pNode->pParent)
+   {
+      Inner * pParent = pNode->pParent;
+      Node * pNext = childAfter(pParent, pNode->isEnd ? -1 : (int)pNode->byte);
+      if (pNext)
+      {
+         pLeaf = minimum(pNext);
+         return *this;
+      }
+      pNode = pParent;
+   }
+   pLeaf = nullptr;
+   return *this;
+}
+
+/**************************************************
+ * ART ITERATOR :: DECREMENT PREFIX
+ * The mirror image, where the end slot is the last
+ * thing to look at before climbing
+ *************************************************/
+template <typename T>
+typename ART <T> :: iterator & ART <T> :: iterator :: operator -- ()
+{
+   if (pLeaf == nullptr)
+      return *this;
+
+   Node * pNode = pLeaf;
+   while (pNode->pParent)
+   {
+      Inner * pParent = pNode->pParent;
+      if (!pNode->isEnd)
+      {
+         Node * pPrev = childBefore(pParent, (int)pNode->byte);
+         if (pPrev)
+         {
+            pLeaf = maximum(pPrev);
+            return *this;
+         }
+         if (pParent->pEnd)
+         {
+            pLeaf = pParent->pEnd;
+            return *this;
+         }
+      }
+      pNode = pParent;
+   }
+   pLeaf = nullptr;
+   return *this;
+}
+
+} // namespace custom
@@ -0,0 +1,863 @@
+/***********************************************************************
+ * Header:
+ *    BALANCE
+ * Summary:
+ *    The balancing policies a BST can be built with. Each policy is
+ *    chosen at compile time as the second template parameter of BST
+ *    and set:
+ *
+ *       custom::set <int>                   : red-black (the default)
+ *       custom::set <int, custom::AVL>      : shorter trees for reading
+ *       custom::set <int, custom::Splay>    : hot keys float to the top
+ *       custom::set <int, custom::Treap>    : O(log n) split and join
+ *       custom::set <int, custom::Scapegoat>: nothing extra in the node
+ *       custom::set <int, custom::Unbalanced> : no balancing at all
+ *
+ *    A policy provides:
+ *       Tag                    : extra data stored in every node. There
+ *                                is also one bit free in the node's
+ *                                pParent, isRed(), that red-black uses
+ *       afterInsert(root, p, n): p was just hooked into the tree, which
+ *                                now holds n elements
+ *       afterFind(root, p)     : p was just looked up
+ *       afterErase(root, pRemoved, pChild, pParent, n)
+ *                              : a node with pRemoved's Tag and bit was spliced
+ *                                out, pChild (maybe nullptr) moved up
+ *                                into its place under pParent. The tree
+ *                                now holds n elements
+ *       rotations()            : how many rotations it has performed
+ *
+ *    Treap also provides split() and join() for BST::split and BST::join
+ *
+ *    This will contain the class definition of:
+ *        Unbalanced          : Leave the tree as the inserts made it
+ *        RedBlack            : Red-black tree balancing
+ *        AVL                 : Height balanced AVL tree
+ *        Splay               : Self-adjusting splay tree
+ *        Treap               : Randomized treap that splits and joins
+ *        Scapegoat           : Scapegoat tree, rebuilt instead of rotated
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>    // for size_t
+#include <cstdint>    // for uint32_t
+#include <cmath>      // for log
+#include <vector>     // for std::vector
+
+namespace custom
+{
+
+/*****************************************************************
+ * REPLACE NODE
+ * Hook pNew up to pOld's parent (or the root) in pOld's place.
+ * pOld's children are left alone.
+ *****************************************************************/
+template <class Node>
+void replaceNode(Node * & root, Node * pOld, Node * pNew)
+{
+   if (pOld->pParent == nullptr)
+      root = pNew;
+   else if (pOld->isLeftChild())
+      pOld->pParent->pLeft = pNew;
+   else
+      pOld->pParent->pRight = pNew;
+
+   if (pNew)
+      pNew->pParent = pOld->pParent;
+}
+
+/*****************************************************************
+ * ROTATOR
+ * The rotations every balancing policy is built out of. Keeps
+ * count so we can compare the policies
+ *****************************************************************/
+class Rotator
+{
+public:
+   Rotator() : numRotations(0) { }
+   size_t rotations() const noexcept { return numRotations; }
+
+protected:
+   /****************************************************
+    * ROTATE LEFT
+    * The right child of pNode takes its place:
+    *       (p)                (r)
+    *          +--+        +--+
+    *            (r)  =>  (p)
+    *          +--+          +--+
+    *        (m)               (m)
+    ****************************************************/
+   template <class Node>
+   void rotateLeft(Node * & root, Node * pNode)
+   {
+      Node * pRight = pNode->pRight;
+      assert(pRight != nullptr);
+
+      pNode->addRight(pRight->pLeft);
+      replaceNode(root, pNode, pRight);
+      pRight->addLeft(pNode);
+      numRotations++;
+   }
+
+   /****************************************************
+    * ROTATE RIGHT
+    * The left child of pNode takes its place:
+    *          (p)          (l)
+    *       +--+              +--+
+    *     (l)        =>         (p)
+    *       +--+             +--+
+    *         (m)          (m)
+    ****************************************************/
+   template <class Node>
+   void rotateRight(Node * & root, Node * pNode)
+   {
+      Node * pLeft = pNode->pLeft;
+      assert(pLeft != nullptr);
+
+      pNode->addLeft(pLeft->pRight);
+      replaceNode(root, pNode, pLeft);
+      pLeft->addRight(pNode);
+      numRotations++;
+   }
+
+   size_t numRotations;    // rotations performed since we were created
+};
+
+/*****************************************************************
+ * UNBALANCED
+ * Leave the tree exactly as the inserts built it. Every hook is
+ * empty so this costs nothing, not even a byte in the node
+ *****************************************************************/
+class Unbalanced
+{
+public:
+   struct Tag { };
+
+   template <class Node>
+   void afterInsert(Node * & root, Node * pNode, size_t numElements) { }
+   template <class Node>
+   void afterFind(Node * & root, Node * pNode) { }
+   template <class Node>
+   void afterErase(Node * & root, const Node * pRemoved, Node * pChild, Node * pParent,
+                   size_t numElements) { }
+
+   size_t rotations() const noexcept { return 0; }
+};
+
+/*****************************************************************
+ * RED BLACK
+ * No red node has a red child and every path from the root down
+ * has the same number of black nodes. That keeps the height at or
+ * below 2 log(n+1) with at most three rotations per change
+ *****************************************************************/
+class RedBlack : public Rotator
+{
+public:
+   // The color needs no room of its own: a node keeps it in the
+   // spare low bit of its pParent, behind isRed() and setRed()
+   struct Tag { };
+
+   template <class Node>
+   void afterInsert(Node * & root, Node * pNode, size_t numElements);
+   template <class Node>
+   void afterFind(Node * & root, Node * pNode) { }
+   template <class Node>
+   void afterErase(Node * & root, const Node * pRemoved, Node * pChild, Node * pParent,
+                   size_t numElements)
+   {
+      // Removing a black node shortens one path, so fix it
+      if (!pRemoved->isRed())
+         repairErase(root, pChild, pParent);
+   }
+
+private:
+   // A missing node counts as black
+   template <class Node>
+   static bool isRed(const Node * pNode) { return pNode && pNode->isRed(); }
+
+   template <class Node>
+   void repairErase(Node * & root, Node * pNode, Node * pParent);
+};
+
+/*****************************************************************
+ * AVL
+ * The heights of the two children of every node differ by at most
+ * one. Trees stay within 1.44 log(n+2), shorter than red-black, at
+ * the price of more rotations when writing
+ *****************************************************************/
+class AVL : public Rotator
+{
+public:
+   struct Tag
+   {
+      Tag() : height(1) { }
+      unsigned char height;    // levels in the subtree rooted here
+   };
+
+   template <class Node>
+   void afterInsert(Node * & root, Node * pNode, size_t numElements)
+   {
+      retrace(root, pNode->pParent.get());
+   }
+   template <class Node>
+   void afterFind(Node * & root, Node * pNode) { }
+   template <class Node>
+   void afterErase(Node * & root, const Node * pRemoved, Node * pChild, Node * pParent,
+                   size_t numElements)
+   {
+      retrace(root, pParent);
+   }
+
+private:
+   template <class Node>
+   static int heightOf(const Node * pNode) { return pNode ? pNode->height : 0; }
+
+   template <class Node>
+   static void update(Node * pNode)
+   {
+      int heightLeft  = heightOf(pNode->pLeft);
+      int heightRight = heightOf(pNode->pRight);
+      pNode->height = (unsigned char)(1 + (heightLeft > heightRight ? heightLeft : heightRight));
+   }
+
+   template <class Node>
+   Node * fix(Node * & root, Node * pNode);
+   template <class Node>
+   void retrace(Node * & root, Node * pNode);
+};
+
+/*****************************************************************
+ * SPLAY
+ * Every node we touch is rotated all the way up to the root, so
+ * the keys that are looked up the most stay a hop or two away.
+ * No per-node data and O(log n) amortized, but a single operation
+ * can be O(n) and even find() changes the shape of the tree
+ *****************************************************************/
+class Splay : public Rotator
+{
+public:
+   struct Tag { };
+
+   template <class Node>
+   void afterInsert(Node * & root, Node * pNode, size_t numElements) { splay(root, pNode); }
+   template <class Node>
+   void afterFind(Node * & root, Node * pNode)   { splay(root, pNode); }
+   template <class Node>
+   void afterErase(Node * & root, const Node * pRemoved, Node * pChild, Node * pParent,
+                   size_t numElements)
+   {
+      // the neighborhood of the erased node is what was just used
+      if (pParent)
+         splay(root, pParent);
+   }
+
+private:
+   template <class Node>
+   void splay(Node * & root, Node * pNode);
+};
+
+/*****************************************************************
+ * TREAP
+ * Every node gets a random priority and the tree is kept a heap on
+ * those priorities: no child outranks its parent. That makes the
+ * shape the same as if the keys had been inserted in random order,
+ * so the expected height is O(log n). Each node also knows the size
+ * of its subtree, so cutting a tree in two at a key or gluing two
+ * trees together is O(log n) with the element counts kept exact
+ *****************************************************************/
+class Treap : public Rotator
+{
+public:
+   struct Tag
+   {
+      Tag() : priority(random()), size(1) { }
+      uint32_t priority;       // heap order: no child has a higher one
+      size_t   size;           // nodes in the subtree rooted here
+   };
+
+   template <class Node>
+   void afterInsert(Node * & root, Node * pNode, size_t numElements);
+   template <class Node>
+   void afterFind(Node * & root, Node * pNode) { }
+   template <class Node>
+   void afterErase(Node * & root, const Node * pRemoved, Node * pChild, Node * pParent,
+                   size_t numElements)
+   {
+      // The node in the vacated spot outranked everything below it
+      // and took over its priority, so the heap is fine. Only the
+      // sizes on the way up are one too big
+      for (Node * p = pParent; p; p = p->pParent)
+         p->size--;
+   }
+
+   template <class Node>
+   static size_t sizeOf(const Node * pNode) { return pNode ? pNode->size : 0; }
+
+   template <class Node, class T>
+   static void split(Node * pNode, const T & t, Node * & pLess, Node * & pRest);
+   template <class Node>
+   static Node * join(Node * pLess, Node * pRest);
+
+private:
+   template <class Node>
+   static void update(Node * pNode)
+   {
+      pNode->size = 1 + sizeOf(pNode->pLeft) + sizeOf(pNode->pRight);
+   }
+
+   // xorshift: cheap, and good enough to shuffle the shape of a tree
+   static uint32_t random()
+   {
+      static thread_local uint32_t state = 2463534242u;
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+      return state;
+   }
+};
+
+/*****************************************************************
+ * SCAPEGOAT
+ * Nothing is stored in the nodes. When an insert lands deeper than
+ * log(n) base 3/2, some ancestor has a child holding more than 2/3
+ * of its subtree: that is the scapegoat and its subtree is rebuilt
+ * perfectly balanced. When erasing leaves fewer than 2/3 of the most
+ * elements the tree has held, the whole tree is rebuilt. Both are
+ * linear in what they rebuild but O(log n) amortized
+ *****************************************************************/
+class Scapegoat
+{
+public:
+   Scapegoat() : maxSize(0), numRebuilds(0) { }
+
+   struct Tag { };
+
+   template <class Node>
+   void afterInsert(Node * & root, Node * pNode, size_t numElements);
+   template <class Node>
+   void afterFind(Node * & root, Node * pNode) { }
+   template <class Node>
+   void afterErase(Node * & root, const Node * pRemoved, Node * pChild, Node * pParent,
+                   size_t numElements);
+
+   size_t rotations() const noexcept { return 0;           }
+   size_t rebuilds()  const noexcept { return numRebuilds; }
+
+private:
+   size_t maxSize;      // the most elements the tree has held since its last full rebuild
+   size_t numRebuilds;  // subtrees rebuilt since we were created
+
+   // a subtree is out of balance when one child holds more than 2/3 of it
+   static bool isHeavy(size_t sizeChild, size_t sizeParent) { return 3 * sizeChild > 2 * sizeParent; }
+
+   template <class Node>
+   static size_t sizeOf(const Node * pNode)
+   {
+      return pNode ? 1 + sizeOf(pNode->pLeft) + sizeOf(pNode->pRight) : 0;
+   }
+
+   template <class Node>
+   void rebuild(Node * & root, Node * pNode, size_t size);
+   template <class Node>
+   static void flatten(Node * pNode, std::vector<Node *> & nodes);
+   template <class Node>
+   static Node * build(std::vector<Node *> & nodes, size_t iBegin, size_t iEnd);
+};
+
+/*********************************************
+ *********************************************
+ ***************** RED BLACK *****************
+ *********************************************
+ *********************************************/
+
+/****************************************************
+ * RED BLACK :: AFTER INSERT
+ * A red node was just added. Walk up the tree fixing any
+ * red node that has a red parent
+ ****************************************************/
+template <class Node>
+void RedBlack :: afterInsert(Node * & root, Node * pNode, size_t numElements)
+{
+   pNode->setRed(true);
+
+   // Case 1: we are the root or our parent is black: nothing to do
+   while (pNode->pParent && pNode->pParent->isRed() && pNode->pParent->pParent)
+   {
+      Node * pParent  = pNode->pParent;
+      Node * pGranny  = pParent->pParent;
+      bool   fLeft    = (pGranny->pLeft == pParent);
+      Node * pAunt    = (fLeft ? pGranny->pRight : pGranny->pLeft);
+
+      // Case 2: red aunt. Recolor and push the problem up to granny
+      if (isRed(pAunt))
+      {
+         pParent->setRed(false);
+         pAunt->setRed(false);
+         pGranny->setRed(true);
+         pNode = pGranny;
+         continue;
+      }
+
+      // Case 3: black aunt and we are on the inside. Rotate to the outside
+      if (fLeft && pNode == pParent->pRight)
+      {
+         rotateLeft(root, pParent);
+         pNode   = pParent;
+         pParent = pNode->pParent;
+      }
+      else if (!fLeft && pNode == pParent->pLeft)
+      {
+         rotateRight(root, pParent);
+         pNode   = pParent;
+         pParent = pNode->pParent;
+      }
+
+      // Case 4: black aunt and we are on the outside. Parent takes granny's place
+      pParent->setRed(false);
+      pGranny->setRed(true);
+      if (fLeft)
+         rotateRight(root, pGranny);
+      else
+         rotateLeft(root, pGranny);
+   }
+
+   root->setRed(false);
+}
+
+/****************************************************
+ * RED BLACK :: REPAIR ERASE
+ * A black node was removed from above pNode (which might be
+ * nullptr so we carry its parent along). The path through
+ * pNode is one black short, so borrow or push up
+ ****************************************************/
+template <class Node>
+void RedBlack :: repairErase(Node * & root, Node * pNode, Node * pParent)
+{
+   while (pNode != root && !isRed(pNode))
+   {
+      bool   fLeft    = (pParent->pLeft == pNode);
+      Node * pSibling = (fLeft ? pParent->pRight : pParent->pLeft);
+      assert(pSibling != nullptr);
+
+      // Case 1: red sibling. Rotate so that we get a black one
+      if (pSibling->isRed())
+      {
+         pSibling->setRed(false);
+         pParent->setRed(true);
+         if (fLeft)
+         {
+            rotateLeft(root, pParent);
+            pSibling = pParent->pRight;
+         }
+         else
+         {
+            rotateRight(root, pParent);
+            pSibling = pParent->pLeft;
+         }
+      }
+
+      // Case 2: black sibling with black children. Recolor and move up
+      if (!isRed(pSibling->pLeft) && !isRed(pSibling->pRight))
+      {
+         pSibling->setRed(true);
+         pNode   = pParent;
+         pParent = pNode->pParent;
+         continue;
+      }
+
+      // Case 3: the sibling's far child is black. Rotate the red one out
+      if (fLeft && !isRed(pSibling->pRight))
+      {
+         pSibling->pLeft->setRed(false);
+         pSibling->setRed(true);
+         rotateRight(root, pSibling);
+         pSibling = pParent->pRight;
+      }
+      else if (!fLeft && !isRed(pSibling->pLeft))
+      {
+         pSibling->pRight->setRed(false);
+         pSibling->setRed(true);
+         rotateLeft(root, pSibling);
+         pSibling = pParent->pLeft;
+      }
+
+      // Case 4: the sibling's far child is red. Rotate the parent down to us
+      pSibling->setRed(pParent->isRed());
+      pParent->setRed(false);
+      if (fLeft)
+      {
+         pSibling->pRight->setRed(false);
+         rotateLeft(root, pParent);
+      }
+      else
+      {
+         pSibling->pLeft->setRed(false);
+         rotateRight(root, pParent);
+      }
+      pNode = root;
+   }
+
+   if (pNode)
+      pNode->setRed(false);
+}
+
+/*********************************************
+ *********************************************
+ ******************** AVL ********************
+ *********************************************
+ *********************************************/
+
+/****************************************************
+ * AVL :: FIX
+ * Bring pNode's height up to date and, if one side got
+ * two taller than the other, rotate it back. Returns the
+ * node now at the top of this subtree
+ ****************************************************/
+template <class Node>
+Node * AVL :: fix(Node * & root, Node * pNode)
+{
+   update(pNode);
+   int balance = heightOf(pNode->pLeft) - heightOf(pNode->pRight);
+
+   // Left heavy. If the left child leans right, straighten it first
+   if (balance > 1)
+   {
+      Node * pLeft = pNode->pLeft;
+      if (heightOf(pLeft->pLeft) < heightOf(pLeft->pRight))
+      {
+         rotateLeft(root, pLeft);
+         update(pLeft);
+      }
+      rotateRight(root, pNode);
+   }
+
+   // Right heavy. If the right child leans left, straighten it first
+   else if (balance < -1)
+   {
+      Node * pRight = pNode->pRight;
+      if (heightOf(pRight->pRight) < heightOf(pRight->pLeft))
+      {
+         rotateRight(root, pRight);
+         update(pRight);
+      }
+      rotateLeft(root, pNode);
+   }
+   else
+      return pNode;
+
+   // pNode moved down a level, so its new parent is the top now
+   update(pNode);
+   update(pNode->pParent.get());
+   return pNode->pParent;
+}
+
+/****************************************************
+ * AVL :: RETRACE
+ * A subtree under pNode changed height. Walk up the tree
+ * fixing each node until a subtree's height is unchanged
+ ****************************************************/
+template <class Node>
+void AVL :: retrace(Node * & root, Node * pNode)
+{
+   while (pNode)
+   {
+      int heightOld = pNode->height;
+      Node * pTop = fix(root, pNode);
+      if (pTop->height == heightOld)
+         return;
+      pNode = pTop->pParent;
+   }
+}
+
+/*********************************************
+ *********************************************
+ ******************* SPLAY *******************
+ *********************************************
+ *********************************************/
+
+/****************************************************
+ * SPLAY :: SPLAY
+ * Rotate pNode up to the root two levels at a time:
+ *   zig     : parent is the root, one rotation
+ *   zig-zig : we and parent lean the same way. Rotate
+ *             granny first, then parent
+ *   zig-zag : we lean the other way. Rotate parent,
+ *             then granny
+ ****************************************************/
+template <class Node>
+void Splay :: splay(Node * & root, Node * pNode)
+{
+   while (pNode->pParent)
+   {
+      Node * pParent = pNode->pParent;
+      Node * pGranny = pParent->pParent;
+      bool   fLeft   = (pParent->pLeft == pNode);
+
+      // zig
+      if (pGranny == nullptr)
+      {
+         if (fLeft)
+            rotateRight(root, pParent);
+         else
+            rotateLeft(root, pParent);
+      }
+
+      // zig-zig
+      else if (fLeft == (pGranny->pLeft == pParent))
+      {
+         if (fLeft)
+         {
+            rotateRight(root, pGranny);
+            rotateRight(root, pParent);
+         }
+         else
+         {
+            rotateLeft(root, pGranny);
+            rotateLeft(root, pParent);
+         }
+      }
+
+      // zig-zag
+      else
+      {
+         if (fLeft)
+         {
+            rotateRight(root, pParent);
+            rotateLeft(root, pGranny);
+         }
+         else
+         {
+            rotateLeft(root, pParent);
+            rotateRight(root, pGranny);
+         }
+      }
+   }
+}
+
+/*********************************************
+ *********************************************
+ ******************* TREAP *******************
+ *********************************************
+ *********************************************/
+
+/****************************************************
+ * TREAP :: AFTER INSERT
+ * pNode went in as a leaf. Everything above it grew by
+ * one, then rotate it up past any parent it outranks
+ ****************************************************/
+template <class Node>
+void Treap :: afterInsert(Node * & root, Node * pNode, size_t numElements)
+{
+   for (Node * p = pNode->pParent; p; p = p->pParent)
+      p->size++;
+
+   while (pNode->pParent && pNode->pParent->priority < pNode->priority)
+   {
+      Node * pParent = pNode->pParent;
+      if (pParent->pLeft == pNode)
+         rotateRight(root, pParent);
+      else
+         rotateLeft(root, pParent);
+
+      // pParent is now our child. We take over its old size
+      pNode->size = pParent->size;
+      update(pParent);
+   }
+}
+
+/****************************************************
+ * TREAP :: SPLIT
+ * Cut the treap rooted at pNode in two: pLess gets
+ * everything less than t, pRest everything else. Only the
+ * nodes on the search path for t are touched
+ ****************************************************/
+template <class Node, class T>
+void Treap :: split(Node * pNode, const T & t, Node * & pLess, Node * & pRest)
+{
+   if (pNode == nullptr)
+   {
+      pLess = pRest = nullptr;
+      return;
+   }
+
+   // pNode and its left subtree are less. Cut up the right subtree
+   if (pNode->data < t)
+   {
+      Node * pRight;
+      split(pNode->pRight, t, pRight, pRest);
+      pNode->addRight(pRight);
+      pLess = pNode;
+   }
+   // pNode and its right subtree are the rest. Cut up the left subtree
+   else
+   {
+      Node * pLeft;
+      split(pNode->pLeft, t, pLess, pLeft);
+      pNode->addLeft(pLeft);
+      pRest = pNode;
+   }
+
+   pNode->pParent = nullptr;
+   update(pNode);
+}
+
+/****************************************************
+ * TREAP :: JOIN
+ * Glue two treaps together where everything in pLess
+ * comes before everything in pRest. The root with the
+ * higher priority stays on top. Returns the new root
+ ****************************************************/
+template <class Node>
+Node * Treap :: join(Node * pLess, Node * pRest)
+{
+   if (pLess == nullptr)
+      return pRest;
+   if (pRest == nullptr)
+      return pLess;
+
+   Node * pTop;
+   if (pRest->priority < pLess->priority)
+   {
+      pLess->addRight(join(pLess->pRight, pRest));
+      pTop = pLess;
+   }
+   else
+   {
+      pRest->addLeft(join(pLess, pRest->pLeft));
+      pTop = pRest;
+   }
+
+   pTop->pParent = nullptr;
+   update(pTop);
+   return pTop;
+}
+
+/*********************************************
+ *********************************************
+ ***************** SCAPEGOAT *****************
+ *********************************************
+ *********************************************/
+
+/****************************************************
+ * SCAPEGOAT :: AFTER INSERT
+ * If pNode is too deep, walk up counting subtree sizes
+ * until we find the ancestor that is too heavy on our side
+ ****************************************************/
+template <class Node>
+void Scapegoat :: afterInsert(Node * & root, Node * pNode, size_t numElements)
+{
+   // a tree that was emptied starts its count over
+   if (numElements == 1 || maxSize < numElements)
+      maxSize = numElements;
+
+   size_t depth = 0;
+   for (const Node * p = pNode; p->pParent; p = p->pParent)
+      depth++;
+   if ((double)depth <= log((double)numElements) / log(1.5))
+      return;
+
+   // the scapegoat must be up there somewhere
+   size_t size = 1;
+   while (pNode->pParent)
+   {
+      Node * pParent  = pNode->pParent;
+      Node * pSibling = (pParent->pLeft == pNode ? pParent->pRight : pParent->pLeft);
+      size_t sizeParent = 1 + size + sizeOf(pSibling);
+
+      if (isHeavy(size, sizeParent))
+      {
+         rebuild(root, pParent, sizeParent);
+         return;
+      }
+
+      pNode = pParent;
+      size  = sizeParent;
+   }
+}
+
+/****************************************************
+ * SCAPEGOAT :: AFTER ERASE
+ * Too many elements have gone since the last rebuild:
+ * rebuild the whole tree
+ ****************************************************/
+template <class Node>
+void Scapegoat :: afterErase(Node * & root, const Node * pRemoved, Node * pChild, Node * pParent,
+                             size_t numElements)
+{
+   if (maxSize < numElements)
+      maxSize = numElements;
+
+   // fewer than two thirds of the most it has held since
+   if (root && 2 * maxSize > 3 * numElements)
+   {
+      rebuild(root, root, numElements);
+      maxSize = numElements;
+   }
+}
+
+/****************************************************
+ * SCAPEGOAT :: REBUILD
+ * Replace the subtree at pNode holding size nodes with a
+ * perfectly balanced one made of the same nodes
+ ****************************************************/
+template <class Node>
+void Scapegoat :: rebuild(Node * & root, Node * pNode, size_t size)
+{
+   Node * pParent = pNode->pParent;
+   bool fLeft = pNode->isLeftChild();
+
+   std::vector<Node *> nodes;
+   nodes.reserve(size);
+   flatten(pNode, nodes);
+   Node * pTop = build(nodes, 0, nodes.size());
+
+   if (pParent == nullptr)
+   {
+      root = pTop;
+      pTop->pParent = nullptr;
+   }
+   else if (fLeft)
+      pParent->addLeft(pTop);
+   else
+      pParent->addRight(pTop);
+
+   numRebuilds++;
+}
+
+/****************************************************
+ * SCAPEGOAT :: FLATTEN
+ * Put the nodes of a subtree in order
+ ****************************************************/
+template <class Node>
+void Scapegoat :: flatten(Node * pNode, std::vector<Node *> & nodes)
+{
+   if (pNode == nullptr)
+      return;
+   flatten(pNode->pLeft, nodes);    // L
+   nodes.push_back(pNode);          // V
+   flatten(pNode->pRight, nodes);   // R
+}
+
+/****************************************************
+ * SCAPEGOAT :: BUILD
+ * Hook nodes[iBegin, iEnd) up as a perfectly balanced
+ * subtree with the middle one on top. Returns the top
+ ****************************************************/
+template <class Node>
+Node * Scapegoat :: build(std::vector<Node *> & nodes, size_t iBegin, size_t iEnd)
+{
+   if (iBegin == iEnd)
+      return nullptr;
+
+   size_t iMiddle = iBegin + (iEnd - iBegin) / 2;
+   Node * pNode = nodes[iMiddle];
+   pNode->addLeft (build(nodes, iBegin,      iMiddle));
+   pNode->addRight(build(nodes, iMiddle + 1, iEnd));
+   return pNode;
+}
+
+} // namespace custom
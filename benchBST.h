@@ -0,0 +1,625 @@
+/***********************************************************************
+ * Header:
+ *    BENCH BST
+ * Summary:
+ *    Timings to compare the BST balancing policies against each other
+ *    and against the B-tree, the B+ tree, the skip list, the flat_set,
+ *    the frozen_set, the adaptive radix tree, the van Emde Boas tree,
+ *    the static search tree, the Swiss-table unordered_set, the
+ *    dense bitset, the roaring_set, the elias_fano_set, the
+ *    perfect_set and a set behind a Bloom filter.
+ *    These only run when BENCHMARK is defined, so build with
+ *    -DBENCHMARK (and optimizations on) to see the numbers
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef BENCHMARK
+
+#include "bst.h"
+#include "btree.h"
+#include "bplustree.h"
+#include "flatSet.h"
+#include "frozenSet.h"
+#include "unorderedSet.h"
+#include "skipList.h"
+#include "compactTree.h"
+#include "art.h"
+#include "veb.h"
+#include "bitset.h"
+#include "roaringSet.h"
+#include "eliasFano.h"
+#include "perfectSet.h"
+#include "set.h"
+#include "sTree.h"
+
+#include <algorithm>  // for std::shuffle and std::upper_bound
+#include <chrono>     // for std::chrono::steady_clock
+#include <cmath>      // for pow
+#include <cstdint>    // for uint32_t
+#include <iostream>   // for std::cout
+#include <memory>     // for std::unique_ptr
+#include <random>     // for std::mt19937
+#include <string>     // for std::string
+#include <vector>     // for std::vector
+
+/***********************************************
+ * ZIPF
+ * Draw ranks in [0, n) where rank i comes up in proportion to
+ * 1 / (i + 1)^s. With s near 1 a handful of ranks get most draws
+ ***********************************************/
+class Zipf
+{
+public:
+   Zipf(size_t n, double s) : cdf(n)
+   {
+      double sum = 0.0;
+      for (size_t i = 0; i < n; i++)
+         cdf[i] = (sum += 1.0 / pow((double)(i + 1), s));
+      for (auto & value : cdf)
+         value /= sum;
+   }
+
+   template <class Random>
+   size_t operator () (Random & random)
+   {
+      double u = std::uniform_real_distribution<double>(0.0, 1.0)(random);
+      size_t rank = std::upper_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+      return (rank < cdf.size() ? rank : cdf.size() - 1);
+   }
+
+private:
+   std::vector<double> cdf;   // cumulative probability of each rank
+};
+
+/***********************************************
+ * BENCH BST
+ * Time the balancing policies on the same workloads
+ ***********************************************/
+class BenchBST
+{
+public:
+   BenchBST() : numKeys(1000000), numFinds(4000000) { }
+
+   void run()
+   {
+      std::mt19937 random(235);
+
+      // the keys, in the order they are inserted
+      std::vector<int> keys(numKeys);
+      for (size_t i = 0; i < numKeys; i++)
+         keys[i] = (int)(i * 2);
+      std::shuffle(keys.begin(), keys.end(), random);
+
+      // the lookups. Hot ranks are scattered across the key space
+      std::vector<int> uniform(numFinds);
+      std::vector<int> skewed(numFinds);
+      Zipf zipf(numKeys, 0.99);
+      std::uniform_int_distribution<size_t> any(0, numKeys - 1);
+      for (size_t i = 0; i < numFinds; i++)
+      {
+         uniform[i] = keys[any(random)];
+         skewed[i]  = keys[zipf(random)];
+      }
+
+      std::cout << "BST find, " << numKeys << " keys, "
+                << numFinds << " lookups (ns per find)\n";
+      std::cout << "\tpolicy    \tuniform\tZipf(0.99)\n";
+      timeFind<custom::BST  <int, custom::RedBlack>>("RedBlack", keys, uniform, skewed);
+      timeFind<RelaidOut                           >("RB vEB  ", keys, uniform, skewed);
+      timeFind<custom::BST  <int, custom::AVL     >>("AVL     ", keys, uniform, skewed);
+      timeFind<custom::CompactTree<int>            >("compact ", keys, uniform, skewed);
+      timeFind<custom::BST  <int, custom::Splay   >>("Splay   ", keys, uniform, skewed);
+      timeFind<custom::BTree<int>                  >("BTree   ", keys, uniform, skewed);
+      timeFind<custom::flat_set<int>               >("flat_set", keys, uniform, skewed);
+      timeFind<custom::frozen_set<int>             >("frozen  ", keys, uniform, skewed);
+      timeFind<custom::unordered_set<int>          >("hash set", keys, uniform, skewed);
+
+      std::cout << "Full scan, " << numKeys << " keys (ns per element)\n";
+      timeScan<custom::BST      <int>>("RedBlack", keys);
+      timeScan<custom::CompactTree<int>>("compact ", keys);
+      timeScan<custom::BTree    <int>>("BTree   ", keys);
+      timeScan<custom::BPlusTree<int>>("BPlus   ", keys);
+
+      std::cout << "Insert " << numKeys << " keys, then erase and insert half again (ns per change)\n";
+      timeInsert<custom::BST     <int, custom::RedBlack>>("RedBlack", keys);
+      timeInsert<custom::BST     <int, custom::AVL     >>("AVL     ", keys);
+      timeInsert<custom::CompactTree<int               >>("compact ", keys);
+      timeInsert<custom::SkipList<int, 4             >>("Skip 1/4", keys);
+      timeInsert<custom::SkipList<int, 2             >>("Skip 1/2", keys);
+
+      std::cout << "Clear " << numKeys << " keys (ns per key)\n";
+      timeClear("RedBlack", keys, false);
+      timeClear("RB arena", keys, true);
+
+      // long keys that share most of their bytes, like paths
+      std::vector<std::string> names(numKeys / 4);
+      for (size_t i = 0; i < names.size(); i++)
+         names[i] = "tenant/region-" + std::to_string(i % 16) + "/account/" + std::to_string(i * 7919);
+      std::vector<std::string> lookups(numFinds / 4);
+      std::uniform_int_distribution<size_t> anyName(0, names.size() - 1);
+      for (auto & lookup : lookups)
+         lookup = names[anyName(random)];
+
+      std::cout << "String find, " << names.size() << " keys, "
+                << lookups.size() << " lookups (ns per find)\n";
+      timeFindString<custom::BST<std::string>>("RedBlack", names, lookups);
+      timeFindString<custom::ART<std::string>>("ART     ", names, lookups);
+
+      // flow IDs spread over a 24-bit universe, and probes anywhere in it
+      std::vector<uint32_t> flows(numKeys);
+      for (size_t i = 0; i < numKeys; i++)
+         flows[i] = (uint32_t)(i * 16);
+      std::shuffle(flows.begin(), flows.end(), random);
+      std::vector<uint32_t> probes(numFinds);
+      std::uniform_int_distribution<uint32_t> anyFlow(0, (1u << 24) - 1);
+      for (auto & probe : probes)
+         probe = anyFlow(random);
+
+      std::cout << "Successor, " << flows.size() << " keys, "
+                << probes.size() << " upper_bound() calls (ns per call)\n";
+      timeSuccessor<custom::BST<uint32_t>    >("RedBlack", flows, probes);
+      timeSuccessor<custom::VEB<uint32_t, 24>>("VEB     ", flows, probes);
+
+      // shard IDs, each set holding about half of the 64K of them
+      std::vector<std::vector<uint16_t>> shards(16);
+      std::bernoulli_distribution half(0.5);
+      for (auto & shard : shards)
+         for (uint32_t i = 0; i < 65536; i++)
+            if (half(random))
+               shard.push_back((uint16_t)i);
+
+      std::cout << "Intersect, " << shards.size() << " sets of 64K shard IDs, "
+                << "every pair (us per intersection)\n";
+      timeIntersect<custom::set<uint16_t>                          >("RedBlack", shards);
+      timeIntersect<custom::set<uint16_t, custom::BitsetEngine<16>>>("Bitset  ", shards);
+
+      // posting lists: document IDs out of 100M, from rare terms to common ones
+      std::vector<std::vector<uint32_t>> postings(8);
+      for (size_t i = 0; i < postings.size(); i++)
+      {
+         std::bernoulli_distribution inDoc(0.002 * (double)(i + 1));
+         for (uint32_t doc = 0; doc < 100000000u; doc += 1 + (uint32_t)(random() % 64))
+            if (inDoc(random))
+               postings[i].push_back(doc);
+      }
+      size_t numPostings = 0;
+      custom::roaring_set<uint32_t> all;
+      for (auto & posting : postings)
+      {
+         numPostings += posting.size();
+         custom::roaring_set<uint32_t> one(posting.begin(), posting.end());
+         one.optimize();
+         all |= one;
+      }
+
+      std::cout << "Postings, " << postings.size() << " lists of " << numPostings / postings.size()
+                << " IDs on average, every pair (us per intersection)\n";
+      timeIntersect<custom::set<uint32_t>        >("RedBlack", postings);
+      timeIntersect<custom::roaring_set<uint32_t>>("Roaring ", postings);
+      std::cout << "\troaring_set of all " << all.size() << " IDs: "
+                << (double)all.bytes() / (double)all.size() << " bytes per ID\n";
+
+      timeEliasFano(random);
+      timeAllowList(random);
+      timeBloom(random);
+      timeSTree(random);
+   }
+
+private:
+   size_t numKeys;    // elements in each tree
+   size_t numFinds;   // lookups timed for each workload
+
+   // a red-black tree moved into van Emde Boas order once it is full
+   struct RelaidOut : public custom::BST <int, custom::RedBlack> { };
+
+   /***********************************************
+    * FILL
+    * Insert the keys one at a time, or all at once
+    * for a flat_set or a frozen_set. A RelaidOut tree
+    * is relaid out after the last insert
+    ***********************************************/
+   template <class Tree>
+   static void fill(Tree & bst, const std::vector<int> & keys)
+   {
+      for (auto key : keys)
+         bst.insert(key, true);
+   }
+   static void fill(RelaidOut & bst, const std::vector<int> & keys)
+   {
+      for (auto key : keys)
+         bst.insert(key, true);
+      bst.relayout_veb();
+   }
+   static void fill(custom::flat_set<int> & s, const std::vector<int> & keys)
+   {
+      s.insert(keys.begin(), keys.end());
+   }
+   static void fill(custom::unordered_set<int> & s, const std::vector<int> & keys)
+   {
+      s.insert(keys.begin(), keys.end());
+   }
+   static void fill(custom::frozen_set<int> & s, const std::vector<int> & keys)
+   {
+      s = custom::frozen_set<int>(keys.begin(), keys.end());
+   }
+
+   /***********************************************
+    * TIME FIND
+    * Build a tree of the given type, then time a run of
+    * find() over each workload
+    ***********************************************/
+   template <class Tree>
+   void timeFind(const char * name, const std::vector<int> & keys,
+                 const std::vector<int> & uniform, const std::vector<int> & skewed)
+   {
+      Tree bst;
+      fill(bst, keys);
+
+      double nsUniform = timeFind(bst, uniform);
+      double nsSkewed  = timeFind(bst, skewed);
+
+      std::cout.setf(std::ios::fixed | std::ios::showpoint);
+      std::cout.precision(1);
+      std::cout << "\t" << name << "\t" << nsUniform << "\t" << nsSkewed << "\n";
+   }
+
+   /***********************************************
+    * TIME SCAN
+    * Build a tree of the given type, then time walking it
+    * from begin() to end() the way an export would
+    ***********************************************/
+   template <class Tree>
+   void timeScan(const char * name, const std::vector<int> & keys)
+   {
+      Tree bst;
+      fill(bst, keys);
+
+      long long sum = 0;
+      size_t numScans = 10;
+      auto begin = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < numScans; i++)
+         for (auto it = bst.begin(); it != bst.end(); ++it)
+            sum += *it;
+      auto end = std::chrono::steady_clock::now();
+
+      // the keys are 0, 2, 4, ... so this keeps the loop honest
+      long long expected = (long long)numKeys * (long long)(numKeys - 1) * (long long)numScans;
+      if (sum != expected)
+         std::cout << "\tscan added up to " << sum << " instead of " << expected << "\n";
+
+      std::cout << "\t" << name << "\t"
+                << std::chrono::duration<double, std::nano>(end - begin).count()
+                   / (double)(numKeys * numScans) << "\n";
+   }
+
+   /***********************************************
+    * TIME INSERT
+    * Time filling a tree of the given type in random order,
+    * then churning half of it out and back in
+    ***********************************************/
+   template <class Tree>
+   void timeInsert(const char * name, const std::vector<int> & keys)
+   {
+      auto begin = std::chrono::steady_clock::now();
+      {
+         Tree bst;
+         for (auto key : keys)
+            bst.insert(key, true);
+         for (size_t i = 0; i < numKeys; i += 2)
+         {
+            auto it = bst.find(keys[i]);
+            bst.erase(it);
+         }
+         for (size_t i = 0; i < numKeys; i += 2)
+            bst.insert(keys[i] + 1, true);
+         if (bst.size() != numKeys)
+            std::cout << "\tended up with " << bst.size() << " keys\n";
+      }
+      auto end = std::chrono::steady_clock::now();
+
+      std::cout << "\t" << name << "\t"
+                << std::chrono::duration<double, std::nano>(end - begin).count()
+                   / (double)(numKeys * 2) << "\n";
+   }
+
+   /***********************************************
+    * TIME CLEAR
+    * Time clear() on a tree filled in random order, with
+    * its nodes from the pool or from an arena
+    ***********************************************/
+   void timeClear(const char * name, const std::vector<int> & keys, bool useArena)
+   {
+      custom::BST <int> bst;
+      if (useArena)
+         bst.use_arena();
+      for (auto key : keys)
+         bst.insert(key, true);
+
+      auto begin = std::chrono::steady_clock::now();
+      bst.clear();
+      auto end = std::chrono::steady_clock::now();
+
+      std::cout << "\t" << name << "\t"
+                << std::chrono::duration<double, std::nano>(end - begin).count()
+                   / (double)keys.size() << "\n";
+   }
+
+   /***********************************************
+    * INTERSECT
+    * What is in both, by looking up each element of one in
+    * the other, or a word or container at a time for a
+    * bitset or a roaring_set
+    ***********************************************/
+   template <class Set>
+   static Set intersect(const Set & lhs, Set & rhs)
+   {
+      Set both;
+      for (auto it = lhs.begin(); it != lhs.end(); ++it)
+         if (rhs.find(*it) != rhs.end())
+            both.insert(*it);
+      return both;
+   }
+   static custom::set<uint16_t, custom::BitsetEngine<16>> intersect(
+      const custom::set<uint16_t, custom::BitsetEngine<16>> & lhs,
+      custom::set<uint16_t, custom::BitsetEngine<16>> & rhs)
+   {
+      custom::set<uint16_t, custom::BitsetEngine<16>> both(lhs);
+      both &= rhs;
+      return both;
+   }
+   static custom::roaring_set<uint32_t> intersect(const custom::roaring_set<uint32_t> & lhs,
+                                                  custom::roaring_set<uint32_t> & rhs)
+   {
+      return lhs & rhs;
+   }
+
+   /***********************************************
+    * TIME INTERSECT
+    * Build a set of each kind for every shard list, then
+    * time intersecting every pair of them
+    ***********************************************/
+   template <class Set, typename Key>
+   void timeIntersect(const char * name, const std::vector<std::vector<Key>> & shards)
+   {
+      std::vector<Set> sets(shards.size());
+      for (size_t i = 0; i < shards.size(); i++)
+         sets[i].insert(shards[i].begin(), shards[i].end());
+
+      size_t total = 0;
+      size_t numPairs = 0;
+      auto begin = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < sets.size(); i++)
+         for (size_t j = i + 1; j < sets.size(); j++, numPairs++)
+            total += intersect(sets[i], sets[j]).size();
+      auto end = std::chrono::steady_clock::now();
+
+      std::cout << "\t" << name << "\t"
+                << std::chrono::duration<double, std::micro>(end - begin).count()
+                   / (double)numPairs << "\t(" << total / numPairs << " in common)\n";
+   }
+
+   /***********************************************
+    * TIME FIND STRING
+    * Build a tree of strings, then time find() over the lookups
+    ***********************************************/
+   template <class Tree>
+   void timeFindString(const char * name, const std::vector<std::string> & names,
+                       const std::vector<std::string> & lookups)
+   {
+      Tree bst;
+      for (auto & key : names)
+         bst.insert(key, true);
+
+      std::cout << "\t" << name << "\t" << timeFind(bst, lookups) << "\n";
+   }
+
+   /***********************************************
+    * TIME SUCCESSOR
+    * Build a tree of flow IDs, then time upper_bound()
+    * over the probes
+    ***********************************************/
+   template <class Tree>
+   void timeSuccessor(const char * name, const std::vector<uint32_t> & flows,
+                      const std::vector<uint32_t> & probes)
+   {
+      Tree bst;
+      for (auto flow : flows)
+         bst.insert(flow, true);
+
+      // every flow is a multiple of 16, so each answer is the next one up
+      size_t numRight = 0;
+      auto begin = std::chrono::steady_clock::now();
+      for (auto probe : probes)
+      {
+         auto it = bst.upper_bound(probe);
+         numRight += (it == bst.end() || *it == (probe | 15) + 1);
+      }
+      auto end = std::chrono::steady_clock::now();
+      if (numRight != probes.size())
+         std::cout << "\tonly " << numRight << " of " << probes.size() << " were right\n";
+
+      std::cout << "\t" << name << "\t"
+                << std::chrono::duration<double, std::nano>(end - begin).count()
+                   / (double)probes.size() << "\n";
+   }
+
+   /***********************************************
+    * TIME S TREE
+    * Build a set ten times the usual size, then time its
+    * find() against a static search tree made from it, one
+    * key at a time and in batches, with each kind of node
+    * search this machine has
+    ***********************************************/
+   void timeSTree(std::mt19937 & random)
+   {
+      size_t numBig = numKeys * 10;
+      std::vector<int> keys(numBig);
+      for (size_t i = 0; i < numBig; i++)
+         keys[i] = (int)(i * 2);
+      std::shuffle(keys.begin(), keys.end(), random);
+      std::vector<int> lookups(numFinds);
+      std::uniform_int_distribution<size_t> any(0, numBig - 1);
+      for (auto & lookup : lookups)
+         lookup = keys[any(random)];
+
+      custom::set<int> s;
+      for (auto key : keys)
+         s.insert(key);
+      custom::STree tree(s);
+
+      std::cout << "Static search tree, " << numBig << " keys, "
+                << numFinds << " lookups (ns per find)\n";
+      std::cout << "\tset find\t" << timeFind(s, lookups) << "\n";
+
+      const char * names[] = { "scalar", "SSE2  ", "AVX2  " };
+      std::unique_ptr<bool[]> pFound(new bool[numFinds]);
+      int best = tree.simdUsed();
+      for (int simd = custom::STree::SCALAR; simd <= best; simd++)
+      {
+         tree.useSimd((custom::STree::Simd)simd);
+
+         size_t numOne = 0;
+         auto begin = std::chrono::steady_clock::now();
+         for (auto key : lookups)
+            numOne += tree.contains(key);
+         auto middle = std::chrono::steady_clock::now();
+         size_t numBatch = tree.contains(lookups.data(), lookups.size(), pFound.get());
+         auto end = std::chrono::steady_clock::now();
+
+         if (numOne != numFinds || numBatch != numFinds)
+            std::cout << "\tonly found " << numOne << " and " << numBatch << "\n";
+         std::cout << "\t" << names[simd] << " one\t"
+                   << std::chrono::duration<double, std::nano>(middle - begin).count() / (double)numFinds
+                   << "\tbatch\t"
+                   << std::chrono::duration<double, std::nano>(end - middle).count() / (double)numFinds
+                   << "\n";
+      }
+   }
+
+   /***********************************************
+    * TIME ELIAS FANO
+    * Spread 64-bit IDs over a 2^40 universe, then time
+    * find() on the set against the elias_fano_set made
+    * from it, and say how small each one is
+    ***********************************************/
+   void timeEliasFano(std::mt19937 & random)
+   {
+      std::uniform_int_distribution<uint64_t> any((uint64_t)0, ((uint64_t)1 << 40) - 1);
+      custom::set<uint64_t> s;
+      while (s.size() < numKeys)
+         s.insert(any(random));
+      custom::elias_fano_set<uint64_t> ids(s);
+
+      std::vector<uint64_t> lookups(numFinds);
+      std::uniform_int_distribution<size_t> anyRank(0, numKeys - 1);
+      for (auto & lookup : lookups)
+         lookup = ids.at(anyRank(random));
+
+      std::cout << "Elias-Fano, " << numKeys << " IDs out of 2^40, "
+                << numFinds << " lookups (ns per find)\n";
+      std::cout << "\tset     \t" << timeFind(s, lookups) << "\n";
+      std::cout << "\tElias-F \t" << timeFind(ids, lookups) << "\t("
+                << (double)ids.bytes() * 8.0 / (double)ids.size() << " bits per ID)\n";
+   }
+
+   /***********************************************
+    * TIME ALLOW LIST
+    * Time membership tests, half of them for something
+    * that is there, on the set, the unordered_set and
+    * the perfect_set made from the set
+    ***********************************************/
+   void timeAllowList(std::mt19937 & random)
+   {
+      custom::set<uint64_t> s;
+      custom::unordered_set<uint64_t> hashed;
+      for (size_t i = 0; i < numKeys; i++)
+      {
+         s.insert((uint64_t)i * 2 * 7919);
+         hashed.insert((uint64_t)i * 2 * 7919);
+      }
+      custom::perfect_set<uint64_t> allowed(s);
+
+      // even multiples are there, odd ones are not
+      std::vector<uint64_t> lookups(numFinds);
+      std::uniform_int_distribution<uint64_t> any(0, (uint64_t)numKeys * 2 - 1);
+      for (auto & lookup : lookups)
+         lookup = any(random) * 7919;
+
+      std::cout << "Allow list, " << numKeys << " IDs, "
+                << numFinds << " lookups, half of them misses (ns per lookup)\n";
+      std::cout << "\tset     \t" << timeContains(s, lookups) << "\n";
+      std::cout << "\thash set\t" << timeContains(hashed, lookups) << "\n";
+      std::cout << "\tperfect \t" << timeContains(allowed, lookups) << "\t("
+                << (double)(allowed.bytes() - allowed.size() * sizeof(uint64_t)) * 8.0
+                   / (double)allowed.size() << " bits per ID beside the IDs)\n";
+   }
+
+   /***********************************************
+    * TIME BLOOM
+    * Time find() on a set where nine lookups in ten miss,
+    * without and then with its Bloom filter
+    ***********************************************/
+   void timeBloom(std::mt19937 & random)
+   {
+      custom::set<uint64_t> s;
+      for (size_t i = 0; i < numKeys; i++)
+         s.insert((uint64_t)i * 2);
+
+      // even keys are there, odd ones are not
+      std::vector<uint64_t> lookups(numFinds);
+      std::uniform_int_distribution<uint64_t> any(0, (uint64_t)numKeys - 1);
+      std::uniform_int_distribution<int> tenth(0, 9);
+      for (auto & lookup : lookups)
+         lookup = any(random) * 2 + (tenth(random) != 0);
+
+      std::cout << "Mostly misses, " << numKeys << " keys, "
+                << numFinds << " lookups, nine in ten misses (ns per find)\n";
+      std::cout << "\tset     \t" << timeContains(s, lookups) << "\n";
+      s.use_bloom_filter();
+      std::cout << "\tBloom   \t" << timeContains(s, lookups) << "\t("
+                << s.bloom_false_positive_rate() * 100.0 << "% false positives)\n";
+   }
+
+   template <class Set>
+   static bool has(Set & s, uint64_t key)                           { return s.find(key) != s.end(); }
+   static bool has(custom::perfect_set<uint64_t> & s, uint64_t key)  { return s.contains(key); }
+
+   template <class Set>
+   double timeContains(Set & s, const std::vector<uint64_t> & lookups)
+   {
+      size_t numFound = 0;
+      auto begin = std::chrono::steady_clock::now();
+      for (auto key : lookups)
+         numFound += has(s, key);
+      auto end = std::chrono::steady_clock::now();
+
+      // some of them are there, so this keeps the loop honest
+      if (numFound == 0 || numFound == lookups.size())
+         std::cout << "\tfound " << numFound << " of " << lookups.size() << "\n";
+
+      return std::chrono::duration<double, std::nano>(end - begin).count()
+             / (double)lookups.size();
+   }
+
+   template <class Tree, class Key>
+   double timeFind(Tree & bst, const std::vector<Key> & lookups)
+   {
+      size_t numFound = 0;
+      auto begin = std::chrono::steady_clock::now();
+      for (auto key : lookups)
+         numFound += (bst.find(key) != bst.end());
+      auto end = std::chrono::steady_clock::now();
+
+      // every lookup hits a key, so this keeps the loop honest
+      if (numFound != lookups.size())
+         std::cout << "\tonly found " << numFound << " of " << lookups.size() << "\n";
+
+      return std::chrono::duration<double, std::nano>(end - begin).count()
+             / (double)lookups.size();
+   }
+};
+
+#endif // BENCHMARK
@@ -0,0 +1,71 @@
+/***********************************************************************
+ * Header:
+ *    BIT OPS
+ * Summary:
+ *    The few bit tricks on a 64-bit word that the bitmap-based
+ *    containers need, each one a single instruction on the machines
+ *    we build for
+ *
+ *    This will contain the definition of:
+ *        lowestBit           : Index of the lowest set bit
+ *        highestBit          : Index of the highest set bit
+ *        popCount            : How many bits are set
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#include <cstdint>    // for uint64_t
+
+#ifdef _MSC_VER
+#include <intrin.h>   // for _BitScanForward64 and friends
+#endif
+
+namespace custom
+{
+
+/*****************************************************************
+ * LOWEST BIT
+ * Index of the lowest set bit. The word must not be zero
+ *****************************************************************/
+inline unsigned int lowestBit(uint64_t word)
+{
+#ifdef _MSC_VER
+   unsigned long i;
+   _BitScanForward64(&i, word);
+   return (unsigned int)i;
+#else
+   return (unsigned int)__builtin_ctzll(word);
+#endif
+}
+
+/*****************************************************************
+ * HIGHEST BIT
+ * Index of the highest set bit. The word must not be zero
+ *****************************************************************/
+inline unsigned int highestBit(uint64_t word)
+{
+#ifdef _MSC_VER
+   unsigned long i;
+   _BitScanReverse64(&i, word);
+   return (unsigned int)i;
+#else
+   return 63u - (unsigned int)__builtin_clzll(word);
+#endif
+}
+
+/*****************************************************************
+ * POP COUNT
+ * How many bits are set
+ *****************************************************************/
+inline unsigned int popCount(uint64_t word)
+{
+#ifdef _MSC_VER
+   return (unsigned int)__popcnt64(word);
+#else
+   return (unsigned int)__builtin_popcountll(word);
+#endif
+}
+
+} // namespace custom
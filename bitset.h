@@ -0,0 +1,443 @@
+/***********************************************************************
+ * Header:
+ *    BITSET
+ * Summary:
+ *    One bit for every key in a small universe, to hold the elements
+ *    of a set of unsigned integers that fill most of their range.
+ *    That is 1/8 of a byte a key instead of a node a key. Finding is
+ *    one bit test, moving to the next element is a count of trailing
+ *    zeros, and union, intersection and difference go a whole word
+ *    of keys at a time
+ *
+ *    This will contain the class definition of:
+ *        Bitset              : A class that represents a dense bit set
+ *        Bitset::iterator    : An iterator through Bitset
+ *        BitsetEngine        : Pick Bitset as the engine behind a set
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint64_t
+#include <cstring>     // for std::memcpy
+#include <type_traits> // for std::is_unsigned
+#include <utility>     // for std::pair and std::swap
+#include <initializer_list>
+#include "bitOps.h"    // for lowestBit, highestBit and popCount
+
+class TestBitset;      // forward declaration for unit tests
+
+namespace custom
+{
+
+/*****************************************************************
+ * BITSET ENGINE
+ * Name this as the second parameter of a set of unsigned integers
+ * to keep its elements in a Bitset. Every element must be below
+ * 2^universeBits, and the set takes 2^universeBits / 8 bytes
+ * once anything is in it:
+ *       custom::set <uint16_t, custom::BitsetEngine<16>>
+ *****************************************************************/
+template <unsigned int universeBits>
+struct BitsetEngine { };
+
+/************************************************
+ * BITSET
+ * Bit k of word k / 64 says whether k is in the set.
+ * The words are only allocated on the first insert
+ ***********************************************/
+template <typename T, unsigned int universeBits>
+class Bitset
+{
+   static_assert(std::is_integral<T>::value && std::is_unsigned<T>::value,
+                 "Bitset keys are unsigned integers");
+   static_assert(universeBits >= 1 && universeBits <= 24 && universeBits <= sizeof(T) * 8,
+                 "Bitset universes are 1 to 24 bits, and no wider than the key");
+
+   friend class ::TestBitset; // give unit tests access to the privates
+public:
+   //
+   // Construct
+   //
+
+   Bitset() : words(nullptr), numElements(0) { }
+   Bitset(const Bitset &  rhs) : words(nullptr), numElements(0) { *this = rhs;            }
+   Bitset(      Bitset && rhs) : words(nullptr), numElements(0) { *this = std::move(rhs); }
+   Bitset(const std::initializer_list<T> & il) : words(nullptr), numElements(0)
+   {
+      for (auto & element : il)
+         insert(element);
+   }
+   ~Bitset() { clear(); }
+
+   //
+   // Assign
+   //
+
+   Bitset & operator = (const Bitset &  rhs);
+   Bitset & operator = (      Bitset && rhs);
+   Bitset & operator = (const std::initializer_list<T> & il);
+   void swap(Bitset & rhs) noexcept
+   {
+      std::swap(words,       rhs.words);
+      std::swap(numElements, rhs.numElements);
+   }
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   iterator begin() const noexcept { return _at(_next(0)); }
+   iterator end()   const noexcept { return iterator(this); }
+
+   //
+   // Access. Lower bound is the first element not less than t,
+   // upper bound the first one greater
+   //
+
+   iterator find(const T & t) const
+   {
+      return (inUniverse(t) && _test((uint64_t)t)) ? iterator(this, t) : end();
+   }
+   iterator lower_bound(const T & t) const
+   {
+      return inUniverse(t) ? _at(_next((uint64_t)t)) : end();
+   }
+   iterator upper_bound(const T & t) const
+   {
+      return inUniverse(t) ? _at(_next((uint64_t)t + 1)) : end();
+   }
+
+   //
+   // Insert. Nothing outside the universe goes in
+   //
+
+   std::pair<iterator, bool> insert(const T & t, bool keepUnique = false);
+   std::pair<iterator, bool> insert(T && t, bool keepUnique = false)
+   {
+      return insert((const T &)t, keepUnique);
+   }
+
+   //
+   // Remove
+   //
+
+   iterator erase(iterator & it);
+   void clear() noexcept
+   {
+      delete [] words;
+      words = nullptr;
+      numElements = 0;
+   }
+
+   //
+   // Set algebra, a word at a time. The size comes from
+   // counting the bits of the words as they are made
+   //
+
+   Bitset & operator |= (const Bitset & rhs);
+   Bitset & operator &= (const Bitset & rhs);
+   Bitset & operator -= (const Bitset & rhs);
+
+   //
+   // Status
+   //
+
+   bool   empty()  const noexcept { return (numElements == 0); }
+   size_t size()   const noexcept { return numElements;        }
+   size_t height() const noexcept { return words ? 1 : 0;      }
+
+private:
+
+   static const uint64_t UNIVERSE  = (uint64_t)1 << universeBits;
+   static const size_t   NUM_WORDS = (size_t)((UNIVERSE + 63) / 64);
+
+   static bool inUniverse(const T & t) { return ((uint64_t)t >> universeBits) == 0; }
+   static uint64_t bit(uint64_t k)     { return (uint64_t)1 << (k & 63);          }
+
+   bool _test(uint64_t k) const        { return words && (words[k >> 6] & bit(k)); }
+   uint64_t _next(uint64_t k) const;
+   uint64_t _prev(uint64_t k) const;
+   iterator _at(uint64_t k) const      { return k < UNIVERSE ? iterator(this, (T)k) : end(); }
+   size_t _count() const;
+
+   uint64_t * words;          // NUM_WORDS of them, or nullptr when empty
+   size_t numElements;        // number of bits set
+};
+
+/**********************************************************
+ * BITSET ITERATOR
+ * The element itself, so inserts and erases elsewhere never
+ * invalidate it. Moving on scans for the next set bit
+ *********************************************************/
+template <typename T, unsigned int universeBits>
+class Bitset <T, universeBits> :: iterator
+{
+   friend class ::TestBitset; // give unit tests access to the privates
+   friend class Bitset <T, universeBits>;
+public:
+   // constructors and assignment
+   iterator() : pSet(nullptr), value(), isEnd(true) { }
+   iterator(const Bitset * pSet) : pSet(pSet), value(), isEnd(true) { }
+   iterator(const Bitset * pSet, const T & t) : pSet(pSet), value(t), isEnd(false) { }
+
+   // compare
+   bool operator == (const iterator & rhs) const
+   {
+      return isEnd == rhs.isEnd && (isEnd || value == rhs.value);
+   }
+   bool operator != (const iterator & rhs) const { return !(*this == rhs);                       }
+
+   // de-reference. Cannot change because it is only a bit
+   const T & operator * () const                 { return value;                                 }
+
+   // increment and decrement
+   iterator & operator ++ ()
+   {
+      if (!isEnd)
+         *this = pSet->_at(pSet->_next((uint64_t)value + 1));
+      return *this;
+   }
+   iterator   operator ++ (int postfix)          { iterator itOld(*this); ++*this; return itOld; }
+   iterator & operator -- ()
+   {
+      if (!isEnd)
+         *this = pSet->_at(pSet->_prev((uint64_t)value));
+      return *this;
+   }
+   iterator   operator -- (int postfix)          { iterator itOld(*this); --*this; return itOld; }
+
+private:
+
+   const Bitset * pSet;       // the set we walk through
+   T value;                   // the element we are on
+   bool isEnd;                // past the last element
+};
+
+/*********************************************
+ * BITSET :: ASSIGNMENT OPERATOR
+ * Copy one set to another
+ ********************************************/
+template <typename T, unsigned int universeBits>
+Bitset <T, universeBits> & Bitset <T, universeBits> :: operator = (const Bitset & rhs)
+{
+   if (this != &rhs)
+   {
+      clear();
+      if (rhs.words)
+      {
+         words = new uint64_t[NUM_WORDS];
+         std::memcpy(words, rhs.words, NUM_WORDS * sizeof(uint64_t));
+      }
+      numElements = rhs.numElements;
+   }
+   return *this;
+}
+
+/*********************************************
+ * BITSET :: MOVE ASSIGNMENT
+ * Steal the words from another set
+ ********************************************/
+template <typename T, unsigned int universeBits>
+Bitset <T, universeBits> & Bitset <T, universeBits> :: operator = (Bitset && rhs)
+{
+   clear();
+   swap(rhs);
+   return *this;
+}
+
+/*********************************************
+ * BITSET :: ASSIGNMENT with INITIALIZATION LIST
+ ********************************************/
+template <typename T, unsigned int universeBits>
+Bitset <T, universeBits> & Bitset <T, universeBits> :: operator = (const std::initializer_list<T> & il)
+{
+   clear();
+   for (auto & element : il)
+      insert(element);
+   return *this;
+}
+
+/*********************************************
+ * BITSET :: NEXT
+ * The first element at k or after, or UNIVERSE if there is
+ * none. Mask off the bits below k in its word, then look
+ * a word at a time
+ ********************************************/
+template <typename T, unsigned int universeBits>
+uint64_t Bitset <T, universeBits> :: _next(uint64_t k) const
+{
+   if (words == nullptr || k >= UNIVERSE)
+      return UNIVERSE;
+   size_t w = (size_t)(k >> 6);
+   uint64_t word = words[w] & (~(uint64_t)0 << (k & 63));
+   while (word == 0)
+   {
+      if (++w == NUM_WORDS)
+         return UNIVERSE;
+      word = words[w];
+   }
+   return ((uint64_t)w << 6) + lowestBit(word);
+}
+
+/*********************************************
+ * BITSET :: PREV
+ * The last element before k, or UNIVERSE if there is none
+ ********************************************/
+template <typename T, unsigned int universeBits>
+uint64_t Bitset <T, universeBits> :: _prev(uint64_t k) const
+{
+   if (words == nullptr || k == 0)
+      return UNIVERSE;
+   k--;
+   size_t w = (size_t)(k >> 6);
+   uint64_t word = words[w] & (~(uint64_t)0 >> (63 - (k & 63)));
+   while (word == 0)
+   {
+      if (w-- == 0)
+         return UNIVERSE;
+      word = words[w];
+   }
+   return ((uint64_t)w << 6) + highestBit(word);
+}
+
+/*********************************************
+ * BITSET :: INSERT
+ * Set the bit for t unless it is already set, or t is
+ * outside the universe. Returns where t is and whether it
+ * went in
+ ********************************************/
+template <typename T, unsigned int universeBits>
+std::pair<typename Bitset <T, universeBits> :: iterator, bool>
+   Bitset <T, universeBits> :: insert(const T & t, bool keepUnique)
+{
+   if (!inUniverse(t))
+      return std::make_pair(end(), false);
+   if (words == nullptr)
+      words = new uint64_t[NUM_WORDS]();
+
+   uint64_t k = (uint64_t)t;
+   uint64_t & word = words[k >> 6];
+   if (word & bit(k))
+      return std::make_pair(iterator(this, t), false);
+   word |= bit(k);
+   numElements++;
+   return std::make_pair(iterator(this, t), true);
+}
+
+/*********************************************
+ * BITSET :: ERASE
+ * Clear the bit the iterator is on, returning the element
+ * after it. The last one out frees the words
+ ********************************************/
+template <typename T, unsigned int universeBits>
+typename Bitset <T, universeBits> :: iterator Bitset <T, universeBits> :: erase(iterator & it)
+{
+   if (it.isEnd)
+      return end();
+   iterator itNext = it;
+   ++itNext;
+
+   uint64_t k = (uint64_t)it.value;
+   assert(_test(k));
+   words[k >> 6] &= ~bit(k);
+   if (--numElements == 0)
+      clear();
+   return itNext;
+}
+
+/*********************************************
+ * BITSET :: UNION
+ * Everything in either. An empty right side changes nothing
+ ********************************************/
+template <typename T, unsigned int universeBits>
+Bitset <T, universeBits> & Bitset <T, universeBits> :: operator |= (const Bitset & rhs)
+{
+   if (rhs.words == nullptr || this == &rhs)
+      return *this;
+   if (words == nullptr)
+      return *this = rhs;
+
+   size_t num = 0;
+   for (size_t w = 0; w < NUM_WORDS; w++)
+   {
+      words[w] |= rhs.words[w];
+      num += popCount(words[w]);
+   }
+   numElements = num;
+   return *this;
+}
+
+/*********************************************
+ * BITSET :: INTERSECTION
+ * Only what is in both. An empty right side empties us
+ ********************************************/
+template <typename T, unsigned int universeBits>
+Bitset <T, universeBits> & Bitset <T, universeBits> :: operator &= (const Bitset & rhs)
+{
+   if (words == nullptr || this == &rhs)
+      return *this;
+   if (rhs.words == nullptr)
+   {
+      clear();
+      return *this;
+   }
+
+   size_t num = 0;
+   for (size_t w = 0; w < NUM_WORDS; w++)
+   {
+      words[w] &= rhs.words[w];
+      num += popCount(words[w]);
+   }
+   numElements = num;
+   if (numElements == 0)
+      clear();
+   return *this;
+}
+
+/*********************************************
+ * BITSET :: DIFFERENCE
+ * What is here but not there
+ ********************************************/
+template <typename T, unsigned int universeBits>
+Bitset <T, universeBits> & Bitset <T, universeBits> :: operator -= (const Bitset & rhs)
+{
+   if (this == &rhs)
+   {
+      clear();
+      return *this;
+   }
+   if (words == nullptr || rhs.words == nullptr)
+      return *this;
+
+   size_t num = 0;
+   for (size_t w = 0; w < NUM_WORDS; w++)
+   {
+      words[w] &= ~rhs.words[w];
+      num += popCount(words[w]);
+   }
+   numElements = num;
+   if (numElements == 0)
+      clear();
+   return *this;
+}
+
+/*********************************************
+ * BITSET :: COUNT
+ * How many bits are set, from scratch
+ ********************************************/
+template <typename T, unsigned int universeBits>
+size_t Bitset <T, universeBits> :: _count() const
+{
+   size_t num = 0;
+   if (words)
+      for (size_t w = 0; w < NUM_WORDS; w++)
+         num += popCount(words[w]);
+   return num;
+}
+
+} // namespace custom
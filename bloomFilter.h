@@ -0,0 +1,249 @@
+/***********************************************************************
+ * Header:
+ *    BLOOM FILTER
+ * Summary:
+ *    A blocked Bloom filter: a set that can say "certainly not here"
+ *    or "maybe here", in about ten bits an element. Each element
+ *    sets one bit in each of the eight words of one 64-byte block,
+ *    so asking about it reads a single cache line. A set puts one
+ *    in front of its tree so that a find for something absent can
+ *    usually answer end() without walking down the tree at all
+ *
+ *    This will contain the definition of:
+ *        BloomHash           : The hash of an element, if std::hash knows it
+ *        BloomFilter         : A class that represents a blocked Bloom filter
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint64_t and uintptr_t
+#include <cstring>     // for std::memset and std::memcpy
+#include <functional>  // for std::hash
+#include <new>         // for ::operator new
+#include <type_traits> // for std::enable_if and std::is_default_constructible
+#include <utility>     // for std::swap
+
+class TestBloomFilter;  // forward declaration for unit tests
+class TestSet;          // forward declaration for unit tests
+
+namespace custom
+{
+
+/************************************************
+ * BLOOM HASH
+ * A well mixed 64-bit hash of an element. Types that
+ * std::hash does not know get none, and a set of them
+ * cannot turn its filter on
+ ***********************************************/
+template <typename T, typename = void>
+struct BloomHash
+{
+   static const bool usable = false;
+   static uint64_t of(const T &) { return 0; }
+};
+
+template <typename T>
+struct BloomHash <T, typename std::enable_if<std::is_default_constructible<std::hash<T>>::value>::type>
+{
+   static const bool usable = true;
+
+   // std::hash of an integer is often the integer (the MurmurHash3 finalizer)
+   static uint64_t of(const T & t)
+   {
+      uint64_t hash = (uint64_t)std::hash<T>()(t);
+      hash ^= hash >> 33;
+      hash *= 0xFF51AFD7ED558CCDull;
+      hash ^= hash >> 33;
+      hash *= 0xC4CEB9FE1A85EC53ull;
+      hash ^= hash >> 33;
+      return hash;
+   }
+};
+
+/************************************************
+ * BLOOM FILTER
+ * The high half of a hash picks the block, and six bits
+ * each from a second mix pick the bit in each word. Bits
+ * are never cleared, so erasing leaves stale ones that
+ * only cost false positives; the owner counts erases and
+ * rebuilds once enough have gone. It also counts how
+ * often the filter was wrong, which is the only honest
+ * false positive rate once elements come and go
+ ***********************************************/
+class BloomFilter
+{
+   friend class ::TestBloomFilter; // give unit tests access to the privates
+   friend class ::TestSet;
+public:
+   static const size_t WORDS_PER_BLOCK = 8;    // one cache line
+
+   //
+   // Construct. Nothing is allocated until reset()
+   //
+
+   explicit BloomFilter(size_t bitsPerElement = 10) :
+      bitsPerElement(bitsPerElement), numBlocks(0), capacity(0),
+      numAdded(0), numErased(0), isStale(false), numNegatives(0),
+      numFalsePositives(0), pBuffer(nullptr), blocks(nullptr) { }
+   BloomFilter(const BloomFilter & rhs);
+   ~BloomFilter() { ::operator delete(pBuffer); }
+
+   BloomFilter & operator = (const BloomFilter & rhs)
+   {
+      BloomFilter copy(rhs);
+      swap(copy);
+      return *this;
+   }
+   void swap(BloomFilter & rhs) noexcept;
+
+   // empty, and sized for this many elements. The counts of hits and misses stay
+   void reset(size_t capacityNew);
+
+   //
+   // Add and ask
+   //
+
+   void add(uint64_t hash);
+   bool mayContain(uint64_t hash) const;
+
+   //
+   // Upkeep. The owner says when an element goes; past a
+   // quarter of those added, or once more were added than
+   // it was sized for, the filter wants rebuilding
+   //
+
+   void erased()              { numErased++;    }
+   void invalidate()          { isStale = true; }
+   bool full() const          { return numAdded >= capacity;                          }
+   bool needsRebuild() const  { return isStale || full() || numErased * 4 > numAdded; }
+
+   //
+   // Statistics. The owner says which "maybe" answers were wrong
+   //
+
+   void countNegative()       { numNegatives++;      }
+   void countFalsePositive()  { numFalsePositives++; }
+   double false_positive_rate() const
+   {
+      size_t numAbsent = numNegatives + numFalsePositives;
+      return numAbsent ? (double)numFalsePositives / (double)numAbsent : 0.0;
+   }
+   size_t bytes() const { return numBlocks * WORDS_PER_BLOCK * sizeof(uint64_t); }
+
+private:
+
+   uint64_t * _block(uint64_t hash) const
+   {
+      return blocks + (size_t)(((hash >> 32) * numBlocks) >> 32) * WORDS_PER_BLOCK;
+   }
+   static uint64_t _bit(uint64_t bits, size_t w)
+   {
+      return (uint64_t)1 << ((bits >> (58 - 6 * w)) & 63);
+   }
+
+   size_t bitsPerElement;      // how big to make it for each element
+   size_t numBlocks;           // 64-byte blocks
+   size_t capacity;            // elements it was sized for
+   size_t numAdded;            // elements added since the last reset
+   size_t numErased;           // elements the owner erased since then
+   bool isStale;               // the owner changed in a way we did not see
+   size_t numNegatives;        // "certainly not" answers
+   size_t numFalsePositives;   // "maybe" answers for something absent
+   void * pBuffer;             // what was allocated, before alignment
+   uint64_t * blocks;          // the bits, block after block
+};
+
+/*********************************************
+ * BLOOM FILTER :: COPY CONSTRUCTOR
+ ********************************************/
+inline BloomFilter :: BloomFilter(const BloomFilter & rhs) : BloomFilter(rhs.bitsPerElement)
+{
+   if (rhs.numBlocks)
+   {
+      reset(rhs.capacity);
+      std::memcpy(blocks, rhs.blocks, bytes());
+   }
+   capacity          = rhs.capacity;
+   numAdded          = rhs.numAdded;
+   numErased         = rhs.numErased;
+   isStale           = rhs.isStale;
+   numNegatives      = rhs.numNegatives;
+   numFalsePositives = rhs.numFalsePositives;
+}
+
+/*********************************************
+ * BLOOM FILTER :: SWAP
+ ********************************************/
+inline void BloomFilter :: swap(BloomFilter & rhs) noexcept
+{
+   std::swap(bitsPerElement,    rhs.bitsPerElement);
+   std::swap(numBlocks,         rhs.numBlocks);
+   std::swap(capacity,          rhs.capacity);
+   std::swap(numAdded,          rhs.numAdded);
+   std::swap(numErased,         rhs.numErased);
+   std::swap(isStale,           rhs.isStale);
+   std::swap(numNegatives,      rhs.numNegatives);
+   std::swap(numFalsePositives, rhs.numFalsePositives);
+   std::swap(pBuffer,           rhs.pBuffer);
+   std::swap(blocks,            rhs.blocks);
+}
+
+/*********************************************
+ * BLOOM FILTER :: RESET
+ * A fresh, aligned run of zeroed blocks, bitsPerElement
+ * for each element we expect
+ ********************************************/
+inline void BloomFilter :: reset(size_t capacityNew)
+{
+   size_t numBits = (capacityNew ? capacityNew : 1) * bitsPerElement;
+   size_t numBlocksNew = (numBits + 511) / 512;
+   if (numBlocksNew != numBlocks)
+   {
+      ::operator delete(pBuffer);
+      pBuffer = ::operator new(numBlocksNew * WORDS_PER_BLOCK * sizeof(uint64_t) + 63);
+      blocks = (uint64_t *)(((uintptr_t)pBuffer + 63) & ~(uintptr_t)63);
+      numBlocks = numBlocksNew;
+   }
+   std::memset(blocks, 0, bytes());
+   capacity  = capacityNew;
+   numAdded  = 0;
+   numErased = 0;
+   isStale   = false;
+}
+
+/*********************************************
+ * BLOOM FILTER :: ADD
+ * One bit in each word of the block
+ ********************************************/
+inline void BloomFilter :: add(uint64_t hash)
+{
+   uint64_t * pBlock = _block(hash);
+   uint64_t bits = hash * 0x9E3779B97F4A7C15ull;
+   for (size_t w = 0; w < WORDS_PER_BLOCK; w++)
+      pBlock[w] |= _bit(bits, w);
+   numAdded++;
+}
+
+/*********************************************
+ * BLOOM FILTER :: MAY CONTAIN
+ * False only if something that was added is certainly
+ * not this. Before the first reset, anything may be.
+ * Every word is checked, with no early out, so the
+ * loop has no branch to mispredict
+ ********************************************/
+inline bool BloomFilter :: mayContain(uint64_t hash) const
+{
+   if (numBlocks == 0)
+      return true;
+   const uint64_t * pBlock = _block(hash);
+   uint64_t bits = hash * 0x9E3779B97F4A7C15ull;
+   uint64_t missing = 0;
+   for (size_t w = 0; w < WORDS_PER_BLOCK; w++)
+      missing |= _bit(bits, w) & ~pBlock[w];
+   return missing == 0;
+}
+
+} // namespace custom
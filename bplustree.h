@@ -0,0 +1,828 @@
+/***********************************************************************
+ * Header:
+ *    B+ TREE
+ * Summary:
+ *    A B+ tree to hold the elements of a set. Every element lives in a
+ *    leaf and each leaf links to its neighbors, so walking the set from
+ *    begin() to end() sweeps the leaves in order instead of climbing
+ *    up and down the tree
+ *
+ *    This will contain the class definition of:
+ *        BPlusTree           : A class that represents a B+ tree
+ *        BPlusTree::iterator : An iterator through BPlusTree
+ *        BPlusTreeEngine     : Pick BPlusTree as the engine behind a set
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>    // for size_t
+#include <utility>    // for std::pair and std::move
+#include <initializer_list>
+
+class TestBPlusTree;  // forward declaration for unit tests
+
+namespace custom
+{
+
+/*****************************************************************
+ * B+ TREE ENGINE
+ * Name this as the second parameter of a set to keep its elements
+ * in a BPlusTree whose nodes span numLines cache lines:
+ *       custom::set <int, custom::BPlusTreeEngine<>>
+ *****************************************************************/
+template <size_t numLines = 4>
+struct BPlusTreeEngine { };
+
+/*****************************************************************
+ * B+ TREE
+ * The leaves hold every element, sorted, and form a doubly linked
+ * list. The inner nodes only hold copies of keys to steer a search:
+ * everything in children[i + 1] is at least keys[i] and everything
+ * in children[i] is less. Every node but the root holds between
+ * MIN_KEYS and MAX_KEYS keys, and every leaf is at the same depth
+ *****************************************************************/
+template <typename T, size_t numLines = 4>
+class BPlusTree
+{
+   friend class ::TestBPlusTree; // give unit tests access to the privates
+public:
+   //
+   // Construct
+   //
+
+   BPlusTree() : root(nullptr), numElements(0) { }
+   BPlusTree(const BPlusTree &  rhs) : root(nullptr), numElements(0) { *this = rhs;            }
+   BPlusTree(      BPlusTree && rhs) : root(nullptr), numElements(0) { *this = std::move(rhs); }
+   BPlusTree(const std::initializer_list<T> & il) : root(nullptr), numElements(0)
+   {
+      for (auto & element : il)
+         insert(element);
+   }
+   ~BPlusTree() { clear(); }
+
+   //
+   // Assign
+   //
+
+   BPlusTree & operator = (const BPlusTree &  rhs);
+   BPlusTree & operator = (      BPlusTree && rhs);
+   BPlusTree & operator = (const std::initializer_list<T> & il);
+   void swap(BPlusTree & rhs) noexcept
+   {
+      std::swap(root,        rhs.root);
+      std::swap(numElements, rhs.numElements);
+   }
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   iterator begin() const noexcept;
+   iterator end()   const noexcept { return iterator(); }
+
+   //
+   // Access
+   //
+
+   iterator find(const T & t) const;
+
+   //
+   // Insert
+   //
+
+   std::pair<iterator, bool> insert(const T &  t, bool keepUnique = false);
+   std::pair<iterator, bool> insert(      T && t, bool keepUnique = false);
+
+   //
+   // Remove
+   //
+
+   iterator erase(iterator & it);
+   void clear() noexcept
+   {
+      _clear(root);
+      root = nullptr;
+      numElements = 0;
+   }
+
+   //
+   // Status
+   //
+
+   bool   empty()  const noexcept { return (numElements == 0); }
+   size_t size()   const noexcept { return numElements;        }
+   size_t height() const noexcept;
+
+private:
+
+   // as many keys as fit in numLines cache lines, less the spare
+   static const size_t CAPACITY = (numLines * 64 / sizeof(T) > 4 ? numLines * 64 / sizeof(T) : 4);
+   static const size_t MAX_KEYS = CAPACITY - 1;
+   static const size_t MIN_KEYS = MAX_KEYS / 2;
+
+   struct Node;
+   struct Leaf;
+   struct Inner;
+
+   Node * root;               // root node of the B+ tree
+   size_t numElements;        // number of elements currently in the tree
+
+   static Node * & child(Node * pNode, size_t i) { return static_cast<Inner *>(pNode)->children[i]; }
+   static size_t indexInParent(const Node * pNode);
+   static size_t lowerBound(const Node * pNode, const T & t);
+   static size_t upperBound(const Node * pNode, const T & t);
+   Leaf * findLeaf(const T & t) const;
+
+   template <class U>
+   std::pair<iterator, bool> _insert(U && t, bool keepUnique);
+   void _splitLeaf(Leaf * pLeaf);
+   void _splitInner(Inner * pNode);
+   void _insertParent(Node * pLeft, const T & separator, Node * pRight);
+   void _underflowLeaf(Leaf * pLeaf, Leaf * & pTrack, size_t & iTrack);
+   void _underflowInner(Inner * pNode);
+   void _mergeLeaves(Leaf * pLeft, Leaf * pRight, size_t iSeparator);
+   void _mergeInner(Inner * pLeft, Inner * pRight, size_t iSeparator);
+   void _removeChild(Inner * pParent, size_t iSeparator);
+   void _shrinkRoot();
+   static void _shiftRight(Node * pNode, size_t i);
+   static void _shiftLeft (Node * pNode, size_t i);
+   static Node * _copy(const Node * pSrc, Inner * pParent, Leaf * & pPrevious);
+   static void _clear(Node * pNode);
+   static void _delete(Node * pNode);
+};
+
+/*****************************************************************
+ * B+ TREE NODE
+ * A leaf has its keys and its neighbors. An inner node has one
+ * more child than it has keys
+ *****************************************************************/
+template <typename T, size_t numLines>
+struct BPlusTree <T, numLines> :: Node
+{
+   Node(bool isLeaf) : pParent(nullptr), numKeys(0), isLeaf(isLeaf) { }
+
+   Inner * pParent;           // nullptr for the root
+   unsigned short numKeys;    // keys in use, the rest are spare
+   bool isLeaf;               // no children
+   T keys[CAPACITY];          // sorted, side by side
+};
+
+template <typename T, size_t numLines>
+struct BPlusTree <T, numLines> :: Leaf : public Node
+{
+   Leaf() : Node(true), pPrev(nullptr), pNext(nullptr) { }
+
+   Leaf * pPrev;              // the leaf with the smaller keys
+   Leaf * pNext;              // the leaf with the larger keys
+};
+
+template <typename T, size_t numLines>
+struct BPlusTree <T, numLines> :: Inner : public Node
+{
+   Inner() : Node(false) { }
+
+   Node * children[CAPACITY + 1];
+};
+
+/**********************************************************
+ * B+ TREE ITERATOR
+ * A leaf and the index of a key in it. Moving on is either
+ * the next slot or the next leaf: never a climb up the tree
+ *********************************************************/
+template <typename T, size_t numLines>
+class BPlusTree <T, numLines> :: iterator
+{
+   friend class ::TestBPlusTree; // give unit tests access to the privates
+   friend class BPlusTree <T, numLines>;
+public:
+   // constructors and assignment
+   iterator(Leaf * p = nullptr, size_t i = 0) : pLeaf(p), iKey(i) { }
+
+   // compare
+   bool operator == (const iterator & rhs) const { return (pLeaf == rhs.pLeaf && iKey == rhs.iKey); }
+   bool operator != (const iterator & rhs) const { return !(*this == rhs);                          }
+
+   // de-reference. Cannot change because it will invalidate the BPlusTree
+   const T & operator * () const                 { return pLeaf->keys[iKey];                      }
+
+   // increment and decrement
+   iterator & operator ++ ()
+   {
+      if (pLeaf && ++iKey == pLeaf->numKeys)
+      {
+         pLeaf = pLeaf->pNext;
+         iKey = 0;
+      }
+      return *this;
+   }
+   iterator   operator ++ (int postfix)          { iterator itOld(*this); ++*this; return itOld;  }
+   iterator & operator -- ()
+   {
+      if (pLeaf == nullptr)
+         return *this;
+      if (iKey > 0)
+         iKey--;
+      else
+      {
+         pLeaf = pLeaf->pPrev;
+         iKey = (pLeaf ? pLeaf->numKeys - 1 : 0);
+      }
+      return *this;
+   }
+   iterator   operator -- (int postfix)          { iterator itOld(*this); --*this; return itOld;  }
+
+private:
+
+   Leaf * pLeaf;              // the leaf, nullptr for end()
+   size_t iKey;               // which key in the leaf
+};
+
+/*********************************************
+ *********************************************
+ ***************** B+ TREE *******************
+ *********************************************
+ *********************************************/
+
+/*********************************************
+ * B+ TREE :: ASSIGNMENT OPERATOR
+ * Copy one tree to another
+ ********************************************/
+template <typename T, size_t numLines>
+BPlusTree <T, numLines> & BPlusTree <T, numLines> :: operator = (const BPlusTree & rhs)
+{
+   if (this != &rhs)
+   {
+      clear();
+      Leaf * pPrevious = nullptr;
+      if (rhs.root)
+         root = _copy(rhs.root, nullptr, pPrevious);
+      numElements = rhs.numElements;
+   }
+   return *this;
+}
+
+/*********************************************
+ * B+ TREE :: MOVE ASSIGNMENT
+ * Steal the nodes from another tree
+ ********************************************/
+template <typename T, size_t numLines>
+BPlusTree <T, numLines> & BPlusTree <T, numLines> :: operator = (BPlusTree && rhs)
+{
+   clear();
+   swap(rhs);
+   return *this;
+}
+
+/*********************************************
+ * B+ TREE :: ASSIGNMENT with INITIALIZATION LIST
+ ********************************************/
+template <typename T, size_t numLines>
+BPlusTree <T, numLines> & BPlusTree <T, numLines> :: operator = (const std::initializer_list<T> & il)
+{
+   clear();
+   for (auto & element : il)
+      insert(element);
+   return *this;
+}
+
+/*********************************************
+ * B+ TREE :: BEGIN
+ * The first key of the leftmost leaf
+ ********************************************/
+template <typename T, size_t numLines>
+typename BPlusTree <T, numLines> :: iterator BPlusTree <T, numLines> :: begin() const noexcept
+{
+   if (root == nullptr)
+      return end();
+   Node * pNode = root;
+   while (!pNode->isLeaf)
+      pNode = child(pNode, 0);
+   return iterator(static_cast<Leaf *>(pNode));
+}
+
+/*********************************************
+ * B+ TREE :: HEIGHT
+ * Every leaf is at the same depth, so follow the left edge
+ ********************************************/
+template <typename T, size_t numLines>
+size_t BPlusTree <T, numLines> :: height() const noexcept
+{
+   size_t levels = 0;
+   for (Node * pNode = root; pNode; pNode = (pNode->isLeaf ? nullptr : child(pNode, 0)))
+      levels++;
+   return levels;
+}
+
+/*********************************************
+ * B+ TREE :: LOWER BOUND and UPPER BOUND
+ * Index of the first key in the node not less than t
+ * (or greater than t)
+ ********************************************/
+template <typename T, size_t numLines>
+size_t BPlusTree <T, numLines> :: lowerBound(const Node * pNode, const T & t)
+{
+   size_t iBegin = 0;
+   size_t iEnd = pNode->numKeys;
+   while (iBegin < iEnd)
+   {
+      size_t iMiddle = (iBegin + iEnd) / 2;
+      if (pNode->keys[iMiddle] < t)
+         iBegin = iMiddle + 1;
+      else
+         iEnd = iMiddle;
+   }
+   return iBegin;
+}
+
+template <typename T, size_t numLines>
+size_t BPlusTree <T, numLines> :: upperBound(const Node * pNode, const T & t)
+{
+   size_t iBegin = 0;
+   size_t iEnd = pNode->numKeys;
+   while (iBegin < iEnd)
+   {
+      size_t iMiddle = (iBegin + iEnd) / 2;
+      if (t < pNode->keys[iMiddle])
+         iEnd = iMiddle;
+      else
+         iBegin = iMiddle + 1;
+   }
+   return iBegin;
+}
+
+/*********************************************
+ * B+ TREE :: INDEX IN PARENT
+ * Which child of its parent a node is
+ ********************************************/
+template <typename T, size_t numLines>
+size_t BPlusTree <T, numLines> :: indexInParent(const Node * pNode)
+{
+   assert(pNode->pParent);
+   size_t i = 0;
+   while (pNode->pParent->children[i] != pNode)
+      i++;
+   return i;
+}
+
+/*********************************************
+ * B+ TREE :: FIND LEAF
+ * The leaf where t is or would go
+ ********************************************/
+template <typename T, size_t numLines>
+typename BPlusTree <T, numLines> :: Leaf * BPlusTree <T, numLines> :: findLeaf(const T & t) const
+{
+   Node * pNode = root;
+   while (!pNode->isLeaf)
+      pNode = child(pNode, upperBound(pNode, t));
+   return static_cast<Leaf *>(pNode);
+}
+
+/*********************************************
+ * B+ TREE :: FIND
+ * Return the iterator to the element if it exists,
+ * otherwise end()
+ ********************************************/
+template <typename T, size_t numLines>
+typename BPlusTree <T, numLines> :: iterator BPlusTree <T, numLines> :: find(const T & t) const
+{
+   if (root == nullptr)
+      return end();
+   Leaf * pLeaf = findLeaf(t);
+   size_t i = lowerBound(pLeaf, t);
+   if (i < pLeaf->numKeys && pLeaf->keys[i] == t)
+      return iterator(pLeaf, i);
+   return end();
+}
+
+/*********************************************
+ * B+ TREE :: INSERT
+ * Insert a new element into the tree
+ ********************************************/
+template <typename T, size_t numLines>
+std::pair<typename BPlusTree <T, numLines> :: iterator, bool> BPlusTree <T, numLines> :: insert(const T & t, bool keepUnique)
+{
+   return _insert(t, keepUnique);
+}
+
+template <typename T, size_t numLines>
+std::pair<typename BPlusTree <T, numLines> :: iterator, bool> BPlusTree <T, numLines> :: insert(T && t, bool keepUnique)
+{
+   return _insert(std::move(t), keepUnique);
+}
+
+/*********************************************
+ * B+ TREE :: _INSERT
+ * Put the element in its leaf, splitting the leaf (and
+ * maybe its ancestors) if that overflows it
+ ********************************************/
+template <typename T, size_t numLines>
+template <class U>
+std::pair<typename BPlusTree <T, numLines> :: iterator, bool> BPlusTree <T, numLines> :: _insert(U && t, bool keepUnique)
+{
+   if (root == nullptr)
+      root = new Leaf;
+
+   Leaf * pLeaf = findLeaf(t);
+   size_t i;
+   if (keepUnique)
+   {
+      i = lowerBound(pLeaf, t);
+      if (i < pLeaf->numKeys && pLeaf->keys[i] == t)
+         return std::make_pair(iterator(pLeaf, i), false);
+   }
+   else
+      i = upperBound(pLeaf, t);
+
+   _shiftRight(pLeaf, i);
+   pLeaf->keys[i] = std::forward<U>(t);
+   numElements++;
+
+   if (pLeaf->numKeys > MAX_KEYS)
+   {
+      size_t iMiddle = pLeaf->numKeys / 2;
+      _splitLeaf(pLeaf);
+      if (i >= iMiddle)
+      {
+         pLeaf = pLeaf->pNext;
+         i -= iMiddle;
+      }
+   }
+
+   return std::make_pair(iterator(pLeaf, i), true);
+}
+
+/*********************************************
+ * B+ TREE :: _SPLIT LEAF
+ * Move the top half of an overflowing leaf into a new leaf
+ * just after it. A copy of the new leaf's first key goes up
+ ********************************************/
+template <typename T, size_t numLines>
+void BPlusTree <T, numLines> :: _splitLeaf(Leaf * pLeaf)
+{
+   const size_t iMiddle = pLeaf->numKeys / 2;
+
+   Leaf * pRight = new Leaf;
+   pRight->numKeys = (unsigned short)(pLeaf->numKeys - iMiddle);
+   for (size_t i = 0; i < pRight->numKeys; i++)
+      pRight->keys[i] = std::move(pLeaf->keys[iMiddle + i]);
+   pLeaf->numKeys = (unsigned short)iMiddle;
+
+   pRight->pPrev = pLeaf;
+   pRight->pNext = pLeaf->pNext;
+   if (pLeaf->pNext)
+      pLeaf->pNext->pPrev = pRight;
+   pLeaf->pNext = pRight;
+
+   _insertParent(pLeaf, pRight->keys[0], pRight);
+}
+
+/*********************************************
+ * B+ TREE :: _SPLIT INNER
+ * Move the top half of an overflowing inner node into a new
+ * sibling. The middle key moves up rather than being copied
+ ********************************************/
+template <typename T, size_t numLines>
+void BPlusTree <T, numLines> :: _splitInner(Inner * pNode)
+{
+   const size_t iMiddle = pNode->numKeys / 2;
+
+   Inner * pRight = new Inner;
+   pRight->numKeys = (unsigned short)(pNode->numKeys - iMiddle - 1);
+   for (size_t i = 0; i < pRight->numKeys; i++)
+      pRight->keys[i] = std::move(pNode->keys[iMiddle + 1 + i]);
+   for (size_t i = 0; i <= pRight->numKeys; i++)
+   {
+      pRight->children[i] = pNode->children[iMiddle + 1 + i];
+      pRight->children[i]->pParent = pRight;
+   }
+   pNode->numKeys = (unsigned short)iMiddle;
+
+   _insertParent(pNode, pNode->keys[iMiddle], pRight);
+}
+
+/*********************************************
+ * B+ TREE :: _INSERT PARENT
+ * Put pRight just after pLeft in their parent with the
+ * separator between them, growing a new root if need be
+ ********************************************/
+template <typename T, size_t numLines>
+void BPlusTree <T, numLines> :: _insertParent(Node * pLeft, const T & separator, Node * pRight)
+{
+   if (pLeft->pParent == nullptr)
+   {
+      Inner * pRoot = new Inner;
+      pRoot->children[0] = pLeft;
+      pLeft->pParent = pRoot;
+      root = pRoot;
+   }
+
+   Inner * pParent = pLeft->pParent;
+   size_t iParent = indexInParent(pLeft);
+   _shiftRight(pParent, iParent);
+   pParent->keys[iParent] = separator;
+   pParent->children[iParent + 1] = pRight;
+   pRight->pParent = pParent;
+
+   if (pParent->numKeys > MAX_KEYS)
+      _splitInner(pParent);
+}
+
+/*********************************************
+ * B+ TREE :: ERASE
+ * Remove one element, returning the one after it
+ ********************************************/
+template <typename T, size_t numLines>
+typename BPlusTree <T, numLines> :: iterator BPlusTree <T, numLines> :: erase(iterator & it)
+{
+   if (it.pLeaf == nullptr)
+      return end();
+
+   // the slot we empty is where the next element ends up
+   Leaf * pLeaf = it.pLeaf;
+   size_t i = it.iKey;
+   _shiftLeft(pLeaf, i);
+   numElements--;
+
+   _underflowLeaf(pLeaf, pLeaf, i);
+
+   if (pLeaf && i == pLeaf->numKeys)
+   {
+      pLeaf = pLeaf->pNext;
+      i = 0;
+   }
+   return iterator(pLeaf, i);
+}
+
+/*********************************************
+ * B+ TREE :: _UNDERFLOW LEAF
+ * pLeaf may have too few keys. Borrow one from a neighbor
+ * with the same parent, or else merge with it. pTrack and
+ * iTrack follow one slot through the shuffle
+ ********************************************/
+template <typename T, size_t numLines>
+void BPlusTree <T, numLines> :: _underflowLeaf(Leaf * pLeaf, Leaf * & pTrack, size_t & iTrack)
+{
+   if (pLeaf == root)
+   {
+      _shrinkRoot();
+      if (root == nullptr)
+         pTrack = nullptr;
+      return;
+   }
+   if (pLeaf->numKeys >= MIN_KEYS)
+      return;
+
+   Inner * pParent = pLeaf->pParent;
+   size_t iParent = indexInParent(pLeaf);
+   Leaf * pLeft  = (iParent > 0                ? static_cast<Leaf *>(pParent->children[iParent - 1]) : nullptr);
+   Leaf * pRight = (iParent < pParent->numKeys ? static_cast<Leaf *>(pParent->children[iParent + 1]) : nullptr);
+
+   // take the largest key of the left neighbor
+   if (pLeft && pLeft->numKeys > MIN_KEYS)
+   {
+      _shiftRight(pLeaf, 0);
+      pLeaf->keys[0] = std::move(pLeft->keys[pLeft->numKeys - 1]);
+      pLeft->numKeys--;
+      pParent->keys[iParent - 1] = pLeaf->keys[0];
+      if (pTrack == pLeaf)
+         iTrack++;
+      return;
+   }
+
+   // take the smallest key of the right neighbor
+   if (pRight && pRight->numKeys > MIN_KEYS)
+   {
+      pLeaf->keys[pLeaf->numKeys++] = std::move(pRight->keys[0]);
+      _shiftLeft(pRight, 0);
+      pParent->keys[iParent] = pRight->keys[0];
+      return;
+   }
+
+   // neither can spare one, so two small leaves become one
+   if (pLeft)
+   {
+      if (pTrack == pLeaf)
+      {
+         pTrack = pLeft;
+         iTrack += pLeft->numKeys;
+      }
+      _mergeLeaves(pLeft, pLeaf, iParent - 1);
+   }
+   else
+      _mergeLeaves(pLeaf, pRight, iParent);
+   _underflowInner(pParent);
+}
+
+/*********************************************
+ * B+ TREE :: _UNDERFLOW INNER
+ * Same as a B-tree: rotate a key through the parent from a
+ * sibling that can spare one, or pull the separator down and
+ * merge, then check the parent in turn
+ ********************************************/
+template <typename T, size_t numLines>
+void BPlusTree <T, numLines> :: _underflowInner(Inner * pNode)
+{
+   while (pNode != root && pNode->numKeys < MIN_KEYS)
+   {
+      Inner * pParent = pNode->pParent;
+      size_t iParent = indexInParent(pNode);
+      Inner * pLeft  = (iParent > 0                ? static_cast<Inner *>(pParent->children[iParent - 1]) : nullptr);
+      Inner * pRight = (iParent < pParent->numKeys ? static_cast<Inner *>(pParent->children[iParent + 1]) : nullptr);
+
+      if (pLeft && pLeft->numKeys > MIN_KEYS)
+      {
+         _shiftRight(pNode, 0);
+         pNode->keys[0] = std::move(pParent->keys[iParent - 1]);
+         pParent->keys[iParent - 1] = std::move(pLeft->keys[pLeft->numKeys - 1]);
+         pNode->children[1] = pNode->children[0];
+         pNode->children[0] = pLeft->children[pLeft->numKeys];
+         pNode->children[0]->pParent = pNode;
+         pLeft->numKeys--;
+         return;
+      }
+
+      if (pRight && pRight->numKeys > MIN_KEYS)
+      {
+         pNode->keys[pNode->numKeys] = std::move(pParent->keys[iParent]);
+         pParent->keys[iParent] = std::move(pRight->keys[0]);
+         pNode->children[pNode->numKeys + 1] = pRight->children[0];
+         pNode->children[pNode->numKeys + 1]->pParent = pNode;
+         for (size_t i = 0; i < pRight->numKeys; i++)
+            pRight->children[i] = pRight->children[i + 1];
+         pNode->numKeys++;
+         _shiftLeft(pRight, 0);
+         return;
+      }
+
+      if (pLeft)
+         _mergeInner(pLeft, pNode, iParent - 1);
+      else
+         _mergeInner(pNode, pRight, iParent);
+      pNode = pParent;
+   }
+
+   if (pNode == root)
+      _shrinkRoot();
+}
+
+/*********************************************
+ * B+ TREE :: _MERGE LEAVES
+ * Fold pRight into pLeft. The separator between them is
+ * only a copy, so it just goes away
+ ********************************************/
+template <typename T, size_t numLines>
+void BPlusTree <T, numLines> :: _mergeLeaves(Leaf * pLeft, Leaf * pRight, size_t iSeparator)
+{
+   for (size_t i = 0; i < pRight->numKeys; i++)
+      pLeft->keys[pLeft->numKeys + i] = std::move(pRight->keys[i]);
+   pLeft->numKeys = (unsigned short)(pLeft->numKeys + pRight->numKeys);
+
+   pLeft->pNext = pRight->pNext;
+   if (pRight->pNext)
+      pRight->pNext->pPrev = pLeft;
+
+   _removeChild(pLeft->pParent, iSeparator);
+   _delete(pRight);
+}
+
+/*********************************************
+ * B+ TREE :: _MERGE INNER
+ * Fold pRight and the separator between them into pLeft
+ ********************************************/
+template <typename T, size_t numLines>
+void BPlusTree <T, numLines> :: _mergeInner(Inner * pLeft, Inner * pRight, size_t iSeparator)
+{
+   size_t iBase = pLeft->numKeys;
+   pLeft->keys[iBase] = std::move(pLeft->pParent->keys[iSeparator]);
+   for (size_t i = 0; i < pRight->numKeys; i++)
+      pLeft->keys[iBase + 1 + i] = std::move(pRight->keys[i]);
+   for (size_t i = 0; i <= pRight->numKeys; i++)
+   {
+      pLeft->children[iBase + 1 + i] = pRight->children[i];
+      pLeft->children[iBase + 1 + i]->pParent = pLeft;
+   }
+   pLeft->numKeys = (unsigned short)(iBase + 1 + pRight->numKeys);
+
+   _removeChild(pLeft->pParent, iSeparator);
+   _delete(pRight);
+}
+
+/*********************************************
+ * B+ TREE :: _REMOVE CHILD
+ * Drop keys[iSeparator] and the child to its right
+ ********************************************/
+template <typename T, size_t numLines>
+void BPlusTree <T, numLines> :: _removeChild(Inner * pParent, size_t iSeparator)
+{
+   for (size_t i = iSeparator + 1; i < pParent->numKeys; i++)
+      pParent->children[i] = pParent->children[i + 1];
+   _shiftLeft(pParent, iSeparator);
+}
+
+/*********************************************
+ * B+ TREE :: _SHRINK ROOT
+ * The root may be small, but not empty. An empty inner root
+ * hands over to its only child; an empty leaf root goes away
+ ********************************************/
+template <typename T, size_t numLines>
+void BPlusTree <T, numLines> :: _shrinkRoot()
+{
+   if (root == nullptr || root->numKeys > 0)
+      return;
+
+   Node * pOld = root;
+   if (root->isLeaf)
+      root = nullptr;
+   else
+   {
+      root = child(root, 0);
+      root->pParent = nullptr;
+   }
+   _delete(pOld);
+}
+
+/*********************************************
+ * B+ TREE :: _SHIFT RIGHT and _SHIFT LEFT
+ * Open a gap at keys[i] (and at children[i + 1] in an inner
+ * node), or close the gap at keys[i]
+ ********************************************/
+template <typename T, size_t numLines>
+void BPlusTree <T, numLines> :: _shiftRight(Node * pNode, size_t i)
+{
+   for (size_t iKey = pNode->numKeys; iKey > i; iKey--)
+      pNode->keys[iKey] = std::move(pNode->keys[iKey - 1]);
+   if (!pNode->isLeaf)
+      for (size_t iChild = pNode->numKeys + 1; iChild > i + 1; iChild--)
+         child(pNode, iChild) = child(pNode, iChild - 1);
+   pNode->numKeys++;
+}
+
+template <typename T, size_t numLines>
+void BPlusTree <T, numLines> :: _shiftLeft(Node * pNode, size_t i)
+{
+   for (size_t iKey = i; iKey + 1 < pNode->numKeys; iKey++)
+      pNode->keys[iKey] = std::move(pNode->keys[iKey + 1]);
+   pNode->numKeys--;
+}
+
+/*********************************************
+ * B+ TREE :: _COPY
+ * Make a copy of a subtree. The leaves are copied left to
+ * right, so each one links to the one copied before it
+ ********************************************/
+template <typename T, size_t numLines>
+typename BPlusTree <T, numLines> :: Node * BPlusTree <T, numLines> :: _copy(const Node * pSrc, Inner * pParent, Leaf * & pPrevious)
+{
+   Node * pDest;
+   if (pSrc->isLeaf)
+   {
+      Leaf * pLeaf = new Leaf;
+      pLeaf->pPrev = pPrevious;
+      if (pPrevious)
+         pPrevious->pNext = pLeaf;
+      pPrevious = pLeaf;
+      pDest = pLeaf;
+   }
+   else
+      pDest = new Inner;
+
+   pDest->pParent = pParent;
+   pDest->numKeys = pSrc->numKeys;
+   for (size_t i = 0; i < pSrc->numKeys; i++)
+      pDest->keys[i] = pSrc->keys[i];
+   if (!pSrc->isLeaf)
+      for (size_t i = 0; i <= pSrc->numKeys; i++)
+         child(pDest, i) = _copy(static_cast<const Inner *>(pSrc)->children[i],
+                                 static_cast<Inner *>(pDest), pPrevious);
+   return pDest;
+}
+
+/*********************************************
+ * B+ TREE :: _CLEAR and _DELETE
+ * Free a subtree, or just one node
+ ********************************************/
+template <typename T, size_t numLines>
+void BPlusTree <T, numLines> :: _clear(Node * pNode)
+{
+   if (pNode == nullptr)
+      return;
+   if (!pNode->isLeaf)
+      for (size_t i = 0; i <= pNode->numKeys; i++)
+         _clear(child(pNode, i));
+   _delete(pNode);
+}
+
+template <typename T, size_t numLines>
+void BPlusTree <T, numLines> :: _delete(Node * pNode)
+{
+   if (pNode->isLeaf)
+      delete static_cast<Leaf *>(pNode);
+   else
+      delete static_cast<Inner *>(pNode);
+}
+
+} // namespace custom
@@ -2,7 +2,10 @@
  * Header:
  *    BST
  * Summary:
- *    Our custom implementation of a BST for set and for map
+ *    Our custom implementation of a BST for set and for map. How the
+ *    tree keeps itself balanced is up to the Balance policy parameter:
+ *    Unbalanced, RedBlack (the default), AVL, Splay, Treap or Scapegoat.
+ *    The policies live in balance.h
  *      __       ____       ____         __
  *     /  |    .'    '.   .'    '.   _  / /
  *     `| |   |  .--.  | |  .--.  | (_)/ /
@@ -31,33 +34,43 @@
 #include <functional> // for std::less
 #include <utility>    // for std::pair
 #include <iostream>
+#include <new>        // for placement new
+#include <type_traits> // for std::is_trivially_destructible
+#include <vector>     // for std::vector
+#include "balance.h"  // for RedBlack and the other balancing policies
+#include "nodePool.h" // for NodePool and NodeArena, where every BNode comes from
+#include "taggedPtr.h" // for TaggedPtr, which holds a node's color with its parent
 class TestBST; // forward declaration for unit tests
 class TestMap;
 class TestSet;
+class TestNodePool;
 
 namespace custom
 {
 
-   template <class TT>
+   template <class TT, class BB, class AA>
    class set;
    template <class KK, class VV>
    class map;
 
 /*****************************************************************
  * BINARY SEARCH TREE
- * Create a Binary Search Tree
+ * Create a Binary Search Tree. Balance is the balancing policy from
+ * balance.h, resolved at compile time. Alloc, rebound to BNode, is
+ * where the nodes come from
  *****************************************************************/
-template <typename T>
+template <typename T, typename Balance = RedBlack, typename Alloc = std::allocator<T>>
 class BST
 {
    friend class ::TestBST; // give unit tests access to the privates
    friend class ::TestMap;
    friend class ::TestSet;
+   friend class ::TestNodePool;
 
    template <class KK, class VV>
    friend class map;
 
-   template <class TT>
+   template <class TT, class BB, class AA>
    friend class set;
 
    template <class KK, class VV>
@@ -68,6 +81,7 @@ public:
    //
 
    BST();
+   explicit BST(const Alloc & alloc);
    BST(const BST &  rhs);
    BST(      BST && rhs);
    BST(const std::initializer_list<T>& il);
@@ -95,6 +109,10 @@ public:
    //
 
    iterator find(const T& t);
+   iterator lower_bound(const T & t);
+   iterator lower_bound(const T & t) const;
+   iterator upper_bound(const T & t);
+   iterator upper_bound(const T & t) const;
 
    //
    // Insert
@@ -110,19 +128,126 @@ public:
    iterator erase(iterator& it);
    void   clear() noexcept;
 
+   //
+   // Split and Join. Only balancing policies that can do these
+   // quickly provide them (Treap)
+   //
+
+   BST split(const T & t);
+   static BST join(BST & lhs, BST & rhs);
+
+   //
+   // Relayout. Move every node into one block in van Emde Boas
+   // order, so a search touches few cache lines whatever the size
+   // of the cache. Invalidates all iterators
+   //
+
+   void relayout_veb();
+
+   //
+   // Arena. From now on the nodes come from chunks this tree
+   // owns, and clear() frees the chunks rather than each node.
+   // Nodes already in the tree move there, in van Emde Boas
+   // order. split() and join() leave the arena behind
+   //
+
+   void use_arena();
+   bool uses_arena() const noexcept { return pArena != nullptr; }
+
    //
    // Status
    //
 
    bool   empty() const noexcept { return (numElements == 0); }
    size_t size()  const noexcept { return numElements;        }
-   
+   size_t height() const noexcept { return _height(root);      }
+   size_t rotations() const noexcept { return balance.rotations(); }
+
+   //
+   // Allocator. Rebound to BNode, it makes every node; the
+   // default std::allocator leaves them to the NodePool
+   //
+
+   Alloc get_allocator() const { return Alloc(alloc); }
+
 
 private:
 
    class BNode;
+   typedef typename std::allocator_traits<Alloc>::template rebind_alloc<BNode> NodeAlloc;
+   typedef std::allocator_traits<NodeAlloc> NodeTraits;
+   typedef std::is_same<Alloc, std::allocator<T>> UsesPool;
+
    BNode * root;              // root node of the binary search tree
    size_t numElements;        // number of elements currently in the tree
+   Balance balance;           // keeps the tree balanced after each change
+   BNode * pBlock;            // the nodes relayout_veb() put in one block, or nullptr
+   size_t blockCapacity;      // how many nodes the block has room for
+   size_t numInBlock;         // how many of them are still in the tree
+   std::unique_ptr<NodeArena> pArena; // where the nodes come from after use_arena(), or nullptr
+   NodeAlloc alloc;           // makes the nodes and the block, unless there is an arena
+
+   // The bound, and in pLast the last node the search looked at
+   BNode * _lowerBound(const T & t, BNode * & pLast) const;
+   BNode * _upperBound(const T & t, BNode * & pLast) const;
+
+   // Make one node, from the arena if there is one
+   template <class U>
+   BNode * _newNode(U && t)
+   {
+      if (pArena)
+         return new (pArena->allocate()) BNode(std::forward<U>(t));
+      return _allocNode(UsesPool(), std::forward<U>(t));
+   }
+
+   // Make or free one node with the allocator, or in the pool for std::allocator
+   template <class U>
+   BNode * _allocNode(std::true_type, U && t) { return new BNode(std::forward<U>(t)); }
+   template <class U>
+   BNode * _allocNode(std::false_type, U && t)
+   {
+      BNode * pNode = NodeTraits::allocate(alloc, 1);
+      return new (pNode) BNode(std::forward<U>(t));
+   }
+   void _freeNode(std::true_type, BNode * pNode) { delete pNode; }
+   void _freeNode(std::false_type, BNode * pNode)
+   {
+      pNode->~BNode();
+      NodeTraits::deallocate(alloc, pNode, 1);
+   }
+
+   // Only some allocators follow their nodes to another tree
+   void _moveAlloc(BST & rhs, std::true_type)  { alloc = rhs.alloc; }
+   void _moveAlloc(BST & rhs, std::false_type) { }
+   void _swapAlloc(BST & rhs, std::true_type)
+   {
+      using std::swap;
+      swap(alloc, rhs.alloc);
+   }
+   void _swapAlloc(BST & rhs, std::false_type) { assert(alloc == rhs.alloc); }
+
+   // Free one node, wherever it lives. The block goes when its last node does
+   void _deleteNode(BNode * pNode)
+   {
+      std::less<const BNode *> before;
+      if (pBlock && !before(pNode, pBlock) && before(pNode, pBlock + blockCapacity))
+      {
+         pNode->~BNode();
+         if (--numInBlock == 0)
+         {
+            NodeTraits::deallocate(alloc, pBlock, blockCapacity);
+            pBlock = nullptr;
+            blockCapacity = 0;
+         }
+      }
+      else if (pArena)
+      {
+         pNode->~BNode();
+         pArena->deallocate(pNode);
+      }
+      else
+         _freeNode(UsesPool(), pNode);
+   }
 
    void _assign(BNode * & pDest, const BNode* pSrc)
    {
@@ -136,7 +261,7 @@ private:
       // Check if pDest exists.
       else if (pDest == nullptr)
       {
-         pDest = new BNode(pSrc->data);        // V
+         pDest = _newNode(pSrc->data);         // V
          _assign(pDest->pRight, pSrc->pRight); // R
          _assign(pDest->pLeft, pSrc->pLeft);   // L
       }
@@ -146,6 +271,7 @@ private:
          _assign(pDest->pRight, pSrc->pRight); // R
          _assign(pDest->pLeft, pSrc->pLeft);   // L
       }
+      pDest->copyBalance(*pSrc);
 
       // Connect any newly assigned children to this one as a parent
       if (pDest->pRight)
@@ -161,10 +287,36 @@ private:
          return;
       _clear(pThis->pLeft);   // L
       _clear(pThis->pRight);  // R
-      delete pThis;           // V
+      _deleteNode(pThis);     // V
       pThis = nullptr;
    }
-   
+
+   // Run every destructor, and leave the memory to the arena
+   static void _destroy(BNode * pThis)
+   {
+      if (pThis == nullptr)
+         return;
+      _destroy(pThis->pLeft);   // L
+      _destroy(pThis->pRight);  // R
+      pThis->~BNode();          // V
+   }
+
+   // Moving the nodes for relayout_veb()
+   static void _vebOrder  (BNode * pNode, size_t height, std::vector<BNode *> & order);
+   static void _vebBottoms(BNode * pNode, size_t depth, size_t height, std::vector<BNode *> & order);
+   void _relocate(const std::vector<BNode *> & order, BNode * pNewBlock);
+   void _unblock();
+
+   // Number of levels in the tree
+   static size_t _height(const BNode * pNode)
+   {
+      if (pNode == nullptr)
+         return 0;
+      size_t heightLeft  = _height(pNode->pLeft);
+      size_t heightRight = _height(pNode->pRight);
+      return 1 + (heightLeft > heightRight ? heightLeft : heightRight);
+   }
+
    std::pair<BNode *, bool> _insert(BNode * pNode, const T & t, bool keepUnique)
    {
       // Equal case, but only check if we're keeping unique
@@ -177,7 +329,7 @@ private:
             return _insert(pNode->pLeft, t, keepUnique);
          else
          {
-            pNode->addLeft(t);
+            pNode->addLeft(_newNode(t));
             return {pNode->pLeft, true};
          }
       }
@@ -188,7 +340,7 @@ private:
             return _insert(pNode->pRight, t, keepUnique);
          else
          {
-            pNode->addRight(t);
+            pNode->addRight(_newNode(t));
             return {pNode->pRight, true};
          }
       }
@@ -206,7 +358,7 @@ private:
             return _insertMove(pNode->pLeft, std::move(t), keepUnique);
          else
          {
-            pNode->addLeft(std::move(t));
+            pNode->addLeft(_newNode(std::move(t)));
             return {pNode->pLeft, true};
          }
       }
@@ -217,7 +369,7 @@ private:
             return _insertMove(pNode->pRight, std::move(t), keepUnique);
          else
          {
-            pNode->addRight(std::move(t));
+            pNode->addRight(_newNode(std::move(t)));
             return {pNode->pRight, true};
          }
       }
@@ -230,9 +382,13 @@ private:
  * BINARY NODE
  * A single node in a binary tree. Note that the node does not know
  * anything about the properties of the tree so no validation can be done.
+ * Whatever the balancing policy needs per node comes from its Tag,
+ * except red-black's color, which lives in the low bit of pParent so
+ * the node is three pointers and the data. new and delete of a node
+ * go to this thread's NodePool rather than to malloc.
  *****************************************************************/
-template <typename T>
-class BST <T> :: BNode
+template <typename T, typename Balance, typename Alloc>
+class BST <T, Balance, Alloc> :: BNode : public Balance::Tag
 {
 public:
    //
@@ -242,6 +398,22 @@ public:
    BNode(const T &  t)  : pLeft(nullptr), pRight(nullptr), pParent(nullptr), data(t)            { }
    BNode(T && t)        : pLeft(nullptr), pRight(nullptr), pParent(nullptr), data(std::move(t)) { }
 
+   //
+   // Allocate. From the slabs, or in place for relayout_veb()
+   //
+   static void * operator new(size_t size)
+   {
+      assert(size == sizeof(BNode));
+      (void)size;
+      return NodePool<sizeof(BNode), alignof(BNode)>::allocate();
+   }
+   static void operator delete(void * p) noexcept
+   {
+      NodePool<sizeof(BNode), alignof(BNode)>::deallocate(p);
+   }
+   static void * operator new(size_t, void * p) noexcept { return p; }
+   static void operator delete(void *, void *) noexcept { }
+
    //
    // Insert
    //
@@ -258,14 +430,33 @@ public:
    bool isRightChild() const { return (pParent && pParent->pRight == this); }
    bool isLeftChild()  const { return (pParent && pParent->pLeft == this);  }
 
+   //
+   // Balance. The Tag, and the bit in pParent that red-black keeps
+   // its color in. Both move together when a node takes another's place
+   //
+   bool isRed() const         { return pParent.tag(); }
+   void setRed(bool isRedNew) { pParent.setTag(isRedNew); }
+   void copyBalance(const BNode & rhs)
+   {
+      static_cast<typename Balance::Tag &>(*this) = rhs;
+      setRed(rhs.isRed());
+   }
+   void swapBalance(BNode & rhs)
+   {
+      std::swap(static_cast<typename Balance::Tag &>(*this),
+                static_cast<typename Balance::Tag &>(rhs));
+      bool isRedThis = isRed();
+      setRed(rhs.isRed());
+      rhs.setRed(isRedThis);
+   }
+
    //
    // Data
    //
    T data;                  // Actual data stored in the BNode
    BNode* pLeft;            // Left child - smaller
    BNode* pRight;           // Right child - larger
-   BNode* pParent;          // Parent
-   bool isRed;              // Red-black balancing stuff
+   TaggedPtr<BNode> pParent; // Parent, and the color for red-black
 
 };
 
@@ -276,8 +467,8 @@ public:
  * BINARY SEARCH TREE ITERATOR
  * Forward and reverse iterator through a BST
  *********************************************************/
-template <typename T>
-class BST <T> :: iterator
+template <typename T, typename Balance, typename Alloc>
+class BST <T, Balance, Alloc> :: iterator
 {
    friend class ::TestBST; // give unit tests access to the privates
    friend class ::TestMap;
@@ -286,7 +477,7 @@ class BST <T> :: iterator
    template <class KK, class VV>
    friend class map;
 
-   template <class TT>
+   template <class TT, class BB, class AA>
    friend class set;
 public:
    // constructors and assignment
@@ -312,7 +503,7 @@ public:
    iterator   operator -- (int postfix)          { return *this;;                                         }
 
    // must give friend status to remove so it can call getNode() from it
-   friend BST <T> :: iterator BST <T> :: erase(iterator & it);
+   friend BST <T, Balance, Alloc> :: iterator BST <T, Balance, Alloc> :: erase(iterator & it);
 
 private:
 
@@ -332,29 +523,38 @@ private:
 /*********************************************
  * BST :: DEFAULT CONSTRUCTOR
  ********************************************/
-template <typename T>
-BST <T> ::BST(): root(nullptr), numElements(0) { }
+template <typename T, typename Balance, typename Alloc>
+BST <T, Balance, Alloc> ::BST(): BST(Alloc()) { }
+
+/*********************************************
+ * BST :: ALLOCATOR CONSTRUCTOR
+ * Every node will come from this allocator
+ ********************************************/
+template <typename T, typename Balance, typename Alloc>
+BST <T, Balance, Alloc> ::BST(const Alloc & alloc): root(nullptr), numElements(0),
+                          pBlock(nullptr), blockCapacity(0), numInBlock(0), alloc(alloc) { }
 
 /*********************************************
  * BST :: COPY CONSTRUCTOR
  * Copy one tree to another
  ********************************************/
-template <typename T>
-BST <T> :: BST ( const BST<T>& rhs): root(nullptr), numElements(rhs.numElements) { *this = rhs; }
+template <typename T, typename Balance, typename Alloc>
+BST <T, Balance, Alloc> :: BST ( const BST <T, Balance, Alloc>& rhs):
+   BST(Alloc(NodeTraits::select_on_container_copy_construction(rhs.alloc))) { *this = rhs; }
 
 /*********************************************
  * BST :: MOVE CONSTRUCTOR
  * Move one tree to another
  ********************************************/
-template <typename T>
-BST <T> :: BST(BST <T> && rhs) : root(nullptr), numElements(0)                   { *this = std::move(rhs); }
+template <typename T, typename Balance, typename Alloc>
+BST <T, Balance, Alloc> :: BST(BST <T, Balance, Alloc> && rhs) : BST(Alloc(rhs.alloc)) { *this = std::move(rhs); }
 
 /*********************************************
  * BST :: INITIALIZER LIST CONSTRUCTOR
  * Create a BST from an initializer list
  ********************************************/
-template <typename T>
-BST <T> ::BST(const std::initializer_list<T>& il) : root(nullptr), numElements(0)
+template <typename T, typename Balance, typename Alloc>
+BST <T, Balance, Alloc> ::BST(const std::initializer_list<T>& il) : BST()
 {
    for (auto & element : il)
       insert(element);
@@ -363,16 +563,16 @@ BST <T> ::BST(const std::initializer_list<T>& il) : root(nullptr), numElements(0
 /*********************************************
  * BST :: DESTRUCTOR
  ********************************************/
-template <typename T>
-BST <T> :: ~BST() { clear(); }
+template <typename T, typename Balance, typename Alloc>
+BST <T, Balance, Alloc> :: ~BST() { clear(); }
 
 
 /*********************************************
  * BST :: ASSIGNMENT OPERATOR
  * Copy one tree to another
  ********************************************/
-template <typename T>
-BST <T> & BST <T> :: operator = (const BST <T> & rhs)
+template <typename T, typename Balance, typename Alloc>
+BST <T, Balance, Alloc> & BST <T, Balance, Alloc> :: operator = (const BST <T, Balance, Alloc> & rhs)
 {
    _assign(this->root, rhs.root);
    numElements = rhs.numElements;
@@ -383,8 +583,8 @@ BST <T> & BST <T> :: operator = (const BST <T> & rhs)
  * BST :: ASSIGNMENT OPERATOR with INITIALIZATION LIST
  * Copy nodes onto a BTree
  ********************************************/
-template <typename T>
-BST <T> & BST <T> :: operator = (const std::initializer_list<T>& il)
+template <typename T, typename Balance, typename Alloc>
+BST <T, Balance, Alloc> & BST <T, Balance, Alloc> :: operator = (const std::initializer_list<T>& il)
 {
    clear();
    for (auto & item : il)
@@ -394,13 +594,22 @@ BST <T> & BST <T> :: operator = (const std::initializer_list<T>& il)
 
 /*********************************************
  * BST :: ASSIGN-MOVE OPERATOR
- * Move one tree to another
+ * Move one tree to another. Nodes from an allocator that
+ * is not ours cannot become ours, so then the elements
+ * are copied instead
  ********************************************/
-template <typename T>
-BST <T> & BST <T> :: operator = (BST <T> && rhs)
+template <typename T, typename Balance, typename Alloc>
+BST <T, Balance, Alloc> & BST <T, Balance, Alloc> :: operator = (BST <T, Balance, Alloc> && rhs)
 {
    clear();
-   swap(rhs);
+   _moveAlloc(rhs, typename NodeTraits::propagate_on_container_move_assignment());
+   if (alloc == rhs.alloc)
+      swap(rhs);
+   else
+   {
+      *this = rhs;
+      rhs.clear();
+   }
    return *this;
 }
 
@@ -408,52 +617,78 @@ BST <T> & BST <T> :: operator = (BST <T> && rhs)
  * BST :: SWAP
  * Swap two trees
  ********************************************/
-template <typename T>
-void BST <T> :: swap (BST <T>& rhs)
+template <typename T, typename Balance, typename Alloc>
+void BST <T, Balance, Alloc> :: swap (BST <T, Balance, Alloc>& rhs)
 {
+    _swapAlloc(rhs, typename NodeTraits::propagate_on_container_swap());
     std::swap(root, rhs.root);
     std::swap(numElements, rhs.numElements);
+    std::swap(balance, rhs.balance);
+    std::swap(pBlock, rhs.pBlock);
+    std::swap(blockCapacity, rhs.blockCapacity);
+    std::swap(numInBlock, rhs.numInBlock);
+    pArena.swap(rhs.pArena);
 }
 
 /*****************************************************
  * BST :: INSERT
  * Insert a node at a given location in the tree
  ****************************************************/
-template <typename T>
-std::pair<typename BST <T> :: iterator, bool> BST <T> :: insert(const T & t, bool keepUnique)
+template <typename T, typename Balance, typename Alloc>
+std::pair<typename BST <T, Balance, Alloc> :: iterator, bool> BST <T, Balance, Alloc> :: insert(const T & t, bool keepUnique)
 {
    if (root)
    {
       auto result = _insert(root, t, keepUnique);
       if (result.second) // If we inserted a new node, increment numElements
+      {
          numElements++;
+         balance.afterInsert(root, result.first, numElements);
+      }
+      else
+         balance.afterFind(root, result.first);
       return result;
 
    }
    else // In case the tree is empty
    {
-      root = new BNode(t);
+      root = _newNode(t);
       numElements = 1;
+      balance.afterInsert(root, root, numElements);
       return { iterator(root), true };
    }
 }
 
-template <typename T>
-std::pair<typename BST <T> ::iterator, bool> BST <T> ::insert(T && t, bool keepUnique)
+template <typename T, typename Balance, typename Alloc>
+std::pair<typename BST <T, Balance, Alloc> ::iterator, bool> BST <T, Balance, Alloc> ::insert(T && t, bool keepUnique)
 {
-   auto result = _insertMove(root, std::move(t), keepUnique);
-   if (result.second) // If we inserted a new node, increment numElements
-      numElements++;
-   
-   return result;
+   if (root)
+   {
+      auto result = _insertMove(root, std::move(t), keepUnique);
+      if (result.second) // If we inserted a new node, increment numElements
+      {
+         numElements++;
+         balance.afterInsert(root, result.first, numElements);
+      }
+      else
+         balance.afterFind(root, result.first);
+      return result;
+   }
+   else // In case the tree is empty
+   {
+      root = _newNode(std::move(t));
+      numElements = 1;
+      balance.afterInsert(root, root, numElements);
+      return { iterator(root), true };
+   }
 }
 
 /*************************************************
  * BST :: ERASE
  * Remove a given node as specified by the iterator
  ************************************************/
-template <typename T>
-typename BST <T> ::iterator BST <T> :: erase(iterator & it)
+template <typename T, typename Balance, typename Alloc>
+typename BST <T, Balance, Alloc> ::iterator BST <T, Balance, Alloc> :: erase(iterator & it)
 {
    // If we're erasing nullptr, do nothing
    if (!it.pNode)
@@ -461,113 +696,287 @@ typename BST <T> ::iterator BST <T> :: erase(iterator & it)
 
    auto itNext = it;
    auto pDelete = it.pNode;
-
    ++itNext;
-   // Case 1: No Children
-   if(!it.pNode->pRight && !it.pNode->pLeft)
+
+   BNode * pChild;   // the node that moves up into the vacated spot
+   BNode * pParent;  // the parent of pChild once the dust settles
+
+   // Case 1 and 2: Zero or one child. The child takes our place
+   if (!pDelete->pLeft || !pDelete->pRight)
    {
-      if (it.pNode->isRightChild())
-         it.pNode->pParent->pRight = nullptr;
-      else if (it.pNode->isLeftChild())
-         it.pNode->pParent->pLeft = nullptr;
+      pChild  = (pDelete->pLeft ? pDelete->pLeft : pDelete->pRight);
+      pParent = pDelete->pParent;
+      replaceNode(root, pDelete, pChild);
    }
 
-   // Case 2a: One Left Child
-   else if(!it.pNode->pRight && it.pNode->pLeft)
+   // Case 3: Two children. The in-order successor takes our place
+   else
    {
-      it.pNode->pLeft->pParent = it.pNode->pParent;
-      if(it.pNode->pParent->pRight->data == it.pNode->data)
-      {
-         it.pNode->pRight = it.pNode->pLeft;
-      }
-      if(it.pNode->pParent->pLeft->data == it.pNode->data)
+      // find the in-order successor. It never has a left child
+      auto pIOS = pDelete->pRight;
+      while (pIOS->pLeft)
+         pIOS = pIOS->pLeft;
+      assert(pIOS->pLeft == nullptr);
+      pChild = pIOS->pRight;
+
+      // If pIOS is not the direct right child, its right child adopts its spot
+      if (pIOS->pParent == pDelete)
+         pParent = pIOS;
+      else
       {
-         it.pNode->pParent->pLeft = it.pNode->pLeft;
+         pParent = pIOS->pParent;
+         replaceNode(root, pIOS, pIOS->pRight);
+         pIOS->addRight(pDelete->pRight);
       }
+
+      // hook up pIOS where pDelete used to be. It takes over the balancing
+      // data of that spot, leaving pDelete with what left the tree
+      replaceNode(root, pDelete, pIOS);
+      pIOS->addLeft(pDelete->pLeft);
+      pIOS->swapBalance(*pDelete);
    }
 
-   // Case 2b: One Right Child
-   else if(!it.pNode->pLeft && it.pNode->pRight)
-   {
+   numElements--;
+   balance.afterErase(root, pDelete, pChild, pParent, numElements);
 
-      it.pNode->pRight->pParent = it.pNode->pParent;
-      if(it.pNode->pParent->pRight->data == it.pNode->data)
-      {
-         it.pNode->pParent->pRight = it.pNode->pRight;
-      }
-      if(it.pNode->pParent->pLeft->data == it.pNode->data)
-      {
-         it.pNode->pParent->pLeft = it.pNode->pRight;
-      }
+   _deleteNode(pDelete);
+   return itNext;
+}
+
+/*****************************************************
+ * BST :: SPLIT
+ * Everything less than t stays, the rest moves to the
+ * returned tree
+ ****************************************************/
+template <typename T, typename Balance, typename Alloc>
+BST <T, Balance, Alloc> BST <T, Balance, Alloc> :: split(const T & t)
+{
+   // the two halves cannot share a block or an arena, so give the nodes their own again
+   _unblock();
+
+   BST <T, Balance, Alloc> rest(get_allocator());
+   BNode * pLess;
+   balance.split(root, t, pLess, rest.root);
+
+   root = pLess;
+   numElements = Balance::sizeOf(root);
+   rest.numElements = Balance::sizeOf(rest.root);
+   return rest;
+}
+
+/*****************************************************
+ * BST :: JOIN
+ * Combine two trees where everything in lhs comes before
+ * everything in rhs. Both are left empty. The nodes are
+ * linked in as they are unless the allocators differ
+ ****************************************************/
+template <typename T, typename Balance, typename Alloc>
+BST <T, Balance, Alloc> BST <T, Balance, Alloc> :: join(BST <T, Balance, Alloc> & lhs, BST <T, Balance, Alloc> & rhs)
+{
+#ifndef NDEBUG
+   if (lhs.root && rhs.root)
+   {
+      BNode * pMax = lhs.root;
+      while (pMax->pRight)
+         pMax = pMax->pRight;
+      assert(!(*rhs.begin() < pMax->data));
    }
+#endif // !NDEBUG
 
-   // Case 3: Two Children
-   else if(it.pNode->pLeft && it.pNode->pRight)
+   // lhs's allocator could not free rhs's nodes, so copy the elements
+   // across instead, as move assignment does
+   if (!(lhs.alloc == rhs.alloc))
    {
-      // adopt the orphan
+      for (auto it = rhs.begin(); it != rhs.end(); ++it)
+         lhs.insert(*it);
+      rhs.clear();
+   }
+   lhs._unblock();
+   rhs._unblock();
 
-      // find the in-order successor
-      auto pIOS = pDelete->pRight;
-      while (pIOS->pLeft)
-         pIOS = pIOS->pLeft;
+   BST <T, Balance, Alloc> both(lhs.get_allocator());
+   both.root = Balance::join(lhs.root, rhs.root);
+   both.numElements = lhs.numElements + rhs.numElements;
 
-      // pIOS must not have a left????? node
-      assert(pIOS->pLeft == nullptr);
-      // take the place of pDelete
-      pIOS->pLeft = pDelete->pLeft;
-      if (pDelete->pLeft)
-         pDelete->pLeft->pParent = pIOS;
+   lhs.root = rhs.root = nullptr;
+   lhs.numElements = rhs.numElements = 0;
+   return both;
+}
 
-      // If pIOS is not direct right sibling, swap it with pDelete
-      if (pDelete->pRight != pIOS)
-      {
-         // if the IOS has a right child, then it takes his place
-         if (pIOS->pRight)
-            pIOS->pRight->pParent = pIOS->pParent;
-         pIOS->pParent->pLeft = pIOS->pRight;
-
-         // make IOS's right child pDelete's right child
-         assert(pDelete->pRight);
-         pIOS->pRight = pDelete->pRight;
-         pDelete->pRight->pParent = pIOS;
-      }
+/*****************************************************
+ * BST :: RELAYOUT VEB
+ * Put every node in one new block, in van Emde Boas
+ * order. Cut the tree at half its height: the top part
+ * goes first, laid out the same way, then each subtree
+ * hanging below it in turn. A path from the root then
+ * crosses O(log_B n) blocks of B nodes for any B, so
+ * it suits every level of cache at once
+ ****************************************************/
+template <typename T, typename Balance, typename Alloc>
+void BST <T, Balance, Alloc> :: relayout_veb()
+{
+   if (root == nullptr)
+      return;
+   std::vector<BNode *> order;
+   order.reserve(numElements);
+   _vebOrder(root, _height(root), order);
+   assert(order.size() == numElements);
+
+   _relocate(order, pArena ? (BNode *)pArena->allocate(order.size())
+                           : NodeTraits::allocate(alloc, order.size()));
+}
+
+/*****************************************************
+ * BST :: USE ARENA
+ * Move the nodes into one run at the start of a new
+ * arena, the way relayout_veb() would. The block belongs
+ * to the arena, so the tree does not keep track of it
+ ****************************************************/
+template <typename T, typename Balance, typename Alloc>
+void BST <T, Balance, Alloc> :: use_arena()
+{
+   if (pArena)
+      return;
+   std::unique_ptr<NodeArena> pNewArena(new NodeArena(sizeof(BNode), alignof(BNode)));
+   if (root)
+   {
+      std::vector<BNode *> order;
+      order.reserve(numElements);
+      _vebOrder(root, _height(root), order);
+      _relocate(order, (BNode *)pNewArena->allocate(order.size()));
+      pBlock = nullptr;
+      blockCapacity = numInBlock = 0;
+   }
+   pArena = std::move(pNewArena);
+}
 
-      // hook up pIOS's successor
-      pIOS->pParent = pDelete->pParent;
-      if (pDelete->pParent && pDelete->pParent->pLeft == pDelete)
-         pDelete->pParent->pLeft = pIOS;
-      else if (pDelete->pParent && pDelete->pParent->pRight == pDelete)
-         pDelete->pParent->pRight = pIOS;
+/*****************************************************
+ * BST :: VEB ORDER
+ * The first height levels under pNode, in vEB order
+ ****************************************************/
+template <typename T, typename Balance, typename Alloc>
+void BST <T, Balance, Alloc> :: _vebOrder(BNode * pNode, size_t height, std::vector<BNode *> & order)
+{
+   if (pNode == nullptr || height == 0)
+      return;
+   if (height == 1)
+   {
+      order.push_back(pNode);
+      return;
+   }
+   size_t heightTop = height / 2;
+   _vebOrder(pNode, heightTop, order);
+   _vebBottoms(pNode, heightTop, height - heightTop, order);
+}
 
-      // In case pDelete is the root
-      if (pDelete == root)
-         root = pIOS;
+/*****************************************************
+ * BST :: VEB BOTTOMS
+ * Lay out, left to right, each subtree rooted depth
+ * levels under pNode
+ ****************************************************/
+template <typename T, typename Balance, typename Alloc>
+void BST <T, Balance, Alloc> :: _vebBottoms(BNode * pNode, size_t depth, size_t height, std::vector<BNode *> & order)
+{
+   if (pNode == nullptr)
+      return;
+   if (depth == 0)
+   {
+      _vebOrder(pNode, height, order);
+      return;
+   }
+   _vebBottoms(pNode->pLeft,  depth - 1, height, order);
+   _vebBottoms(pNode->pRight, depth - 1, height, order);
+}
 
-      itNext = iterator(pIOS);
+/*****************************************************
+ * BST :: RELOCATE
+ * Move the nodes, in this order, into pNewBlock or, when
+ * that is nullptr, into nodes of their own from the
+ * allocator even if there is an arena. Each old node
+ * points its pParent at its replacement long enough for
+ * the links to be translated
+ ****************************************************/
+template <typename T, typename Balance, typename Alloc>
+void BST <T, Balance, Alloc> :: _relocate(const std::vector<BNode *> & order, BNode * pNewBlock)
+{
+   std::vector<BNode *> moved(order.size());
+   for (size_t i = 0; i < order.size(); i++)
+   {
+      BNode * pOld = order[i];
+      BNode * pNew = (pNewBlock ? new (pNewBlock + i) BNode(std::move(pOld->data))
+                                : _allocNode(UsesPool(), std::move(pOld->data)));
+      pNew->copyBalance(*pOld);
+      pNew->pLeft   = pOld->pLeft;
+      pNew->pRight  = pOld->pRight;
+      pNew->pParent = pOld->pParent;
+      moved[i] = pNew;
+   }
+   for (size_t i = 0; i < order.size(); i++)
+      order[i]->pParent = moved[i];
 
+   auto translate = [](BNode * pOld) { return pOld ? pOld->pParent.get() : nullptr; };
+   for (auto pNew : moved)
+   {
+      pNew->pLeft   = translate(pNew->pLeft);
+      pNew->pRight  = translate(pNew->pRight);
+      pNew->pParent = translate(pNew->pParent);
+   }
+   root = translate(root);
+
+   // the old nodes go, and with them any old block
+   for (auto pOld : order)
+      _deleteNode(pOld);
+   if (pNewBlock && !pArena)
+   {
+      pBlock = pNewBlock;
+      blockCapacity = numInBlock = order.size();
    }
-   numElements--;
-   delete pDelete;
-   return itNext;
+}
+
+/*****************************************************
+ * BST :: UNBLOCK
+ * Give every node its own allocation again, out of any
+ * block or arena
+ ****************************************************/
+template <typename T, typename Balance, typename Alloc>
+void BST <T, Balance, Alloc> :: _unblock()
+{
+   if (pBlock == nullptr && pArena == nullptr)
+      return;
+   std::vector<BNode *> order;
+   order.reserve(numElements);
+   _vebOrder(root, _height(root), order);
+   _relocate(order, nullptr);
+   pArena.reset();
 }
 
 /*****************************************************
  * BST :: CLEAR
- * Removes all the BNodes from a tree
+ * Removes all the BNodes from a tree. With an arena there
+ * is nothing to free one node at a time, and when the
+ * nodes have no destructors to run, nothing to visit
  ****************************************************/
-template <typename T>
-void BST <T> ::clear() noexcept
+template <typename T, typename Balance, typename Alloc>
+void BST <T, Balance, Alloc> ::clear() noexcept
 {
    numElements = 0;
-   _clear(root);
+   if (pArena)
+   {
+      if (!std::is_trivially_destructible<BNode>::value)
+         _destroy(root);
+      root = nullptr;
+      pArena->release();
+   }
+   else
+      _clear(root);
 }
 
 /*****************************************************
  * BST :: BEGIN
  * Return the first node (left-most) in a binary search tree
  ****************************************************/
-template <typename T>
-typename BST <T> :: iterator custom :: BST <T> :: begin() const noexcept
+template <typename T, typename Balance, typename Alloc>
+typename BST <T, Balance, Alloc> :: iterator custom :: BST <T, Balance, Alloc> :: begin() const noexcept
 {
    
    if(empty())
@@ -581,24 +990,118 @@ typename BST <T> :: iterator custom :: BST <T> :: begin() const noexcept
 
 /****************************************************
  * BST :: FIND
- * Return the node corresponding to a given value
+ * Return the node corresponding to a given value. A miss
+ * still hands the balancing policy the last node we looked
+ * at, so that a splay tree reshapes itself around the
+ * search as it would around a hit
  ****************************************************/
-template <typename T>
-typename BST <T> :: iterator BST<T> :: find(const T & t)
+template <typename T, typename Balance, typename Alloc>
+typename BST <T, Balance, Alloc> :: iterator BST <T, Balance, Alloc> :: find(const T & t)
 {
    auto p = root;
+   BNode * pLast = nullptr;
    while(p != nullptr)
    {
       if(p->data == t)
+      {
+         balance.afterFind(root, p);
          return iterator(p);
-      else if(t < p->data)
+      }
+      pLast = p;
+      if(t < p->data)
          p = p->pLeft;
       else
          p = p->pRight;
    }
+   if (pLast)
+      balance.afterFind(root, pLast);
    return end();
 }
 
+/****************************************************
+ * BST :: LOWER BOUND
+ * Return the first node not less than a given value, and
+ * let the balancing policy see where the search ended.
+ * A const tree cannot be reshaped, so that one is a plain
+ * search
+ ****************************************************/
+template <typename T, typename Balance, typename Alloc>
+typename BST <T, Balance, Alloc> :: iterator BST <T, Balance, Alloc> :: lower_bound(const T & t)
+{
+   BNode * pLast;
+   BNode * pBound = _lowerBound(t, pLast);
+   if (pLast)
+      balance.afterFind(root, pLast);
+   return iterator(pBound);
+}
+
+template <typename T, typename Balance, typename Alloc>
+typename BST <T, Balance, Alloc> :: iterator BST <T, Balance, Alloc> :: lower_bound(const T & t) const
+{
+   BNode * pLast;
+   return iterator(_lowerBound(t, pLast));
+}
+
+template <typename T, typename Balance, typename Alloc>
+typename BST <T, Balance, Alloc> :: BNode * BST <T, Balance, Alloc> :: _lowerBound(const T & t, BNode * & pLast) const
+{
+   BNode * pBound = nullptr;
+   pLast = nullptr;
+   for (auto p = root; p != nullptr; )
+   {
+      pLast = p;
+      if (p->data < t)
+         p = p->pRight;
+      else
+      {
+         pBound = p;
+         p = p->pLeft;
+      }
+   }
+   return pBound;
+}
+
+/****************************************************
+ * BST :: UPPER BOUND
+ * Return the first node greater than a given value, and
+ * let the balancing policy see where the search ended
+ ****************************************************/
+template <typename T, typename Balance, typename Alloc>
+typename BST <T, Balance, Alloc> :: iterator BST <T, Balance, Alloc> :: upper_bound(const T & t)
+{
+   BNode * pLast;
+   BNode * pBound = _upperBound(t, pLast);
+   if (pLast)
+      balance.afterFind(root, pLast);
+   return iterator(pBound);
+}
+
+template <typename T, typename Balance, typename Alloc>
+typename BST <T, Balance, Alloc> :: iterator BST <T, Balance, Alloc> :: upper_bound(const T & t) const
+{
+   BNode * pLast;
+   return iterator(_upperBound(t, pLast));
+}
+
+template <typename T, typename Balance, typename Alloc>
+typename BST <T, Balance, Alloc> :: BNode * BST <T, Balance, Alloc> :: _upperBound(const T & t, BNode * & pLast) const
+{
+   BNode * pBound = nullptr;
+   pLast = nullptr;
+   for (auto p = root; p != nullptr; )
+   {
+      pLast = p;
+      if (t < p->data)
+      {
+         pBound = p;
+         p = p->pLeft;
+      }
+      else
+         p = p->pRight;
+   }
+   return pBound;
+}
+
 /******************************************************
  ******************************************************
  ******************************************************
@@ -612,8 +1115,8 @@ typename BST <T> :: iterator BST<T> :: find(const T & t)
  * BINARY NODE :: ADD LEFT
  * Add a node to the left of the current node
  ******************************************************/
-template <typename T>
-void BST <T> :: BNode :: addLeft (BNode * pNode)
+template <typename T, typename Balance, typename Alloc>
+void BST <T, Balance, Alloc> :: BNode :: addLeft (BNode * pNode)
 {
    if (pNode != nullptr)
       pNode->pParent = this;
@@ -625,8 +1128,8 @@ void BST <T> :: BNode :: addLeft (BNode * pNode)
  * BINARY NODE :: ADD RIGHT
  * Add a node to the right of the current node
  ******************************************************/
-template <typename T>
-void BST <T> :: BNode :: addRight (BNode * pNode)
+template <typename T, typename Balance, typename Alloc>
+void BST <T, Balance, Alloc> :: BNode :: addRight (BNode * pNode)
 {
    if (pNode != nullptr)
       pNode->pParent = this;
@@ -638,8 +1141,8 @@ void BST <T> :: BNode :: addRight (BNode * pNode)
  * BINARY NODE :: ADD LEFT
  * Add a node to the left of the current node
  ******************************************************/
-template <typename T>
-void BST<T> :: BNode :: addLeft (const T & t)
+template <typename T, typename Balance, typename Alloc>
+void BST <T, Balance, Alloc> :: BNode :: addLeft (const T & t)
 {
    auto pAdd = new BNode(t);
    pAdd->pParent = this;
@@ -650,8 +1153,8 @@ void BST<T> :: BNode :: addLeft (const T & t)
  * BINARY NODE :: ADD LEFT
  * Add a node to the left of the current node
  ******************************************************/
-template <typename T>
-void BST<T> ::BNode::addLeft(T && t)
+template <typename T, typename Balance, typename Alloc>
+void BST <T, Balance, Alloc> ::BNode::addLeft(T && t)
 {
    auto pAdd = new BNode(std::move(t));
    pAdd->pParent = this;
@@ -662,8 +1165,8 @@ void BST<T> ::BNode::addLeft(T && t)
  * BINARY NODE :: ADD RIGHT
  * Add a node to the right of the current node
  ******************************************************/
-template <typename T>
-void BST <T> :: BNode :: addRight (const T & t)
+template <typename T, typename Balance, typename Alloc>
+void BST <T, Balance, Alloc> :: BNode :: addRight (const T & t)
 {
    auto pAdd = new BNode(t);
    pAdd->pParent = this;
@@ -674,8 +1177,8 @@ void BST <T> :: BNode :: addRight (const T & t)
  * BINARY NODE :: ADD RIGHT
  * Add a node to the right of the current node
  ******************************************************/
-template <typename T>
-void BST <T> ::BNode::addRight(T && t)
+template <typename T, typename Balance, typename Alloc>
+void BST <T, Balance, Alloc> ::BNode::addRight(T && t)
 {
    auto pAdd = new BNode(std::move(t));
    pAdd->pParent = this;
@@ -696,8 +1199,8 @@ void BST <T> ::BNode::addRight(T && t)
  * BST ITERATOR :: INCREMENT PREFIX
  * advance by one
  *************************************************/
-template <typename T>
-typename BST <T> :: iterator & BST <T> :: iterator :: operator ++ ()
+template <typename T, typename Balance, typename Alloc>
+typename BST <T, Balance, Alloc> :: iterator & BST <T, Balance, Alloc> :: iterator :: operator ++ ()
 {
    // Check for null node
    if(pNode == nullptr)
@@ -710,13 +1213,9 @@ typename BST <T> :: iterator & BST <T> :: iterator :: operator ++ ()
       while(pNode->pLeft)
          pNode = pNode->pLeft;
    }
-   // Case when the next consecutive number is parent.
-   else if(pNode->pRight == nullptr && pNode->pParent->pLeft == pNode)
-   {
-      pNode = pNode->pParent;
-   }
-   // Case when you have to go all the way up to grannys!
-   else if(pNode->pRight == nullptr && pNode->pParent->pRight == pNode)
+   // Case when you have to go up: past every parent we are the right child of
+   // (all the way up to grannys!) and stop at the first we are the left of.
+   else
    {
       while(pNode->pParent && pNode->pParent->pRight == pNode)
          pNode = pNode->pParent;
@@ -729,22 +1228,18 @@ typename BST <T> :: iterator & BST <T> :: iterator :: operator ++ ()
  * BST ITERATOR :: DECREMENT PREFIX
  * advance by one
  *************************************************/
-template <typename T>
-typename BST <T> :: iterator & BST <T> :: iterator :: operator -- ()
+template <typename T, typename Balance, typename Alloc>
+typename BST <T, Balance, Alloc> :: iterator & BST <T, Balance, Alloc> :: iterator :: operator -- ()
 {
    if(pNode == nullptr)
       return *this;
    else if(pNode->pLeft)
    {
       pNode = pNode->pLeft;
-      while(pNode->pLeft)
+      while(pNode->pRight)
          pNode = pNode->pRight;
    }
-   else if(pNode->pLeft == nullptr && pNode->pParent->pRight == pNode)
-   {
-      pNode = pNode->pParent;
-   }
-   else if(pNode->pLeft == nullptr && pNode->pParent->pLeft == pNode)
+   else
    {
       while(pNode->pParent && pNode->pParent->pLeft == pNode)
          pNode = pNode->pParent;
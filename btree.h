@@ -0,0 +1,842 @@
+/***********************************************************************
+ * Header:
+ *    B-TREE
+ * Summary:
+ *    A B-tree to hold the elements of a set. Each node keeps its keys
+ *    next to each other in an array sized to a few cache lines, so a
+ *    find touches one node per level instead of one node per comparison.
+ *    Nodes start on a cache line and only the keys in use are constructed
+ *
+ *    This will contain the class definition of:
+ *        BTree               : A class that represents a B-tree
+ *        BTree::iterator     : An iterator through BTree
+ *        BTreeEngine         : Pick BTree as the engine behind a set
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>    // for size_t
+#include <cstdlib>    // for posix_memalign and free
+#include <new>        // for placement new and std::bad_alloc
+#include <utility>    // for std::pair and std::move
+#include <initializer_list>
+
+#ifdef _WIN32
+#include <malloc.h>   // for _aligned_malloc and _aligned_free
+#endif
+
+class TestBTree;      // forward declaration for unit tests
+
+namespace custom
+{
+
+/*****************************************************************
+ * B-TREE ENGINE
+ * Name this as the second parameter of a set to keep its elements
+ * in a BTree whose nodes span numLines cache lines:
+ *       custom::set <int, custom::BTreeEngine<>>
+ *****************************************************************/
+template <size_t numLines = 4>
+struct BTreeEngine { };
+
+/*****************************************************************
+ * B-TREE
+ * Every node but the root holds between MIN_KEYS and MAX_KEYS
+ * sorted keys, and every leaf is at the same depth. The key array
+ * has one spare slot so a node can overflow by one before it splits
+ *****************************************************************/
+template <typename T, size_t numLines = 4>
+class BTree
+{
+   friend class ::TestBTree; // give unit tests access to the privates
+public:
+   //
+   // Construct
+   //
+
+   BTree() : root(nullptr), numElements(0) { }
+   BTree(const BTree &  rhs) : root(nullptr), numElements(0) { *this = rhs;            }
+   BTree(      BTree && rhs) : root(nullptr), numElements(0) { *this = std::move(rhs); }
+   BTree(const std::initializer_list<T> & il) : root(nullptr), numElements(0)
+   {
+      for (auto & element : il)
+         insert(element);
+   }
+   ~BTree() { clear(); }
+
+   //
+   // Assign
+   //
+
+   BTree & operator = (const BTree &  rhs);
+   BTree & operator = (      BTree && rhs);
+   BTree & operator = (const std::initializer_list<T> & il);
+   void swap(BTree & rhs) noexcept
+   {
+      std::swap(root,        rhs.root);
+      std::swap(numElements, rhs.numElements);
+   }
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   iterator begin() const noexcept;
+   iterator end()   const noexcept { return iterator(); }
+
+   //
+   // Access
+   //
+
+   iterator find(const T & t) const;
+
+   //
+   // Insert
+   //
+
+   std::pair<iterator, bool> insert(const T &  t, bool keepUnique = false);
+   std::pair<iterator, bool> insert(      T && t, bool keepUnique = false);
+
+   //
+   // Remove
+   //
+
+   iterator erase(iterator & it);
+   void clear() noexcept
+   {
+      _clear(root);
+      root = nullptr;
+      numElements = 0;
+   }
+
+   //
+   // Status
+   //
+
+   bool   empty()  const noexcept { return (numElements == 0); }
+   size_t size()   const noexcept { return numElements;        }
+   size_t height() const noexcept;
+
+private:
+
+   // as many keys as fit in numLines cache lines, less the spare
+   static const size_t CAPACITY = (numLines * 64 / sizeof(T) > 4 ? numLines * 64 / sizeof(T) : 4);
+   static const size_t MAX_KEYS = CAPACITY - 1;
+   static const size_t MIN_KEYS = MAX_KEYS / 2;
+
+   struct Node;
+   struct Inner;
+
+   Node * root;               // root node of the B-tree
+   size_t numElements;        // number of elements currently in the tree
+
+   static Node * & child(Node * pNode, size_t i) { return static_cast<Inner *>(pNode)->children[i]; }
+   static size_t indexInParent(const Node * pNode);
+   static size_t lowerBound(const Node * pNode, const T & t);
+   static size_t upperBound(const Node * pNode, const T & t);
+
+   template <class U>
+   std::pair<iterator, bool> _insert(U && t, bool keepUnique);
+   void _split(Node * pNode, Node * & pTrack, size_t & iTrack);
+   void _underflow(Node * pNode);
+   void _merge(Node * pLeft, Node * pRight, size_t iSeparator);
+   void _erase(Node * pNode, size_t i);
+   static void _relocate(T & dest, T & src);
+   static void _shiftRight(Node * pNode, size_t i);
+   static void _shiftLeft (Node * pNode, size_t i);
+   static Node * _copy(const Node * pSrc, Inner * pParent);
+   static void _clear(Node * pNode);
+   static void _delete(Node * pNode);
+};
+
+/*****************************************************************
+ * B-TREE NODE
+ * A leaf is just the keys. An inner node also has one more child
+ * than it has keys: everything in children[i] sorts before key(i).
+ * The keys come first and the node is allocated on a cache line, so
+ * they fill exactly numLines lines. Only the first numKeys slots hold
+ * a constructed T; the spare ones are raw bytes
+ *****************************************************************/
+template <typename T, size_t numLines>
+struct BTree <T, numLines> :: Node
+{
+   Node(bool isLeaf) : pParent(nullptr), numKeys(0), isLeaf(isLeaf) { }
+   ~Node()
+   {
+      for (size_t i = 0; i < numKeys; i++)
+         key(i).~T();
+   }
+
+   T &       key(size_t i)       { return reinterpret_cast<T *>(storage)[i];       }
+   const T & key(size_t i) const { return reinterpret_cast<const T *>(storage)[i]; }
+
+   // plain new only promises 16 bytes of alignment
+   static void * operator new(size_t numBytes);
+   static void operator delete(void * p) noexcept;
+
+   alignas(64) alignas(T)
+   unsigned char storage[CAPACITY * sizeof(T)]; // sorted keys, side by side
+   Inner * pParent;           // nullptr for the root
+   unsigned short numKeys;    // keys in use, the rest are spare
+   bool isLeaf;               // no children
+};
+
+template <typename T, size_t numLines>
+struct BTree <T, numLines> :: Inner : public Node
+{
+   Inner() : Node(false) { }
+
+   Node * children[CAPACITY + 1];
+};
+
+/**********************************************************
+ * B-TREE ITERATOR
+ * A node and the index of a key in it. Walks the tree in order
+ *********************************************************/
+template <typename T, size_t numLines>
+class BTree <T, numLines> :: iterator
+{
+   friend class ::TestBTree; // give unit tests access to the privates
+   friend class BTree <T, numLines>;
+public:
+   // constructors and assignment
+   iterator(Node * p = nullptr, size_t i = 0) : pNode(p), iKey(i) { }
+
+   // compare
+   bool operator == (const iterator & rhs) const { return (pNode == rhs.pNode && iKey == rhs.iKey); }
+   bool operator != (const iterator & rhs) const { return !(*this == rhs);                          }
+
+   // de-reference. Cannot change because it will invalidate the BTree
+   const T & operator * () const                 { return pNode->key(iKey);                       }
+
+   // increment and decrement
+   iterator & operator ++ ();
+   iterator   operator ++ (int postfix)          { iterator itOld(*this); ++*this; return itOld;  }
+   iterator & operator -- ();
+   iterator   operator -- (int postfix)          { iterator itOld(*this); --*this; return itOld;  }
+
+private:
+
+   Node * pNode;              // the node, nullptr for end()
+   size_t iKey;               // which key in the node
+};
+
+/*********************************************
+ *********************************************
+ ****************** B-TREE *******************
+ *********************************************
+ *********************************************/
+
+/*********************************************
+ * B-TREE :: ASSIGNMENT OPERATOR
+ * Copy one tree to another
+ ********************************************/
+template <typename T, size_t numLines>
+BTree <T, numLines> & BTree <T, numLines> :: operator = (const BTree & rhs)
+{
+   if (this != &rhs)
+   {
+      clear();
+      if (rhs.root)
+         root = _copy(rhs.root, nullptr);
+      numElements = rhs.numElements;
+   }
+   return *this;
+}
+
+/*********************************************
+ * B-TREE :: MOVE ASSIGNMENT
+ * Steal the nodes from another tree
+ ********************************************/
+template <typename T, size_t numLines>
+BTree <T, numLines> & BTree <T, numLines> :: operator = (BTree && rhs)
+{
+   clear();
+   swap(rhs);
+   return *this;
+}
+
+/*********************************************
+ * B-TREE :: ASSIGNMENT with INITIALIZATION LIST
+ ********************************************/
+template <typename T, size_t numLines>
+BTree <T, numLines> & BTree <T, numLines> :: operator = (const std::initializer_list<T> & il)
+{
+   clear();
+   for (auto & element : il)
+      insert(element);
+   return *this;
+}
+
+/*********************************************
+ * B-TREE :: BEGIN
+ * The first key of the leftmost leaf
+ ********************************************/
+template <typename T, size_t numLines>
+typename BTree <T, numLines> :: iterator BTree <T, numLines> :: begin() const noexcept
+{
+   if (root == nullptr)
+      return end();
+   Node * pNode = root;
+   while (!pNode->isLeaf)
+      pNode = child(pNode, 0);
+   return iterator(pNode);
+}
+
+/*********************************************
+ * B-TREE :: HEIGHT
+ * Every leaf is at the same depth, so follow the left edge
+ ********************************************/
+template <typename T, size_t numLines>
+size_t BTree <T, numLines> :: height() const noexcept
+{
+   size_t levels = 0;
+   for (Node * pNode = root; pNode; pNode = (pNode->isLeaf ? nullptr : child(pNode, 0)))
+      levels++;
+   return levels;
+}
+
+/*********************************************
+ * B-TREE :: LOWER BOUND and UPPER BOUND
+ * Index of the first key in the node not less than t
+ * (or greater than t). The keys are contiguous, so this
+ * scans a few cache lines rather than chasing pointers
+ ********************************************/
+template <typename T, size_t numLines>
+size_t BTree <T, numLines> :: lowerBound(const Node * pNode, const T & t)
+{
+   size_t iBegin = 0;
+   size_t iEnd = pNode->numKeys;
+   while (iBegin < iEnd)
+   {
+      size_t iMiddle = (iBegin + iEnd) / 2;
+      if (pNode->key(iMiddle) < t)
+         iBegin = iMiddle + 1;
+      else
+         iEnd = iMiddle;
+   }
+   return iBegin;
+}
+
+template <typename T, size_t numLines>
+size_t BTree <T, numLines> :: upperBound(const Node * pNode, const T & t)
+{
+   size_t iBegin = 0;
+   size_t iEnd = pNode->numKeys;
+   while (iBegin < iEnd)
+   {
+      size_t iMiddle = (iBegin + iEnd) / 2;
+      if (t < pNode->key(iMiddle))
+         iEnd = iMiddle;
+      else
+         iBegin = iMiddle + 1;
+   }
+   return iBegin;
+}
+
+/*********************************************
+ * B-TREE :: INDEX IN PARENT
+ * Which child of its parent a node is
+ ********************************************/
+template <typename T, size_t numLines>
+size_t BTree <T, numLines> :: indexInParent(const Node * pNode)
+{
+   assert(pNode->pParent);
+   size_t i = 0;
+   while (pNode->pParent->children[i] != pNode)
+      i++;
+   return i;
+}
+
+/*********************************************
+ * B-TREE :: FIND
+ * Return the iterator to the element if it exists,
+ * otherwise end()
+ ********************************************/
+template <typename T, size_t numLines>
+typename BTree <T, numLines> :: iterator BTree <T, numLines> :: find(const T & t) const
+{
+   Node * pNode = root;
+   while (pNode)
+   {
+      size_t i = lowerBound(pNode, t);
+      if (i < pNode->numKeys && pNode->key(i) == t)
+         return iterator(pNode, i);
+      pNode = (pNode->isLeaf ? nullptr : child(pNode, i));
+   }
+   return end();
+}
+
+/*********************************************
+ * B-TREE :: INSERT
+ * Insert a new element into the tree
+ ********************************************/
+template <typename T, size_t numLines>
+std::pair<typename BTree <T, numLines> :: iterator, bool> BTree <T, numLines> :: insert(const T & t, bool keepUnique)
+{
+   return _insert(t, keepUnique);
+}
+
+template <typename T, size_t numLines>
+std::pair<typename BTree <T, numLines> :: iterator, bool> BTree <T, numLines> :: insert(T && t, bool keepUnique)
+{
+   return _insert(std::move(t), keepUnique);
+}
+
+/*********************************************
+ * B-TREE :: _INSERT
+ * Walk down to the leaf, put the element there, and split
+ * any node that overflows on the way back up
+ ********************************************/
+template <typename T, size_t numLines>
+template <class U>
+std::pair<typename BTree <T, numLines> :: iterator, bool> BTree <T, numLines> :: _insert(U && t, bool keepUnique)
+{
+   if (root == nullptr)
+      root = new Node(true);
+
+   Node * pNode = root;
+   size_t i;
+   while (true)
+   {
+      if (keepUnique)
+      {
+         i = lowerBound(pNode, t);
+         if (i < pNode->numKeys && pNode->key(i) == t)
+            return std::make_pair(iterator(pNode, i), false);
+      }
+      else
+         i = upperBound(pNode, t);
+
+      if (pNode->isLeaf)
+         break;
+      pNode = child(pNode, i);
+   }
+
+   _shiftRight(pNode, i);
+   new (&pNode->key(i)) T(std::forward<U>(t));
+   numElements++;
+
+   // follow the new element as the splits move it around
+   if (pNode->numKeys > MAX_KEYS)
+      _split(pNode, pNode, i);
+
+   return std::make_pair(iterator(pNode, i), true);
+}
+
+/*********************************************
+ * B-TREE :: _SPLIT
+ * pNode has one key too many. Move the top half into a new
+ * sibling and the middle key up into the parent, splitting
+ * the parent in turn if that overflows it. pTrack and iTrack
+ * follow one key through the shuffle
+ ********************************************/
+template <typename T, size_t numLines>
+void BTree <T, numLines> :: _split(Node * pNode, Node * & pTrack, size_t & iTrack)
+{
+   const size_t iMiddle = pNode->numKeys / 2;
+
+   // the new sibling gets everything after the middle
+   Node * pRight = (pNode->isLeaf ? new Node(true) : new Inner);
+   pRight->numKeys = (unsigned short)(pNode->numKeys - iMiddle - 1);
+   for (size_t i = 0; i < pRight->numKeys; i++)
+      _relocate(pRight->key(i), pNode->key(iMiddle + 1 + i));
+   if (!pNode->isLeaf)
+      for (size_t i = 0; i <= pRight->numKeys; i++)
+      {
+         child(pRight, i) = child(pNode, iMiddle + 1 + i);
+         child(pRight, i)->pParent = static_cast<Inner *>(pRight);
+      }
+   // a root that splits gets a new root above it
+   if (pNode->pParent == nullptr)
+   {
+      Inner * pRoot = new Inner;
+      pRoot->children[0] = pNode;
+      pNode->pParent = pRoot;
+      root = pRoot;
+   }
+
+   // the middle key moves up, just left of the new sibling
+   Inner * pParent = pNode->pParent;
+   size_t iParent = indexInParent(pNode);
+   _shiftRight(pParent, iParent);
+   _relocate(pParent->key(iParent), pNode->key(iMiddle));
+   pNode->numKeys = (unsigned short)iMiddle;
+   pParent->children[iParent + 1] = pRight;
+   pRight->pParent = pParent;
+
+   if (pTrack == pNode && iTrack == iMiddle)
+   {
+      pTrack = pParent;
+      iTrack = iParent;
+   }
+   else if (pTrack == pNode && iTrack > iMiddle)
+   {
+      pTrack = pRight;
+      iTrack -= iMiddle + 1;
+   }
+   else if (pTrack == pParent && iTrack >= iParent)
+      iTrack++;
+
+   if (pParent->numKeys > MAX_KEYS)
+      _split(pParent, pTrack, iTrack);
+}
+
+/*********************************************
+ * B-TREE :: ERASE
+ * Remove one element, returning the one after it
+ ********************************************/
+template <typename T, size_t numLines>
+typename BTree <T, numLines> :: iterator BTree <T, numLines> :: erase(iterator & it)
+{
+   if (it.pNode == nullptr)
+      return end();
+
+   // the nodes shuffle as we rebalance, so look the next one up afterwards
+   iterator itNext = it;
+   ++itNext;
+   if (itNext == end())
+   {
+      _erase(it.pNode, it.iKey);
+      return end();
+   }
+   T tNext(*itNext);
+   _erase(it.pNode, it.iKey);
+
+   Node * pFind = root;
+   while (true)
+   {
+      size_t i = lowerBound(pFind, tNext);
+      if ((i < pFind->numKeys && !(tNext < pFind->key(i))) || pFind->isLeaf)
+         return iterator(pFind, i);
+      pFind = child(pFind, i);
+   }
+}
+
+/*********************************************
+ * B-TREE :: _ERASE
+ * Take key i out of pNode. An inner key trades places
+ * with its predecessor, which is always in a leaf
+ ********************************************/
+template <typename T, size_t numLines>
+void BTree <T, numLines> :: _erase(Node * pNode, size_t i)
+{
+   if (!pNode->isLeaf)
+   {
+      Node * pLeaf = child(pNode, i);
+      while (!pLeaf->isLeaf)
+         pLeaf = child(pLeaf, pLeaf->numKeys);
+      pNode->key(i) = std::move(pLeaf->key(pLeaf->numKeys - 1));
+      pNode = pLeaf;
+      i = pLeaf->numKeys - 1;
+   }
+
+   _shiftLeft(pNode, i);
+   numElements--;
+   _underflow(pNode);
+}
+
+/*********************************************
+ * B-TREE :: _UNDERFLOW
+ * pNode may have too few keys. Borrow one through the parent
+ * from a sibling that can spare it, or else merge with a
+ * sibling and check the parent in turn
+ ********************************************/
+template <typename T, size_t numLines>
+void BTree <T, numLines> :: _underflow(Node * pNode)
+{
+   while (pNode != root && pNode->numKeys < MIN_KEYS)
+   {
+      Inner * pParent = pNode->pParent;
+      size_t iParent = indexInParent(pNode);
+      Node * pLeft  = (iParent > 0                 ? pParent->children[iParent - 1] : nullptr);
+      Node * pRight = (iParent < pParent->numKeys  ? pParent->children[iParent + 1] : nullptr);
+
+      // rotate the largest key of the left sibling through the parent
+      if (pLeft && pLeft->numKeys > MIN_KEYS)
+      {
+         _shiftRight(pNode, 0);
+         new (&pNode->key(0)) T(std::move(pParent->key(iParent - 1)));
+         pParent->key(iParent - 1) = std::move(pLeft->key(pLeft->numKeys - 1));
+         pLeft->key(pLeft->numKeys - 1).~T();
+         if (!pNode->isLeaf)
+         {
+            child(pNode, 1) = child(pNode, 0);
+            child(pNode, 0) = child(pLeft, pLeft->numKeys);
+            child(pNode, 0)->pParent = static_cast<Inner *>(pNode);
+         }
+         pLeft->numKeys--;
+         return;
+      }
+
+      // rotate the smallest key of the right sibling through the parent
+      if (pRight && pRight->numKeys > MIN_KEYS)
+      {
+         new (&pNode->key(pNode->numKeys)) T(std::move(pParent->key(iParent)));
+         pParent->key(iParent) = std::move(pRight->key(0));
+         if (!pNode->isLeaf)
+         {
+            child(pNode, pNode->numKeys + 1) = child(pRight, 0);
+            child(pNode, pNode->numKeys + 1)->pParent = static_cast<Inner *>(pNode);
+            for (size_t i = 0; i < pRight->numKeys; i++)
+               child(pRight, i) = child(pRight, i + 1);
+         }
+         pNode->numKeys++;
+         _shiftLeft(pRight, 0);
+         return;
+      }
+
+      // neither can spare one, so two small nodes become one
+      if (pLeft)
+         _merge(pLeft, pNode, iParent - 1);
+      else
+         _merge(pNode, pRight, iParent);
+      pNode = pParent;
+   }
+
+   // the root is allowed to be small, but not empty
+   if (root && root->numKeys == 0)
+   {
+      Node * pOld = root;
+      if (root->isLeaf)
+         root = nullptr;
+      else
+      {
+         root = child(root, 0);
+         root->pParent = nullptr;
+      }
+      _delete(pOld);
+   }
+}
+
+/*********************************************
+ * B-TREE :: _MERGE
+ * Fold pRight and the parent key between them into pLeft
+ ********************************************/
+template <typename T, size_t numLines>
+void BTree <T, numLines> :: _merge(Node * pLeft, Node * pRight, size_t iSeparator)
+{
+   Inner * pParent = pLeft->pParent;
+   size_t iBase = pLeft->numKeys;
+
+   new (&pLeft->key(iBase)) T(std::move(pParent->key(iSeparator)));
+   for (size_t i = 0; i < pRight->numKeys; i++)
+      _relocate(pLeft->key(iBase + 1 + i), pRight->key(i));
+   if (!pLeft->isLeaf)
+      for (size_t i = 0; i <= pRight->numKeys; i++)
+      {
+         child(pLeft, iBase + 1 + i) = child(pRight, i);
+         child(pLeft, iBase + 1 + i)->pParent = static_cast<Inner *>(pLeft);
+      }
+   pLeft->numKeys = (unsigned short)(iBase + 1 + pRight->numKeys);
+   pRight->numKeys = 0;
+
+   // the parent loses the separator and pRight
+   for (size_t i = iSeparator + 1; i < pParent->numKeys; i++)
+      pParent->children[i] = pParent->children[i + 1];
+   _shiftLeft(pParent, iSeparator);
+   _delete(pRight);
+}
+
+/*********************************************
+ * B-TREE :: _SHIFT RIGHT and _SHIFT LEFT
+ * Open a gap at key(i) (and at children[i + 1] in an inner
+ * node), or close the gap at key(i). The gap is left raw for
+ * the caller to construct into; closing one destroys the key
+ ********************************************/
+template <typename T, size_t numLines>
+void BTree <T, numLines> :: _shiftRight(Node * pNode, size_t i)
+{
+   for (size_t iKey = pNode->numKeys; iKey > i; iKey--)
+      _relocate(pNode->key(iKey), pNode->key(iKey - 1));
+   if (!pNode->isLeaf)
+      for (size_t iChild = pNode->numKeys + 1; iChild > i + 1; iChild--)
+         child(pNode, iChild) = child(pNode, iChild - 1);
+   pNode->numKeys++;
+}
+
+template <typename T, size_t numLines>
+void BTree <T, numLines> :: _shiftLeft(Node * pNode, size_t i)
+{
+   pNode->key(i).~T();
+   for (size_t iKey = i; iKey + 1 < pNode->numKeys; iKey++)
+      _relocate(pNode->key(iKey), pNode->key(iKey + 1));
+   pNode->numKeys--;
+}
+
+/*********************************************
+ * B-TREE :: _RELOCATE
+ * Move a key from a live slot into a raw one,
+ * leaving the old slot raw
+ ********************************************/
+template <typename T, size_t numLines>
+void BTree <T, numLines> :: _relocate(T & dest, T & src)
+{
+   new (&dest) T(std::move(src));
+   src.~T();
+}
+
+/*********************************************
+ * B-TREE :: NODE :: NEW and DELETE
+ * Every node starts on a cache line, so its keys do too
+ ********************************************/
+template <typename T, size_t numLines>
+void * BTree <T, numLines> :: Node :: operator new(size_t numBytes)
+{
+#ifdef _WIN32
+   void * p = _aligned_malloc(numBytes, alignof(Node));
+#else
+   void * p = nullptr;
+   if (posix_memalign(&p, alignof(Node), numBytes) != 0)
+      p = nullptr;
+#endif
+   if (p == nullptr)
+      throw std::bad_alloc();
+   return p;
+}
+
+template <typename T, size_t numLines>
+void BTree <T, numLines> :: Node :: operator delete(void * p) noexcept
+{
+#ifdef _WIN32
+   _aligned_free(p);
+#else
+   free(p);
+#endif
+}
+
+/*********************************************
+ * B-TREE :: _COPY
+ * Make a copy of a subtree
+ ********************************************/
+template <typename T, size_t numLines>
+typename BTree <T, numLines> :: Node * BTree <T, numLines> :: _copy(const Node * pSrc, Inner * pParent)
+{
+   Node * pDest = (pSrc->isLeaf ? new Node(true) : new Inner);
+   pDest->pParent = pParent;
+   for (size_t i = 0; i < pSrc->numKeys; i++)
+   {
+      new (&pDest->key(i)) T(pSrc->key(i));
+      pDest->numKeys++;
+   }
+   if (!pSrc->isLeaf)
+      for (size_t i = 0; i <= pSrc->numKeys; i++)
+         child(pDest, i) = _copy(static_cast<const Inner *>(pSrc)->children[i],
+                                 static_cast<Inner *>(pDest));
+   return pDest;
+}
+
+/*********************************************
+ * B-TREE :: _CLEAR and _DELETE
+ * Free a subtree, or just one node
+ ********************************************/
+template <typename T, size_t numLines>
+void BTree <T, numLines> :: _clear(Node * pNode)
+{
+   if (pNode == nullptr)
+      return;
+   if (!pNode->isLeaf)
+      for (size_t i = 0; i <= pNode->numKeys; i++)
+         _clear(child(pNode, i));
+   _delete(pNode);
+}
+
+template <typename T, size_t numLines>
+void BTree <T, numLines> :: _delete(Node * pNode)
+{
+   if (pNode->isLeaf)
+      delete pNode;
+   else
+      delete static_cast<Inner *>(pNode);
+}
+
+/*********************************************
+ *********************************************
+ ************** B-TREE ITERATOR **************
+ *********************************************
+ *********************************************/
+
+/**************************************************
+ * B-TREE ITERATOR :: INCREMENT PREFIX
+ * The next key in the leaf, or the leftmost key of
+ * the subtree to our right, or else up to the first
+ * ancestor we are left of
+ *************************************************/
+template <typename T, size_t numLines>
+typename BTree <T, numLines> :: iterator & BTree <T, numLines> :: iterator :: operator ++ ()
+{
+   if (pNode == nullptr)
+      return *this;
+
+   if (!pNode->isLeaf)
+   {
+      pNode = child(pNode, iKey + 1);
+      while (!pNode->isLeaf)
+         pNode = child(pNode, 0);
+      iKey = 0;
+      return *this;
+   }
+
+   if (++iKey < pNode->numKeys)
+      return *this;
+
+   while (pNode->pParent)
+   {
+      size_t iParent = indexInParent(pNode);
+      pNode = pNode->pParent;
+      if (iParent < pNode->numKeys)
+      {
+         iKey = iParent;
+         return *this;
+      }
+   }
+   pNode = nullptr;
+   iKey = 0;
+   return *this;
+}
+
+/**************************************************
+ * B-TREE ITERATOR :: DECREMENT PREFIX
+ * The mirror image of increment
+ *************************************************/
+template <typename T, size_t numLines>
+typename BTree <T, numLines> :: iterator & BTree <T, numLines> :: iterator :: operator -- ()
+{
+   if (pNode == nullptr)
+      return *this;
+
+   if (!pNode->isLeaf)
+   {
+      pNode = child(pNode, iKey);
+      while (!pNode->isLeaf)
+         pNode = child(pNode, pNode->numKeys);
+      iKey = pNode->numKeys - 1;
+      return *this;
+   }
+
+   if (iKey > 0)
+   {
+      iKey--;
+      return *this;
+   }
+
+   while (pNode->pParent)
+   {
+      size_t iParent = indexInParent(pNode);
+      pNode = pNode->pParent;
+      if (iParent > 0)
+      {
+         iKey = iParent - 1;
+         return *this;
+      }
+   }
+   pNode = nullptr;
+   iKey = 0;
+   return *this;
+}
+
+} // namespace custom
@@ -0,0 +1,687 @@
+/***********************************************************************
+ * Header:
+ *    COMPACT TREE
+ * Summary:
+ *    A red-black tree to hold the elements of a set, with every node
+ *    in one vector and the links between them as 32-bit indices
+ *    rather than pointers. A node costs T and twelve bytes instead of
+ *    T and thirty-two, the nodes sit close together, and nothing
+ *    points into the vector, so it can grow, move, or be copied
+ *    whole. An erased node's slot is kept for the next insert
+ *
+ *    This will contain the class definition of:
+ *        CompactTree           : A class that represents an index-linked tree
+ *        CompactTree::iterator : An iterator through CompactTree
+ *        CompactEngine         : Pick CompactTree as the engine behind a set
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>    // for size_t
+#include <cstdint>    // for uint32_t
+#include <utility>    // for std::pair, std::move, and std::forward
+#include <vector>     // for std::vector
+#include <initializer_list>
+
+class TestCompactTree;   // forward declaration for unit tests
+
+namespace custom
+{
+
+/*****************************************************************
+ * COMPACT ENGINE
+ * Name this as the second parameter of a set to keep its elements
+ * in a CompactTree:
+ *       custom::set <int, custom::CompactEngine>
+ *****************************************************************/
+struct CompactEngine { };
+
+/*****************************************************************
+ * COMPACT TREE
+ * Balanced the red-black way, as BST is by default. A node's
+ * parent index shares its word with the node's color, so there is
+ * room for 2^31 - 1 nodes. The free slots are linked through their
+ * left index. Iterators hold the tree and an index, so they stay
+ * good when the vector grows
+ *****************************************************************/
+template <typename T>
+class CompactTree
+{
+   friend class ::TestCompactTree; // give unit tests access to the privates
+public:
+   //
+   // Construct. A copy is a copy of the vector, which for a
+   // trivially copyable T is one memcpy
+   //
+
+   CompactTree() : root(NIL), freeHead(NIL), numElements(0) { }
+   CompactTree(const CompactTree &  rhs) = default;
+   CompactTree(      CompactTree && rhs) noexcept : CompactTree() { swap(rhs); }
+   CompactTree(const std::initializer_list<T> & il) : CompactTree()
+   {
+      for (auto & element : il)
+         insert(element);
+   }
+
+   //
+   // Assign
+   //
+
+   CompactTree & operator = (const CompactTree &  rhs) = default;
+   CompactTree & operator = (      CompactTree && rhs) noexcept
+   {
+      clear();
+      swap(rhs);
+      return *this;
+   }
+   CompactTree & operator = (const std::initializer_list<T> & il);
+   void swap(CompactTree & rhs) noexcept;
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   iterator begin() const noexcept;
+   iterator end()   const noexcept { return iterator(this, NIL); }
+
+   //
+   // Access
+   //
+
+   iterator find(const T & t) const;
+   iterator lower_bound(const T & t) const;
+   iterator upper_bound(const T & t) const;
+
+   //
+   // Insert
+   //
+
+   std::pair<iterator, bool> insert(const T &  t, bool keepUnique = false) { return _insert(t, keepUnique);            }
+   std::pair<iterator, bool> insert(      T && t, bool keepUnique = false) { return _insert(std::move(t), keepUnique); }
+   void reserve(size_t numNodes) { nodes.reserve(numNodes); }
+
+   //
+   // Remove
+   //
+
+   iterator erase(iterator & it);
+   void clear() noexcept;
+
+   //
+   // Status
+   //
+
+   bool   empty()  const noexcept { return (numElements == 0);            }
+   size_t size()   const noexcept { return numElements;                   }
+   size_t height() const noexcept { return _height(root);                 }
+   size_t bytes()  const noexcept { return nodes.capacity() * sizeof(Node); }
+
+private:
+
+   static const uint32_t NIL = 0x7FFFFFFF;   // no node
+   static const uint32_t RED = 0x80000000;   // the color bit of parentAndColor
+
+   struct Node
+   {
+      explicit Node(const T &  t) : data(t),            left(NIL), right(NIL), parentAndColor(NIL | RED) { }
+      explicit Node(      T && t) : data(std::move(t)), left(NIL), right(NIL), parentAndColor(NIL | RED) { }
+
+      T data;                    // Actual data stored in the Node
+      uint32_t left;             // Left child - smaller, or the next free slot
+      uint32_t right;            // Right child - larger
+      uint32_t parentAndColor;   // Parent, with RED set for a red node
+   };
+
+   std::vector<Node> nodes;      // every node, in the tree or free
+   uint32_t root;                // index of the root, or NIL
+   uint32_t freeHead;            // the first free slot, or NIL
+   size_t numElements;           // number of elements currently in the tree
+
+   // the links, hiding the color in the parent's word
+   uint32_t _parent(uint32_t i) const { return nodes[i].parentAndColor & ~RED;                   }
+   bool     _isRed (uint32_t i) const { return i != NIL && (nodes[i].parentAndColor & RED) != 0; }
+   void _setParent(uint32_t i, uint32_t iParent)
+   {
+      nodes[i].parentAndColor = (nodes[i].parentAndColor & RED) | iParent;
+   }
+   void _setRed(uint32_t i, bool isRed)
+   {
+      assert(i != NIL);
+      nodes[i].parentAndColor = (nodes[i].parentAndColor & ~RED) | (isRed ? RED : 0);
+   }
+
+   uint32_t _first(uint32_t i) const
+   {
+      while (nodes[i].left != NIL)
+         i = nodes[i].left;
+      return i;
+   }
+   uint32_t _last(uint32_t i) const
+   {
+      while (nodes[i].right != NIL)
+         i = nodes[i].right;
+      return i;
+   }
+   uint32_t _next(uint32_t i) const;
+   uint32_t _prev(uint32_t i) const;
+   size_t _height(uint32_t i) const
+   {
+      if (i == NIL)
+         return 0;
+      size_t heightLeft  = _height(nodes[i].left);
+      size_t heightRight = _height(nodes[i].right);
+      return 1 + (heightLeft > heightRight ? heightLeft : heightRight);
+   }
+
+   template <class U>
+   uint32_t _newNode(U && t);
+   void _freeNode(uint32_t i);
+   void _replaceChild(uint32_t iParent, uint32_t iOld, uint32_t iNew);
+   void _rotateLeft (uint32_t i);
+   void _rotateRight(uint32_t i);
+   void _insertFixup(uint32_t i);
+   void _eraseFixup(uint32_t i, uint32_t iParent);
+
+   template <class U>
+   std::pair<iterator, bool> _insert(U && t, bool keepUnique);
+};
+
+/**********************************************************
+ * COMPACT TREE ITERATOR
+ * The tree and an index into it. end() is NIL, and
+ * stepping back from it gives the last element
+ *********************************************************/
+template <typename T>
+class CompactTree <T> :: iterator
+{
+   friend class ::TestCompactTree; // give unit tests access to the privates
+   friend class CompactTree <T>;
+public:
+   // constructors and assignment
+   iterator() : pTree(nullptr), index(NIL)       { }
+   iterator(const CompactTree * pTree, uint32_t index) : pTree(pTree), index(index) { }
+
+   // compare
+   bool operator == (const iterator & rhs) const { return (index == rhs.index);                 }
+   bool operator != (const iterator & rhs) const { return (index != rhs.index);                 }
+
+   // de-reference. Cannot change because it will invalidate the CompactTree
+   const T & operator * () const                 { return pTree->nodes[index].data;             }
+
+   // increment and decrement
+   iterator & operator ++ ()                     { if (index != NIL) index = pTree->_next(index); return *this; }
+   iterator   operator ++ (int postfix)          { iterator itOld(*this); ++*this; return itOld; }
+   iterator & operator -- ()
+   {
+      if (index != NIL)
+         index = pTree->_prev(index);
+      else if (pTree && pTree->root != NIL)
+         index = pTree->_last(pTree->root);
+      return *this;
+   }
+   iterator   operator -- (int postfix)          { iterator itOld(*this); --*this; return itOld; }
+
+private:
+
+   const CompactTree * pTree; // the tree the node is in
+   uint32_t index;            // the node, NIL for end()
+};
+
+/*********************************************
+ *********************************************
+ *************** COMPACT TREE ****************
+ *********************************************
+ *********************************************/
+
+/*********************************************
+ * COMPACT TREE :: ASSIGNMENT with INITIALIZATION LIST
+ ********************************************/
+template <typename T>
+CompactTree <T> & CompactTree <T> :: operator = (const std::initializer_list<T> & il)
+{
+   clear();
+   for (auto & element : il)
+      insert(element);
+   return *this;
+}
+
+/*********************************************
+ * COMPACT TREE :: SWAP
+ * Nothing points at the tree, so swap the parts
+ ********************************************/
+template <typename T>
+void CompactTree <T> :: swap(CompactTree & rhs) noexcept
+{
+   nodes.swap(rhs.nodes);
+   std::swap(root,        rhs.root);
+   std::swap(freeHead,    rhs.freeHead);
+   std::swap(numElements, rhs.numElements);
+}
+
+/*********************************************
+ * COMPACT TREE :: BEGIN
+ ********************************************/
+template <typename T>
+typename CompactTree <T> :: iterator CompactTree <T> :: begin() const noexcept
+{
+   return iterator(this, root == NIL ? NIL : _first(root));
+}
+
+/*********************************************
+ * COMPACT TREE :: CLEAR
+ * The vector keeps its capacity for what comes next
+ ********************************************/
+template <typename T>
+void CompactTree <T> :: clear() noexcept
+{
+   nodes.clear();
+   root = freeHead = NIL;
+   numElements = 0;
+}
+
+/*********************************************
+ * COMPACT TREE :: NEXT and PREV
+ * The in-order neighbors: down one side and all the
+ * way along the other, or up until we come from it
+ ********************************************/
+template <typename T>
+uint32_t CompactTree <T> :: _next(uint32_t i) const
+{
+   if (nodes[i].right != NIL)
+      return _first(nodes[i].right);
+   uint32_t iParent = _parent(i);
+   while (iParent != NIL && nodes[iParent].right == i)
+   {
+      i = iParent;
+      iParent = _parent(i);
+   }
+   return iParent;
+}
+
+template <typename T>
+uint32_t CompactTree <T> :: _prev(uint32_t i) const
+{
+   if (nodes[i].left != NIL)
+      return _last(nodes[i].left);
+   uint32_t iParent = _parent(i);
+   while (iParent != NIL && nodes[iParent].left == i)
+   {
+      i = iParent;
+      iParent = _parent(i);
+   }
+   return iParent;
+}
+
+/*********************************************
+ * COMPACT TREE :: FIND
+ * Return the iterator to the element if it exists,
+ * otherwise end()
+ ********************************************/
+template <typename T>
+typename CompactTree <T> :: iterator CompactTree <T> :: find(const T & t) const
+{
+   uint32_t i = root;
+   while (i != NIL)
+   {
+      const Node & node = nodes[i];
+      if (node.data == t)
+         return iterator(this, i);
+      i = (t < node.data ? node.left : node.right);
+   }
+   return end();
+}
+
+/*********************************************
+ * COMPACT TREE :: LOWER BOUND and UPPER BOUND
+ * The first element not less than t, and the first
+ * one greater than t
+ ********************************************/
+template <typename T>
+typename CompactTree <T> :: iterator CompactTree <T> :: lower_bound(const T & t) const
+{
+   uint32_t iBound = NIL;
+   for (uint32_t i = root; i != NIL; )
+   {
+      if (nodes[i].data < t)
+         i = nodes[i].right;
+      else
+      {
+         iBound = i;
+         i = nodes[i].left;
+      }
+   }
+   return iterator(this, iBound);
+}
+
+template <typename T>
+typename CompactTree <T> :: iterator CompactTree <T> :: upper_bound(const T & t) const
+{
+   uint32_t iBound = NIL;
+   for (uint32_t i = root; i != NIL; )
+   {
+      if (t < nodes[i].data)
+      {
+         iBound = i;
+         i = nodes[i].left;
+      }
+      else
+         i = nodes[i].right;
+   }
+   return iterator(this, iBound);
+}
+
+/*********************************************
+ * COMPACT TREE :: NEW NODE and FREE NODE
+ * A free slot if there is one, else one more on the
+ * end of the vector. A freed slot lets go of what its
+ * element held right away, rather than at the next insert
+ ********************************************/
+template <typename T>
+template <class U>
+uint32_t CompactTree <T> :: _newNode(U && t)
+{
+   uint32_t i;
+   if (freeHead != NIL)
+   {
+      i = freeHead;
+      freeHead = nodes[i].left;
+      nodes[i].data = std::forward<U>(t);
+      nodes[i].left = NIL;
+   }
+   else
+   {
+      assert(nodes.size() < NIL);
+      i = (uint32_t)nodes.size();
+      nodes.push_back(Node(std::forward<U>(t)));
+   }
+   nodes[i].right = NIL;
+   nodes[i].parentAndColor = NIL | RED;
+   return i;
+}
+
+template <typename T>
+void CompactTree <T> :: _freeNode(uint32_t i)
+{
+   (void)T(std::move(nodes[i].data));
+   nodes[i].left = freeHead;
+   nodes[i].right = NIL;
+   nodes[i].parentAndColor = NIL;
+   freeHead = i;
+}
+
+/*********************************************
+ * COMPACT TREE :: REPLACE CHILD
+ * Whatever pointed at iOld from above points at iNew
+ ********************************************/
+template <typename T>
+void CompactTree <T> :: _replaceChild(uint32_t iParent, uint32_t iOld, uint32_t iNew)
+{
+   if (iParent == NIL)
+      root = iNew;
+   else if (nodes[iParent].left == iOld)
+      nodes[iParent].left = iNew;
+   else
+      nodes[iParent].right = iNew;
+}
+
+/*********************************************
+ * COMPACT TREE :: ROTATE
+ * The child on one side takes i's place, and i
+ * becomes its child on the other side
+ ********************************************/
+template <typename T>
+void CompactTree <T> :: _rotateLeft(uint32_t i)
+{
+   uint32_t iRight = nodes[i].right;
+   nodes[i].right = nodes[iRight].left;
+   if (nodes[iRight].left != NIL)
+      _setParent(nodes[iRight].left, i);
+   _setParent(iRight, _parent(i));
+   _replaceChild(_parent(i), i, iRight);
+   nodes[iRight].left = i;
+   _setParent(i, iRight);
+}
+
+template <typename T>
+void CompactTree <T> :: _rotateRight(uint32_t i)
+{
+   uint32_t iLeft = nodes[i].left;
+   nodes[i].left = nodes[iLeft].right;
+   if (nodes[iLeft].right != NIL)
+      _setParent(nodes[iLeft].right, i);
+   _setParent(iLeft, _parent(i));
+   _replaceChild(_parent(i), i, iLeft);
+   nodes[iLeft].right = i;
+   _setParent(i, iLeft);
+}
+
+/*********************************************
+ * COMPACT TREE :: _INSERT
+ * Down to a leaf, a new red node there, then fix any
+ * red node with a red parent. Equal elements go right
+ ********************************************/
+template <typename T>
+template <class U>
+std::pair<typename CompactTree <T> :: iterator, bool> CompactTree <T> :: _insert(U && t, bool keepUnique)
+{
+   uint32_t iParent = NIL;
+   bool isLeft = false;
+   for (uint32_t i = root; i != NIL; )
+   {
+      if (keepUnique && t == nodes[i].data)
+         return std::make_pair(iterator(this, i), false);
+      iParent = i;
+      isLeft = (t < nodes[i].data);
+      i = (isLeft ? nodes[i].left : nodes[i].right);
+   }
+
+   uint32_t iNew = _newNode(std::forward<U>(t));
+   _setParent(iNew, iParent);
+   if (iParent == NIL)
+      root = iNew;
+   else if (isLeft)
+      nodes[iParent].left = iNew;
+   else
+      nodes[iParent].right = iNew;
+
+   numElements++;
+   _insertFixup(iNew);
+   return std::make_pair(iterator(this, iNew), true);
+}
+
+/*********************************************
+ * COMPACT TREE :: INSERT FIXUP
+ * A red uncle: recolor and look again two levels up.
+ * A black one: one or two rotations and we are done
+ ********************************************/
+template <typename T>
+void CompactTree <T> :: _insertFixup(uint32_t i)
+{
+   while (_isRed(_parent(i)))
+   {
+      uint32_t iParent = _parent(i);
+      uint32_t iGranny = _parent(iParent);
+      if (iParent == nodes[iGranny].left)
+      {
+         uint32_t iAunt = nodes[iGranny].right;
+         if (_isRed(iAunt))
+         {
+            _setRed(iParent, false);
+            _setRed(iAunt,   false);
+            _setRed(iGranny, true);
+            i = iGranny;
+            continue;
+         }
+         if (i == nodes[iParent].right)
+         {
+            i = iParent;
+            _rotateLeft(i);
+            iParent = _parent(i);
+         }
+         _setRed(iParent, false);
+         _setRed(iGranny, true);
+         _rotateRight(iGranny);
+      }
+      else
+      {
+         uint32_t iAunt = nodes[iGranny].left;
+         if (_isRed(iAunt))
+         {
+            _setRed(iParent, false);
+            _setRed(iAunt,   false);
+            _setRed(iGranny, true);
+            i = iGranny;
+            continue;
+         }
+         if (i == nodes[iParent].left)
+         {
+            i = iParent;
+            _rotateRight(i);
+            iParent = _parent(i);
+         }
+         _setRed(iParent, false);
+         _setRed(iGranny, true);
+         _rotateLeft(iGranny);
+      }
+   }
+   _setRed(root, false);
+}
+
+/*********************************************
+ * COMPACT TREE :: ERASE
+ * With two children, the in-order successor moves
+ * into the node's place, taking its color. Nodes move,
+ * not elements, so every other iterator stays good.
+ * Losing a black node leaves the place it came from
+ * short one black, which the fixup puts right
+ ********************************************/
+template <typename T>
+typename CompactTree <T> :: iterator CompactTree <T> :: erase(iterator & it)
+{
+   uint32_t iDelete = it.index;
+   if (iDelete == NIL)
+      return end();
+   iterator itNext(this, _next(iDelete));
+
+   uint32_t iChild;     // what moves up into the place that lost a node
+   uint32_t iParent;    // where that place hangs
+   bool isBlackGone;    // whether that place lost a black node
+   if (nodes[iDelete].left == NIL || nodes[iDelete].right == NIL)
+   {
+      iChild  = (nodes[iDelete].left != NIL ? nodes[iDelete].left : nodes[iDelete].right);
+      iParent = _parent(iDelete);
+      isBlackGone = !_isRed(iDelete);
+      _replaceChild(iParent, iDelete, iChild);
+      if (iChild != NIL)
+         _setParent(iChild, iParent);
+   }
+   else
+   {
+      uint32_t iIOS = _first(nodes[iDelete].right);
+      iChild = nodes[iIOS].right;
+      isBlackGone = !_isRed(iIOS);
+      if (_parent(iIOS) == iDelete)
+         iParent = iIOS;
+      else
+      {
+         iParent = _parent(iIOS);
+         _replaceChild(iParent, iIOS, iChild);
+         if (iChild != NIL)
+            _setParent(iChild, iParent);
+         nodes[iIOS].right = nodes[iDelete].right;
+         _setParent(nodes[iIOS].right, iIOS);
+      }
+      _replaceChild(_parent(iDelete), iDelete, iIOS);
+      nodes[iIOS].parentAndColor = nodes[iDelete].parentAndColor;
+      nodes[iIOS].left = nodes[iDelete].left;
+      _setParent(nodes[iIOS].left, iIOS);
+   }
+
+   if (isBlackGone)
+      _eraseFixup(iChild, iParent);
+   _freeNode(iDelete);
+   numElements--;
+   return itNext;
+}
+
+/*********************************************
+ * COMPACT TREE :: ERASE FIXUP
+ * i, which may be NIL, is short one black. A red
+ * sibling is rotated up to make the sibling black; then
+ * either the sibling turns red and the shortage moves
+ * up, or a rotation or two pays it off
+ ********************************************/
+template <typename T>
+void CompactTree <T> :: _eraseFixup(uint32_t i, uint32_t iParent)
+{
+   while (i != root && !_isRed(i))
+   {
+      if (i == nodes[iParent].left)
+      {
+         uint32_t iSibling = nodes[iParent].right;
+         if (_isRed(iSibling))
+         {
+            _setRed(iSibling, false);
+            _setRed(iParent, true);
+            _rotateLeft(iParent);
+            iSibling = nodes[iParent].right;
+         }
+         if (!_isRed(nodes[iSibling].left) && !_isRed(nodes[iSibling].right))
+         {
+            _setRed(iSibling, true);
+            i = iParent;
+            iParent = _parent(i);
+            continue;
+         }
+         if (!_isRed(nodes[iSibling].right))
+         {
+            _setRed(nodes[iSibling].left, false);
+            _setRed(iSibling, true);
+            _rotateRight(iSibling);
+            iSibling = nodes[iParent].right;
+         }
+         _setRed(iSibling, _isRed(iParent));
+         _setRed(iParent, false);
+         _setRed(nodes[iSibling].right, false);
+         _rotateLeft(iParent);
+      }
+      else
+      {
+         uint32_t iSibling = nodes[iParent].left;
+         if (_isRed(iSibling))
+         {
+            _setRed(iSibling, false);
+            _setRed(iParent, true);
+            _rotateRight(iParent);
+            iSibling = nodes[iParent].left;
+         }
+         if (!_isRed(nodes[iSibling].left) && !_isRed(nodes[iSibling].right))
+         {
+            _setRed(iSibling, true);
+            i = iParent;
+            iParent = _parent(i);
+            continue;
+         }
+         if (!_isRed(nodes[iSibling].left))
+         {
+            _setRed(nodes[iSibling].right, false);
+            _setRed(iSibling, true);
+            _rotateLeft(iSibling);
+            iSibling = nodes[iParent].left;
+         }
+         _setRed(iSibling, _isRed(iParent));
+         _setRed(iParent, false);
+         _setRed(nodes[iSibling].left, false);
+         _rotateRight(iParent);
+      }
+      i = root;
+   }
+   if (i != NIL)
+      _setRed(i, false);
+}
+
+} // namespace custom
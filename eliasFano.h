@@ -0,0 +1,387 @@
+/***********************************************************************
+ * Header:
+ *    ELIAS FANO
+ * Summary:
+ *    An immutable set of unsigned integers in Elias-Fano form, for
+ *    ID sets that are archived and only ever searched. Each element
+ *    is cut into a low part of L bits, stored as it is, and a high
+ *    part, stored in unary as the gaps between one bits of a second
+ *    bit vector. With L near log2(U/n) that comes to about
+ *    2 + log2(U/n) bits an element, where a set takes a node of 40
+ *    bytes or so. Finding, rank and iteration all work on the
+ *    compressed form; nothing is ever decoded in bulk
+ *
+ *    This will contain the class definition of:
+ *        elias_fano_set            : A class that represents a compressed frozen Set
+ *        elias_fano_set::iterator  : An iterator through elias_fano_set
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint64_t
+#include <type_traits> // for std::is_unsigned
+#include <utility>     // for std::swap
+#include <vector>      // for std::vector
+#include "set.h"       // for custom::set, which we are built from
+#include "bitOps.h"    // for lowestBit, highestBit and popCount
+
+class TestEliasFano;   // forward declaration for unit tests
+
+namespace custom
+{
+
+/************************************************
+ * ELIAS FANO SET
+ * Element i is (high << L) | low, where low is bits
+ * i*L ... i*L + L - 1 of lows, and high is how many zeros
+ * come before the i-th one bit of highs. Every SAMPLE-th
+ * one and zero has its position written down, so finding
+ * the i-th of either is a jump and a short scan: O(1)
+ * whatever the size. There is no insert or erase: build
+ * a new one instead
+ ***********************************************/
+template <typename T = uint64_t>
+class elias_fano_set
+{
+   static_assert(std::is_integral<T>::value && std::is_unsigned<T>::value,
+                 "elias_fano_set elements are unsigned integers");
+
+   friend class ::TestEliasFano; // give unit tests access to the privates
+public:
+   //
+   // Construct. From a set, or any sorted range without
+   // repeats that can be walked twice
+   //
+
+   elias_fano_set() : numElements(0), numLowBits(0), largest(0) { }
+   template <typename Balance, typename Alloc>
+   elias_fano_set(const set<T, Balance, Alloc> & s) : elias_fano_set(s.begin(), s.end()) { }
+   template <class Iterator>
+   elias_fano_set(Iterator first, Iterator last);
+
+   //
+   // Assign
+   //
+
+   void swap(elias_fano_set & rhs) noexcept
+   {
+      std::swap(numElements, rhs.numElements);
+      std::swap(numLowBits,  rhs.numLowBits);
+      std::swap(largest,     rhs.largest);
+      lows.swap(rhs.lows);
+      highs.swap(rhs.highs);
+      onesAt.swap(rhs.onesAt);
+      zerosAt.swap(rhs.zerosAt);
+   }
+
+   //
+   // Iterator. In order, as with any set
+   //
+
+   class iterator;
+   iterator begin() const noexcept;
+   iterator end()   const noexcept { return iterator(this); }
+
+   //
+   // Access. Lower bound is the first element not less than t.
+   // Rank is how many elements are less than t, and at(i) is
+   // the element with rank i
+   //
+
+   iterator find(const T & t) const
+   {
+      iterator it = lower_bound(t);
+      return (it != end() && *it == t) ? it : end();
+   }
+   iterator lower_bound(const T & t) const;
+   size_t rank(const T & t) const;
+   T at(size_t i) const
+   {
+      assert(i < numElements);
+      return _value(i, _selectOne(i));
+   }
+
+   //
+   // Status
+   //
+
+   bool   empty() const noexcept { return (numElements == 0); }
+   size_t size()  const noexcept { return numElements;        }
+   size_t bytes() const noexcept
+   {
+      return (lows.size() + highs.size()) * sizeof(uint64_t) +
+             (onesAt.size() + zerosAt.size()) * sizeof(size_t);
+   }
+
+private:
+
+   static const size_t SAMPLE = 256;   // how many ones or zeros between samples
+
+   bool _bit(size_t pos) const       { return (highs[pos >> 6] >> (pos & 63)) & 1; }
+   uint64_t _lowMask() const         { return numLowBits ? (~(uint64_t)0 >> (64 - numLowBits)) : 0; }
+   uint64_t _low(size_t i) const;
+   T _value(size_t i, size_t pos) const
+   {
+      return (T)(((uint64_t)(pos - i) << numLowBits) | _low(i));
+   }
+   size_t _selectOne (size_t i) const;
+   size_t _selectZero(size_t i) const;
+   size_t _nextOne(size_t pos) const;
+   size_t _prevOne(size_t pos) const;
+   size_t _lowerBound(const T & t, size_t & pos) const;
+
+   size_t numElements;            // how many ones there are in highs
+   unsigned int numLowBits;       // L, the bits of each element stored as they are
+   T largest;                     // the last element, when there is one
+   std::vector<uint64_t> lows;    // the low L bits of each element, packed end to end
+   std::vector<uint64_t> highs;   // the high parts, each a one after that many zeros
+   std::vector<size_t> onesAt;    // where one number k * SAMPLE is in highs
+   std::vector<size_t> zerosAt;   // where zero number k * SAMPLE is in highs
+};
+
+/**************************************************
+ * ELIAS FANO SET ITERATOR
+ * The rank of an element and where its one bit is.
+ * Moving on is a scan to the next one bit, and the
+ * element is worked out from the two
+ *************************************************/
+template <typename T>
+class elias_fano_set <T> :: iterator
+{
+   friend class ::TestEliasFano; // give unit tests access to the privates
+   friend class elias_fano_set <T>;
+public:
+   // constructors and assignment
+   iterator() : pSet(nullptr), i(0), pos(0), value() { }
+   iterator(const elias_fano_set * pSet) : pSet(pSet), i(pSet->numElements), pos(0), value() { }
+   iterator(const elias_fano_set * pSet, size_t i, size_t pos) :
+      pSet(pSet), i(i), pos(pos), value(pSet->_value(i, pos)) { }
+
+   // compare
+   bool operator == (const iterator & rhs) const { return i == rhs.i;                            }
+   bool operator != (const iterator & rhs) const { return i != rhs.i;                            }
+
+   // de-reference. Cannot change because the set is frozen
+   const T & operator * () const                 { return value;                                 }
+
+   // increment and decrement
+   iterator & operator ++ ()
+   {
+      if (i == pSet->numElements)
+         return *this;
+      if (i + 1 == pSet->numElements)
+         return *this = pSet->end();
+      return *this = iterator(pSet, i + 1, pSet->_nextOne(pos + 1));
+   }
+   iterator   operator ++ (int postfix)          { iterator itOld(*this); ++*this; return itOld; }
+   iterator & operator -- ()
+   {
+      if (i == pSet->numElements)
+         return *this;
+      if (i == 0)
+         return *this = pSet->end();
+      return *this = iterator(pSet, i - 1, pSet->_prevOne(pos - 1));
+   }
+   iterator   operator -- (int postfix)          { iterator itOld(*this); --*this; return itOld; }
+
+   // the rank of this element
+   size_t index() const                          { return i;                                     }
+
+private:
+
+   const elias_fano_set * pSet;  // the set we walk through
+   size_t i;                     // rank of the element, size() for end()
+   size_t pos;                   // where its one bit is in highs
+   T value;                      // the element
+};
+
+/*********************************************
+ * ELIAS FANO SET :: CONSTRUCTOR
+ * One pass for the count and the largest, which fixes L,
+ * and another to fill in the bits. Then the samples
+ ********************************************/
+template <typename T>
+template <class Iterator>
+elias_fano_set <T> :: elias_fano_set(Iterator first, Iterator last) : elias_fano_set()
+{
+   for (Iterator it = first; it != last; ++it)
+   {
+      assert(numElements == 0 || largest < *it);
+      largest = *it;
+      numElements++;
+   }
+   if (numElements == 0)
+      return;
+
+   // L is about log2(U / n), so the high parts average a couple of bits
+   uint64_t perElement = (uint64_t)largest / numElements;
+   numLowBits = (perElement ? highestBit(perElement) : 0);
+   size_t numHighBits = numElements + (size_t)((uint64_t)largest >> numLowBits) + 1;
+   lows.assign((numElements * numLowBits + 63) / 64 + 1, 0);
+   highs.assign((numHighBits + 63) / 64, 0);
+
+   size_t i = 0;
+   for (Iterator it = first; it != last; ++it, i++)
+   {
+      uint64_t x = (uint64_t)*it;
+      if (numLowBits)
+      {
+         uint64_t low = x & _lowMask();
+         size_t bit = i * numLowBits;
+         lows[bit >> 6] |= low << (bit & 63);
+         if ((bit & 63) + numLowBits > 64)
+            lows[(bit >> 6) + 1] |= low >> (64 - (bit & 63));
+      }
+      size_t pos = (size_t)(x >> numLowBits) + i;
+      highs[pos >> 6] |= (uint64_t)1 << (pos & 63);
+   }
+
+   // every SAMPLE-th one and zero, so a select starts close by
+   size_t numOnes = 0;
+   size_t numZeros = 0;
+   for (size_t pos = 0; pos < numHighBits; pos++)
+      if (_bit(pos))
+      {
+         if (numOnes++ % SAMPLE == 0)
+            onesAt.push_back(pos);
+      }
+      else
+      {
+         if (numZeros++ % SAMPLE == 0)
+            zerosAt.push_back(pos);
+      }
+}
+
+/*********************************************
+ * ELIAS FANO SET :: LOW
+ * The low L bits of element i, which may straddle a word
+ ********************************************/
+template <typename T>
+uint64_t elias_fano_set <T> :: _low(size_t i) const
+{
+   if (numLowBits == 0)
+      return 0;
+   size_t bit = i * numLowBits;
+   uint64_t low = lows[bit >> 6] >> (bit & 63);
+   if ((bit & 63) + numLowBits > 64)
+      low |= lows[(bit >> 6) + 1] << (64 - (bit & 63));
+   return low & _lowMask();
+}
+
+/*********************************************
+ * ELIAS FANO SET :: SELECT ONE and SELECT ZERO
+ * Where the i-th one, or zero, is. Jump to the sample
+ * before it, skip whole words by counting their bits,
+ * then step through the last word
+ ********************************************/
+template <typename T>
+size_t elias_fano_set <T> :: _selectOne(size_t i) const
+{
+   size_t pos = onesAt[i / SAMPLE];
+   size_t left = i % SAMPLE;
+   size_t w = pos >> 6;
+   uint64_t word = highs[w] & (~(uint64_t)0 << (pos & 63));
+   for (size_t num = popCount(word); left >= num; num = popCount(word))
+   {
+      left -= num;
+      word = highs[++w];
+   }
+   for (; left; left--)
+      word &= word - 1;
+   return (w << 6) + lowestBit(word);
+}
+
+template <typename T>
+size_t elias_fano_set <T> :: _selectZero(size_t i) const
+{
+   size_t pos = zerosAt[i / SAMPLE];
+   size_t left = i % SAMPLE;
+   size_t w = pos >> 6;
+   uint64_t word = ~highs[w] & (~(uint64_t)0 << (pos & 63));
+   for (size_t num = popCount(word); left >= num; num = popCount(word))
+   {
+      left -= num;
+      word = ~highs[++w];
+   }
+   for (; left; left--)
+      word &= word - 1;
+   return (w << 6) + lowestBit(word);
+}
+
+/*********************************************
+ * ELIAS FANO SET :: NEXT ONE and PREV ONE
+ * The first one bit at pos or after, and the last one at
+ * pos or before. There always is one: the caller knows
+ ********************************************/
+template <typename T>
+size_t elias_fano_set <T> :: _nextOne(size_t pos) const
+{
+   size_t w = pos >> 6;
+   uint64_t word = highs[w] & (~(uint64_t)0 << (pos & 63));
+   while (word == 0)
+      word = highs[++w];
+   return (w << 6) + lowestBit(word);
+}
+
+template <typename T>
+size_t elias_fano_set <T> :: _prevOne(size_t pos) const
+{
+   size_t w = pos >> 6;
+   uint64_t word = highs[w] & (~(uint64_t)0 >> (63 - (pos & 63)));
+   while (word == 0)
+      word = highs[--w];
+   return (w << 6) + highestBit(word);
+}
+
+/*********************************************
+ * ELIAS FANO SET :: LOWER BOUND
+ * The rank of the first element not less than t, and
+ * where its one bit is. The elements with t's high part
+ * start just after zero number high - 1; walk along them
+ * comparing low parts. Running into a zero means the next
+ * element has a bigger high part, so it is the answer
+ ********************************************/
+template <typename T>
+size_t elias_fano_set <T> :: _lowerBound(const T & t, size_t & pos) const
+{
+   if (numElements == 0 || largest < t)
+      return numElements;
+   uint64_t high = (uint64_t)t >> numLowBits;
+   uint64_t low  = (uint64_t)t & _lowMask();
+   pos = (high == 0 ? 0 : _selectZero((size_t)high - 1) + 1);
+   size_t i = pos - (size_t)high;
+   for (; _bit(pos); pos++, i++)
+      if (_low(i) >= low)
+         return i;
+   return i < numElements ? (pos = _nextOne(pos), i) : numElements;
+}
+
+template <typename T>
+typename elias_fano_set <T> :: iterator elias_fano_set <T> :: lower_bound(const T & t) const
+{
+   size_t pos = 0;
+   size_t i = _lowerBound(t, pos);
+   return i == numElements ? end() : iterator(this, i, pos);
+}
+
+template <typename T>
+size_t elias_fano_set <T> :: rank(const T & t) const
+{
+   size_t pos = 0;
+   return _lowerBound(t, pos);
+}
+
+/*********************************************
+ * ELIAS FANO SET :: BEGIN
+ ********************************************/
+template <typename T>
+typename elias_fano_set <T> :: iterator elias_fano_set <T> :: begin() const noexcept
+{
+   return numElements ? iterator(this, 0, onesAt[0]) : end();
+}
+
+} // namespace custom
@@ -0,0 +1,223 @@
+/***********************************************************************
+ * Header:
+ *    FLAT SET
+ * Summary:
+ *    A set kept as one sorted array. Finding is a binary search over
+ *    contiguous memory and the iterators are plain pointers, which
+ *    suits sets that are built once and then queried many times.
+ *    Inserting one element shifts everything after it, so build it
+ *    with the batched insert(first, last) instead
+ *
+ *    This will contain the class definition of:
+ *        flat_set            : A class that represents a sorted-array Set
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#include <algorithm>  // for std::lower_bound and std::sort
+#include <vector>     // for std::vector
+#include <utility>    // for std::pair and std::move
+#include <initializer_list>
+
+class TestFlatSet;    // forward declaration for unit tests
+
+namespace custom
+{
+
+/************************************************
+ * FLAT SET
+ * The same interface as set, with the elements in a
+ * sorted std::vector. Any insert or erase may move the
+ * elements, so it invalidates every iterator
+ ***********************************************/
+template <typename T>
+class flat_set
+{
+   friend class ::TestFlatSet; // give unit tests access to the privates
+public:
+
+   //
+   // Construct
+   //
+   flat_set() = default;
+   flat_set(const flat_set & rhs) : elements(rhs.elements)           {}
+   flat_set(flat_set && rhs) : elements(std::move(rhs.elements))     {}
+   flat_set(const std::initializer_list<T> & il)
+   {
+      insert(il.begin(), il.end());
+   }
+   template <class Iterator>
+   flat_set(Iterator first, Iterator last)
+   {
+      insert(first, last);
+   }
+   ~flat_set() { }
+
+   //
+   // Assign
+   //
+   flat_set & operator=(const flat_set & rhs)
+   {
+      elements = rhs.elements;
+      return *this;
+   }
+   flat_set & operator=(flat_set && rhs)
+   {
+      elements.clear();
+      elements.swap(rhs.elements);
+      return *this;
+   }
+   flat_set & operator=(const std::initializer_list<T> & il)
+   {
+      elements.clear();
+      insert(il.begin(), il.end());
+      return *this;
+   }
+   void swap(flat_set & rhs) noexcept
+   {
+      elements.swap(rhs.elements);
+   }
+
+   //
+   // Iterator
+   //
+   typedef const T * iterator;
+
+   iterator begin() const noexcept { return elements.data();                   }
+   iterator end()   const noexcept { return elements.data() + elements.size(); }
+
+   //
+   // Access
+   //
+   iterator find(const T & t) const
+   {
+      iterator it = std::lower_bound(begin(), end(), t);
+      return (it != end() && *it == t) ? it : end();
+   }
+
+   //
+   // Status
+   //
+   bool empty() const noexcept   { return elements.empty(); }
+   size_t size() const noexcept  { return elements.size();  }
+
+   //
+   // Insert
+   //
+   std::pair<iterator, bool> insert(const T & t)  { return _insert(t);            }
+   std::pair<iterator, bool> insert(T && t)       { return _insert(std::move(t)); }
+   void insert(const std::initializer_list<T> & il)
+   {
+      insert(il.begin(), il.end());
+   }
+   template <class Iterator>
+   void insert(Iterator first, Iterator last);
+
+   //
+   // Remove
+   //
+   void clear() noexcept
+   {
+      elements.clear();
+   }
+   iterator erase(iterator it)
+   {
+      return erase(it, it + 1);
+   }
+   size_t erase(const T & t)
+   {
+      iterator it = find(t);
+      if (it == end())
+         return 0;
+      erase(it);
+      return 1;
+   }
+   iterator erase(iterator itBegin, iterator itEnd)
+   {
+      size_t iBegin = itBegin - begin();
+      elements.erase(elements.begin() + iBegin, elements.begin() + (itEnd - begin()));
+      return begin() + iBegin;
+   }
+
+private:
+
+   std::vector<T> elements;   // sorted, no duplicates
+
+   template <class U>
+   std::pair<iterator, bool> _insert(U && t)
+   {
+      iterator it = std::lower_bound(begin(), end(), t);
+      if (it != end() && *it == t)
+         return std::make_pair(it, false);
+      size_t i = it - begin();
+      elements.insert(elements.begin() + i, std::forward<U>(t));
+      return std::make_pair(begin() + i, true);
+   }
+};
+
+/***********************************************
+ * FLAT SET : INSERT RANGE
+ * Sort the newcomers on their own, then merge them with
+ * what we have in one pass, dropping duplicates as we go.
+ * That is O(n + k log k) rather than k shifts of O(n) each
+ ***********************************************/
+template <typename T>
+template <class Iterator>
+void flat_set<T>::insert(Iterator first, Iterator last)
+{
+   std::vector<T> incoming(first, last);
+   if (incoming.empty())
+      return;
+   std::sort(incoming.begin(), incoming.end());
+
+   std::vector<T> merged;
+   merged.reserve(elements.size() + incoming.size());
+   auto itOld = elements.begin();
+   auto itNew = incoming.begin();
+   while (itOld != elements.end() || itNew != incoming.end())
+   {
+      // take the smaller of the two heads, the old one on a tie
+      bool takeOld = (itNew == incoming.end() ||
+                      (itOld != elements.end() && !(*itNew < *itOld)));
+      T & t = (takeOld ? *itOld++ : *itNew++);
+      if (merged.empty() || !(merged.back() == t))
+         merged.push_back(std::move(t));
+   }
+   elements.swap(merged);
+}
+
+/***********************************************
+ * FLAT SET : EQUIVALENCE
+ * See if two sets hold the same elements
+ ***********************************************/
+template <typename T>
+bool operator==(const flat_set<T> & lhs, const flat_set<T> & rhs)
+{
+   return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <typename T>
+inline bool operator!=(const flat_set<T> & lhs, const flat_set<T> & rhs)
+{
+   return !(lhs == rhs);
+}
+
+/***********************************************
+ * FLAT SET : RELATIVE COMPARISON
+ * See if one set is lexicographically before the second
+ ***********************************************/
+template <typename T>
+bool operator<(const flat_set<T> & lhs, const flat_set<T> & rhs)
+{
+   return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename T>
+inline bool operator>(const flat_set<T> & lhs, const flat_set<T> & rhs)
+{
+   return rhs < lhs;
+}
+
+} // namespace custom
@@ -0,0 +1,290 @@
+/***********************************************************************
+ * Header:
+ *    FROZEN SET
+ * Summary:
+ *    An immutable snapshot of a set, laid out for searching. The
+ *    elements sit in one cache-aligned array in the order a breadth
+ *    first walk of a perfectly balanced tree would visit them (the
+ *    Eytzinger layout), so the two children of element k are at 2k
+ *    and 2k+1. A search is then one comparison and no branch per
+ *    level, and the next few levels can be fetched before they are
+ *    needed because their addresses do not depend on the comparisons
+ *
+ *    This will contain the class definition of:
+ *        frozen_set            : A class that represents a frozen Set
+ *        frozen_set::iterator  : An iterator through frozen_set
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#include <algorithm>  // for std::sort, std::unique and std::is_sorted
+#include <cstddef>    // for size_t
+#include <cstdint>    // for uint64_t and uintptr_t
+#include <new>        // for placement new
+#include <utility>    // for std::swap
+#include <vector>     // for std::vector
+#include <initializer_list>
+#include "bitOps.h"   // for lowestBit
+
+#ifdef _MSC_VER
+#include <xmmintrin.h> // for _mm_prefetch
+#endif
+
+class TestFrozenSet;  // forward declaration for unit tests
+
+namespace custom
+{
+
+/************************************************
+ * FROZEN SET
+ * Elements 1 through numElements of the array, in
+ * Eytzinger order. Slot 0 is never used, which puts the
+ * 64 / sizeof(T) descendants four levels down from any
+ * element on one cache line. There is no insert or erase:
+ * build a new one instead, usually with set::freeze()
+ ***********************************************/
+template <typename T>
+class frozen_set
+{
+   friend class ::TestFrozenSet; // give unit tests access to the privates
+public:
+   //
+   // Construct. The elements need not be sorted or unique
+   //
+
+   frozen_set() : numElements(0), pBuffer(nullptr), elements(nullptr) { }
+   template <class Iterator>
+   frozen_set(Iterator first, Iterator last) : frozen_set()
+   {
+      std::vector<T> sorted(first, last);
+      if (!std::is_sorted(sorted.begin(), sorted.end()))
+         std::sort(sorted.begin(), sorted.end());
+      sorted.erase(std::unique(sorted.begin(), sorted.end(),
+                               [](const T & lhs, const T & rhs) { return !(lhs < rhs); }),
+                   sorted.end());
+      _allocate(sorted.size());
+      size_t i = 0;
+      _build(sorted, i, 1);
+   }
+   frozen_set(const std::initializer_list<T> & il) : frozen_set(il.begin(), il.end()) { }
+   frozen_set(const frozen_set & rhs) : frozen_set()
+   {
+      _allocate(rhs.numElements);
+      for (size_t k = 1; k <= numElements; k++)
+         new (elements + k) T(rhs.elements[k]);
+   }
+   frozen_set(frozen_set && rhs) : frozen_set() { swap(rhs); }
+   ~frozen_set() { _release(); }
+
+   //
+   // Assign
+   //
+
+   frozen_set & operator = (const frozen_set & rhs)
+   {
+      frozen_set copy(rhs);
+      swap(copy);
+      return *this;
+   }
+   frozen_set & operator = (frozen_set && rhs)
+   {
+      _release();
+      swap(rhs);
+      return *this;
+   }
+   void swap(frozen_set & rhs) noexcept
+   {
+      std::swap(numElements, rhs.numElements);
+      std::swap(pBuffer,     rhs.pBuffer);
+      std::swap(elements,    rhs.elements);
+   }
+
+   //
+   // Iterator. In order, as with any set
+   //
+
+   class iterator;
+   iterator begin() const noexcept { return iterator(this, leftmost(1)); }
+   iterator end()   const noexcept { return iterator(this, 0);           }
+
+   //
+   // Access. Lower bound is the first element not less than t
+   //
+
+   iterator find(const T & t) const
+   {
+      size_t k = search(t);
+      return iterator(this, (k && !(t < elements[k])) ? k : 0);
+   }
+   iterator lower_bound(const T & t) const
+   {
+      return iterator(this, search(t));
+   }
+
+   //
+   // Status
+   //
+
+   bool   empty() const noexcept { return (numElements == 0); }
+   size_t size()  const noexcept { return numElements;        }
+
+private:
+
+   // how many elements share a cache line, so how far ahead to fetch
+   static const size_t PER_LINE = (sizeof(T) < 64 ? 64 / sizeof(T) : 1);
+
+   size_t search(const T & t) const;
+   size_t leftmost(size_t k) const
+   {
+      if (k > numElements)
+         return 0;
+      while (2 * k <= numElements)
+         k = 2 * k;
+      return k;
+   }
+   size_t rightmost(size_t k) const
+   {
+      if (k > numElements)
+         return 0;
+      while (2 * k + 1 <= numElements)
+         k = 2 * k + 1;
+      return k;
+   }
+
+   void _build(const std::vector<T> & sorted, size_t & i, size_t k);
+   void _allocate(size_t num);
+   void _release();
+
+   size_t numElements;        // elements 1 ... numElements are in use
+   void * pBuffer;            // what was allocated, before alignment
+   T * elements;              // the Eytzinger array, on a 64-byte line
+};
+
+/**************************************************
+ * FROZEN SET ITERATOR
+ * A position in the array. The next element in order
+ * is the leftmost one in the right subtree or, lacking
+ * that, the first ancestor we are left of
+ *************************************************/
+template <typename T>
+class frozen_set <T> :: iterator
+{
+   friend class ::TestFrozenSet; // give unit tests access to the privates
+   friend class frozen_set <T>;
+public:
+   // constructors and assignment
+   iterator() : pSet(nullptr), k(0) { }
+   iterator(const frozen_set * pSet, size_t k) : pSet(pSet), k(k) { }
+
+   // compare
+   bool operator == (const iterator & rhs) const { return k == rhs.k;                            }
+   bool operator != (const iterator & rhs) const { return k != rhs.k;                            }
+
+   // de-reference. Cannot change because the set is frozen
+   const T & operator * () const                 { return pSet->elements[k];                     }
+
+   // increment and decrement
+   iterator & operator ++ ()
+   {
+      if (k == 0)
+         return *this;
+      if (2 * k + 1 <= pSet->numElements)
+         k = pSet->leftmost(2 * k + 1);
+      else
+         k >>= lowestBit(~(uint64_t)k) + 1;
+      return *this;
+   }
+   iterator   operator ++ (int postfix)          { iterator itOld(*this); ++*this; return itOld; }
+   iterator & operator -- ()
+   {
+      if (k == 0)
+         return *this;
+      if (2 * k <= pSet->numElements)
+         k = pSet->rightmost(2 * k);
+      else
+         k >>= lowestBit((uint64_t)k) + 1;
+      return *this;
+   }
+   iterator   operator -- (int postfix)          { iterator itOld(*this); --*this; return itOld; }
+
+private:
+
+   const frozen_set * pSet;   // the set we walk through
+   size_t k;                  // index in the Eytzinger array, 0 for end()
+};
+
+/*********************************************
+ * FROZEN SET :: SEARCH
+ * Go left or right at each level without a branch: the
+ * comparison only picks the next index. Walking off the
+ * bottom leaves the path in the bits of k, and the answer
+ * is where we last went left, so shift off the trailing
+ * right turns and the left turn before them. 0 means
+ * every element is less than t
+ ********************************************/
+template <typename T>
+size_t frozen_set <T> :: search(const T & t) const
+{
+   size_t k = 1;
+   while (k <= numElements)
+   {
+      // the line with our descendants four levels down
+      const char * pAhead = (const char *)((uintptr_t)elements + k * PER_LINE * sizeof(T));
+#ifdef _MSC_VER
+      _mm_prefetch(pAhead, _MM_HINT_T0);
+#else
+      __builtin_prefetch(pAhead);
+#endif
+      k = 2 * k + (size_t)(elements[k] < t);
+   }
+   return k >> (lowestBit(~(uint64_t)k) + 1);
+}
+
+/*********************************************
+ * FROZEN SET :: BUILD
+ * An in-order walk of the implicit tree, handing out
+ * the sorted elements as it goes
+ ********************************************/
+template <typename T>
+void frozen_set <T> :: _build(const std::vector<T> & sorted, size_t & i, size_t k)
+{
+   if (k > numElements)
+      return;
+   _build(sorted, i, 2 * k);
+   new (elements + k) T(sorted[i++]);
+   _build(sorted, i, 2 * k + 1);
+}
+
+/*********************************************
+ * FROZEN SET :: ALLOCATE
+ * Room for slot 0 and num elements, with slot 0 on a
+ * 64-byte boundary. Nothing is constructed yet
+ ********************************************/
+template <typename T>
+void frozen_set <T> :: _allocate(size_t num)
+{
+   if (num == 0)
+      return;
+   pBuffer = ::operator new((num + 1) * sizeof(T) + 63);
+   elements = (T *)(((uintptr_t)pBuffer + 63) & ~(uintptr_t)63);
+   numElements = num;
+}
+
+/*********************************************
+ * FROZEN SET :: RELEASE
+ * Destroy the elements and free the array
+ ********************************************/
+template <typename T>
+void frozen_set <T> :: _release()
+{
+   for (size_t k = 1; k <= numElements; k++)
+      elements[k].~T();
+   ::operator delete(pBuffer);
+   pBuffer = nullptr;
+   elements = nullptr;
+   numElements = 0;
+}
+
+} // namespace custom
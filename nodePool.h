@@ -0,0 +1,529 @@
+/***********************************************************************
+ * Header:
+ *    NODE POOL
+ * Summary:
+ *    Fixed-size node memory for the trees, handed out from 64K slabs
+ *    rather than by malloc. Each thread has its own free list and its
+ *    own slabs to carve from, so allocating and freeing a node is a
+ *    couple of pointer moves with no lock. A node freed on another
+ *    thread goes back to the thread that made it, and a thread's slabs
+ *    are given back once it has ended and the last of their nodes is
+ *    freed. A tree can instead take its nodes from an arena of its own,
+ *    which it gives back in one piece when it is cleared
+ *
+ *    This will contain the class definition of:
+ *        NodePool            : Slabs of nodes of one size, per thread
+ *        NodeArena           : Chunks of nodes of one size, for one tree
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#include <atomic>     // for std::atomic
+#include <cassert>
+#include <cstddef>    // for size_t and std::max_align_t
+#include <cstdint>    // for uintptr_t
+#include <cstdlib>    // for posix_memalign and free
+#include <new>        // for ::operator new and std::bad_alloc
+
+#ifdef _WIN32
+#include <malloc.h>   // for _aligned_malloc and _aligned_free
+#endif
+
+// Under AddressSanitizer, a node that is free, or not yet handed out, is
+// off limits, so reusing the memory does not hide a use after free
+#if defined(__SANITIZE_ADDRESS__)
+#define NODE_POOL_ASAN
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define NODE_POOL_ASAN
+#endif
+#endif
+
+#ifdef NODE_POOL_ASAN
+#include <sanitizer/asan_interface.h>
+#define NODE_POOL_POISON(p, size)   ASAN_POISON_MEMORY_REGION(p, size)
+#define NODE_POOL_UNPOISON(p, size) ASAN_UNPOISON_MEMORY_REGION(p, size)
+#else
+#define NODE_POOL_POISON(p, size)
+#define NODE_POOL_UNPOISON(p, size)
+#endif
+
+class TestNodePool;   // forward declaration for unit tests
+
+namespace custom
+{
+
+/************************************************
+ * NODE POOL
+ * All nodes of one size and alignment share a pool, so
+ * BST<int> and BST<float> draw on the same slabs. A free
+ * node's first bytes link it to the next free one.
+ *
+ * Every slab belongs to the thread that carved it and
+ * starts on a multiple of SLAB_BYTES, so a node finds its
+ * slab, and through it its owner, by masking its address.
+ * A node freed by another thread is pushed onto a list of
+ * the owner's that the owner takes in one swap when its
+ * own free list runs dry. When a thread ends, its slabs
+ * stay until the last of their nodes is freed, wherever
+ * that happens, and then go back to the system
+ ***********************************************/
+template <size_t nodeSize, size_t nodeAlign>
+class NodePool
+{
+   friend class ::TestNodePool; // give unit tests access to the privates
+public:
+   static const size_t SLAB_BYTES = 64 * 1024;
+
+   static void * allocate();
+   static void deallocate(void * p) noexcept;
+
+   // how many slabs every thread together holds
+   static size_t slabs() { return _numSlabs().load(); }
+
+private:
+   static_assert(nodeAlign <= SLAB_BYTES, "slabs are only aligned to their own size");
+
+   // what a free node holds
+   struct Slot
+   {
+      Slot * pNext;
+   };
+
+   struct Local;
+
+   // what each slab starts with
+   struct Slab
+   {
+      Local * pOwner;  // the thread that carved it
+      Slab  * pNext;   // the slab that thread carved before this one
+   };
+
+   // a node's room, rounded up so the next one is aligned too
+   static const size_t SLOT_BYTES = ((nodeSize > sizeof(Slot) ? nodeSize : sizeof(Slot))
+                                     + nodeAlign - 1) / nodeAlign * nodeAlign;
+   // the Slab, and padding to where the nodes start
+   static const size_t HEADER_BYTES = (sizeof(Slab) + nodeAlign - 1) / nodeAlign * nodeAlign;
+   // at least one, even for a node too big for SLAB_BYTES
+   static const size_t NODES_PER_SLAB = (SLAB_BYTES - HEADER_BYTES) / SLOT_BYTES
+                                        ? (SLAB_BYTES - HEADER_BYTES) / SLOT_BYTES : 1;
+
+   // one thread's nodes. Only that thread touches anything but pRemote
+   // and, after the thread has ended, numOrphans
+   struct Local
+   {
+      Local() : pFree(nullptr), pNext(nullptr), pEnd(nullptr), pSlabs(nullptr),
+                numLive(0), pRemote(nullptr), numOrphans(0) { }
+      Slot * pFree;    // nodes freed on this thread, ready to reuse
+      char * pNext;    // the next node never handed out in the current slab
+      char * pEnd;     // the end of the current slab
+      Slab * pSlabs;   // the newest slab this thread carved
+      size_t numLive;  // nodes handed out and not yet back
+      std::atomic<Slot *> pRemote;    // nodes freed by other threads, or _orphan()
+      std::atomic<size_t> numOrphans; // nodes still out once the thread has ended
+   };
+
+   // lets go of this thread's Local when the thread ends
+   struct Retire
+   {
+      Retire() : pLocal(nullptr) { }
+      ~Retire()
+      {
+         _isEnded() = true;
+         _current() = nullptr;
+         if (pLocal)
+            _retire(pLocal);
+      }
+      Local * pLocal;
+   };
+
+   // Plain data, so reading them costs no check that they were made
+   static Local * & _current()
+   {
+      static thread_local Local * pLocal = nullptr;
+      return pLocal;
+   }
+   static bool & _isEnded()
+   {
+      static thread_local bool isEnded = false;
+      return isEnded;
+   }
+   static std::atomic<size_t> & _numSlabs()
+   {
+      static std::atomic<size_t> numSlabs(0);
+      return numSlabs;
+   }
+   // marks the remote list of a thread that has ended
+   static Slot * _orphan()
+   {
+      static Slot orphan;
+      return &orphan;
+   }
+
+   static Local & _local()
+   {
+      Local * pLocal = _current();
+      return pLocal ? *pLocal : _adopt();
+   }
+   static Local & _adopt();
+   static void _grow(Local & local);
+   static Slot * _drain(Local & local);
+   static void _freeRemote(Local * pOwner, Slot * pSlot) noexcept;
+   static void _retire(Local * pLocal) noexcept;
+   static void _destroy(Local * pLocal) noexcept;
+};
+
+/*********************************************
+ * NODE POOL :: ALLOCATE
+ * The last node freed on this thread, which is likely
+ * still in cache. Failing that, those other threads gave
+ * back, and failing that the next one in the slab
+ ********************************************/
+template <size_t nodeSize, size_t nodeAlign>
+void * NodePool <nodeSize, nodeAlign> :: allocate()
+{
+   Local & local = _local();
+   if (local.pFree == nullptr && local.pRemote.load(std::memory_order_relaxed))
+      local.pFree = _drain(local);
+   local.numLive++;
+   if (local.pFree)
+   {
+      Slot * pSlot = local.pFree;
+      NODE_POOL_UNPOISON(pSlot, SLOT_BYTES);
+      local.pFree = pSlot->pNext;
+      return pSlot;
+   }
+   if (local.pNext == local.pEnd)
+      _grow(local);
+   void * p = local.pNext;
+   local.pNext += SLOT_BYTES;
+   NODE_POOL_UNPOISON(p, SLOT_BYTES);
+   return p;
+}
+
+/*********************************************
+ * NODE POOL :: DEALLOCATE
+ * Onto the front of this thread's free list if the node
+ * is ours, otherwise back to the thread that made it
+ ********************************************/
+template <size_t nodeSize, size_t nodeAlign>
+void NodePool <nodeSize, nodeAlign> :: deallocate(void * p) noexcept
+{
+   if (p == nullptr)
+      return;
+   Slot * pSlot = (Slot *)p;
+   Local * pOwner = ((Slab *)((uintptr_t)p & ~(uintptr_t)(SLAB_BYTES - 1)))->pOwner;
+   if (pOwner != _current())
+   {
+      _freeRemote(pOwner, pSlot);
+      return;
+   }
+   pSlot->pNext = pOwner->pFree;
+   pOwner->pFree = pSlot;
+   pOwner->numLive--;
+   NODE_POOL_POISON(pSlot, SLOT_BYTES);
+}
+
+/*********************************************
+ * NODE POOL :: ADOPT
+ * The first node on this thread makes its Local. One made
+ * while the thread is being torn down, after its Local
+ * was let go, is never given back
+ ********************************************/
+template <size_t nodeSize, size_t nodeAlign>
+typename NodePool <nodeSize, nodeAlign> :: Local & NodePool <nodeSize, nodeAlign> :: _adopt()
+{
+   Local * pLocal = new Local;
+   _current() = pLocal;
+   if (!_isEnded())
+   {
+      static thread_local Retire retire;
+      retire.pLocal = pLocal;
+   }
+   return *pLocal;
+}
+
+/*********************************************
+ * NODE POOL :: GROW
+ * A fresh slab for this thread to carve nodes from. What
+ * was left of the old one is too little for a node
+ ********************************************/
+template <size_t nodeSize, size_t nodeAlign>
+void NodePool <nodeSize, nodeAlign> :: _grow(Local & local)
+{
+   size_t numBytes = HEADER_BYTES + NODES_PER_SLAB * SLOT_BYTES;
+#ifdef _WIN32
+   void * p = _aligned_malloc(numBytes, SLAB_BYTES);
+#else
+   void * p = nullptr;
+   if (posix_memalign(&p, SLAB_BYTES, numBytes) != 0)
+      p = nullptr;
+#endif
+   if (p == nullptr)
+      throw std::bad_alloc();
+
+   Slab * pSlab = (Slab *)p;
+   pSlab->pOwner = &local;
+   pSlab->pNext  = local.pSlabs;
+   local.pSlabs  = pSlab;
+   _numSlabs()++;
+
+   local.pNext = (char *)p + HEADER_BYTES;
+   local.pEnd  = local.pNext + NODES_PER_SLAB * SLOT_BYTES;
+   NODE_POOL_POISON(local.pNext, NODES_PER_SLAB * SLOT_BYTES);
+}
+
+/*********************************************
+ * NODE POOL :: DRAIN
+ * Everything other threads gave back since we last
+ * looked, taken in one swap. They are no longer out
+ ********************************************/
+template <size_t nodeSize, size_t nodeAlign>
+typename NodePool <nodeSize, nodeAlign> :: Slot * NodePool <nodeSize, nodeAlign> :: _drain(Local & local)
+{
+   Slot * pList = local.pRemote.exchange(nullptr, std::memory_order_acquire);
+   for (Slot * pSlot = pList; pSlot; pSlot = pSlot->pNext)
+      local.numLive--;
+   return pList;
+}
+
+/*********************************************
+ * NODE POOL :: FREE REMOTE
+ * Pushed onto the owner's remote list. Only the link is
+ * left unpoisoned, since it may be written again before
+ * the push takes. If the owner has ended, count the node
+ * off instead, and the last one lets the owner go
+ ********************************************/
+template <size_t nodeSize, size_t nodeAlign>
+void NodePool <nodeSize, nodeAlign> :: _freeRemote(Local * pOwner, Slot * pSlot) noexcept
+{
+   NODE_POOL_POISON((char *)pSlot + sizeof(Slot), SLOT_BYTES - sizeof(Slot));
+   Slot * pHead = pOwner->pRemote.load(std::memory_order_acquire);
+   do
+   {
+      if (pHead == _orphan())
+      {
+         if (pOwner->numOrphans.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            _destroy(pOwner);
+         return;
+      }
+      pSlot->pNext = pHead;
+   }
+   while (!pOwner->pRemote.compare_exchange_weak(pHead, pSlot, std::memory_order_release,
+                                                 std::memory_order_acquire));
+}
+
+/*********************************************
+ * NODE POOL :: RETIRE
+ * The thread has ended. Take what was given back, and
+ * mark the remote list so that those still out are
+ * counted off from now on. If none are out, we are done
+ ********************************************/
+template <size_t nodeSize, size_t nodeAlign>
+void NodePool <nodeSize, nodeAlign> :: _retire(Local * pLocal) noexcept
+{
+   size_t numLive;
+   Slot * pEmpty;
+   do
+   {
+      _drain(*pLocal);
+      numLive = pLocal->numLive;
+      pLocal->numOrphans.store(numLive, std::memory_order_relaxed);
+      pEmpty = nullptr;
+   }
+   while (!pLocal->pRemote.compare_exchange_strong(pEmpty, _orphan(), std::memory_order_acq_rel));
+
+   if (numLive == 0)
+      _destroy(pLocal);
+}
+
+/*********************************************
+ * NODE POOL :: DESTROY
+ * Every slab of an ended thread, once none of its nodes
+ * is in use
+ ********************************************/
+template <size_t nodeSize, size_t nodeAlign>
+void NodePool <nodeSize, nodeAlign> :: _destroy(Local * pLocal) noexcept
+{
+   while (pLocal->pSlabs)
+   {
+      Slab * pSlab = pLocal->pSlabs;
+      pLocal->pSlabs = pSlab->pNext;
+      NODE_POOL_UNPOISON((char *)pSlab + HEADER_BYTES, NODES_PER_SLAB * SLOT_BYTES);
+#ifdef _WIN32
+      _aligned_free(pSlab);
+#else
+      free(pSlab);
+#endif
+      _numSlabs()--;
+   }
+   delete pLocal;
+}
+
+/************************************************
+ * NODE ARENA
+ * Nodes carved one after another from chunks that double
+ * in size, up to a limit. Erased nodes go on a free list
+ * to be used again, but nothing goes back to the system
+ * until release(), which frees every chunk at once. The
+ * size of a node is given when the arena is made, so a
+ * tree can hold one before its node type is complete
+ ***********************************************/
+class NodeArena
+{
+   friend class ::TestNodePool; // give unit tests access to the privates
+public:
+   static const size_t CHUNK_BYTES_MIN = 4 * 1024;
+   static const size_t CHUNK_BYTES_MAX = 1024 * 1024;
+
+   NodeArena(size_t nodeSize, size_t nodeAlign);
+   ~NodeArena() { release(); }
+   NodeArena(const NodeArena &) = delete;
+   NodeArena & operator = (const NodeArena &) = delete;
+
+   // one node, or numNodes side by side in a chunk of their own
+   void * allocate();
+   void * allocate(size_t numNodes);
+   void deallocate(void * p) noexcept;
+
+   // every node goes, and every chunk with them
+   void release() noexcept;
+
+   // how much the chunks take
+   size_t bytes() const noexcept { return numBytes; }
+
+private:
+   struct Slot
+   {
+      Slot * pNext;
+   };
+
+   // what each chunk starts with
+   struct Chunk
+   {
+      Chunk * pNext;   // the chunk made before this one
+      size_t  bytes;   // the nodes in it, not counting this header
+   };
+
+   char * _chunk(size_t numNodes);
+
+   size_t slotBytes;     // a node's room, rounded up so the next one is aligned too
+   size_t headerBytes;   // a Chunk, and padding to where the nodes start
+   size_t chunkBytes;    // how big to make the next chunk
+   size_t numBytes;      // every chunk, headers and all
+   Slot * pFree;         // erased nodes, ready to reuse
+   char * pNext;         // the next node never handed out in the current chunk
+   char * pEnd;          // the end of the current chunk
+   Chunk * pChunks;      // the newest chunk
+};
+
+/*********************************************
+ * NODE ARENA :: CONSTRUCTOR
+ * Nothing is allocated until the first node
+ ********************************************/
+inline NodeArena :: NodeArena(size_t nodeSize, size_t nodeAlign) :
+   slotBytes(((nodeSize > sizeof(Slot) ? nodeSize : sizeof(Slot)) + nodeAlign - 1) / nodeAlign * nodeAlign),
+   headerBytes((sizeof(Chunk) + nodeAlign - 1) / nodeAlign * nodeAlign),
+   chunkBytes(CHUNK_BYTES_MIN), numBytes(0),
+   pFree(nullptr), pNext(nullptr), pEnd(nullptr), pChunks(nullptr)
+{
+   assert(nodeAlign <= alignof(std::max_align_t));
+}
+
+/*********************************************
+ * NODE ARENA :: ALLOCATE
+ * The last node erased, or the next one in the chunk
+ ********************************************/
+inline void * NodeArena :: allocate()
+{
+   if (pFree)
+   {
+      Slot * pSlot = pFree;
+      NODE_POOL_UNPOISON(pSlot, slotBytes);
+      pFree = pSlot->pNext;
+      return pSlot;
+   }
+   if (pNext == pEnd)
+   {
+      size_t numNodes = (chunkBytes - headerBytes) / slotBytes;
+      if (numNodes == 0)
+         numNodes = 1;
+      pNext = _chunk(numNodes);
+      pEnd  = pNext + numNodes * slotBytes;
+      if (chunkBytes < CHUNK_BYTES_MAX)
+         chunkBytes *= 2;
+   }
+   void * p = pNext;
+   pNext += slotBytes;
+   NODE_POOL_UNPOISON(p, slotBytes);
+   return p;
+}
+
+/*********************************************
+ * NODE ARENA :: ALLOCATE
+ * A run of nodes, for relayout_veb(). The current chunk
+ * is left as it is for the nodes that come after
+ ********************************************/
+inline void * NodeArena :: allocate(size_t numNodes)
+{
+   char * p = _chunk(numNodes ? numNodes : 1);
+   NODE_POOL_UNPOISON(p, numNodes * slotBytes);
+   return p;
+}
+
+/*********************************************
+ * NODE ARENA :: DEALLOCATE
+ * Onto the front of the free list
+ ********************************************/
+inline void NodeArena :: deallocate(void * p) noexcept
+{
+   if (p == nullptr)
+      return;
+   Slot * pSlot = (Slot *)p;
+   pSlot->pNext = pFree;
+   pFree = pSlot;
+   NODE_POOL_POISON(pSlot, slotBytes);
+}
+
+/*********************************************
+ * NODE ARENA :: RELEASE
+ * One free for each chunk, however many nodes were in it.
+ * The next node starts over with a small chunk
+ ********************************************/
+inline void NodeArena :: release() noexcept
+{
+   while (pChunks)
+   {
+      Chunk * pChunk = pChunks;
+      pChunks = pChunk->pNext;
+      NODE_POOL_UNPOISON((char *)pChunk + headerBytes, pChunk->bytes);
+      ::operator delete(pChunk);
+   }
+   chunkBytes = CHUNK_BYTES_MIN;
+   numBytes = 0;
+   pFree = nullptr;
+   pNext = pEnd = nullptr;
+}
+
+/*********************************************
+ * NODE ARENA :: CHUNK
+ * A new chunk with room for numNodes, linked in front
+ * of the others. Returns where its nodes start
+ ********************************************/
+inline char * NodeArena :: _chunk(size_t numNodes)
+{
+   size_t bytesNodes = numNodes * slotBytes;
+   Chunk * pChunk = (Chunk *)::operator new(headerBytes + bytesNodes);
+   pChunk->pNext = pChunks;
+   pChunk->bytes = bytesNodes;
+   pChunks = pChunk;
+   numBytes += headerBytes + bytesNodes;
+
+   char * pNodes = (char *)pChunk + headerBytes;
+   NODE_POOL_POISON(pNodes, bytesNodes);
+   return pNodes;
+}
+
+} // namespace custom
@@ -0,0 +1,365 @@
+/***********************************************************************
+ * Header:
+ *    PERFECT SET
+ * Summary:
+ *    An immutable set that only answers "is this in it?", for
+ *    allow-lists and the like that are built once and asked on
+ *    every request. A minimal perfect hash in the style of BBHash
+ *    gives each element its own slot from 0 to n-1 with no empty
+ *    ones and no probing, in a few bits an element. A lookup reads
+ *    one cache line of bits and then the element in its slot
+ *
+ *    This will contain the class definition of:
+ *        perfect_set           : A class that represents a frozen membership Set
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint64_t and uintptr_t
+#include <cstring>     // for std::memcpy
+#include <functional>  // for std::hash
+#include <new>         // for ::operator new
+#include <utility>     // for std::swap
+#include <vector>      // for std::vector
+#include "set.h"       // for custom::set, which we are built from
+#include "bitOps.h"    // for popCount
+
+class TestPerfectSet;  // forward declaration for unit tests
+
+namespace custom
+{
+
+/************************************************
+ * PERFECT SET
+ * A cascade of bit vectors, one per level. An element
+ * hashes to one bit on each level and lives on the first
+ * level where no other element still looking for a home
+ * hashed to the same bit. Its slot is the number of one
+ * bits before that one, counted over all the levels. The
+ * bits are kept in cache-line blocks that start with the
+ * count of ones before them, so finding the slot reads
+ * one line, and the element in it is the only other read.
+ * Those that collide on every level, which is very few,
+ * are kept to the side. There is no insert, erase, or
+ * order: build a new one instead
+ ***********************************************/
+template <typename T, typename Hash = std::hash<T>>
+class perfect_set
+{
+   friend class ::TestPerfectSet; // give unit tests access to the privates
+public:
+   //
+   // Construct. From a set, or any range without repeats
+   //
+
+   perfect_set() : numElements(0), numBlocks(0), pBuffer(nullptr), blocks(nullptr) { }
+   template <typename Balance, typename Alloc>
+   perfect_set(const set<T, Balance, Alloc> & s) : perfect_set(s.begin(), s.end()) { }
+   template <class Iterator>
+   perfect_set(Iterator first, Iterator last);
+   perfect_set(const perfect_set &  rhs);
+   perfect_set(      perfect_set && rhs) noexcept : perfect_set() { swap(rhs); }
+   ~perfect_set() { ::operator delete(pBuffer); }
+
+   //
+   // Assign
+   //
+
+   perfect_set & operator = (const perfect_set & rhs)
+   {
+      perfect_set copy(rhs);
+      swap(copy);
+      return *this;
+   }
+   perfect_set & operator = (perfect_set && rhs) noexcept
+   {
+      swap(rhs);
+      return *this;
+   }
+   void swap(perfect_set & rhs) noexcept
+   {
+      std::swap(numElements, rhs.numElements);
+      levels.swap(rhs.levels);
+      std::swap(numBlocks, rhs.numBlocks);
+      std::swap(pBuffer, rhs.pBuffer);
+      std::swap(blocks, rhs.blocks);
+      elements.swap(rhs.elements);
+      leftovers.swap(rhs.leftovers);
+      std::swap(hasher, rhs.hasher);
+   }
+
+   //
+   // Access. One block of bits, then the slot
+   //
+
+   bool contains(const T & t) const;
+   size_t count(const T & t) const { return contains(t) ? 1 : 0; }
+
+   //
+   // Status
+   //
+
+   bool   empty() const noexcept { return (numElements == 0); }
+   size_t size()  const noexcept { return numElements;        }
+   size_t bytes() const noexcept
+   {
+      return numBlocks * sizeof(Block) + levels.size() * sizeof(Level) +
+             (elements.size() + leftovers.size()) * sizeof(T);
+   }
+
+private:
+
+   static const size_t   MAX_LEVELS      = 32;  // after this many, the rest go to leftovers
+   static const uint64_t GAMMA           = 2;   // bits on a level for each element still looking
+   static const size_t   WORDS_PER_BLOCK = 7;   // with the rank, one cache line
+   static const size_t   BITS_PER_BLOCK  = 64 * WORDS_PER_BLOCK;
+
+   // a cache line of bits, with the ones in every block before it
+   struct Block
+   {
+      uint64_t rank;
+      uint64_t bits[WORDS_PER_BLOCK];
+   };
+
+   // where a level starts, counted in bits over every level, and how many it has
+   struct Level
+   {
+      uint64_t firstBit;
+      uint64_t numBits;
+   };
+
+   uint64_t _hash(const T & t) const { return _mix((uint64_t)hasher(t)); }
+   static uint64_t _mix(uint64_t hash);
+   size_t _bit(uint64_t hash, size_t level) const;
+   bool _slot(size_t bit, size_t & slot) const;
+   void _allocate(size_t numBlocksNew);
+   void _pack(const std::vector<uint64_t> & words);
+
+   size_t numElements;             // elements plus leftovers
+   std::vector<Level> levels;      // one per level, in order
+   size_t numBlocks;               // the bits of every level, end to end
+   void * pBuffer;                 // what was allocated, before alignment
+   Block * blocks;                 // block after block, each on a cache line
+   std::vector<T> elements;        // slot i has the element whose bit is one number i
+   std::vector<T> leftovers;       // those that never got a bit of their own
+   Hash hasher;                    // std::hash or what the user gave us
+};
+
+/*********************************************
+ * PERFECT SET :: CONSTRUCTOR
+ * Each level has GAMMA bits for every element left. One
+ * pass marks the bits hit once and those hit more often;
+ * the elements on a bit hit once stay, and the rest try
+ * again on the next level. With GAMMA = 2, about 60% stay
+ * each time, so a handful of levels are enough
+ ********************************************/
+template <typename T, typename Hash>
+template <class Iterator>
+perfect_set <T, Hash> :: perfect_set(Iterator first, Iterator last) : perfect_set()
+{
+   std::vector<T> all;
+   for (; first != last; ++first)
+      all.push_back(*first);
+   std::vector<uint64_t> hashes(all.size());
+   for (size_t i = 0; i < all.size(); i++)
+      hashes[i] = _hash(all[i]);
+   numElements = all.size();
+
+   std::vector<size_t> left(all.size());
+   for (size_t i = 0; i < left.size(); i++)
+      left[i] = i;
+   std::vector<std::pair<size_t, size_t>> placed;   // which element, on which bit overall
+   placed.reserve(all.size());
+   std::vector<uint64_t> words;                      // every level's bits, before packing
+
+   for (size_t level = 0; level < MAX_LEVELS && !left.empty(); level++)
+   {
+      Level newLevel;
+      newLevel.firstBit = words.size() * 64;
+      newLevel.numBits = (GAMMA * left.size() + 63) / 64 * 64;
+      assert(newLevel.numBits <= ((uint64_t)1 << 32));
+      levels.push_back(newLevel);
+
+      // which bits are hit at all, and which more than once
+      size_t numWords = (size_t)(newLevel.numBits / 64);
+      std::vector<uint64_t> hit(numWords, 0);
+      std::vector<uint64_t> collide(numWords, 0);
+      for (size_t i : left)
+      {
+         size_t bit = _bit(hashes[i], level) - (size_t)newLevel.firstBit;
+         uint64_t mask = (uint64_t)1 << (bit & 63);
+         if (hit[bit >> 6] & mask)
+            collide[bit >> 6] |= mask;
+         hit[bit >> 6] |= mask;
+      }
+      for (size_t w = 0; w < numWords; w++)
+         words.push_back(hit[w] & ~collide[w]);
+
+      // those on a bit of their own are done
+      std::vector<size_t> stillLeft;
+      for (size_t i : left)
+      {
+         size_t bit = _bit(hashes[i], level);
+         if ((words[bit >> 6] >> (bit & 63)) & 1)
+            placed.push_back(std::make_pair(i, bit));
+         else
+            stillLeft.push_back(i);
+      }
+      left.swap(stillLeft);
+   }
+
+   // into blocks, each with the ones before it, so a slot is one block's popcounts
+   _pack(words);
+
+   std::vector<size_t> inSlot(placed.size());
+   for (auto & p : placed)
+   {
+      size_t slot = 0;
+      bool isSet = _slot(p.second, slot);
+      assert(isSet && slot < inSlot.size());
+      (void)isSet;
+      inSlot[slot] = p.first;
+   }
+   elements.reserve(inSlot.size());
+   for (size_t i : inSlot)
+      elements.push_back(all[i]);
+   for (size_t i : left)
+      leftovers.push_back(all[i]);
+}
+
+/*********************************************
+ * PERFECT SET :: COPY CONSTRUCTOR
+ ********************************************/
+template <typename T, typename Hash>
+perfect_set <T, Hash> :: perfect_set(const perfect_set & rhs) :
+   numElements(rhs.numElements), levels(rhs.levels), numBlocks(0),
+   pBuffer(nullptr), blocks(nullptr), elements(rhs.elements),
+   leftovers(rhs.leftovers), hasher(rhs.hasher)
+{
+   if (rhs.numBlocks)
+   {
+      _allocate(rhs.numBlocks);
+      std::memcpy(blocks, rhs.blocks, numBlocks * sizeof(Block));
+   }
+}
+
+/*********************************************
+ * PERFECT SET :: CONTAINS
+ * The first level whose bit for t is one is the only
+ * place t can be: had it collided there the bit would be
+ * zero, and nothing else has that bit. Most answers come
+ * from the first level
+ ********************************************/
+template <typename T, typename Hash>
+bool perfect_set <T, Hash> :: contains(const T & t) const
+{
+   uint64_t hash = _hash(t);
+   for (size_t level = 0; level < levels.size(); level++)
+   {
+      size_t slot;
+      if (_slot(_bit(hash, level), slot))
+         return elements[slot] == t;
+   }
+   for (auto & leftover : leftovers)
+      if (leftover == t)
+         return true;
+   return false;
+}
+
+/*********************************************
+ * PERFECT SET :: MIX
+ * std::hash of an integer is often the integer. Mix every
+ * bit into every other first (the MurmurHash3 finalizer)
+ ********************************************/
+template <typename T, typename Hash>
+uint64_t perfect_set <T, Hash> :: _mix(uint64_t hash)
+{
+   hash ^= hash >> 33;
+   hash *= 0xFF51AFD7ED558CCDull;
+   hash ^= hash >> 33;
+   hash *= 0xC4CEB9FE1A85EC53ull;
+   hash ^= hash >> 33;
+   return hash;
+}
+
+/*********************************************
+ * PERFECT SET :: BIT
+ * Where a hash lands on a level, counted from the start
+ * of the first one. The hash is already mixed, so one
+ * multiply with the level's own number in it is enough to
+ * spread out on the next level the elements that collided
+ * on this one. The high half of that is scaled to the
+ * level's size with a multiply rather than a divide
+ ********************************************/
+template <typename T, typename Hash>
+size_t perfect_set <T, Hash> :: _bit(uint64_t hash, size_t level) const
+{
+   uint64_t spread = (hash ^ (uint64_t)(level + 1) * 0x9E3779B97F4A7C15ull) * 0xBF58476D1CE4E5B9ull;
+   const Level & l = levels[level];
+   return (size_t)(l.firstBit + (((spread >> 32) * l.numBits) >> 32));
+}
+
+/*********************************************
+ * PERFECT SET :: SLOT
+ * Whether a bit is one and, if it is, how many ones come
+ * before it: those before its block, and those before it
+ * in the block, which is all on the one cache line
+ ********************************************/
+template <typename T, typename Hash>
+bool perfect_set <T, Hash> :: _slot(size_t bit, size_t & slot) const
+{
+   const Block & block = blocks[bit / BITS_PER_BLOCK];
+   size_t inBlock = bit % BITS_PER_BLOCK;
+   size_t w = inBlock / 64;
+   uint64_t mask = (uint64_t)1 << (inBlock & 63);
+   if ((block.bits[w] & mask) == 0)
+      return false;
+   slot = (size_t)block.rank + popCount(block.bits[w] & (mask - 1));
+   for (size_t i = 0; i < w; i++)
+      slot += popCount(block.bits[i]);
+   return true;
+}
+
+/*********************************************
+ * PERFECT SET :: ALLOCATE
+ * Room for the blocks, each on a cache line of its own
+ ********************************************/
+template <typename T, typename Hash>
+void perfect_set <T, Hash> :: _allocate(size_t numBlocksNew)
+{
+   static_assert(sizeof(Block) == 64, "a block is one cache line");
+   ::operator delete(pBuffer);
+   pBuffer = ::operator new(numBlocksNew * sizeof(Block) + 63);
+   blocks = (Block *)(((uintptr_t)pBuffer + 63) & ~(uintptr_t)63);
+   numBlocks = numBlocksNew;
+}
+
+/*********************************************
+ * PERFECT SET :: PACK
+ * The bits of every level, end to end, WORDS_PER_BLOCK
+ * words to a block. The last block is padded with zeros
+ ********************************************/
+template <typename T, typename Hash>
+void perfect_set <T, Hash> :: _pack(const std::vector<uint64_t> & words)
+{
+   if (words.empty())
+      return;
+   _allocate((words.size() + WORDS_PER_BLOCK - 1) / WORDS_PER_BLOCK);
+   uint64_t rank = 0;
+   for (size_t b = 0; b < numBlocks; b++)
+   {
+      blocks[b].rank = rank;
+      for (size_t i = 0; i < WORDS_PER_BLOCK; i++)
+      {
+         size_t w = b * WORDS_PER_BLOCK + i;
+         blocks[b].bits[i] = (w < words.size() ? words[w] : 0);
+         rank += popCount(blocks[b].bits[i]);
+      }
+   }
+}
+
+} // namespace custom
@@ -0,0 +1,1164 @@
+/***********************************************************************
+ * Header:
+ *    ROARING SET
+ * Summary:
+ *    A compressed set of 32-bit unsigned integers in the style of
+ *    Roaring bitmaps. The keys are cut into chunks of 65536 by their
+ *    high 16 bits, and each chunk holds its low 16 bits in whichever
+ *    container is smallest for how full it is:
+ *        array  : the sorted values, 2 bytes each, up to 4096 of them
+ *        bitmap : one bit for each of the 65536 values, 8 KB
+ *        run    : (start, length) pairs, 4 bytes for each run
+ *    A posting list of a million IDs then takes 2 bytes an ID or
+ *    less, where a set takes a node of about 48. Union, intersection
+ *    and difference work a container at a time, and two bitmaps
+ *    combine a word at a time in loops the compiler can vectorize
+ *
+ *    This will contain the class definition of:
+ *        RoaringContainer       : The low 16 bits of one chunk
+ *        roaring_set            : A class that represents a compressed Set
+ *        roaring_set::iterator  : An iterator through roaring_set
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#include <algorithm>   // for std::lower_bound, std::set_union and friends
+#include <cassert>
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint16_t, uint32_t and uint64_t
+#include <iterator>    // for std::back_inserter
+#include <type_traits> // for std::is_unsigned
+#include <utility>     // for std::pair and std::swap
+#include <vector>      // for std::vector
+#include <initializer_list>
+#include "bitOps.h"    // for lowestBit, highestBit and popCount
+
+class TestRoaringSet;  // forward declaration for unit tests
+
+namespace custom
+{
+
+/************************************************
+ * ROARING CONTAINER
+ * The low 16 bits of the keys in one chunk. An array
+ * turns into a bitmap when it passes 4096 values and a
+ * bitmap back into an array when it falls to 4096. Runs
+ * come from fit(), which the set algebra and optimize()
+ * call, and turn back into one of the others when an
+ * insert or erase leaves them bigger than that would be
+ ***********************************************/
+class RoaringContainer
+{
+   friend class ::TestRoaringSet; // give unit tests access to the privates
+public:
+   enum Kind { ARRAY, BITMAP, RUN };
+
+   static const uint32_t NONE      = 0x10000;  // past the last value
+   static const uint32_t ARRAY_MAX = 4096;     // most values an array holds
+   static const size_t   NUM_WORDS = 1024;     // words in a bitmap
+
+   RoaringContainer() : kind(ARRAY), cardinality(0) { }
+
+   //
+   // Access. Next is the smallest value not less than x,
+   // last the largest value not greater than x. NONE if
+   // there is no such value
+   //
+
+   bool     contains(uint16_t x) const;
+   uint32_t next(uint32_t x) const;
+   uint32_t last(uint32_t x) const;
+   uint32_t first() const                   { return next(0);      }
+
+   //
+   // Insert and erase one value. False when there was nothing to do
+   //
+
+   bool insert(uint16_t x);
+   bool erase(uint16_t x);
+
+   //
+   // Status
+   //
+
+   Kind     type()  const                   { return kind;         }
+   uint32_t size()  const                   { return cardinality;  }
+   size_t   bytes() const;
+
+   //
+   // Representation. Fit picks the smallest container for
+   // what is here
+   //
+
+   void fit(bool allowRuns = true);
+   template <class Visit>
+   void forEach(Visit visit) const;
+
+   //
+   // Set algebra
+   //
+
+   static RoaringContainer unite    (const RoaringContainer & lhs, const RoaringContainer & rhs);
+   static RoaringContainer intersect(const RoaringContainer & lhs, const RoaringContainer & rhs);
+   static RoaringContainer subtract (const RoaringContainer & lhs, const RoaringContainer & rhs);
+
+private:
+
+   static uint64_t bit(uint32_t x)          { return (uint64_t)1 << (x & 63); }
+   uint32_t runStart(size_t i) const        { return values[2 * i];           }
+   uint32_t runEnd  (size_t i) const        { return (uint32_t)values[2 * i] + values[2 * i + 1]; }
+   size_t   numRuns() const                 { return values.size() / 2;       }
+
+   size_t _countRuns() const;
+   size_t _runIndex(uint32_t x) const;
+   bool   _insertRun(uint16_t x);
+   bool   _eraseRun(uint16_t x);
+   void   _toArray();
+   void   _toBitmap();
+   void   _toRuns();
+   void   _recount();
+   const RoaringContainer & _noRuns(RoaringContainer & scratch) const;
+
+   Kind kind;                     // which of values and words is in use
+   uint32_t cardinality;          // how many values, up to 65536
+   std::vector<uint16_t> values;  // ARRAY: sorted values. RUN: start, length - 1
+   std::vector<uint64_t> words;   // BITMAP: NUM_WORDS of them
+};
+
+/************************************************
+ * ROARING SET
+ * The high 16 bits of every chunk with anything in it,
+ * sorted, and beside each its container. The same
+ * interface as set, plus union, intersection and
+ * difference in place. An insert or erase can move
+ * the containers, so it invalidates every iterator
+ ***********************************************/
+template <typename T = uint32_t>
+class roaring_set
+{
+   static_assert(std::is_integral<T>::value && std::is_unsigned<T>::value && sizeof(T) <= 4,
+                 "roaring_set keys are unsigned integers of 32 bits or fewer");
+
+   friend class ::TestRoaringSet; // give unit tests access to the privates
+   template <typename U>
+   friend roaring_set <U> operator & (const roaring_set <U> & lhs, const roaring_set <U> & rhs);
+public:
+   //
+   // Construct
+   //
+
+   roaring_set() : numElements(0) { }
+   roaring_set(const roaring_set & rhs) = default;
+   roaring_set(roaring_set && rhs) : numElements(0) { swap(rhs); }
+   roaring_set(const std::initializer_list<T> & il) : numElements(0)
+   {
+      insert(il.begin(), il.end());
+   }
+   template <class Iterator>
+   roaring_set(Iterator first, Iterator last) : numElements(0)
+   {
+      insert(first, last);
+   }
+
+   //
+   // Assign
+   //
+
+   roaring_set & operator = (const roaring_set & rhs) = default;
+   roaring_set & operator = (roaring_set && rhs)
+   {
+      clear();
+      swap(rhs);
+      return *this;
+   }
+   roaring_set & operator = (const std::initializer_list<T> & il)
+   {
+      clear();
+      insert(il.begin(), il.end());
+      return *this;
+   }
+   void swap(roaring_set & rhs) noexcept
+   {
+      highs.swap(rhs.highs);
+      containers.swap(rhs.containers);
+      std::swap(numElements, rhs.numElements);
+   }
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   iterator begin() const noexcept
+   {
+      return containers.empty() ? end() : iterator(this, 0, containers[0].first());
+   }
+   iterator end()   const noexcept { return iterator(this); }
+
+   //
+   // Access. Lower bound is the first element not less than t,
+   // upper bound the first one greater
+   //
+
+   iterator find(const T & t) const;
+   iterator lower_bound(const T & t) const;
+   iterator upper_bound(const T & t) const
+   {
+      if ((uint64_t)t == (uint64_t)(T)~(T)0)
+         return end();
+      return lower_bound((T)(t + 1));
+   }
+
+   //
+   // Insert
+   //
+
+   std::pair<iterator, bool> insert(const T & t);
+   void insert(const std::initializer_list<T> & il)
+   {
+      insert(il.begin(), il.end());
+   }
+   template <class Iterator>
+   void insert(Iterator first, Iterator last)
+   {
+      for (; first != last; ++first)
+         insert(*first);
+   }
+
+   //
+   // Remove
+   //
+
+   iterator erase(iterator it);
+   size_t erase(const T & t);
+   void clear() noexcept
+   {
+      highs.clear();
+      containers.clear();
+      numElements = 0;
+   }
+
+   //
+   // Set algebra, a container at a time. There are also
+   // the operators &, | and - that make a new set
+   //
+
+   roaring_set & operator |= (const roaring_set & rhs);
+   roaring_set & operator &= (const roaring_set & rhs);
+   roaring_set & operator -= (const roaring_set & rhs);
+
+   //
+   // Compress. Turn every container that would be smaller
+   // as runs into runs. Worth doing after a bulk load
+   //
+
+   void optimize()
+   {
+      for (auto & container : containers)
+         container.fit();
+   }
+
+   //
+   // Status
+   //
+
+   bool   empty() const noexcept { return (numElements == 0); }
+   size_t size()  const noexcept { return numElements;        }
+   size_t bytes() const noexcept;
+
+private:
+
+   static uint16_t high(uint32_t t)          { return (uint16_t)(t >> 16);     }
+   static uint16_t low (uint32_t t)          { return (uint16_t)(t & 0xFFFF);  }
+   size_t _index(uint16_t h) const
+   {
+      return std::lower_bound(highs.begin(), highs.end(), h) - highs.begin();
+   }
+   iterator _at(size_t i, uint32_t x) const;
+   void _recount();
+
+   std::vector<uint16_t> highs;                 // sorted high halves
+   std::vector<RoaringContainer> containers;    // the low halves under each
+   size_t numElements;                          // total over the containers
+};
+
+/**************************************************
+ * ROARING SET ITERATOR
+ * Which container, and the low half in it. Moving on
+ * asks the container first and the next one after
+ *************************************************/
+template <typename T>
+class roaring_set <T> :: iterator
+{
+   friend class ::TestRoaringSet; // give unit tests access to the privates
+   friend class roaring_set <T>;
+public:
+   // constructors and assignment
+   iterator() : pSet(nullptr), i(0), value(), isEnd(true) { }
+   iterator(const roaring_set * pSet) : pSet(pSet), i(0), value(), isEnd(true) { }
+   iterator(const roaring_set * pSet, size_t i, uint32_t x) :
+      pSet(pSet), i(i), value((T)(((uint32_t)pSet->highs[i] << 16) | x)), isEnd(false) { }
+
+   // compare
+   bool operator == (const iterator & rhs) const
+   {
+      return isEnd == rhs.isEnd && (isEnd || value == rhs.value);
+   }
+   bool operator != (const iterator & rhs) const { return !(*this == rhs);                       }
+
+   // de-reference. Cannot change because that would move it
+   const T & operator * () const                 { return value;                                 }
+
+   // increment and decrement
+   iterator & operator ++ ()
+   {
+      if (!isEnd)
+         *this = pSet->_at(i, (uint32_t)low(value) + 1);
+      return *this;
+   }
+   iterator   operator ++ (int postfix)          { iterator itOld(*this); ++*this; return itOld; }
+   iterator & operator -- ();
+   iterator   operator -- (int postfix)          { iterator itOld(*this); --*this; return itOld; }
+
+private:
+
+   const roaring_set * pSet;  // the set we walk through
+   size_t i;                  // which container
+   T value;                   // the element we are on
+   bool isEnd;                // past the last element
+};
+
+/*********************************************
+ *********************************************
+ ************ ROARING CONTAINER **************
+ *********************************************
+ *********************************************/
+
+/*********************************************
+ * ROARING CONTAINER :: FOR EACH
+ * Hand every value to visit, in order
+ ********************************************/
+template <class Visit>
+void RoaringContainer :: forEach(Visit visit) const
+{
+   switch (kind)
+   {
+      case ARRAY:
+         for (auto x : values)
+            visit((uint16_t)x);
+         break;
+      case BITMAP:
+         for (size_t w = 0; w < words.size(); w++)
+            for (uint64_t word = words[w]; word; word &= word - 1)
+               visit((uint16_t)((w << 6) + lowestBit(word)));
+         break;
+      case RUN:
+         for (size_t i = 0; i < numRuns(); i++)
+            for (uint32_t x = runStart(i); x <= runEnd(i); x++)
+               visit((uint16_t)x);
+         break;
+   }
+}
+
+/*********************************************
+ * ROARING CONTAINER :: RUN INDEX
+ * The last run starting at or before x, or numRuns()
+ * if x comes before them all
+ ********************************************/
+inline size_t RoaringContainer :: _runIndex(uint32_t x) const
+{
+   size_t lo = 0;
+   size_t hi = numRuns();
+   while (lo < hi)
+   {
+      size_t mid = (lo + hi) / 2;
+      if (runStart(mid) <= x)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+   return lo == 0 ? numRuns() : lo - 1;
+}
+
+/*********************************************
+ * ROARING CONTAINER :: CONTAINS
+ ********************************************/
+inline bool RoaringContainer :: contains(uint16_t x) const
+{
+   switch (kind)
+   {
+      case ARRAY:
+         return std::binary_search(values.begin(), values.end(), x);
+      case BITMAP:
+         return (words[x >> 6] & bit(x)) != 0;
+      case RUN:
+      {
+         size_t i = _runIndex(x);
+         return i < numRuns() && x <= runEnd(i);
+      }
+   }
+   return false;
+}
+
+/*********************************************
+ * ROARING CONTAINER :: NEXT
+ * The smallest value not less than x
+ ********************************************/
+inline uint32_t RoaringContainer :: next(uint32_t x) const
+{
+   if (x >= NONE)
+      return NONE;
+   switch (kind)
+   {
+      case ARRAY:
+      {
+         auto it = std::lower_bound(values.begin(), values.end(), (uint16_t)x);
+         return it == values.end() ? NONE : *it;
+      }
+      case BITMAP:
+      {
+         size_t w = x >> 6;
+         uint64_t word = words[w] & (~(uint64_t)0 << (x & 63));
+         while (word == 0)
+         {
+            if (++w == NUM_WORDS)
+               return NONE;
+            word = words[w];
+         }
+         return (uint32_t)((w << 6) + lowestBit(word));
+      }
+      case RUN:
+      {
+         size_t i = _runIndex(x);
+         if (i < numRuns() && x <= runEnd(i))
+            return x;
+         i = (i == numRuns() ? 0 : i + 1);
+         return i < numRuns() ? runStart(i) : NONE;
+      }
+   }
+   return NONE;
+}
+
+/*********************************************
+ * ROARING CONTAINER :: LAST
+ * The largest value not greater than x
+ ********************************************/
+inline uint32_t RoaringContainer :: last(uint32_t x) const
+{
+   if (x >= NONE)
+      x = NONE - 1;
+   switch (kind)
+   {
+      case ARRAY:
+      {
+         auto it = std::upper_bound(values.begin(), values.end(), (uint16_t)x);
+         return it == values.begin() ? NONE : *(it - 1);
+      }
+      case BITMAP:
+      {
+         size_t w = x >> 6;
+         uint64_t word = words[w] & (~(uint64_t)0 >> (63 - (x & 63)));
+         while (word == 0)
+         {
+            if (w-- == 0)
+               return NONE;
+            word = words[w];
+         }
+         return (uint32_t)((w << 6) + highestBit(word));
+      }
+      case RUN:
+      {
+         size_t i = _runIndex(x);
+         if (i == numRuns())
+            return NONE;
+         return std::min(x, runEnd(i));
+      }
+   }
+   return NONE;
+}
+
+/*********************************************
+ * ROARING CONTAINER :: INSERT
+ * Add x unless it is here. An array that grows past
+ * ARRAY_MAX becomes a bitmap
+ ********************************************/
+inline bool RoaringContainer :: insert(uint16_t x)
+{
+   switch (kind)
+   {
+      case ARRAY:
+      {
+         auto it = std::lower_bound(values.begin(), values.end(), x);
+         if (it != values.end() && *it == x)
+            return false;
+         values.insert(it, x);
+         if (++cardinality > ARRAY_MAX)
+            _toBitmap();
+         return true;
+      }
+      case BITMAP:
+         if (words[x >> 6] & bit(x))
+            return false;
+         words[x >> 6] |= bit(x);
+         cardinality++;
+         return true;
+      case RUN:
+         return _insertRun(x);
+   }
+   return false;
+}
+
+/*********************************************
+ * ROARING CONTAINER :: ERASE
+ * Take out x if it is here. A bitmap that falls to
+ * ARRAY_MAX becomes an array
+ ********************************************/
+inline bool RoaringContainer :: erase(uint16_t x)
+{
+   switch (kind)
+   {
+      case ARRAY:
+      {
+         auto it = std::lower_bound(values.begin(), values.end(), x);
+         if (it == values.end() || *it != x)
+            return false;
+         values.erase(it);
+         cardinality--;
+         return true;
+      }
+      case BITMAP:
+         if (!(words[x >> 6] & bit(x)))
+            return false;
+         words[x >> 6] &= ~bit(x);
+         if (--cardinality <= ARRAY_MAX)
+            _toArray();
+         return true;
+      case RUN:
+         return _eraseRun(x);
+   }
+   return false;
+}
+
+/*********************************************
+ * ROARING CONTAINER :: INSERT RUN
+ * Grow the run x touches, joining it with the next if
+ * that closes the gap, or start a run of one. Give up
+ * on runs if there are now too many of them
+ ********************************************/
+inline bool RoaringContainer :: _insertRun(uint16_t x)
+{
+   size_t i = _runIndex(x);
+   if (i < numRuns() && x <= runEnd(i))
+      return false;
+
+   size_t iNext = (i == numRuns() ? 0 : i + 1);
+   bool touchesPrev = (i < numRuns() && runEnd(i) + 1 == x);
+   bool touchesNext = (iNext < numRuns() && runStart(iNext) == (uint32_t)x + 1);
+   if (touchesPrev && touchesNext)
+   {
+      values[2 * i + 1] = (uint16_t)(runEnd(iNext) - runStart(i));
+      values.erase(values.begin() + 2 * iNext, values.begin() + 2 * iNext + 2);
+   }
+   else if (touchesPrev)
+      values[2 * i + 1]++;
+   else if (touchesNext)
+   {
+      values[2 * iNext]--;
+      values[2 * iNext + 1]++;
+   }
+   else
+   {
+      uint16_t run[2] = { x, 0 };
+      values.insert(values.begin() + 2 * iNext, run, run + 2);
+   }
+   cardinality++;
+   if (4 * numRuns() > std::min((size_t)2 * cardinality, 2 * (size_t)ARRAY_MAX))
+      fit(false);
+   return true;
+}
+
+/*********************************************
+ * ROARING CONTAINER :: ERASE RUN
+ * Shorten the run x is in from either end, or cut it in two
+ ********************************************/
+inline bool RoaringContainer :: _eraseRun(uint16_t x)
+{
+   size_t i = _runIndex(x);
+   if (i == numRuns() || x > runEnd(i))
+      return false;
+
+   uint32_t start = runStart(i);
+   uint32_t end   = runEnd(i);
+   if (start == end)
+      values.erase(values.begin() + 2 * i, values.begin() + 2 * i + 2);
+   else if (x == start)
+   {
+      values[2 * i]++;
+      values[2 * i + 1]--;
+   }
+   else if (x == end)
+      values[2 * i + 1]--;
+   else
+   {
+      values[2 * i + 1] = (uint16_t)(x - 1 - start);
+      uint16_t run[2] = { (uint16_t)(x + 1), (uint16_t)(end - x - 1) };
+      values.insert(values.begin() + 2 * i + 2, run, run + 2);
+   }
+   cardinality--;
+   if (cardinality && 4 * numRuns() > std::min((size_t)2 * cardinality, 2 * (size_t)ARRAY_MAX))
+      fit(false);
+   return true;
+}
+
+/*********************************************
+ * ROARING CONTAINER :: BYTES
+ * How much the values take, not counting the vector
+ ********************************************/
+inline size_t RoaringContainer :: bytes() const
+{
+   return values.capacity() * sizeof(uint16_t) + words.capacity() * sizeof(uint64_t);
+}
+
+/*********************************************
+ * ROARING CONTAINER :: COUNT RUNS
+ * How many runs the values would make. In a bitmap a
+ * run starts at each bit set whose lower neighbor is not
+ ********************************************/
+inline size_t RoaringContainer :: _countRuns() const
+{
+   size_t num = 0;
+   switch (kind)
+   {
+      case ARRAY:
+         for (size_t i = 0; i < values.size(); i++)
+            num += (i == 0 || values[i] != values[i - 1] + 1);
+         break;
+      case BITMAP:
+      {
+         uint64_t carry = 0;
+         for (auto word : words)
+         {
+            num += popCount(word & ~((word << 1) | carry));
+            carry = word >> 63;
+         }
+         break;
+      }
+      case RUN:
+         num = numRuns();
+         break;
+   }
+   return num;
+}
+
+/*********************************************
+ * ROARING CONTAINER :: FIT
+ * Whichever is smallest: 4 bytes a run, 2 bytes a value
+ * for up to ARRAY_MAX values, or 8 KB
+ ********************************************/
+inline void RoaringContainer :: fit(bool allowRuns)
+{
+   size_t bytesFlat = (cardinality <= ARRAY_MAX ? 2 * (size_t)cardinality : 8 * NUM_WORDS);
+   if (allowRuns && 4 * _countRuns() < bytesFlat)
+      _toRuns();
+   else if (cardinality <= ARRAY_MAX)
+      _toArray();
+   else
+      _toBitmap();
+}
+
+/*********************************************
+ * ROARING CONTAINER :: TO ARRAY, TO BITMAP, TO RUNS
+ * The same values in another container
+ ********************************************/
+inline void RoaringContainer :: _toArray()
+{
+   if (kind == ARRAY)
+      return;
+   std::vector<uint16_t> sorted;
+   sorted.reserve(cardinality);
+   forEach([&sorted](uint16_t x) { sorted.push_back(x); });
+   values.swap(sorted);
+   std::vector<uint64_t>().swap(words);
+   kind = ARRAY;
+}
+
+inline void RoaringContainer :: _toBitmap()
+{
+   if (kind == BITMAP)
+      return;
+   std::vector<uint64_t> bits(NUM_WORDS, 0);
+   forEach([&bits](uint16_t x) { bits[x >> 6] |= bit(x); });
+   words.swap(bits);
+   std::vector<uint16_t>().swap(values);
+   kind = BITMAP;
+}
+
+inline void RoaringContainer :: _toRuns()
+{
+   if (kind == RUN)
+      return;
+   std::vector<uint16_t> runs;
+   runs.reserve(2 * _countRuns());
+   forEach([&runs](uint16_t x)
+   {
+      if (!runs.empty() && (uint32_t)runs[runs.size() - 2] + runs.back() + 1 == x)
+         runs.back()++;
+      else
+      {
+         runs.push_back(x);
+         runs.push_back(0);
+      }
+   });
+   values.swap(runs);
+   std::vector<uint64_t>().swap(words);
+   kind = RUN;
+}
+
+/*********************************************
+ * ROARING CONTAINER :: RECOUNT
+ * The cardinality, after the words changed in bulk
+ ********************************************/
+inline void RoaringContainer :: _recount()
+{
+   uint32_t num = 0;
+   for (auto word : words)
+      num += popCount(word);
+   cardinality = num;
+}
+
+/*********************************************
+ * ROARING CONTAINER :: NO RUNS
+ * Runs are for storing, not combining: hand back an
+ * array or bitmap copy in scratch, or this one if it
+ * already is
+ ********************************************/
+inline const RoaringContainer & RoaringContainer :: _noRuns(RoaringContainer & scratch) const
+{
+   if (kind != RUN)
+      return *this;
+   scratch = *this;
+   scratch.fit(false);
+   return scratch;
+}
+
+/*********************************************
+ * ROARING CONTAINER :: UNITE
+ * Everything in either. Two arrays merge; anything with
+ * a bitmap becomes one, OR'd a word at a time
+ ********************************************/
+inline RoaringContainer RoaringContainer :: unite(const RoaringContainer & lhsAny, const RoaringContainer & rhsAny)
+{
+   RoaringContainer scratchL, scratchR, both;
+   const RoaringContainer & lhs = lhsAny._noRuns(scratchL);
+   const RoaringContainer & rhs = rhsAny._noRuns(scratchR);
+
+   if (lhs.kind == ARRAY && rhs.kind == ARRAY)
+   {
+      both.values.reserve(lhs.values.size() + rhs.values.size());
+      std::set_union(lhs.values.begin(), lhs.values.end(),
+                     rhs.values.begin(), rhs.values.end(),
+                     std::back_inserter(both.values));
+      both.cardinality = (uint32_t)both.values.size();
+   }
+   else
+   {
+      const RoaringContainer & bitmap = (lhs.kind == BITMAP ? lhs : rhs);
+      const RoaringContainer & other  = (lhs.kind == BITMAP ? rhs : lhs);
+      both.kind = BITMAP;
+      both.words = bitmap.words;
+      if (other.kind == BITMAP)
+         for (size_t w = 0; w < NUM_WORDS; w++)
+            both.words[w] |= other.words[w];
+      else
+         for (auto x : other.values)
+            both.words[x >> 6] |= bit(x);
+      both._recount();
+   }
+   both.fit();
+   return both;
+}
+
+/*********************************************
+ * ROARING CONTAINER :: INTERSECT
+ * Only what is in both. Two bitmaps AND a word at a
+ * time; an array keeps what the other side has. Two
+ * arrays of very different sizes gallop through the
+ * bigger one rather than walking all of it
+ ********************************************/
+inline RoaringContainer RoaringContainer :: intersect(const RoaringContainer & lhsAny, const RoaringContainer & rhsAny)
+{
+   RoaringContainer scratchL, scratchR, both;
+   const RoaringContainer & lhs = lhsAny._noRuns(scratchL);
+   const RoaringContainer & rhs = rhsAny._noRuns(scratchR);
+
+   if (lhs.kind == BITMAP && rhs.kind == BITMAP)
+   {
+      both.kind = BITMAP;
+      both.words = lhs.words;
+      for (size_t w = 0; w < NUM_WORDS; w++)
+         both.words[w] &= rhs.words[w];
+      both._recount();
+   }
+   else if (lhs.kind == BITMAP || rhs.kind == BITMAP)
+   {
+      const RoaringContainer & bitmap = (lhs.kind == BITMAP ? lhs : rhs);
+      const RoaringContainer & array  = (lhs.kind == BITMAP ? rhs : lhs);
+      for (auto x : array.values)
+         if (bitmap.words[x >> 6] & bit(x))
+            both.values.push_back(x);
+      both.cardinality = (uint32_t)both.values.size();
+   }
+   else
+   {
+      const std::vector<uint16_t> & small = (lhs.values.size() <= rhs.values.size() ? lhs.values : rhs.values);
+      const std::vector<uint16_t> & large = (lhs.values.size() <= rhs.values.size() ? rhs.values : lhs.values);
+      if (small.size() * 32 < large.size())
+      {
+         auto itFrom = large.begin();
+         for (auto x : small)
+         {
+            itFrom = std::lower_bound(itFrom, large.end(), x);
+            if (itFrom == large.end())
+               break;
+            if (*itFrom == x)
+               both.values.push_back(x);
+         }
+      }
+      else
+      {
+         // a merge that steps whichever side is behind, without a branch,
+         // into a buffer on the stack since most answers are short
+         uint16_t common[ARRAY_MAX];
+         size_t iS = 0;
+         size_t iL = 0;
+         size_t num = 0;
+         while (iS < small.size() && iL < large.size())
+         {
+            uint16_t xS = small[iS];
+            uint16_t xL = large[iL];
+            common[num] = xS;
+            num += (xS == xL);
+            iS  += (xS <= xL);
+            iL  += (xL <= xS);
+         }
+         both.values.assign(common, common + num);
+      }
+      both.cardinality = (uint32_t)both.values.size();
+   }
+   both.fit();
+   return both;
+}
+
+/*********************************************
+ * ROARING CONTAINER :: SUBTRACT
+ * What is on the left but not the right
+ ********************************************/
+inline RoaringContainer RoaringContainer :: subtract(const RoaringContainer & lhsAny, const RoaringContainer & rhsAny)
+{
+   RoaringContainer scratchL, scratchR, both;
+   const RoaringContainer & lhs = lhsAny._noRuns(scratchL);
+   const RoaringContainer & rhs = rhsAny._noRuns(scratchR);
+
+   if (lhs.kind == BITMAP)
+   {
+      both.kind = BITMAP;
+      both.words = lhs.words;
+      if (rhs.kind == BITMAP)
+         for (size_t w = 0; w < NUM_WORDS; w++)
+            both.words[w] &= ~rhs.words[w];
+      else
+         for (auto x : rhs.values)
+            both.words[x >> 6] &= ~bit(x);
+      both._recount();
+   }
+   else
+   {
+      if (rhs.kind == BITMAP)
+      {
+         for (auto x : lhs.values)
+            if (!(rhs.words[x >> 6] & bit(x)))
+               both.values.push_back(x);
+      }
+      else
+         std::set_difference(lhs.values.begin(), lhs.values.end(),
+                             rhs.values.begin(), rhs.values.end(),
+                             std::back_inserter(both.values));
+      both.cardinality = (uint32_t)both.values.size();
+   }
+   both.fit();
+   return both;
+}
+
+/*********************************************
+ *********************************************
+ *************** ROARING SET *****************
+ *********************************************
+ *********************************************/
+
+/*********************************************
+ * ROARING SET :: AT
+ * The first element at x or after in container i,
+ * or failing that the first of a later container
+ ********************************************/
+template <typename T>
+typename roaring_set <T> :: iterator roaring_set <T> :: _at(size_t i, uint32_t x) const
+{
+   for (; i < containers.size(); i++, x = 0)
+   {
+      uint32_t next = containers[i].next(x);
+      if (next != RoaringContainer::NONE)
+         return iterator(this, i, next);
+   }
+   return end();
+}
+
+/*********************************************
+ * ROARING SET :: FIND
+ ********************************************/
+template <typename T>
+typename roaring_set <T> :: iterator roaring_set <T> :: find(const T & t) const
+{
+   size_t i = _index(high(t));
+   if (i < highs.size() && highs[i] == high(t) && containers[i].contains(low(t)))
+      return iterator(this, i, low(t));
+   return end();
+}
+
+/*********************************************
+ * ROARING SET :: LOWER BOUND
+ ********************************************/
+template <typename T>
+typename roaring_set <T> :: iterator roaring_set <T> :: lower_bound(const T & t) const
+{
+   size_t i = _index(high(t));
+   if (i < highs.size() && highs[i] == high(t))
+      return _at(i, low(t));
+   return _at(i, 0);
+}
+
+/*********************************************
+ * ROARING SET :: INSERT
+ * Into the container for the high half, made as an
+ * empty array if there is none yet
+ ********************************************/
+template <typename T>
+std::pair<typename roaring_set <T> :: iterator, bool> roaring_set <T> :: insert(const T & t)
+{
+   uint16_t h = high(t);
+   size_t i = _index(h);
+   if (i == highs.size() || highs[i] != h)
+   {
+      highs.insert(highs.begin() + i, h);
+      containers.insert(containers.begin() + i, RoaringContainer());
+   }
+   bool isNew = containers[i].insert(low(t));
+   numElements += isNew;
+   return std::make_pair(iterator(this, i, low(t)), isNew);
+}
+
+/*********************************************
+ * ROARING SET :: ERASE
+ * Out of its container, and the container goes when
+ * it is empty. Returns the element after
+ ********************************************/
+template <typename T>
+size_t roaring_set <T> :: erase(const T & t)
+{
+   uint16_t h = high(t);
+   size_t i = _index(h);
+   if (i == highs.size() || highs[i] != h || !containers[i].erase(low(t)))
+      return 0;
+   numElements--;
+   if (containers[i].size() == 0)
+   {
+      highs.erase(highs.begin() + i);
+      containers.erase(containers.begin() + i);
+   }
+   return 1;
+}
+
+template <typename T>
+typename roaring_set <T> :: iterator roaring_set <T> :: erase(iterator it)
+{
+   if (it.isEnd)
+      return end();
+   T value = it.value;
+   erase(value);
+   return upper_bound(value);
+}
+
+/*********************************************
+ * ROARING SET :: UNION
+ * Walk the two lists of high halves together, the way
+ * a merge does, combining where they match
+ ********************************************/
+template <typename T>
+roaring_set <T> & roaring_set <T> :: operator |= (const roaring_set & rhs)
+{
+   if (this == &rhs)
+      return *this;
+   std::vector<uint16_t> highsNew;
+   std::vector<RoaringContainer> containersNew;
+   size_t iL = 0;
+   size_t iR = 0;
+   while (iL < highs.size() || iR < rhs.highs.size())
+   {
+      if (iR == rhs.highs.size() || (iL < highs.size() && highs[iL] < rhs.highs[iR]))
+      {
+         highsNew.push_back(highs[iL]);
+         containersNew.push_back(std::move(containers[iL++]));
+      }
+      else if (iL == highs.size() || rhs.highs[iR] < highs[iL])
+      {
+         highsNew.push_back(rhs.highs[iR]);
+         containersNew.push_back(rhs.containers[iR++]);
+      }
+      else
+      {
+         highsNew.push_back(highs[iL]);
+         containersNew.push_back(RoaringContainer::unite(containers[iL++], rhs.containers[iR++]));
+      }
+   }
+   highs.swap(highsNew);
+   containers.swap(containersNew);
+   _recount();
+   return *this;
+}
+
+/*********************************************
+ * ROARING SET :: INTERSECTION
+ * Only the high halves both have can have anything left,
+ * so build the answer from nothing rather than whittle
+ * down a copy
+ ********************************************/
+template <typename T>
+roaring_set <T> & roaring_set <T> :: operator &= (const roaring_set & rhs)
+{
+   if (this != &rhs)
+      *this = *this & rhs;
+   return *this;
+}
+
+template <typename T>
+roaring_set <T> operator & (const roaring_set <T> & lhs, const roaring_set <T> & rhs)
+{
+   roaring_set <T> both;
+   size_t iR = 0;
+   for (size_t iL = 0; iL < lhs.highs.size(); iL++)
+   {
+      while (iR < rhs.highs.size() && rhs.highs[iR] < lhs.highs[iL])
+         iR++;
+      if (iR == rhs.highs.size())
+         break;
+      if (rhs.highs[iR] != lhs.highs[iL])
+         continue;
+      RoaringContainer container = RoaringContainer::intersect(lhs.containers[iL], rhs.containers[iR]);
+      if (container.size())
+      {
+         both.highs.push_back(lhs.highs[iL]);
+         both.containers.push_back(std::move(container));
+      }
+   }
+   both._recount();
+   return both;
+}
+
+/*********************************************
+ * ROARING SET :: DIFFERENCE
+ * Each of our containers, less the matching one there
+ ********************************************/
+template <typename T>
+roaring_set <T> & roaring_set <T> :: operator -= (const roaring_set & rhs)
+{
+   if (this == &rhs)
+   {
+      clear();
+      return *this;
+   }
+   std::vector<uint16_t> highsNew;
+   std::vector<RoaringContainer> containersNew;
+   size_t iR = 0;
+   for (size_t iL = 0; iL < highs.size(); iL++)
+   {
+      while (iR < rhs.highs.size() && rhs.highs[iR] < highs[iL])
+         iR++;
+      if (iR < rhs.highs.size() && rhs.highs[iR] == highs[iL])
+      {
+         RoaringContainer rest = RoaringContainer::subtract(containers[iL], rhs.containers[iR]);
+         if (rest.size() == 0)
+            continue;
+         containers[iL] = std::move(rest);
+      }
+      highsNew.push_back(highs[iL]);
+      containersNew.push_back(std::move(containers[iL]));
+   }
+   highs.swap(highsNew);
+   containers.swap(containersNew);
+   _recount();
+   return *this;
+}
+
+/*********************************************
+ * ROARING SET : UNION and DIFFERENCE
+ * A copy of the left side, combined in place
+ ********************************************/
+template <typename T>
+inline roaring_set <T> operator | (const roaring_set <T> & lhs, const roaring_set <T> & rhs)
+{
+   roaring_set <T> either(lhs);
+   either |= rhs;
+   return either;
+}
+
+template <typename T>
+inline roaring_set <T> operator - (const roaring_set <T> & lhs, const roaring_set <T> & rhs)
+{
+   roaring_set <T> rest(lhs);
+   rest -= rhs;
+   return rest;
+}
+
+/*********************************************
+ * ROARING SET :: RECOUNT and BYTES
+ ********************************************/
+template <typename T>
+void roaring_set <T> :: _recount()
+{
+   numElements = 0;
+   for (auto & container : containers)
+      numElements += container.size();
+}
+
+template <typename T>
+size_t roaring_set <T> :: bytes() const noexcept
+{
+   size_t num = highs.capacity() * sizeof(uint16_t) +
+                containers.capacity() * sizeof(RoaringContainer);
+   for (auto & container : containers)
+      num += container.bytes();
+   return num;
+}
+
+/**************************************************
+ * ROARING SET ITERATOR :: DECREMENT PREFIX
+ * Back in this container, or to the last of an earlier
+ * one, or off the front
+ *************************************************/
+template <typename T>
+typename roaring_set <T> :: iterator & roaring_set <T> :: iterator :: operator -- ()
+{
+   if (isEnd)
+      return *this;
+   uint32_t x = low(value);
+   for (size_t j = i + 1; j-- > 0; x = RoaringContainer::NONE)
+   {
+      uint32_t prev = (x == 0 ? RoaringContainer::NONE : pSet->containers[j].last(x - 1));
+      if (prev != RoaringContainer::NONE)
+         return *this = iterator(pSet, j, prev);
+   }
+   return *this = pSet->end();
+}
+
+} // namespace custom
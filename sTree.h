@@ -0,0 +1,489 @@
+/***********************************************************************
+ * Header:
+ *    S TREE
+ * Summary:
+ *    A static search tree over a frozen set of ints. It is a B-tree
+ *    whose nodes are exactly one cache line of 16 sorted keys, laid
+ *    out in one array so that the children of node k are nodes
+ *    17k+1 ... 17k+17 and no pointers are stored. Searching a node is
+ *    a handful of vector compares and a movemask instead of a binary
+ *    search, and the tree is only log17(n) nodes tall. Which vector
+ *    instructions to use (AVX2, SSE2 or none) is decided once, at run
+ *    time, by asking the CPU
+ *
+ *    This will contain the class definition of:
+ *        STree               : A class that represents a static search tree
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#include <climits>    // for INT_MAX
+#include <cstddef>    // for size_t
+#include <cstdint>    // for uintptr_t
+#include <new>        // for operator new
+#include <utility>    // for std::swap
+#include "set.h"      // for custom::set, which we are built from
+#include "bitOps.h"   // for lowestBit
+
+// SSE2 is always there on x86-64, and on 32-bit x86 only when the compiler says so
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define STREE_X86
+#include <immintrin.h> // for the SSE2 and AVX2 intrinsics
+#ifdef _MSC_VER
+#include <intrin.h>    // for __cpuid and _xgetbv
+#endif
+#endif
+
+// GCC and Clang only emit AVX2 in functions that ask for it; MSVC always can
+#if defined(STREE_X86) && (defined(__GNUC__) || defined(__clang__))
+#define STREE_AVX2 __attribute__((target("avx2")))
+#else
+#define STREE_AVX2
+#endif
+
+class TestSTree;      // forward declaration for unit tests
+
+namespace custom
+{
+
+/************************************************
+ * S TREE
+ * Every node is full: the last ones are padded out with
+ * INT_MAX, which sorts after every key we could be asked
+ * about. lower_bound never stops on the padding because
+ * anything greater than the largest element is turned
+ * away before the search starts
+ ***********************************************/
+class STree
+{
+   friend class ::TestSTree; // give unit tests access to the privates
+public:
+   // the instructions used to search a node
+   enum Simd { SCALAR, SSE2, AVX2 };
+
+   //
+   // Construct. Walks the set once, in order
+   //
+
+   STree() : numElements(0), numNodes(0), largest(0), pBuffer(nullptr), nodes(nullptr), simd(SCALAR) { }
+   template <typename Balance, typename Alloc>
+   explicit STree(const set<int, Balance, Alloc> & s);
+   STree(const STree & rhs);
+   STree(STree && rhs) : STree() { swap(rhs); }
+   ~STree() { ::operator delete(pBuffer); }
+
+   //
+   // Assign
+   //
+
+   STree & operator = (const STree & rhs)
+   {
+      STree copy(rhs);
+      swap(copy);
+      return *this;
+   }
+   STree & operator = (STree && rhs)
+   {
+      swap(rhs);
+      return *this;
+   }
+   void swap(STree & rhs) noexcept
+   {
+      std::swap(numElements, rhs.numElements);
+      std::swap(numNodes,    rhs.numNodes);
+      std::swap(largest,     rhs.largest);
+      std::swap(pBuffer,     rhs.pBuffer);
+      std::swap(nodes,       rhs.nodes);
+      std::swap(simd,        rhs.simd);
+   }
+
+   //
+   // Access. Lower bound is a pointer to the first element not
+   // less than key, or nullptr when there is none. The batch
+   // versions run several searches side by side so that their
+   // cache misses overlap, filling in one answer per key
+   //
+
+   const int * lower_bound(int key) const;
+   bool contains(int key) const
+   {
+      const int * p = lower_bound(key);
+      return p && *p == key;
+   }
+   void   lower_bound(const int * keys, size_t num, const int * * results) const;
+   size_t contains   (const int * keys, size_t num, bool * found) const;
+
+   //
+   // Status
+   //
+
+   bool   empty()   const noexcept { return (numElements == 0); }
+   size_t size()    const noexcept { return numElements;        }
+   size_t height()  const noexcept;
+   Simd   simdUsed() const noexcept { return simd;              }
+
+   // search with no better than this, say to compare them. What
+   // the machine can do is still the limit
+   void useSimd(Simd level) noexcept { simd = (level < detect() ? level : detect()); }
+
+private:
+
+   static const size_t KEYS  = 16;   // keys in a node, one cache line of ints
+   static const size_t GROUP = 8;    // searches a batch runs side by side
+
+   static size_t child(size_t k, size_t i) { return k * (KEYS + 1) + i + 1; }
+   static Simd detect();
+
+   template <class Iterator>
+   void _build(Iterator & it, size_t & numPlaced, size_t k);
+   void _allocate(size_t num);
+
+   // count the keys in a node less than key, one way per instruction set
+   static unsigned int rankScalar(const int * node, int key);
+#ifdef STREE_X86
+   static unsigned int rankSse2(const int * node, int key);
+   STREE_AVX2 static unsigned int rankAvx2(const int * node, int key);
+   STREE_AVX2 const int * _lowerBoundAvx2(int key) const;
+   STREE_AVX2 void _lowerBoundAvx2(const int * keys, size_t num, const int * * results) const;
+#endif
+   template <unsigned int (*rank)(const int *, int)>
+   const int * _lowerBound(int key) const;
+   template <unsigned int (*rank)(const int *, int)>
+   void _lowerBound(const int * keys, size_t num, const int * * results) const;
+
+   size_t numElements;        // keys in the tree, not counting the padding
+   size_t numNodes;           // nodes of KEYS keys each
+   int largest;               // the last element, when there is one
+   void * pBuffer;            // what was allocated, before alignment
+   int * nodes;               // node k is nodes[KEYS * k ... KEYS * k + KEYS - 1]
+   Simd simd;                 // how this machine searches a node
+};
+
+/*********************************************
+ * S TREE :: CONSTRUCTOR
+ * Fill the nodes with an in-order walk of the implicit
+ * tree, taking the elements of the set as they come
+ ********************************************/
+template <typename Balance, typename Alloc>
+STree :: STree(const set<int, Balance, Alloc> & s) : STree()
+{
+   simd = detect();
+   _allocate((s.size() + KEYS - 1) / KEYS);
+   numElements = s.size();
+   auto it = s.begin();
+   size_t numPlaced = 0;
+   _build(it, numPlaced, 0);
+}
+
+/*********************************************
+ * S TREE :: COPY CONSTRUCTOR
+ ********************************************/
+inline STree :: STree(const STree & rhs) : STree()
+{
+   _allocate(rhs.numNodes);
+   for (size_t i = 0; i < numNodes * KEYS; i++)
+      nodes[i] = rhs.nodes[i];
+   numElements = rhs.numElements;
+   largest = rhs.largest;
+   simd = rhs.simd;
+}
+
+/*********************************************
+ * S TREE :: BUILD
+ * Before each key of a node come all the keys of the
+ * child to its left
+ ********************************************/
+template <class Iterator>
+void STree :: _build(Iterator & it, size_t & numPlaced, size_t k)
+{
+   if (k >= numNodes)
+      return;
+   for (size_t i = 0; i < KEYS; i++)
+   {
+      _build(it, numPlaced, child(k, i));
+      if (numPlaced < numElements)
+      {
+         largest = nodes[k * KEYS + i] = *it;
+         ++it;
+         numPlaced++;
+      }
+      else
+         nodes[k * KEYS + i] = INT_MAX;
+   }
+   _build(it, numPlaced, child(k, KEYS));
+}
+
+/*********************************************
+ * S TREE :: ALLOCATE
+ * Room for num nodes, each on its own cache line
+ ********************************************/
+inline void STree :: _allocate(size_t num)
+{
+   if (num == 0)
+      return;
+   pBuffer = ::operator new(num * KEYS * sizeof(int) + 63);
+   nodes = (int *)(((uintptr_t)pBuffer + 63) & ~(uintptr_t)63);
+   numNodes = num;
+}
+
+/*********************************************
+ * S TREE :: HEIGHT
+ * Nodes on the way down the leftmost path
+ ********************************************/
+inline size_t STree :: height() const noexcept
+{
+   size_t levels = 0;
+   for (size_t k = 0; k < numNodes; k = child(k, 0))
+      levels++;
+   return levels;
+}
+
+/*********************************************
+ * S TREE :: DETECT
+ * Ask the CPU, once, what it can do. AVX2 also needs
+ * the operating system to save the YMM registers, which
+ * __builtin_cpu_supports checks for us and MSVC has to
+ * check with XGETBV
+ ********************************************/
+inline STree :: Simd STree :: detect()
+{
+#if defined(STREE_X86) && defined(_MSC_VER)
+   static const Simd level = []()
+   {
+      int info[4];
+      __cpuid(info, 0);
+      if (info[0] >= 7)
+      {
+         __cpuid(info, 1);
+         bool osSaves = (info[2] & (1 << 27)) != 0;
+         __cpuidex(info, 7, 0);
+         bool hasAvx2 = (info[1] & (1 << 5)) != 0;
+         if (hasAvx2 && osSaves && (_xgetbv(0) & 6) == 6)
+            return AVX2;
+      }
+      return SSE2;
+   }();
+   return level;
+#elif defined(STREE_X86)
+   static const Simd level = []()
+   {
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2") ? AVX2 : SSE2;
+   }();
+   return level;
+#else
+   return SCALAR;
+#endif
+}
+
+/*********************************************
+ * S TREE :: RANK
+ * How many of the 16 keys of a node are less than key,
+ * which, with the keys sorted, is where key would go.
+ * The keys less than key are a run at the front, so the
+ * compare mask is a run of ones and its length is where
+ * the first zero is
+ ********************************************/
+inline unsigned int STree :: rankScalar(const int * node, int key)
+{
+   unsigned int rank = 0;
+   for (size_t i = 0; i < KEYS; i++)
+      rank += (node[i] < key);
+   return rank;
+}
+
+#ifdef STREE_X86
+// four compares of four keys each
+inline unsigned int STree :: rankSse2(const int * node, int key)
+{
+   __m128i x = _mm_set1_epi32(key);
+   unsigned int mask = 0;
+   for (size_t i = 0; i < KEYS; i += 4)
+   {
+      __m128i keys = _mm_load_si128((const __m128i *)(node + i));
+      __m128i less = _mm_cmpgt_epi32(x, keys);
+      mask |= (unsigned int)_mm_movemask_ps(_mm_castsi128_ps(less)) << i;
+   }
+   return lowestBit(~(uint64_t)mask);
+}
+
+// two compares of eight keys each
+STREE_AVX2 inline unsigned int STree :: rankAvx2(const int * node, int key)
+{
+   __m256i x = _mm256_set1_epi32(key);
+   __m256i lo = _mm256_load_si256((const __m256i *)node);
+   __m256i hi = _mm256_load_si256((const __m256i *)(node + 8));
+   unsigned int maskLo = (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(x, lo)));
+   unsigned int maskHi = (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(x, hi)));
+   return lowestBit(~(uint64_t)(maskLo | (maskHi << 8)));
+}
+#endif // STREE_X86
+
+/*********************************************
+ * S TREE :: LOWER BOUND
+ * Descend from the root, remembering the last key we
+ * stopped in front of. That is the answer when we fall
+ * off the bottom
+ ********************************************/
+template <unsigned int (*rank)(const int *, int)>
+const int * STree :: _lowerBound(int key) const
+{
+   const int * pBound = nullptr;
+   for (size_t k = 0; k < numNodes; )
+   {
+      const int * node = nodes + k * KEYS;
+      unsigned int i = rank(node, key);
+      if (i < KEYS)
+         pBound = node + i;
+      k = child(k, i);
+   }
+   return pBound;
+}
+
+inline const int * STree :: lower_bound(int key) const
+{
+   if (numElements == 0 || key > largest)
+      return nullptr;
+   switch (simd)
+   {
+#ifdef STREE_X86
+      case AVX2:
+         return _lowerBoundAvx2(key);
+      case SSE2:
+         return _lowerBound<rankSse2>(key);
+#endif
+      default:
+         return _lowerBound<rankScalar>(key);
+   }
+}
+
+#ifdef STREE_X86
+// the same, compiled for AVX2 so that rankAvx2 is inlined
+STREE_AVX2 inline const int * STree :: _lowerBoundAvx2(int key) const
+{
+   const int * pBound = nullptr;
+   for (size_t k = 0; k < numNodes; )
+   {
+      const int * node = nodes + k * KEYS;
+      unsigned int i = rankAvx2(node, key);
+      if (i < KEYS)
+         pBound = node + i;
+      k = child(k, i);
+   }
+   return pBound;
+}
+#endif // STREE_X86
+
+/*********************************************
+ * S TREE :: LOWER BOUND BATCH
+ * GROUP searches at a time, a level at a time, so the
+ * loads for one do not wait on the compares of another
+ ********************************************/
+template <unsigned int (*rank)(const int *, int)>
+void STree :: _lowerBound(const int * keys, size_t num, const int * * results) const
+{
+   for (size_t iFirst = 0; iFirst < num; iFirst += GROUP)
+   {
+      size_t numLanes = (num - iFirst < GROUP ? num - iFirst : GROUP);
+      size_t k[GROUP];
+      for (size_t j = 0; j < numLanes; j++)
+      {
+         k[j] = 0;
+         results[iFirst + j] = nullptr;
+      }
+      for (bool isMore = true; isMore; )
+      {
+         isMore = false;
+         for (size_t j = 0; j < numLanes; j++)
+            if (k[j] < numNodes)
+            {
+               const int * node = nodes + k[j] * KEYS;
+               unsigned int i = rank(node, keys[iFirst + j]);
+               if (i < KEYS)
+                  results[iFirst + j] = node + i;
+               k[j] = child(k[j], i);
+               isMore = true;
+            }
+      }
+   }
+}
+
+inline void STree :: lower_bound(const int * keys, size_t num, const int * * results) const
+{
+   switch (simd)
+   {
+#ifdef STREE_X86
+      case AVX2:
+         _lowerBoundAvx2(keys, num, results);
+         break;
+      case SSE2:
+         _lowerBound<rankSse2>(keys, num, results);
+         break;
+#endif
+      default:
+         _lowerBound<rankScalar>(keys, num, results);
+         break;
+   }
+
+   // the searches never look at largest, so turn away what is past it here
+   for (size_t i = 0; i < num; i++)
+      if (numElements == 0 || keys[i] > largest)
+         results[i] = nullptr;
+}
+
+#ifdef STREE_X86
+// the same, compiled for AVX2 so that rankAvx2 is inlined
+STREE_AVX2 inline void STree :: _lowerBoundAvx2(const int * keys, size_t num, const int * * results) const
+{
+   for (size_t iFirst = 0; iFirst < num; iFirst += GROUP)
+   {
+      size_t numLanes = (num - iFirst < GROUP ? num - iFirst : GROUP);
+      size_t k[GROUP];
+      for (size_t j = 0; j < numLanes; j++)
+      {
+         k[j] = 0;
+         results[iFirst + j] = nullptr;
+      }
+      for (bool isMore = true; isMore; )
+      {
+         isMore = false;
+         for (size_t j = 0; j < numLanes; j++)
+            if (k[j] < numNodes)
+            {
+               const int * node = nodes + k[j] * KEYS;
+               unsigned int i = rankAvx2(node, keys[iFirst + j]);
+               if (i < KEYS)
+                  results[iFirst + j] = node + i;
+               k[j] = child(k[j], i);
+               isMore = true;
+            }
+      }
+   }
+}
+#endif // STREE_X86
+
+/*********************************************
+ * S TREE :: CONTAINS BATCH
+ * Which of the keys are in the tree, and how many
+ ********************************************/
+inline size_t STree :: contains(const int * keys, size_t num, bool * found) const
+{
+   const size_t CHUNK = 64;
+   const int * results[CHUNK];
+   size_t numFound = 0;
+   for (size_t iFirst = 0; iFirst < num; iFirst += CHUNK)
+   {
+      size_t numChunk = (num - iFirst < CHUNK ? num - iFirst : CHUNK);
+      lower_bound(keys + iFirst, numChunk, results);
+      for (size_t j = 0; j < numChunk; j++)
+      {
+         found[iFirst + j] = results[j] && *results[j] == keys[iFirst + j];
+         numFound += found[iFirst + j];
+      }
+   }
+   return numFound;
+}
+
+} // namespace custom
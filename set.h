@@ -21,19 +21,95 @@
 #include <cassert>
 #include <iostream>
 #include "bst.h"
-#include <memory>     // for std::allocator
+#include "btree.h"
+#include "bplustree.h"
+#include "skipList.h"
+#include "art.h"
+#include "veb.h"
+#include "bitset.h"
+#include "compactTree.h"
+#include "frozenSet.h"
+#include "bloomFilter.h"
+#include <memory>     // for std::allocator and std::unique_ptr
 #include <functional> // for std::less
+#include <vector>     // for std::vector
+
+// std::pmr is C++17, and only where the library has it
+#if defined(__has_include)
+#if __has_include(<memory_resource>) && (__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L))
+#include <memory_resource> // for std::pmr::polymorphic_allocator
+#define SET_HAS_PMR
+#endif
+#endif
 
 class TestSet;        // forward declaration for unit tests
 
 namespace custom
 {
 
+/************************************************
+ * SET STORAGE
+ * What holds the elements of a set. A balancing policy
+ * from balance.h means a BST balanced that way; an engine
+ * tag picks another structure altogether. Only a BST takes
+ * its memory from Alloc
+ ***********************************************/
+template <typename T, typename Balance, typename Alloc>
+struct SetStorage
+{
+   typedef BST<T, Balance, Alloc> type;
+};
+
+template <typename T, size_t numLines, typename Alloc>
+struct SetStorage <T, BTreeEngine<numLines>, Alloc>
+{
+   typedef BTree<T, numLines> type;
+};
+
+template <typename T, size_t numLines, typename Alloc>
+struct SetStorage <T, BPlusTreeEngine<numLines>, Alloc>
+{
+   typedef BPlusTree<T, numLines> type;
+};
+
+template <typename T, unsigned int oneIn, typename Alloc>
+struct SetStorage <T, SkipListEngine<oneIn>, Alloc>
+{
+   typedef SkipList<T, oneIn> type;
+};
+
+template <typename T, typename Alloc>
+struct SetStorage <T, ArtEngine, Alloc>
+{
+   typedef ART<T> type;
+};
+
+template <typename T, unsigned int universeBits, typename Alloc>
+struct SetStorage <T, VebEngine<universeBits>, Alloc>
+{
+   typedef VEB<T, universeBits> type;
+};
+
+template <typename T, unsigned int universeBits, typename Alloc>
+struct SetStorage <T, BitsetEngine<universeBits>, Alloc>
+{
+   typedef Bitset<T, universeBits> type;
+};
+
+template <typename T, typename Alloc>
+struct SetStorage <T, CompactEngine, Alloc>
+{
+   typedef CompactTree<T> type;
+};
+
 /************************************************
  * SET
- * A class that represents a Set
+ * A class that represents a Set. Balance picks how the
+ * underlying BST keeps itself balanced (see balance.h),
+ * or names another engine to hold the elements instead.
+ * Alloc makes the nodes of the BST
  ***********************************************/
-template<typename T>
+template<typename T, typename Balance = RedBlack, typename Alloc = std::allocator<T>>
 class set
 {
    friend class ::TestSet; // give unit tests access to the privates
@@ -43,8 +119,10 @@ public:
    // Construct
    //
    set() = default;
-   set(const set & rhs) : bst(rhs.bst)       {}
-   set(set && rhs) : bst(std::move(rhs.bst)) {}
+   explicit set(const Alloc & alloc) : bst(alloc) {}
+   set(const set & rhs) : bst(rhs.bst),
+      pBloom(rhs.pBloom ? new BloomFilter(*rhs.pBloom) : nullptr) {}
+   set(set && rhs) : bst(std::move(rhs.bst)), pBloom(std::move(rhs.pBloom)) {}
    set(const std::initializer_list<T> & il)
    {
       for (auto & element: il)
@@ -65,24 +143,26 @@ public:
    set & operator=(const set & rhs)
    {
       this->bst = rhs.bst;
+      pBloom.reset(rhs.pBloom ? new BloomFilter(*rhs.pBloom) : nullptr);
       return *this;
    }
    set & operator=(set && rhs)
    {
-      bst.clear();
-      bst.swap(rhs.bst);
+      bst = std::move(rhs.bst);
+      pBloom = std::move(rhs.pBloom);
       return *this;
    }
    set & operator=(const std::initializer_list<T> & il)
    {
-      bst.clear();
+      clear();
       for (auto & element: il)
-         bst.insert(element);
+         insert(element);
       return *this;
    }
    void swap(set & rhs) noexcept
    {
       std::swap(bst, rhs.bst);
+      pBloom.swap(rhs.pBloom);
    }
 
    //
@@ -105,8 +185,26 @@ public:
    //
    iterator find(const T & t)
    {
+      if (pBloom)
+         return _findFiltered(t);
       return iterator(bst.find(t));
    }
+   iterator lower_bound(const T & t)
+   {
+      return iterator(bst.lower_bound(t));
+   }
+   iterator lower_bound(const T & t) const
+   {
+      return iterator(bst.lower_bound(t));
+   }
+   iterator upper_bound(const T & t)
+   {
+      return iterator(bst.upper_bound(t));
+   }
+   iterator upper_bound(const T & t) const
+   {
+      return iterator(bst.upper_bound(t));
+   }
 
    //
    // Status
@@ -116,22 +214,34 @@ public:
    {
       return bst.size();
    }
+   size_t rotations() const noexcept
+   {
+      return bst.rotations();
+   }
+   Alloc get_allocator() const
+   {
+      return bst.get_allocator();
+   }
 
    //
    // Insert
    //
    std::pair<iterator, bool> insert(const T & t)
    {
+      if (pBloom)
+         _bloomAdd(t);
       return bst.insert(t, true);
    }
    std::pair<iterator, bool> insert(T && t)
    {
+      if (pBloom)
+         _bloomAdd(t);
       return bst.insert(t, true);
    }
    void insert(const std::initializer_list<T> & il)
    {
       for (auto & element: il)
-         bst.insert(element, true);
+         insert(element);
    }
    template<class Iterator>
    void insert(Iterator first, Iterator last)
@@ -146,9 +256,13 @@ public:
    void clear() noexcept
    {
       bst.clear();
+      if (pBloom)
+         pBloom->reset(0);
    }
    iterator erase(iterator & it)
    {
+      if (pBloom)
+         pBloom->erased();
       return iterator(bst.erase(it.it));
    }
    size_t erase(const T & t)
@@ -167,46 +281,150 @@ public:
       return itEnd;
    }
 
+   //
+   // Set algebra (Bitset only). Union, intersection and
+   // difference in place, a word of elements at a time
+   //
+   set & operator|=(const set & rhs)
+   {
+      bst |= rhs.bst;
+      _bloomInvalidate();
+      return *this;
+   }
+   set & operator&=(const set & rhs)
+   {
+      bst &= rhs.bst;
+      _bloomInvalidate();
+      return *this;
+   }
+   set & operator-=(const set & rhs)
+   {
+      bst -= rhs.bst;
+      _bloomInvalidate();
+      return *this;
+   }
+
+   //
+   // Freeze. A snapshot for searching that later changes
+   // to the set do not touch
+   //
+   frozen_set<T> freeze() const
+   {
+      std::vector<T> sorted;
+      sorted.reserve(size());
+      for (auto it = begin(); it != end(); ++it)
+         sorted.push_back(*it);
+      return frozen_set<T>(sorted.begin(), sorted.end());
+   }
+
+   //
+   // Relayout (BST only). All the nodes in one block, in van
+   // Emde Boas order. Worth doing after a bulk load
+   //
+   void relayout_veb()
+   {
+      bst.relayout_veb();
+   }
+
+   //
+   // Arena (BST only). The nodes come from chunks the set owns,
+   // and clear() gives them all back at once. Worth it for a
+   // big set that lives only as long as one request
+   //
+   void use_arena()
+   {
+      bst.use_arena();
+   }
+
+   //
+   // Split and Join (Treap only)
+   //
+   set split(const T & t)
+   {
+      set rest(get_allocator());
+      rest.bst = bst.split(t);
+      _bloomInvalidate();
+      return rest;
+   }
+   static set join(set & lhs, set & rhs)
+   {
+      set both(lhs.get_allocator());
+      both.bst = Storage::join(lhs.bst, rhs.bst);
+      return both;
+   }
+
+   //
+   // Bloom filter. Off unless asked for. Once on, find() can
+   // answer end() for most absent elements from one cache
+   // line, without walking the tree. It is kept up on insert,
+   // and rebuilt on the next find() after enough erases
+   //
+   void use_bloom_filter(size_t bitsPerElement = 10)
+   {
+      static_assert(BloomHash<T>::usable, "a Bloom filter needs std::hash of the elements");
+      pBloom.reset(new BloomFilter(bitsPerElement));
+      _bloomRebuild();
+   }
+   bool has_bloom_filter() const noexcept { return pBloom != nullptr; }
+   double bloom_false_positive_rate() const noexcept
+   {
+      return pBloom ? pBloom->false_positive_rate() : 0.0;
+   }
+
 private:
 
-   custom::BST<T> bst;
+   // the filter starts out room for twice what is there, or this many
+   static const size_t BLOOM_MIN_CAPACITY = 64;
+
+   iterator _findFiltered(const T & t);
+   void _bloomAdd(const T & t);
+   void _bloomRebuild();
+   void _bloomInvalidate()
+   {
+      if (pBloom)
+         pBloom->invalidate();
+   }
+
+   typedef typename SetStorage<T, Balance, Alloc>::type Storage;
+   Storage bst;               // the elements, in a BST unless Balance says otherwise
+   std::unique_ptr<BloomFilter> pBloom;  // in front of find(), when it is on
 };
 
 /**************************************************
  * SET ITERATOR
  * An iterator through Set
  *************************************************/
-template<typename T>
-class set<T>::iterator
+template<typename T, typename Balance, typename Alloc>
+class set<T, Balance, Alloc>::iterator
 {
    friend class ::TestSet; // give unit tests access to the privates
-   friend class custom::set<T>;
+   friend class custom::set<T, Balance, Alloc>;
 
 public:
    // constructors, destructors, and assignment operator
-   iterator() : it(nullptr)
+   iterator() : it()
    {
 
    }
-   iterator(const typename custom::BST<T>::iterator & itRHS)
+   iterator(const typename Storage::iterator & itRHS)
    {
       it = itRHS;
    }
    iterator(const iterator & rhs) : it(rhs.it) {}
    iterator & operator=(const iterator & rhs)
    {
-      this->it.pNode = rhs.it.pNode;
+      this->it = rhs.it;
       return *this;
    }
 
    // equals, not equals operator
    bool operator!=(const iterator & rhs) const
    {
-      return (it.pNode != rhs.it.pNode);
+      return (it != rhs.it);
    }
    bool operator==(const iterator & rhs) const
    {
-      return (it.pNode == rhs.it.pNode);
+      return !(it != rhs.it);
    }
 
    // dereference operator: by-reference so we can modify the Set
@@ -245,21 +463,73 @@ public:
 
 private:
 
-   typename custom::BST<T>::iterator it;
+   typename Storage::iterator it;
 };
 
+/***********************************************
+ * SET : FIND FILTERED
+ * Ask the filter first. A "no" is certain, so the tree
+ * is left alone; a "maybe" that the tree does not bear
+ * out counts against the filter
+ ***********************************************/
+template<typename T, typename Balance, typename Alloc>
+typename set<T, Balance, Alloc>::iterator set<T, Balance, Alloc>::_findFiltered(const T & t)
+{
+   if (pBloom->needsRebuild())
+      _bloomRebuild();
+   if (!pBloom->mayContain(BloomHash<T>::of(t)))
+   {
+      pBloom->countNegative();
+      return end();
+   }
+   auto it = bst.find(t);
+   if (it == bst.end())
+      pBloom->countFalsePositive();
+   return iterator(it);
+}
+
+/***********************************************
+ * SET : BLOOM ADD
+ * Once the filter has all it was sized for, rebuild it
+ * twice as big rather than let it fill up. Adding what is
+ * already there only sets bits that are already set
+ ***********************************************/
+template<typename T, typename Balance, typename Alloc>
+void set<T, Balance, Alloc>::_bloomAdd(const T & t)
+{
+   if (pBloom->full())
+      _bloomRebuild();
+   pBloom->add(BloomHash<T>::of(t));
+}
+
+/***********************************************
+ * SET : BLOOM REBUILD
+ * Start over from what is in the set now, with room
+ * for twice as many
+ ***********************************************/
+template<typename T, typename Balance, typename Alloc>
+void set<T, Balance, Alloc>::_bloomRebuild()
+{
+   size_t capacity = size() * 2;
+   if (capacity < BLOOM_MIN_CAPACITY)
+      capacity = BLOOM_MIN_CAPACITY;
+   pBloom->reset(capacity);
+   for (auto it = bst.begin(); it != bst.end(); ++it)
+      pBloom->add(BloomHash<T>::of(*it));
+}
+
 /***********************************************
  * SET : EQUIVALENCE
  * See if two sets are the same size
  ***********************************************/
-template<typename T>
-bool operator==(const set<T> & lhs, const set<T> & rhs)
+template<typename T, typename Balance, typename Alloc>
+bool operator==(const set<T, Balance, Alloc> & lhs, const set<T, Balance, Alloc> & rhs)
 {
    return true;
 }
 
-template<typename T>
-inline bool operator!=(const set<T> & lhs, const set<T> & rhs)
+template<typename T, typename Balance, typename Alloc>
+inline bool operator!=(const set<T, Balance, Alloc> & lhs, const set<T, Balance, Alloc> & rhs)
 {
    return true;
 }
@@ -268,18 +538,33 @@ inline bool operator!=(const set<T> & lhs, const set<T> & rhs)
  * SET : RELATIVE COMPARISON
  * See if one set is lexicographically before the second
  ***********************************************/
-template<typename T>
-bool operator<(const set<T> & lhs, const set<T> & rhs)
+template<typename T, typename Balance, typename Alloc>
+bool operator<(const set<T, Balance, Alloc> & lhs, const set<T, Balance, Alloc> & rhs)
 {
    return true;
 }
 
-template<typename T>
-inline bool operator>(const set<T> & lhs, const set<T> & rhs)
+template<typename T, typename Balance, typename Alloc>
+inline bool operator>(const set<T, Balance, Alloc> & lhs, const set<T, Balance, Alloc> & rhs)
 {
    return true;
 }
 
+#ifdef SET_HAS_PMR
+namespace pmr
+{
+
+/************************************************
+ * PMR SET
+ * A set whose nodes come from a memory resource, such as
+ * a monotonic_buffer_resource that lives for one request
+ ***********************************************/
+template <typename T, typename Balance = RedBlack>
+using set = custom::set<T, Balance, std::pmr::polymorphic_allocator<T>>;
+
+} // namespace pmr
+#endif // SET_HAS_PMR
+
 }; // namespace custom
 
 
@@ -0,0 +1,457 @@
+/***********************************************************************
+ * Header:
+ *    SKIP LIST
+ * Summary:
+ *    A skip list to hold the elements of a set. Each node stands in a
+ *    tower of random height, and the towers let a search skip over
+ *    runs of the list. Nothing is ever rebalanced: an insert links a
+ *    node in and an erase links it out
+ *
+ *    This will contain the class definition of:
+ *        SkipList            : A class that represents a skip list
+ *        SkipList::iterator  : An iterator through SkipList
+ *        SkipListEngine      : Pick SkipList as the engine behind a set
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>    // for size_t
+#include <cstdint>    // for uint64_t
+#include <new>        // for placement new
+#include <utility>    // for std::pair and std::move
+#include <initializer_list>
+
+class TestSkipList;   // forward declaration for unit tests
+
+namespace custom
+{
+
+/*****************************************************************
+ * SKIP LIST ENGINE
+ * Name this as the second parameter of a set to keep its elements
+ * in a SkipList where a node climbs to the next level one time in
+ * oneIn:
+ *       custom::set <int, custom::SkipListEngine<>>
+ *****************************************************************/
+template <unsigned int oneIn = 4>
+struct SkipListEngine { };
+
+/*****************************************************************
+ * SKIP LIST
+ * Level 0 links every node in order, and each level above links
+ * about 1/oneIn of the nodes of the level below. Smaller oneIn
+ * means taller towers, fewer steps per search, and more links
+ *****************************************************************/
+template <typename T, unsigned int oneIn = 4>
+class SkipList
+{
+   friend class ::TestSkipList; // give unit tests access to the privates
+public:
+   //
+   // Construct
+   //
+
+   SkipList() : numElements(0), numLevels(0), seed(0x9E3779B97F4A7C15ull) { _reset(); }
+   SkipList(const SkipList &  rhs) : SkipList() { *this = rhs;            }
+   SkipList(      SkipList && rhs) : SkipList() { *this = std::move(rhs); }
+   SkipList(const std::initializer_list<T> & il) : SkipList()
+   {
+      for (auto & element : il)
+         insert(element);
+   }
+   ~SkipList() { clear(); }
+
+   //
+   // Assign
+   //
+
+   SkipList & operator = (const SkipList &  rhs);
+   SkipList & operator = (      SkipList && rhs);
+   SkipList & operator = (const std::initializer_list<T> & il);
+   void swap(SkipList & rhs) noexcept;
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   iterator begin() const noexcept { return iterator(head[0]); }
+   iterator end()   const noexcept { return iterator();        }
+
+   //
+   // Access
+   //
+
+   iterator find(const T & t) const;
+
+   //
+   // Insert
+   //
+
+   std::pair<iterator, bool> insert(const T &  t, bool keepUnique = false);
+   std::pair<iterator, bool> insert(      T && t, bool keepUnique = false);
+
+   //
+   // Remove
+   //
+
+   iterator erase(iterator & it);
+   void clear() noexcept;
+
+   //
+   // Status
+   //
+
+   bool   empty()  const noexcept { return (numElements == 0); }
+   size_t size()   const noexcept { return numElements;        }
+   size_t height() const noexcept { return numLevels;          }
+
+private:
+
+   static const size_t MAX_LEVELS = 32;
+
+   struct Node;
+
+   Node * head[MAX_LEVELS];   // the first node on each level
+   size_t numElements;        // number of elements currently in the list
+   size_t numLevels;          // levels with at least one node on them
+   uint64_t seed;             // for picking tower heights
+
+   size_t randomLevels();
+   static Node * _newNode(size_t levels, const T &  t);
+   static Node * _newNode(size_t levels,       T && t);
+   static void _deleteNode(Node * pNode);
+   Node * _predecessors(const T & t, Node * * update) const;
+   Node * & link(Node * pPrev, size_t i) { return (pPrev ? pPrev->next[i] : head[i]); }
+   void _reset() noexcept
+   {
+      for (size_t i = 0; i < MAX_LEVELS; i++)
+         head[i] = nullptr;
+      numElements = 0;
+      numLevels = 0;
+   }
+
+   template <class U>
+   std::pair<iterator, bool> _insert(U && t, bool keepUnique);
+};
+
+/*****************************************************************
+ * SKIP LIST NODE
+ * The data, a link back, and the tower of links forward. The tower
+ * is allocated with the node, so next[] runs past its declared end
+ *****************************************************************/
+template <typename T, unsigned int oneIn>
+struct SkipList <T, oneIn> :: Node
+{
+   Node(const T &  t) : data(t),            pPrev(nullptr), numLevels(0) { }
+   Node(      T && t) : data(std::move(t)), pPrev(nullptr), numLevels(0) { }
+
+   T data;                    // Actual data stored in the Node
+   Node * pPrev;              // the one before on level 0
+   size_t numLevels;          // the height of the tower
+   Node * next[1];            // the one after on each level of the tower
+};
+
+/**********************************************************
+ * SKIP LIST ITERATOR
+ * Walks level 0 forward and back
+ *********************************************************/
+template <typename T, unsigned int oneIn>
+class SkipList <T, oneIn> :: iterator
+{
+   friend class ::TestSkipList; // give unit tests access to the privates
+   friend class SkipList <T, oneIn>;
+public:
+   // constructors and assignment
+   iterator(Node * p = nullptr) : pNode(p)       { }
+
+   // compare
+   bool operator == (const iterator & rhs) const { return (pNode == rhs.pNode);                    }
+   bool operator != (const iterator & rhs) const { return (pNode != rhs.pNode);                    }
+
+   // de-reference. Cannot change because it will invalidate the SkipList
+   const T & operator * () const                 { return pNode->data;                             }
+
+   // increment and decrement
+   iterator & operator ++ ()                     { if (pNode) pNode = pNode->next[0]; return *this; }
+   iterator   operator ++ (int postfix)          { iterator itOld(*this); ++*this; return itOld;    }
+   iterator & operator -- ()                     { if (pNode) pNode = pNode->pPrev;   return *this; }
+   iterator   operator -- (int postfix)          { iterator itOld(*this); --*this; return itOld;    }
+
+private:
+
+   Node * pNode;              // the node, nullptr for end()
+};
+
+/*********************************************
+ *********************************************
+ **************** SKIP LIST ******************
+ *********************************************
+ *********************************************/
+
+/*********************************************
+ * SKIP LIST :: ASSIGNMENT OPERATOR
+ * Copy one list to another, tower for tower
+ ********************************************/
+template <typename T, unsigned int oneIn>
+SkipList <T, oneIn> & SkipList <T, oneIn> :: operator = (const SkipList & rhs)
+{
+   if (this == &rhs)
+      return *this;
+   clear();
+
+   // the last node we added on each level
+   Node * tail[MAX_LEVELS] = {};
+   Node * pPrev = nullptr;
+   for (Node * pSrc = rhs.head[0]; pSrc; pSrc = pSrc->next[0])
+   {
+      Node * pNode = _newNode(pSrc->numLevels, pSrc->data);
+      pNode->pPrev = pPrev;
+      for (size_t i = 0; i < pNode->numLevels; i++)
+      {
+         link(tail[i], i) = pNode;
+         tail[i] = pNode;
+      }
+      pPrev = pNode;
+   }
+   numElements = rhs.numElements;
+   numLevels = rhs.numLevels;
+   return *this;
+}
+
+/*********************************************
+ * SKIP LIST :: MOVE ASSIGNMENT
+ * Steal the nodes from another list
+ ********************************************/
+template <typename T, unsigned int oneIn>
+SkipList <T, oneIn> & SkipList <T, oneIn> :: operator = (SkipList && rhs)
+{
+   clear();
+   swap(rhs);
+   return *this;
+}
+
+/*********************************************
+ * SKIP LIST :: ASSIGNMENT with INITIALIZATION LIST
+ ********************************************/
+template <typename T, unsigned int oneIn>
+SkipList <T, oneIn> & SkipList <T, oneIn> :: operator = (const std::initializer_list<T> & il)
+{
+   clear();
+   for (auto & element : il)
+      insert(element);
+   return *this;
+}
+
+/*********************************************
+ * SKIP LIST :: SWAP
+ * No node points back at the head, so swapping the
+ * heads swaps the lists
+ ********************************************/
+template <typename T, unsigned int oneIn>
+void SkipList <T, oneIn> :: swap(SkipList & rhs) noexcept
+{
+   for (size_t i = 0; i < MAX_LEVELS; i++)
+      std::swap(head[i], rhs.head[i]);
+   std::swap(numElements, rhs.numElements);
+   std::swap(numLevels,   rhs.numLevels);
+   std::swap(seed,        rhs.seed);
+}
+
+/*********************************************
+ * SKIP LIST :: CLEAR
+ * Level 0 has every node on it
+ ********************************************/
+template <typename T, unsigned int oneIn>
+void SkipList <T, oneIn> :: clear() noexcept
+{
+   Node * pNode = head[0];
+   while (pNode)
+   {
+      Node * pNext = pNode->next[0];
+      _deleteNode(pNode);
+      pNode = pNext;
+   }
+   _reset();
+}
+
+/*********************************************
+ * SKIP LIST :: RANDOM LEVELS
+ * One level, plus one more each time a 1 in oneIn
+ * chance comes up
+ ********************************************/
+template <typename T, unsigned int oneIn>
+size_t SkipList <T, oneIn> :: randomLevels()
+{
+   size_t levels = 1;
+   while (levels < MAX_LEVELS)
+   {
+      // xorshift64*
+      seed ^= seed >> 12;
+      seed ^= seed << 25;
+      seed ^= seed >> 27;
+      if ((seed * 0x2545F4914F6CDD1Dull >> 32) % oneIn != 0)
+         break;
+      levels++;
+   }
+   return levels;
+}
+
+/*********************************************
+ * SKIP LIST :: NEW NODE and DELETE NODE
+ * The node and its tower in one allocation
+ ********************************************/
+template <typename T, unsigned int oneIn>
+typename SkipList <T, oneIn> :: Node * SkipList <T, oneIn> :: _newNode(size_t levels, const T & t)
+{
+   void * p = ::operator new(sizeof(Node) + (levels - 1) * sizeof(Node *));
+   Node * pNode = new (p) Node(t);
+   pNode->numLevels = levels;
+   for (size_t i = 0; i < levels; i++)
+      pNode->next[i] = nullptr;
+   return pNode;
+}
+
+template <typename T, unsigned int oneIn>
+typename SkipList <T, oneIn> :: Node * SkipList <T, oneIn> :: _newNode(size_t levels, T && t)
+{
+   void * p = ::operator new(sizeof(Node) + (levels - 1) * sizeof(Node *));
+   Node * pNode = new (p) Node(std::move(t));
+   pNode->numLevels = levels;
+   for (size_t i = 0; i < levels; i++)
+      pNode->next[i] = nullptr;
+   return pNode;
+}
+
+template <typename T, unsigned int oneIn>
+void SkipList <T, oneIn> :: _deleteNode(Node * pNode)
+{
+   pNode->~Node();
+   ::operator delete(pNode);
+}
+
+/*********************************************
+ * SKIP LIST :: PREDECESSORS
+ * Return the first node not less than t. On the way,
+ * update[i] gets the last node before it on level i,
+ * or nullptr when that is the head
+ ********************************************/
+template <typename T, unsigned int oneIn>
+typename SkipList <T, oneIn> :: Node * SkipList <T, oneIn> :: _predecessors(const T & t, Node * * update) const
+{
+   Node * pPrev = nullptr;
+   for (size_t i = numLevels; i-- > 0; )
+   {
+      Node * pNext = (pPrev ? pPrev->next[i] : head[i]);
+      while (pNext && pNext->data < t)
+      {
+         pPrev = pNext;
+         pNext = pNext->next[i];
+      }
+      if (update)
+         update[i] = pPrev;
+   }
+   return (pPrev ? pPrev->next[0] : head[0]);
+}
+
+/*********************************************
+ * SKIP LIST :: FIND
+ * Return the iterator to the element if it exists,
+ * otherwise end()
+ ********************************************/
+template <typename T, unsigned int oneIn>
+typename SkipList <T, oneIn> :: iterator SkipList <T, oneIn> :: find(const T & t) const
+{
+   Node * pNode = _predecessors(t, nullptr);
+   if (pNode && pNode->data == t)
+      return iterator(pNode);
+   return end();
+}
+
+/*********************************************
+ * SKIP LIST :: INSERT
+ * Insert a new element into the list
+ ********************************************/
+template <typename T, unsigned int oneIn>
+std::pair<typename SkipList <T, oneIn> :: iterator, bool> SkipList <T, oneIn> :: insert(const T & t, bool keepUnique)
+{
+   return _insert(t, keepUnique);
+}
+
+template <typename T, unsigned int oneIn>
+std::pair<typename SkipList <T, oneIn> :: iterator, bool> SkipList <T, oneIn> :: insert(T && t, bool keepUnique)
+{
+   return _insert(std::move(t), keepUnique);
+}
+
+/*********************************************
+ * SKIP LIST :: _INSERT
+ * Find the links on each level that should lead to the
+ * new node, then point them at it
+ ********************************************/
+template <typename T, unsigned int oneIn>
+template <class U>
+std::pair<typename SkipList <T, oneIn> :: iterator, bool> SkipList <T, oneIn> :: _insert(U && t, bool keepUnique)
+{
+   Node * update[MAX_LEVELS];
+   Node * pFound = _predecessors(t, update);
+   if (keepUnique && pFound && pFound->data == t)
+      return std::make_pair(iterator(pFound), false);
+
+   size_t levels = randomLevels();
+   for (; numLevels < levels; numLevels++)
+      update[numLevels] = nullptr;
+
+   Node * pNode = _newNode(levels, std::forward<U>(t));
+   for (size_t i = 0; i < levels; i++)
+   {
+      pNode->next[i] = link(update[i], i);
+      link(update[i], i) = pNode;
+   }
+
+   pNode->pPrev = update[0];
+   if (pNode->next[0])
+      pNode->next[0]->pPrev = pNode;
+
+   numElements++;
+   return std::make_pair(iterator(pNode), true);
+}
+
+/*********************************************
+ * SKIP LIST :: ERASE
+ * Unlink the node from every level of its tower
+ ********************************************/
+template <typename T, unsigned int oneIn>
+typename SkipList <T, oneIn> :: iterator SkipList <T, oneIn> :: erase(iterator & it)
+{
+   Node * pDelete = it.pNode;
+   if (pDelete == nullptr)
+      return end();
+   iterator itNext(pDelete->next[0]);
+
+   // on each level of the tower, step past any equal nodes
+   // to the one that points at this very node
+   Node * update[MAX_LEVELS];
+   _predecessors(pDelete->data, update);
+   for (size_t i = 0; i < pDelete->numLevels; i++)
+   {
+      Node * pPrev = update[i];
+      while (link(pPrev, i) != pDelete)
+         pPrev = link(pPrev, i);
+      link(pPrev, i) = pDelete->next[i];
+   }
+   if (pDelete->next[0])
+      pDelete->next[0]->pPrev = pDelete->pPrev;
+
+   while (numLevels > 0 && head[numLevels - 1] == nullptr)
+      numLevels--;
+
+   _deleteNode(pDelete);
+   numElements--;
+   return itNext;
+}
+
+} // namespace custom
@@ -0,0 +1,77 @@
+/***********************************************************************
+ * Header:
+ *    TAGGED POINTER
+ * Summary:
+ *    A pointer that carries one bit of its owner's in its lowest bit.
+ *    Anything aligned to two bytes or more has that bit zero in every
+ *    address, so it is free to use. The trees keep a node's
+ *    red-black color there, in its link to the parent, and so do
+ *    without a word for it of their own
+ *
+ *    This will contain the class definition of:
+ *        TaggedPtr           : A pointer with one spare bit
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#include <cstdint>    // for uintptr_t
+
+namespace custom
+{
+
+/************************************************
+ * TAGGED PTR
+ * Reads and writes as a plain Node *. The bit is only
+ * seen through tag() and setTag(), and it stays where
+ * it is when a new pointer is assigned: it belongs to
+ * whatever holds the pointer, not to what it points to
+ ***********************************************/
+template <class Node>
+class TaggedPtr
+{
+public:
+   TaggedPtr(Node * p = nullptr) noexcept : bits((uintptr_t)p) { }
+
+   //
+   // Assign. Only the pointer; the tag stays
+   //
+
+   TaggedPtr & operator = (Node * p) noexcept
+   {
+      bits = (uintptr_t)p | (bits & TAG);
+      return *this;
+   }
+   TaggedPtr & operator = (const TaggedPtr & rhs) noexcept
+   {
+      return *this = rhs.get();
+   }
+
+   //
+   // Access
+   //
+
+   Node * get()         const noexcept { return (Node *)(bits & ~TAG); }
+   operator Node * ()   const noexcept { return get(); }
+   Node * operator -> () const noexcept { return get(); }
+   Node & operator * () const noexcept { return *get(); }
+
+   //
+   // Tag
+   //
+
+   bool tag() const noexcept { return (bits & TAG) != 0; }
+   void setTag(bool isSet) noexcept
+   {
+      static_assert(alignof(Node) >= 2, "the lowest bit of the address must be free");
+      bits = (bits & ~TAG) | (isSet ? TAG : 0);
+   }
+
+private:
+   static const uintptr_t TAG = 1;
+
+   uintptr_t bits;    // the pointer, with the tag in its lowest bit
+};
+
+} // namespace custom
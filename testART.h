@@ -0,0 +1,325 @@
+/***********************************************************************
+ * Header:
+ *    TEST ART
+ * Summary:
+ *    Unit tests for art
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "art.h"
+#include "unitTest.h"
+
+#include <string>
+
+/***********************************************
+ * TEST ART
+ * Unit tests for the ART class
+ ***********************************************/
+class TestART : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Key
+      test_key_signedOrder();
+
+      // Construct
+      test_construct_default();
+      test_constructCopy_standard();
+
+      // Insert
+      test_insert_empty();
+      test_insert_duplicate();
+      test_insert_grow();
+      test_insert_prefixSplit();
+      test_insert_prefixOfAnother();
+
+      // Find
+      test_find_standard();
+      test_find_missing();
+
+      // Iterator
+      test_iterator_negative();
+      test_iterator_decrement();
+
+      // Remove
+      test_erase_shrink();
+      test_erase_collapse();
+      test_erase_every();
+
+      report("ART");
+   }
+
+   typedef custom::ART <int> IntTree;
+   typedef custom::ART <std::string> StringTree;
+
+   /***************************************
+    * KEY
+    ***************************************/
+
+   // byte by byte, the order is that of the integers
+   void test_key_signedOrder()
+   {  // setup
+      typedef custom::ArtKey <int> Key;
+      // exercise and verify
+      assertUnit(Key::size(0) == sizeof(int));
+      assertUnit(Key::at(-1, 0) < Key::at(0, 0));
+      assertUnit(Key::at(0, 0) == 0x80);
+      assertUnit(Key::at(0x01020304, 3) == 0x04);
+      assertUnit(Key::at(0x01020304, 2) == 0x03);
+   }  // teardown
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // default constructor
+   void test_construct_default()
+   {  // setup
+      // exercise
+      IntTree tree;
+      // verify
+      assertUnit(tree.root == nullptr);
+      assertUnit(tree.numElements == 0);
+      assertUnit(tree.begin() == tree.end());
+   }  // teardown
+
+   // copy has its own nodes, in the same order
+   void test_constructCopy_standard()
+   {  // setup
+      StringTree treeSrc{ "apple", "app", "banana", "band", "bandana" };
+      // exercise
+      StringTree treeDest(treeSrc);
+      // verify
+      assertUnit(treeDest.size() == 5);
+      assertUnit(treeDest.root != treeSrc.root);
+      auto itSrc = treeSrc.begin();
+      for (auto it = treeDest.begin(); it != treeDest.end(); ++it, ++itSrc)
+      {
+         assertUnit(it.pLeaf != itSrc.pLeaf);
+         assertUnit(*it == *itSrc);
+      }
+      assertUnit(itSrc == treeSrc.end());
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // the first element is a lone leaf
+   void test_insert_empty()
+   {  // setup
+      IntTree tree;
+      // exercise
+      auto result = tree.insert(50);
+      // verify
+      assertUnit(result.second == true);
+      assertUnit(*result.first == 50);
+      assertUnit(tree.root != nullptr);
+      assertUnit(tree.root && tree.root->type == IntTree::LEAF);
+   }  // teardown
+
+   // something already there stays as it is
+   void test_insert_duplicate()
+   {  // setup
+      StringTree tree{ "app", "apple" };
+      // exercise
+      auto result = tree.insert(std::string("app"));
+      // verify
+      assertUnit(result.second == false);
+      assertUnit(*result.first == "app");
+      assertUnit(tree.size() == 2);
+   }  // teardown
+
+   // a node moves up through the sizes as children arrive
+   void test_insert_grow()
+   {  // setup
+      IntTree tree;
+      // exercise and verify
+      for (int i = 0; i < 256; i++)
+      {
+         tree.insert(i);
+         auto type = tree.root->type;
+         if (i == 1)
+            assertUnit(type == IntTree::NODE4);
+         if (i == 4)
+            assertUnit(type == IntTree::NODE16);
+         if (i == 16)
+            assertUnit(type == IntTree::NODE48);
+         if (i == 48)
+            assertUnit(type == IntTree::NODE256);
+      }
+      // the three high bytes are all 0x80 0x00 0x00
+      auto pRoot = static_cast<IntTree::Inner *>(tree.root);
+      assertUnit(pRoot->prefix == std::string("\x80\x00\x00", 3));
+      assertUnit(tree.height() == 2);
+   }  // teardown
+
+   // a key that leaves a prefix part way splits it
+   void test_insert_prefixSplit()
+   {  // setup
+      StringTree tree{ "romane", "romanus" };
+      auto pOld = static_cast<StringTree::Inner *>(tree.root);
+      assertUnit(pOld->prefix == "roman");
+      // exercise
+      tree.insert(std::string("rubens"));
+      // verify
+      auto pRoot = static_cast<StringTree::Inner *>(tree.root);
+      assertUnit(pRoot->prefix == "r");
+      assertUnit(pRoot->numChildren == 2);
+      assertUnit(pOld->prefix == "man");
+      assertUnit(pOld->pParent == pRoot);
+      assertUnit(pOld->byte == 'o');
+      assertUnit(tree.find("romane") != tree.end());
+      assertUnit(tree.find("rubens") != tree.end());
+   }  // teardown
+
+   // a key that ends where another goes on sits in the end slot
+   void test_insert_prefixOfAnother()
+   {  // setup
+      StringTree tree;
+      // exercise
+      tree.insert(std::string("band"));
+      tree.insert(std::string("ban"));
+      tree.insert(std::string(""));
+      // verify
+      assertUnit(tree.size() == 3);
+      auto pRoot = static_cast<StringTree::Inner *>(tree.root);
+      assertUnit(pRoot->pEnd != nullptr && pRoot->pEnd->data == "");
+      auto it = tree.begin();
+      assertUnit(*it == "");
+      assertUnit(*++it == "ban");
+      assertUnit(*++it == "band");
+      assertUnit(++it == tree.end());
+   }  // teardown
+
+   /***************************************
+    * FIND
+    ***************************************/
+
+   // every element is found
+   void test_find_standard()
+   {  // setup
+      IntTree tree;
+      for (int i = 0; i < 1000; i++)
+         tree.insert((i * 7919) % 100000);
+      // exercise and verify
+      for (int i = 0; i < 1000; i++)
+      {
+         auto it = tree.find((i * 7919) % 100000);
+         assertUnit(it != tree.end() && *it == (i * 7919) % 100000);
+      }
+   }  // teardown
+
+   // nothing else is, including prefixes and extensions of what is there
+   void test_find_missing()
+   {  // setup
+      StringTree tree{ "app", "apple", "banana" };
+      // exercise and verify
+      assertUnit(tree.find("ap") == tree.end());
+      assertUnit(tree.find("appl") == tree.end());
+      assertUnit(tree.find("apples") == tree.end());
+      assertUnit(tree.find("bananas") == tree.end());
+      assertUnit(tree.find("") == tree.end());
+   }  // teardown
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // negative numbers come first
+   void test_iterator_negative()
+   {  // setup
+      IntTree tree{ 5, -5, 0, -1000000, 1000000, -1 };
+      // exercise and verify
+      int expected[] = { -1000000, -5, -1, 0, 5, 1000000 };
+      size_t i = 0;
+      for (auto it = tree.begin(); it != tree.end(); ++it, i++)
+         assertUnit(*it == expected[i]);
+      assertUnit(i == 6);
+   }  // teardown
+
+   // walk back from the largest to the smallest
+   void test_iterator_decrement()
+   {  // setup
+      StringTree tree{ "a", "ab", "abc", "b", "ba", "" };
+      auto it = tree.find("ba");
+      // exercise
+      std::string expected[] = { "ba", "b", "abc", "ab", "a", "" };
+      size_t i = 0;
+      for (; it != tree.end(); --it, i++)
+         assertUnit(*it == expected[i]);
+      // verify
+      assertUnit(i == 6);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // a node moves down through the sizes as children leave
+   void test_erase_shrink()
+   {  // setup
+      IntTree tree;
+      for (int i = 0; i < 256; i++)
+         tree.insert(i);
+      // exercise and verify
+      for (int i = 255; i > 1; i--)
+      {
+         auto it = tree.find(i);
+         tree.erase(it);
+         auto type = tree.root->type;
+         if (i == 37)
+            assertUnit(type == IntTree::NODE48);
+         if (i == 12)
+            assertUnit(type == IntTree::NODE16);
+         if (i == 3)
+            assertUnit(type == IntTree::NODE4);
+      }
+      assertUnit(tree.size() == 2);
+   }  // teardown
+
+   // a node left with one child gives way to it
+   void test_erase_collapse()
+   {  // setup
+      StringTree tree{ "romane", "romanus", "rubens" };
+      auto it = tree.find("rubens");
+      // exercise
+      auto itNext = tree.erase(it);
+      // verify
+      assertUnit(itNext == tree.end());
+      auto pRoot = static_cast<StringTree::Inner *>(tree.root);
+      assertUnit(pRoot->prefix == "roman");
+      assertUnit(pRoot->pParent == nullptr);
+      assertUnit(tree.height() == 2);
+      assertUnit(tree.find("romanus") != tree.end());
+   }  // teardown
+
+   // erase everything, and the tree is gone
+   void test_erase_every()
+   {  // setup
+      IntTree tree;
+      for (int i = 0; i < 1000; i++)
+         tree.insert(i * 37);
+      // exercise
+      for (int i = 0; i < 1000; i++)
+      {
+         auto it = tree.find(((i * 7) % 1000) * 37);
+         assertUnit(it != tree.end());
+         tree.erase(it);
+      }
+      // verify
+      assertUnit(tree.size() == 0);
+      assertUnit(tree.root == nullptr);
+      assertUnit(tree.begin() == tree.end());
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,345 @@
+/***********************************************************************
+ * Header:
+ *    TEST B+ TREE
+ * Summary:
+ *    Unit tests for bplustree
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "bplustree.h"
+#include "unitTest.h"
+
+/***********************************************
+ * TEST B+ TREE
+ * Unit tests for the BPlusTree class. These use one cache
+ * line per node so a few hundred elements make a deep tree
+ ***********************************************/
+class TestBPlusTree : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_constructCopy_standard();
+
+      // Insert
+      test_insert_empty();
+      test_insert_duplicate();
+      test_insert_ascending();
+      test_insert_descending();
+
+      // Find
+      test_find_standard();
+      test_find_missing();
+
+      // Iterator
+      test_iterator_leavesLinked();
+      test_iterator_decrement();
+
+      // Remove
+      test_erase_one();
+      test_erase_every();
+      test_erase_returnsNext();
+
+      report("BPlusTree");
+   }
+
+   typedef custom::BPlusTree <int, 1> Tree;
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // default constructor
+   void test_construct_default()
+   {  // setup
+      // exercise
+      Tree tree;
+      // verify
+      assertUnit(tree.root == nullptr);
+      assertUnit(tree.numElements == 0);
+      assertUnit(tree.begin() == tree.end());
+   }  // teardown
+
+   // copy makes new leaves, linked the same way
+   void test_constructCopy_standard()
+   {  // setup
+      Tree treeSrc;
+      for (int i = 0; i < 500; i++)
+         treeSrc.insert(i * 3, true);
+      // exercise
+      Tree treeDest(treeSrc);
+      // verify
+      assertUnit(treeDest.size() == 500);
+      assertUnit(treeDest.root != treeSrc.root);
+      assertUnit(isValid(treeDest));
+      auto itSrc = treeSrc.begin();
+      for (auto it = treeDest.begin(); it != treeDest.end(); ++it, ++itSrc)
+      {
+         assertUnit(it.pLeaf != itSrc.pLeaf);
+         assertUnit(*it == *itSrc);
+      }
+      assertUnit(itSrc == treeSrc.end());
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // the first insert makes a leaf root
+   void test_insert_empty()
+   {  // setup
+      Tree tree;
+      // exercise
+      auto result = tree.insert(50, true);
+      // verify
+      assertUnit(result.second == true);
+      assertUnit(*result.first == 50);
+      assertUnit(tree.size() == 1);
+      assertUnit(tree.root != nullptr);
+      if (tree.root)
+      {
+         assertUnit(tree.root->isLeaf);
+         assertUnit(tree.root->numKeys == 1);
+      }
+   }  // teardown
+
+   // a unique insert of something already there changes nothing,
+   // even when a copy of it steers the search in an inner node
+   void test_insert_duplicate()
+   {  // setup
+      Tree tree;
+      for (int i = 0; i < 100; i++)
+         tree.insert(i, true);
+      // exercise and verify
+      for (int i = 0; i < 100; i++)
+      {
+         auto result = tree.insert(i, true);
+         assertUnit(result.second == false);
+         assertUnit(*result.first == i);
+      }
+      assertUnit(tree.size() == 100);
+   }  // teardown
+
+   // ascending inserts split the rightmost leaf over and over
+   void test_insert_ascending()
+   {  // setup
+      Tree tree;
+      // exercise
+      for (int i = 0; i < 1000; i++)
+      {
+         auto result = tree.insert(i, true);
+         assertUnit(result.second && *result.first == i);
+      }
+      // verify
+      assertUnit(tree.size() == 1000);
+      assertUnit(tree.height() > 1);
+      assertUnit(tree.height() <= 4);
+      assertUnit(isValid(tree));
+      int expected = 0;
+      for (auto it = tree.begin(); it != tree.end(); ++it)
+         assertUnit(*it == expected++);
+      assertUnit(expected == 1000);
+   }  // teardown
+
+   // descending inserts split the leftmost leaf over and over
+   void test_insert_descending()
+   {  // setup
+      Tree tree;
+      // exercise
+      for (int i = 999; i >= 0; i--)
+      {
+         auto result = tree.insert(i, true);
+         assertUnit(result.second && *result.first == i);
+      }
+      // verify
+      assertUnit(tree.size() == 1000);
+      assertUnit(isValid(tree));
+      int expected = 0;
+      for (auto it = tree.begin(); it != tree.end(); ++it)
+         assertUnit(*it == expected++);
+   }  // teardown
+
+   /***************************************
+    * FIND
+    ***************************************/
+
+   // every key is found in a leaf
+   void test_find_standard()
+   {  // setup
+      Tree tree;
+      for (int i = 0; i < 1000; i++)
+         tree.insert((i * 7) % 1000, true);
+      // exercise and verify
+      for (int i = 0; i < 1000; i++)
+      {
+         auto it = tree.find(i);
+         assertUnit(it != tree.end() && *it == i);
+         assertUnit(it.pLeaf == nullptr || it.pLeaf->isLeaf);
+      }
+   }  // teardown
+
+   // keys between the ones there are not found
+   void test_find_missing()
+   {  // setup
+      Tree tree;
+      for (int i = 0; i < 500; i++)
+         tree.insert(i * 2, true);
+      // exercise and verify
+      for (int i = -1; i < 1000; i += 2)
+         assertUnit(tree.find(i) == tree.end());
+   }  // teardown
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // the leaves form a list that covers everything in order
+   void test_iterator_leavesLinked()
+   {  // setup
+      Tree tree;
+      for (int i = 0; i < 500; i++)
+         tree.insert(i, true);
+      auto itBegin = tree.begin();
+      // exercise
+      int expected = 0;
+      size_t numLeaves = 0;
+      const Tree::Leaf * pPrev = nullptr;
+      for (auto pLeaf = itBegin.pLeaf; pLeaf; pLeaf = pLeaf->pNext, numLeaves++)
+      {
+         assertUnit(pLeaf->pPrev == pPrev);
+         for (size_t i = 0; i < pLeaf->numKeys; i++)
+            assertUnit(pLeaf->keys[i] == expected++);
+         pPrev = pLeaf;
+      }
+      // verify
+      assertUnit(expected == 500);
+      assertUnit(numLeaves >= 500 / Tree::MAX_KEYS);
+   }  // teardown
+
+   // walk back from the largest to the smallest
+   void test_iterator_decrement()
+   {  // setup
+      Tree tree;
+      for (int i = 0; i < 500; i++)
+         tree.insert(i, true);
+      auto it = tree.find(499);
+      // exercise
+      int expected = 499;
+      for (; it != tree.end(); --it)
+         assertUnit(*it == expected--);
+      // verify
+      assertUnit(expected == -1);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // erase out of the middle of the tree
+   void test_erase_one()
+   {  // setup
+      Tree tree;
+      for (int i = 0; i < 500; i++)
+         tree.insert(i, true);
+      auto it = tree.find(250);
+      // exercise
+      auto itNext = tree.erase(it);
+      // verify
+      assertUnit(tree.size() == 499);
+      assertUnit(itNext != tree.end() && *itNext == 251);
+      assertUnit(tree.find(250) == tree.end());
+      assertUnit(isValid(tree));
+   }  // teardown
+
+   // erase everything, merging leaves and inner nodes along the way
+   void test_erase_every()
+   {  // setup
+      Tree tree;
+      for (int i = 0; i < 1000; i++)
+         tree.insert(i, true);
+      // exercise
+      for (int i = 0; i < 1000; i++)
+      {
+         auto it = tree.find((i * 7) % 1000);
+         tree.erase(it);
+         if (i % 100 == 0)
+            assertUnit(isValid(tree));
+      }
+      // verify
+      assertUnit(tree.size() == 0);
+      assertUnit(tree.root == nullptr);
+      assertUnit(tree.begin() == tree.end());
+   }  // teardown
+
+   // erase walks the whole tree in order when fed its own return value
+   void test_erase_returnsNext()
+   {  // setup
+      Tree tree;
+      for (int i = 0; i < 500; i++)
+         tree.insert(i, true);
+      // exercise
+      int expected = 0;
+      for (auto it = tree.begin(); it != tree.end(); expected++)
+      {
+         assertUnit(*it == expected);
+         it = tree.erase(it);
+      }
+      // verify
+      assertUnit(expected == 500);
+      assertUnit(tree.empty());
+   }  // teardown
+
+   /*************************************************************
+    * IS VALID
+    * Every node but the root is at least half full, the keys are
+    * in order, the separators bound their children, the parent
+    * links are right, and the leaves line up
+    *************************************************************/
+   bool isValid(const Tree & tree)
+   {
+      int depthLeaf = -1;
+      return tree.root == nullptr ||
+             isValid(tree.root, nullptr, 0, depthLeaf);
+   }
+
+   bool isValid(const Tree::Node * pNode, const Tree::Inner * pParent,
+                int depth, int & depthLeaf)
+   {
+      if (pNode->pParent != pParent)
+         return false;
+      if (pParent && (pNode->numKeys < Tree::MIN_KEYS || pNode->numKeys > Tree::MAX_KEYS))
+         return false;
+      for (size_t i = 1; i < pNode->numKeys; i++)
+         if (!(pNode->keys[i - 1] < pNode->keys[i]))
+            return false;
+      if (pNode->isLeaf)
+      {
+         if (depthLeaf < 0)
+            depthLeaf = depth;
+         return depth == depthLeaf;
+      }
+      auto pInner = static_cast<const Tree::Inner *>(pNode);
+      for (size_t i = 0; i <= pNode->numKeys; i++)
+      {
+         const Tree::Node * pChild = pInner->children[i];
+         if (i > 0 && pChild->keys[0] < pNode->keys[i - 1])
+            return false;
+         if (i < pNode->numKeys && !(pChild->keys[pChild->numKeys - 1] < pNode->keys[i]))
+            return false;
+         if (!isValid(pChild, pInner, depth + 1, depthLeaf))
+            return false;
+      }
+      return true;
+   }
+};
+
+#endif // DEBUG
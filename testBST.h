@@ -20,6 +20,7 @@
 #include <iostream>
 #include <string>
 #include <functional> // for std::less and std::greater
+#include <cmath>      // for log2 and log
 
  /***********************************************
   * TEST BST
@@ -81,6 +82,8 @@ public:
       test_find_standardBegin();
       test_find_standardLast();
       test_find_standardMissing();
+      test_lowerBound_standardMissing();
+      test_upperBound_standardPresent();
 
       // Insert
       test_insert_oneLeft();
@@ -91,6 +94,8 @@ public:
       test_insertMove_oneRight();
       test_insertMove_duplicate();
       test_insertMove_keepUnique();
+      test_insert_rotate();
+      test_insert_ascendingBalanced();
 
       // Remove
       test_erase_empty();
@@ -98,9 +103,50 @@ public:
       test_erase_noChildren();
       test_erase_oneChild();
       test_erase_twoChildren();
+      test_erase_rebalance();
+
+      // Balancing policy
+      test_balance_unbalancedAscending();
+      test_balance_avlAscending();
+      test_balance_avlErase();
+      test_balance_splayInsert();
+      test_balance_splayFind();
+      test_balance_splayFindMissing();
+      test_balance_splayErase();
+      test_balance_treapAscending();
+      test_balance_treapErase();
+      test_balance_scapegoatAscending();
+      test_balance_scapegoatErase();
+      test_balance_scapegoatEraseFew();
+      test_balance_scapegoatNodeSize();
+      test_balance_redBlackNodeSize();
+      test_balance_redBlackColorInParent();
+
+      // Split and Join
+      test_split_treapMiddle();
+      test_split_treapEnds();
+      test_join_treap();
       test_clear_empty();
       test_clear_standard();
 
+      // Relayout
+      test_relayoutVeb_standard();
+      test_relayoutVeb_order();
+      test_relayoutVeb_erase();
+      test_relayoutVeb_split();
+
+      // Arena
+      test_useArena_standard();
+      test_useArena_clearTrivial();
+      test_useArena_clearSpy();
+      test_useArena_churn();
+      test_useArena_split();
+
+      // Allocator
+      test_alloc_nodes();
+      test_alloc_copyMove();
+      test_alloc_relayout();
+
       // Status
       test_empty_empty();
       test_empty_standard();
@@ -1777,6 +1823,60 @@ public:
       teardownStandardFixture(bst);
    }
 
+   // the first element not less than something missing is the one after
+   void test_lowerBound_standardMissing()
+   {  // setup
+      //                 50 
+      //          +-------+-------+
+      //         30              70  
+      //     +----+----+     +----+----+
+      //    20        40    60        80  
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      custom::BST<Spy>::iterator it;
+      Spy s(42);
+      Spy::reset();
+      // exercise
+      it = bst.lower_bound(s);
+      // verify
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(Spy::numLessthan() == 3);    // compare [50][30][40]
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(it.pNode == bst.root);
+      assertStandardFixture(bst);
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
+   // the first element greater than something there is the one after it
+   void test_upperBound_standardPresent()
+   {  // setup
+      //                 50 
+      //          +-------+-------+
+      //         30              70  
+      //     +----+----+     +----+----+
+      //    20        40    60        80  
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      custom::BST<Spy>::iterator it;
+      Spy s(60);
+      Spy::reset();
+      // exercise
+      it = bst.upper_bound(s);
+      // verify
+      assertUnit(Spy::numEquals() == 0);
+      assertUnit(Spy::numLessthan() == 3);    // compare [50][70][60]
+      assertUnit(Spy::numDestructor() == 0);
+      assertUnit(Spy::numAlloc() == 0);
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(it.pNode == bst.root->pRight);
+      assertStandardFixture(bst);
+      // teardown
+      teardownStandardFixture(bst);
+   }
+
 
 
    /***************************************
@@ -2240,6 +2340,829 @@ public:
    }
 
 
+   /***************************************
+    * Balance
+    *    BST::insert(const T &)
+    *    BST::erase(it)
+    ***************************************/
+
+   // three in a row to the right need a rotation
+   void test_insert_rotate()
+   {  // setup
+      //     (10b)
+      //        +----+
+      //           (20r)
+      custom::BST <int> bst;
+      bst.insert(10);
+      bst.insert(20);
+      // exercise
+      auto pairBST = bst.insert(30);
+      // verify
+      //           (20b)
+      //        +----+----+
+      //      (10r)     (30r)
+      assertUnit(pairBST.second == true);
+      assertUnit(bst.numElements == 3);
+      assertUnit(bst.root != nullptr);
+      if (bst.root && bst.root->pLeft && bst.root->pRight)
+      {
+         assertUnit(bst.root->data == 20);
+         assertUnit(bst.root->isRed() == false);
+         assertUnit(bst.root->pParent == nullptr);
+         assertUnit(bst.root->pLeft->data == 10);
+         assertUnit(bst.root->pLeft->isRed() == true);
+         assertUnit(bst.root->pLeft->pParent == bst.root);
+         assertUnit(bst.root->pRight->data == 30);
+         assertUnit(bst.root->pRight->isRed() == true);
+         assertUnit(bst.root->pRight->pParent == bst.root);
+      }
+      else
+         assertUnit(false);
+      assertUnit(redBlackHeight(bst.root) == 1);
+      assertUnit(bst.rotations() == 1);
+   }  // teardown
+
+   // insert a long run of increasing values. Should not make a linked list
+   void test_insert_ascendingBalanced()
+   {  // setup
+      custom::BST <int> bst;
+      const int num = 1000;
+      // exercise
+      for (int i = 0; i < num; i++)
+         bst.insert(i);
+      // verify
+      assertUnit(bst.size() == num);
+      assertUnit(redBlackHeight(bst.root) > 0);
+      assertUnit(bst.height() <= 2 * log2(num + 1));
+      int expected = 0;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+         assertUnit(*it == expected++);
+      assertUnit(expected == num);
+   }  // teardown
+
+   // erase every other value, then the rest. Stays balanced the whole way
+   void test_erase_rebalance()
+   {  // setup
+      custom::BST <int> bst;
+      const int num = 1000;
+      for (int i = 0; i < num; i++)
+         bst.insert(i);
+      // exercise
+      for (int i = 0; i < num; i += 2)
+      {
+         auto it = bst.find(i);
+         bst.erase(it);
+      }
+      // verify
+      assertUnit(bst.size() == num / 2);
+      assertUnit(redBlackHeight(bst.root) > 0);
+      assertUnit(bst.height() <= 2 * log2(num / 2 + 1));
+      int expected = 1;
+      for (auto it = bst.begin(); it != bst.end(); ++it, expected += 2)
+         assertUnit(*it == expected);
+      // exercise
+      for (int i = 1; i < num; i += 2)
+      {
+         auto it = bst.find(i);
+         bst.erase(it);
+         assertUnit(redBlackHeight(bst.root) >= 0);
+      }
+      // verify
+      assertUnit(bst.empty());
+      assertUnit(bst.root == nullptr);
+   }  // teardown
+
+   /***************************************
+    * Balancing policy
+    *    BST <T, Unbalanced>
+    *    BST <T, AVL>
+    ***************************************/
+
+   // no balancing: increasing values make a linked list
+   void test_balance_unbalancedAscending()
+   {  // setup
+      custom::BST <int, custom::Unbalanced> bst;
+      const int num = 100;
+      // exercise
+      for (int i = 0; i < num; i++)
+         bst.insert(i);
+      // verify
+      assertUnit(bst.size() == num);
+      assertUnit(bst.height() == num);
+      assertUnit(bst.rotations() == 0);
+      int expected = 0;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+         assertUnit(*it == expected++);
+      assertUnit(expected == num);
+   }  // teardown
+
+   // AVL: increasing values stay within 1.44 log(n+2)
+   void test_balance_avlAscending()
+   {  // setup
+      custom::BST <int, custom::AVL> bst;
+      const int num = 1000;
+      // exercise
+      for (int i = 0; i < num; i++)
+         bst.insert(i);
+      // verify
+      assertUnit(bst.size() == num);
+      assertUnit(avlHeight(bst.root) == (int)bst.height());
+      assertUnit(bst.height() <= 1.44 * log2(num + 2));
+      assertUnit(bst.rotations() > 0);
+      int expected = 0;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+         assertUnit(*it == expected++);
+      assertUnit(expected == num);
+   }  // teardown
+
+   // AVL: erase every other value, then the rest
+   void test_balance_avlErase()
+   {  // setup
+      custom::BST <int, custom::AVL> bst;
+      const int num = 1000;
+      for (int i = 0; i < num; i++)
+         bst.insert(i);
+      // exercise
+      for (int i = 0; i < num; i += 2)
+      {
+         auto it = bst.find(i);
+         bst.erase(it);
+      }
+      // verify
+      assertUnit(bst.size() == num / 2);
+      assertUnit(avlHeight(bst.root) == (int)bst.height());
+      assertUnit(bst.height() <= 1.44 * log2(num / 2 + 2));
+      int expected = 1;
+      for (auto it = bst.begin(); it != bst.end(); ++it, expected += 2)
+         assertUnit(*it == expected);
+      // exercise
+      for (int i = 1; i < num; i += 2)
+      {
+         auto it = bst.find(i);
+         bst.erase(it);
+         assertUnit(avlHeight(bst.root) >= 0);
+      }
+      // verify
+      assertUnit(bst.empty());
+      assertUnit(bst.root == nullptr);
+   }  // teardown
+
+   // Splay: the node we just inserted is the new root
+   void test_balance_splayInsert()
+   {  // setup
+      custom::BST <int, custom::Splay> bst;
+      // exercise
+      for (int i = 0; i < 100; i++)
+      {
+         auto pairBST = bst.insert((i * 37) % 100);
+         // verify
+         assertUnit(pairBST.second == true);
+         assertUnit(pairBST.first.pNode == bst.root);
+         assertUnit(bst.root->pParent == nullptr);
+      }
+      // verify
+      assertUnit(bst.size() == 100);
+      int expected = 0;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+         assertUnit(*it == expected++);
+      assertUnit(expected == 100);
+   }  // teardown
+
+   // Splay: find moves the node to the root, so the next find is one hop
+   void test_balance_splayFind()
+   {  // setup
+      custom::BST <int, custom::Splay> bst;
+      for (int i = 0; i < 100; i++)
+         bst.insert(i);
+      auto rotations = bst.rotations();
+      // exercise
+      auto it = bst.find(42);
+      // verify
+      assertUnit(it != bst.end());
+      assertUnit(it.pNode == bst.root);
+      assertUnit(bst.root->data == 42);
+      assertUnit(bst.rotations() > rotations);
+      // exercise
+      rotations = bst.rotations();
+      it = bst.find(42);
+      // verify
+      assertUnit(it.pNode == bst.root);
+      assertUnit(bst.rotations() == rotations);
+      assertUnit(bst.find(1000) == bst.end());
+      int expected = 0;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+         assertUnit(*it == expected++);
+      assertUnit(expected == 100);
+   }  // teardown
+
+   // Splay: a search that misses reshapes the tree too
+   void test_balance_splayFindMissing()
+   {  // setup
+      custom::BST <int, custom::Splay> bst;
+      for (int i = 0; i < 1000; i++)
+         bst.insert(i);
+      size_t height = bst.height();
+      assertUnit(height == 1000);
+      auto rotations = bst.rotations();
+      // exercise
+      assertUnit(bst.find(-1) == bst.end());
+      // verify
+      assertUnit(bst.root->data == 0);
+      assertUnit(bst.rotations() > rotations);
+      assertUnit(bst.height() <= height / 2 + 2);
+      // exercise
+      rotations = bst.rotations();
+      auto it = bst.lower_bound(10000);
+      // verify
+      assertUnit(it == bst.end());
+      assertUnit(bst.rotations() > rotations);
+      assertUnit(bst.root->data == 999);
+      // exercise
+      it = bst.upper_bound(-1);
+      // verify
+      assertUnit(it != bst.end() && *it == 0);
+      assertUnit(bst.root->data == 0);
+      int expected = 0;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+         assertUnit(*it == expected++);
+      assertUnit(expected == 1000);
+   }  // teardown
+
+   // Splay: erasing brings the neighborhood up to the root
+   void test_balance_splayErase()
+   {  // setup
+      custom::BST <int, custom::Splay> bst;
+      for (int i = 0; i < 100; i++)
+         bst.insert(i);
+      auto it = bst.find(50);
+      bst.find(0);
+      // exercise
+      auto itNext = bst.erase(it);
+      // verify
+      assertUnit(itNext != bst.end());
+      if (itNext != bst.end())
+         assertUnit(*itNext == 51);
+      assertUnit(bst.size() == 99);
+      assertUnit(bst.root != nullptr && bst.root->pParent == nullptr);
+      assertUnit(bst.find(50) == bst.end());
+      int expected = 0;
+      for (auto it = bst.begin(); it != bst.end(); ++it, ++expected)
+         assertUnit(*it == (expected < 50 ? expected : expected + 1));
+      assertUnit(expected == 99);
+   }  // teardown
+
+   // Treap: increasing values still make a shallow tree
+   void test_balance_treapAscending()
+   {  // setup
+      custom::BST <int, custom::Treap> bst;
+      const int num = 1000;
+      // exercise
+      for (int i = 0; i < num; i++)
+         bst.insert(i);
+      // verify
+      assertUnit(bst.size() == num);
+      assertUnit(treapSize(bst.root) == num);
+      assertUnit(bst.height() <= 4 * log2(num + 1));
+      int expected = 0;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+         assertUnit(*it == expected++);
+      assertUnit(expected == num);
+   }  // teardown
+
+   // Treap: the sizes and priorities survive erasing
+   void test_balance_treapErase()
+   {  // setup
+      custom::BST <int, custom::Treap> bst;
+      const int num = 1000;
+      for (int i = 0; i < num; i++)
+         bst.insert(i);
+      // exercise
+      for (int i = 0; i < num; i += 2)
+      {
+         auto it = bst.find(i);
+         bst.erase(it);
+      }
+      // verify
+      assertUnit(bst.size() == num / 2);
+      assertUnit(treapSize(bst.root) == num / 2);
+      int expected = 1;
+      for (auto it = bst.begin(); it != bst.end(); ++it, expected += 2)
+         assertUnit(*it == expected);
+   }  // teardown
+
+   // Scapegoat: increasing values get rebuilt into a shallow tree
+   void test_balance_scapegoatAscending()
+   {  // setup
+      custom::BST <int, custom::Scapegoat> bst;
+      const int num = 1000;
+      // exercise
+      for (int i = 0; i < num; i++)
+         bst.insert(i);
+      // verify
+      assertUnit(bst.size() == num);
+      assertUnit(bst.height() <= log(num) / log(1.5) + 2);
+      assertUnit(bst.balance.rebuilds() > 0);
+      assertUnit(bst.rotations() == 0);
+      int expected = 0;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+         assertUnit(*it == expected++);
+      assertUnit(expected == num);
+   }  // teardown
+
+   // Scapegoat: erasing most of the tree rebuilds it
+   void test_balance_scapegoatErase()
+   {  // setup
+      custom::BST <int, custom::Scapegoat> bst;
+      const int num = 1000;
+      for (int i = 0; i < num; i++)
+         bst.insert(i);
+      size_t rebuilds = bst.balance.rebuilds();
+      // exercise
+      for (int i = 0; i < num; i++)
+         if (i % 4 != 3)
+         {
+            auto it = bst.find(i);
+            bst.erase(it);
+         }
+      // verify
+      assertUnit(bst.size() == num / 4);
+      assertUnit(bst.balance.rebuilds() > rebuilds);
+      assertUnit(bst.height() <= log(num / 4) / log(1.5) + 2);
+      int expected = 3;
+      for (auto it = bst.begin(); it != bst.end(); ++it, expected += 4)
+         assertUnit(*it == expected);
+      assertUnit(expected == num + 3);
+   }  // teardown
+
+   // Scapegoat: a few erases from a big tree leave it as it is
+   void test_balance_scapegoatEraseFew()
+   {  // setup
+      custom::BST <int, custom::Scapegoat> bst;
+      const int num = 1000;
+      for (int i = 0; i < num; i++)
+         bst.insert(i);
+      size_t rebuilds = bst.balance.rebuilds();
+      // exercise
+      for (int i = 0; i < 10; i++)
+      {
+         auto it = bst.find(i * 7);
+         bst.erase(it);
+      }
+      // verify
+      assertUnit(bst.size() == num - 10);
+      assertUnit(bst.balance.rebuilds() == rebuilds);
+      assertUnit(bst.find(7) == bst.end());
+      assertUnit(bst.find(8) != bst.end());
+   }  // teardown
+
+   // Scapegoat: the node carries nothing but the data and the links
+   void test_balance_scapegoatNodeSize()
+   {
+      assertUnit(sizeof(custom::BST <uint64_t, custom::Scapegoat>::BNode)
+                 == sizeof(uint64_t) + 3 * sizeof(void *));
+   }
+
+   // RedBlack: the color is in pParent, so the node is no bigger than Scapegoat's
+   void test_balance_redBlackNodeSize()
+   {
+      assertUnit(sizeof(custom::BST <uint64_t, custom::RedBlack>::BNode)
+                 == sizeof(uint64_t) + 3 * sizeof(void *));
+      assertUnit(sizeof(custom::BST <uint64_t, custom::RedBlack>::BNode)
+                 == sizeof(custom::BST <uint64_t, custom::Scapegoat>::BNode));
+   }
+
+   // RedBlack: a new parent leaves the color alone, and the color
+   // never shows in the parent
+   void test_balance_redBlackColorInParent()
+   {  // setup
+      custom::BST <int>::BNode parent(1);
+      custom::BST <int>::BNode other(2);
+      custom::BST <int>::BNode child(3);
+      child.setRed(true);
+      // exercise
+      parent.addLeft(&child);
+      // verify
+      assertUnit(child.isRed() == true);
+      assertUnit(child.pParent == &parent);
+      assertUnit(child.isLeftChild());
+      // exercise
+      child.pParent = other.pParent;
+      // verify
+      assertUnit(child.isRed() == true);
+      assertUnit(child.pParent == nullptr);
+      // exercise
+      other.swapBalance(child);
+      // verify
+      assertUnit(child.isRed() == false);
+      assertUnit(other.isRed() == true);
+      assertUnit(other.pParent == nullptr);
+   }  // teardown
+
+   /***************************************
+    * Split and Join
+    *    BST::split(const T &)
+    *    BST::join(BST &, BST &)
+    ***************************************/
+
+   // split down the middle
+   void test_split_treapMiddle()
+   {  // setup
+      custom::BST <int, custom::Treap> bst;
+      const int num = 1000;
+      for (int i = 0; i < num; i++)
+         bst.insert(i);
+      // exercise
+      auto rest = bst.split(num / 4);
+      // verify
+      assertUnit(bst.size() == num / 4);
+      assertUnit(rest.size() == num - num / 4);
+      assertUnit(treapSize(bst.root) == num / 4);
+      assertUnit(treapSize(rest.root) == num - num / 4);
+      int expected = 0;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+         assertUnit(*it == expected++);
+      assertUnit(expected == num / 4);
+      for (auto it = rest.begin(); it != rest.end(); ++it)
+         assertUnit(*it == expected++);
+      assertUnit(expected == num);
+   }  // teardown
+
+   // split before the first and after the last
+   void test_split_treapEnds()
+   {  // setup
+      custom::BST <int, custom::Treap> bst;
+      for (int i = 0; i < 100; i++)
+         bst.insert(i);
+      // exercise
+      auto all = bst.split(-1);
+      auto none = all.split(100);
+      // verify
+      assertUnit(bst.empty());
+      assertUnit(bst.root == nullptr);
+      assertUnit(none.empty());
+      assertUnit(none.root == nullptr);
+      assertUnit(all.size() == 100);
+      assertUnit(treapSize(all.root) == 100);
+   }  // teardown
+
+   // join two halves back together
+   void test_join_treap()
+   {  // setup
+      custom::BST <int, custom::Treap> bstLess;
+      custom::BST <int, custom::Treap> bstRest;
+      for (int i = 0; i < 300; i++)
+         bstLess.insert(i);
+      for (int i = 300; i < 1000; i++)
+         bstRest.insert(i);
+      // exercise
+      auto bst = custom::BST <int, custom::Treap> ::join(bstLess, bstRest);
+      // verify
+      assertUnit(bstLess.empty());
+      assertUnit(bstLess.root == nullptr);
+      assertUnit(bstRest.empty());
+      assertUnit(bstRest.root == nullptr);
+      assertUnit(bst.size() == 1000);
+      assertUnit(treapSize(bst.root) == 1000);
+      int expected = 0;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+         assertUnit(*it == expected++);
+      assertUnit(expected == 1000);
+   }  // teardown
+
+   /***************************************
+    * Relayout
+    *    BST::relayout_veb()
+    ***************************************/
+
+   // the same tree, now in one block: the top, then each subtree under it
+   void test_relayoutVeb_standard()
+   {  // setup
+      //                 50 
+      //          +-------+-------+
+      //         30              70  
+      //     +----+----+     +----+----+
+      //    20        40    60        80  
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      Spy::reset();
+      // exercise
+      bst.relayout_veb();
+      // verify
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numAssign() == 0);
+      assertUnit(Spy::numLessthan() == 0);
+      assertUnit(bst.blockCapacity == 7);
+      assertUnit(bst.numInBlock == 7);
+      assertUnit(bst.root == bst.pBlock);
+      assertUnit(bst.root->pLeft == bst.pBlock + 1);
+      assertUnit(bst.root->pLeft->pLeft == bst.pBlock + 2);
+      assertUnit(bst.root->pLeft->pRight == bst.pBlock + 3);
+      assertUnit(bst.root->pRight == bst.pBlock + 4);
+      assertUnit(bst.root->pRight->pLeft == bst.pBlock + 5);
+      assertUnit(bst.root->pRight->pRight == bst.pBlock + 6);
+      assertStandardFixture(bst);
+   }  // teardown, by the destructor since the nodes share a block
+
+   // four levels split into two on top and four below
+   void test_relayoutVeb_order()
+   {  // setup
+      custom::BST <int, custom::Unbalanced> bst;
+      for (int i : { 8, 4, 12, 2, 6, 10, 14, 1, 3, 5, 7, 9, 11, 13, 15 })
+         bst.insert(i);
+      // exercise
+      bst.relayout_veb();
+      // verify
+      int expected[] = { 8, 4, 12, 2, 1, 3, 6, 5, 7, 10, 9, 11, 14, 13, 15 };
+      for (int i = 0; i < 15; i++)
+         assertUnit(bst.pBlock[i].data == expected[i]);
+      int value = 1;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+         assertUnit(*it == value++);
+      assertUnit(value == 16);
+   }  // teardown
+
+   // the tree still changes after, and the block goes with its last node
+   void test_relayoutVeb_erase()
+   {  // setup
+      custom::BST <int> bst;
+      for (int i = 0; i < 1000; i++)
+         bst.insert(i);
+      bst.relayout_veb();
+      // exercise
+      for (int i = 1000; i < 1100; i++)
+         bst.insert(i);
+      for (int i = 0; i < 500; i++)
+      {
+         auto it = bst.find(i * 2);
+         bst.erase(it);
+      }
+      // verify
+      assertUnit(bst.size() == 600);
+      assertUnit(bst.numInBlock == 500);
+      int expected = 1;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+      {
+         assertUnit(*it == expected);
+         expected += (expected < 999 ? 2 : 1);
+      }
+      assertUnit(expected == 1100);
+      // exercise
+      for (int i = 0; i < 500; i++)
+      {
+         auto it = bst.find(i * 2 + 1);
+         bst.erase(it);
+      }
+      // verify
+      assertUnit(bst.size() == 100);
+      assertUnit(bst.pBlock == nullptr);
+      assertUnit(bst.numInBlock == 0);
+   }  // teardown
+
+   // the halves of a split each own their nodes
+   void test_relayoutVeb_split()
+   {  // setup
+      custom::BST <int, custom::Treap> bst;
+      for (int i = 0; i < 1000; i++)
+         bst.insert(i);
+      bst.relayout_veb();
+      // exercise
+      auto rest = bst.split(500);
+      // verify
+      assertUnit(bst.pBlock == nullptr);
+      assertUnit(rest.pBlock == nullptr);
+      assertUnit(treapSize(bst.root) == 500);
+      assertUnit(treapSize(rest.root) == 500);
+      int expected = 0;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+         assertUnit(*it == expected++);
+      for (auto it = rest.begin(); it != rest.end(); ++it)
+         assertUnit(*it == expected++);
+      assertUnit(expected == 1000);
+   }  // teardown
+
+   /***************************************
+    * Arena
+    *    BST::use_arena()
+    ***************************************/
+
+   // the nodes move into the arena, in one block in vEB order
+   void test_useArena_standard()
+   {  // setup
+      //                 50 
+      //          +-------+-------+
+      //         30              70  
+      //     +----+----+     +----+----+
+      //    20        40    60        80  
+      custom::BST <Spy> bst;
+      setupStandardFixture(bst);
+      Spy::reset();
+      // exercise
+      bst.use_arena();
+      // verify
+      assertUnit(bst.uses_arena());
+      assertUnit(Spy::numCopy() == 0);
+      assertUnit(Spy::numLessthan() == 0);
+      assertUnit(bst.pBlock == nullptr);
+      assertUnit(bst.root->pLeft == bst.root + 1);
+      assertUnit(bst.root->pRight == bst.root + 4);
+      assertUnit(bst.root->pRight->pRight == bst.root + 6);
+      assertStandardFixture(bst);
+   }  // teardown
+
+   // clearing ints frees the chunks without visiting a node
+   void test_useArena_clearTrivial()
+   {  // setup
+      custom::BST <int> bst;
+      bst.use_arena();
+      for (int i = 0; i < 10000; i++)
+         bst.insert(i);
+      assertUnit(bst.pArena->bytes() > 10000 * sizeof(int));
+      // exercise
+      bst.clear();
+      // verify
+      assertUnit(bst.uses_arena());
+      assertUnit(bst.pArena->bytes() == 0);
+      assertUnit(bst.root == nullptr);
+      assertUnit(bst.size() == 0);
+      // exercise
+      bst.insert(7);
+      // verify
+      assertUnit(bst.size() == 1);
+      assertUnit(*bst.begin() == 7);
+   }  // teardown
+
+   // clearing Spys still runs each destructor, but deletes nothing
+   void test_useArena_clearSpy()
+   {  // setup
+      custom::BST <Spy> bst;
+      bst.use_arena();
+      for (int i = 0; i < 100; i++)
+         bst.insert(Spy(i));
+      Spy::reset();
+      // exercise
+      bst.clear();
+      // verify
+      assertUnit(Spy::numDestructor() == 100);
+      assertUnit(Spy::numDelete() == 100);
+      assertUnit(bst.pArena->bytes() == 0);
+      assertEmptyFixture(bst);
+   }  // teardown
+
+   // erased nodes are reused, so churn takes no more chunks
+   void test_useArena_churn()
+   {  // setup
+      custom::BST <int> bst;
+      bst.use_arena();
+      for (int i = 0; i < 5000; i++)
+         bst.insert(i);
+      size_t numBytes = bst.pArena->bytes();
+      // exercise
+      for (int round = 0; round < 5; round++)
+      {
+         for (int i = 0; i < 5000; i += 2)
+         {
+            auto it = bst.find(i);
+            bst.erase(it);
+         }
+         for (int i = 0; i < 5000; i += 2)
+            bst.insert(i);
+      }
+      // verify
+      assertUnit(bst.size() == 5000);
+      assertUnit(bst.pArena->bytes() == numBytes);
+      int expected = 0;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+         assertUnit(*it == expected++);
+      assertUnit(expected == 5000);
+   }  // teardown
+
+   // the halves of a split each own their nodes, outside any arena
+   void test_useArena_split()
+   {  // setup
+      custom::BST <int, custom::Treap> bst;
+      bst.use_arena();
+      for (int i = 0; i < 1000; i++)
+         bst.insert(i);
+      // exercise
+      auto rest = bst.split(500);
+      // verify
+      assertUnit(!bst.uses_arena());
+      assertUnit(!rest.uses_arena());
+      assertUnit(treapSize(bst.root) == 500);
+      assertUnit(treapSize(rest.root) == 500);
+      int expected = 0;
+      for (auto it = bst.begin(); it != bst.end(); ++it)
+         assertUnit(*it == expected++);
+      for (auto it = rest.begin(); it != rest.end(); ++it)
+         assertUnit(*it == expected++);
+      assertUnit(expected == 1000);
+   }  // teardown
+
+   /***************************************
+    * Allocator
+    *    BST::BST(alloc)
+    ***************************************/
+
+   // an allocator that counts the nodes it has out
+   template <class T>
+   struct CountingAlloc
+   {
+      typedef T value_type;
+      CountingAlloc(int * pCount) : pCount(pCount) { }
+      template <class U>
+      CountingAlloc(const CountingAlloc<U> & rhs) : pCount(rhs.pCount) { }
+      T * allocate(size_t n)
+      {
+         *pCount += (int)n;
+         return (T *)::operator new(n * sizeof(T));
+      }
+      void deallocate(T * p, size_t n)
+      {
+         *pCount -= (int)n;
+         ::operator delete(p);
+      }
+      bool operator == (const CountingAlloc & rhs) const { return pCount == rhs.pCount; }
+      bool operator != (const CountingAlloc & rhs) const { return pCount != rhs.pCount; }
+      int * pCount;
+   };
+   typedef custom::BST <int, custom::RedBlack, CountingAlloc<int>> CountedBST;
+
+   // each node comes from the allocator, and goes back to it
+   void test_alloc_nodes()
+   {  // setup
+      int numNodes = 0;
+      CountingAlloc<int> alloc(&numNodes);
+      CountedBST bst(alloc);
+      // exercise
+      for (int i = 0; i < 100; i++)
+         bst.insert(i);
+      // verify
+      assertUnit(numNodes == 100);
+      assertUnit(bst.get_allocator().pCount == &numNodes);
+      // exercise
+      for (int i = 0; i < 100; i += 2)
+      {
+         auto it = bst.find(i);
+         bst.erase(it);
+      }
+      // verify
+      assertUnit(numNodes == 50);
+      // exercise
+      bst.clear();
+      // verify
+      assertUnit(numNodes == 0);
+   }  // teardown
+
+   // a copy and a move keep the allocator, and moving between two copies
+   void test_alloc_copyMove()
+   {  // setup
+      int numNodes = 0;
+      int numOther = 0;
+      CountingAlloc<int> alloc(&numNodes);
+      CountedBST bstSrc(alloc);
+      for (int i = 0; i < 10; i++)
+         bstSrc.insert(i);
+      // exercise
+      CountedBST bstCopy(bstSrc);
+      CountedBST bstMoved(std::move(bstSrc));
+      // verify
+      assertUnit(numNodes == 20);
+      assertUnit(bstSrc.size() == 0);
+      assertUnit(bstMoved.size() == 10);
+      // exercise
+      CountingAlloc<int> allocOther(&numOther);
+      CountedBST bstOther(allocOther);
+      bstOther = std::move(bstCopy);
+      // verify
+      assertUnit(numNodes == 10);
+      assertUnit(numOther == 10);
+      assertUnit(bstOther.size() == 10);
+      assertUnit(bstCopy.size() == 0);
+      int expected = 0;
+      for (auto it = bstOther.begin(); it != bstOther.end(); ++it)
+         assertUnit(*it == expected++);
+      assertUnit(expected == 10);
+   }  // teardown
+
+   // the block of relayout_veb() comes from the allocator too
+   void test_alloc_relayout()
+   {  // setup
+      int numNodes = 0;
+      CountingAlloc<int> alloc(&numNodes);
+      CountedBST bst(alloc);
+      for (int i = 0; i < 100; i++)
+         bst.insert(i);
+      // exercise
+      bst.relayout_veb();
+      // verify
+      assertUnit(numNodes == 100);
+      assertUnit(bst.blockCapacity == 100);
+      // exercise
+      bst.clear();
+      // verify
+      assertUnit(numNodes == 0);
+   }  // teardown
+
    /***************************************
     * Erase
     *    BST::erase(it)
@@ -2475,6 +3398,87 @@ public:
       bst.root = nullptr;
    }
 
+   /**************************************************************
+    * RED BLACK HEIGHT
+    * Verify the red-black rules below pNode: red nodes have black
+    * children, parent pointers line up, the tree is in order, and every
+    * path down has the same number of black nodes. Returns that
+    * number or -1 if a rule is broken
+    *************************************************************/
+   int redBlackHeight(const custom::BST <int> ::BNode * pNode)
+   {
+      if (pNode == nullptr)
+         return 0;
+      if (pNode->pParent == nullptr && pNode->isRed())
+         return -1;
+
+      if (pNode->pLeft && (pNode->pLeft->pParent != pNode || pNode->data < pNode->pLeft->data))
+         return -1;
+      if (pNode->pRight && (pNode->pRight->pParent != pNode || pNode->pRight->data < pNode->data))
+         return -1;
+      if (pNode->isRed() && ((pNode->pLeft  && pNode->pLeft->isRed()) ||
+                           (pNode->pRight && pNode->pRight->isRed())))
+         return -1;
+
+      int heightLeft  = redBlackHeight(pNode->pLeft);
+      int heightRight = redBlackHeight(pNode->pRight);
+      if (heightLeft < 0 || heightLeft != heightRight)
+         return -1;
+      return heightLeft + (pNode->isRed() ? 0 : 1);
+   }
+
+   /**************************************************************
+    * AVL HEIGHT
+    * Verify the AVL rules below pNode: the stored heights are right,
+    * the children differ in height by at most one, parent pointers
+    * line up, and the tree is in order. Returns the height or -1 if
+    * a rule is broken
+    *************************************************************/
+   int avlHeight(const custom::BST <int, custom::AVL> ::BNode * pNode)
+   {
+      if (pNode == nullptr)
+         return 0;
+
+      if (pNode->pLeft && (pNode->pLeft->pParent != pNode || pNode->data < pNode->pLeft->data))
+         return -1;
+      if (pNode->pRight && (pNode->pRight->pParent != pNode || pNode->pRight->data < pNode->data))
+         return -1;
+
+      int heightLeft  = avlHeight(pNode->pLeft);
+      int heightRight = avlHeight(pNode->pRight);
+      if (heightLeft < 0 || heightRight < 0 || heightLeft - heightRight > 1 || heightRight - heightLeft > 1)
+         return -1;
+      int height = 1 + (heightLeft > heightRight ? heightLeft : heightRight);
+      return (pNode->height == height ? height : -1);
+   }
+
+   /**************************************************************
+    * TREAP SIZE
+    * Verify the treap rules below pNode: no child outranks its
+    * parent, the stored sizes are right, parent pointers line up,
+    * and the tree is in order. Returns the size or -1 if a rule is
+    * broken
+    *************************************************************/
+   int treapSize(const custom::BST <int, custom::Treap> ::BNode * pNode)
+   {
+      if (pNode == nullptr)
+         return 0;
+
+      if (pNode->pLeft && (pNode->pLeft->pParent != pNode || pNode->data < pNode->pLeft->data ||
+                           pNode->priority < pNode->pLeft->priority))
+         return -1;
+      if (pNode->pRight && (pNode->pRight->pParent != pNode || pNode->pRight->data < pNode->data ||
+                            pNode->priority < pNode->pRight->priority))
+         return -1;
+
+      int sizeLeft  = treapSize(pNode->pLeft);
+      int sizeRight = treapSize(pNode->pRight);
+      if (sizeLeft < 0 || sizeRight < 0)
+         return -1;
+      int size = 1 + sizeLeft + sizeRight;
+      return ((int)pNode->size == size ? size : -1);
+   }
+
    /**************************************************************
     * SETUP STANDARD FIXTURE
     *                (50) 
@@ -0,0 +1,406 @@
+/***********************************************************************
+ * Header:
+ *    TEST B-TREE
+ * Summary:
+ *    Unit tests for btree
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "btree.h"
+#include "unitTest.h"
+
+#include <cstdint>   // for uintptr_t
+#include <string>
+
+/***********************************************
+ * TEST B-TREE
+ * Unit tests for the BTree class. Most use one cache
+ * line per node so a few hundred elements make a deep tree
+ ***********************************************/
+class TestBTree : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_constructCopy_standard();
+
+      // Insert
+      test_insert_empty();
+      test_insert_duplicate();
+      test_insert_ascending();
+      test_insert_descending();
+      test_insert_string();
+      test_insert_noDefault();
+      test_insert_aligned();
+
+      // Find
+      test_find_standard();
+      test_find_missing();
+
+      // Iterator
+      test_iterator_decrement();
+
+      // Remove
+      test_erase_one();
+      test_erase_every();
+      test_erase_returnsNext();
+      test_clear_standard();
+
+      report("BTree");
+   }
+
+   typedef custom::BTree <int, 1> Tree;
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // default constructor
+   void test_construct_default()
+   {  // setup
+      // exercise
+      Tree tree;
+      // verify
+      assertUnit(tree.root == nullptr);
+      assertUnit(tree.numElements == 0);
+      assertUnit(tree.begin() == tree.end());
+      assertUnit(Tree::MAX_KEYS == 15);
+   }  // teardown
+
+   // copy makes new nodes with the same keys
+   void test_constructCopy_standard()
+   {  // setup
+      Tree treeSrc;
+      for (int i = 0; i < 500; i++)
+         treeSrc.insert(i * 3, true);
+      // exercise
+      Tree treeDest(treeSrc);
+      // verify
+      assertUnit(treeDest.size() == 500);
+      assertUnit(treeDest.root != treeSrc.root);
+      assertUnit(isValid(treeDest));
+      auto itSrc = treeSrc.begin();
+      for (auto it = treeDest.begin(); it != treeDest.end(); ++it, ++itSrc)
+         assertUnit(*it == *itSrc);
+      assertUnit(itSrc == treeSrc.end());
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // the first insert makes a leaf root
+   void test_insert_empty()
+   {  // setup
+      Tree tree;
+      // exercise
+      auto result = tree.insert(50, true);
+      // verify
+      assertUnit(result.second == true);
+      assertUnit(*result.first == 50);
+      assertUnit(tree.size() == 1);
+      assertUnit(tree.root != nullptr);
+      if (tree.root)
+      {
+         assertUnit(tree.root->isLeaf);
+         assertUnit(tree.root->numKeys == 1);
+         assertUnit(tree.root->key(0) == 50);
+      }
+   }  // teardown
+
+   // a unique insert of something already there changes nothing
+   void test_insert_duplicate()
+   {  // setup
+      Tree tree;
+      for (int i = 0; i < 100; i++)
+         tree.insert(i, true);
+      // exercise
+      auto result = tree.insert(42, true);
+      // verify
+      assertUnit(result.second == false);
+      assertUnit(*result.first == 42);
+      assertUnit(tree.size() == 100);
+   }  // teardown
+
+   // ascending inserts split the rightmost leaf over and over
+   void test_insert_ascending()
+   {  // setup
+      Tree tree;
+      // exercise
+      for (int i = 0; i < 1000; i++)
+      {
+         auto result = tree.insert(i, true);
+         assertUnit(result.second && *result.first == i);
+      }
+      // verify
+      assertUnit(tree.size() == 1000);
+      assertUnit(tree.height() > 1);
+      assertUnit(tree.height() <= 4);
+      assertUnit(isValid(tree));
+      int expected = 0;
+      for (auto it = tree.begin(); it != tree.end(); ++it)
+         assertUnit(*it == expected++);
+      assertUnit(expected == 1000);
+   }  // teardown
+
+   // descending inserts split the leftmost leaf over and over
+   void test_insert_descending()
+   {  // setup
+      Tree tree;
+      // exercise
+      for (int i = 999; i >= 0; i--)
+      {
+         auto result = tree.insert(i, true);
+         assertUnit(result.second && *result.first == i);
+      }
+      // verify
+      assertUnit(tree.size() == 1000);
+      assertUnit(isValid(tree));
+      int expected = 0;
+      for (auto it = tree.begin(); it != tree.end(); ++it)
+         assertUnit(*it == expected++);
+   }  // teardown
+
+   // bigger keys mean fewer of them in a node
+   void test_insert_string()
+   {  // setup
+      custom::BTree <std::string> tree;
+      // exercise
+      for (int i = 0; i < 200; i++)
+         tree.insert(std::to_string(i), true);
+      // verify
+      assertUnit(tree.size() == 200);
+      assertUnit(tree.height() > 1);
+      assertUnit(tree.find("137") != tree.end());
+      assertUnit(tree.find("1370") == tree.end());
+      std::string previous;
+      for (auto it = tree.begin(); it != tree.end(); ++it)
+      {
+         assertUnit(previous < *it);
+         previous = *it;
+      }
+   }  // teardown
+
+   // a key with no default constructor, and only the keys in use are alive
+   void test_insert_noDefault()
+   {  // setup
+      {
+         custom::BTree <Counted, 1> tree;
+         // exercise
+         for (int i = 0; i < 500; i++)
+            tree.insert(Counted((i * 7) % 500), true);
+         // verify
+         assertUnit(tree.size() == 500);
+         assertUnit(tree.height() > 1);
+         assertUnit(Counted::numLive() == 500);
+         assertUnit(isValid(tree));
+         for (int i = 0; i < 500; i += 2)
+         {
+            auto it = tree.find(Counted(i));
+            tree.erase(it);
+         }
+         assertUnit(tree.size() == 250);
+         assertUnit(Counted::numLive() == 250);
+         assertUnit(isValid(tree));
+      }
+      assertUnit(Counted::numLive() == 0);
+   }  // teardown
+
+   // every node's keys start on a cache line
+   void test_insert_aligned()
+   {  // setup
+      custom::BTree <int, 2> tree;
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         tree.insert(i, true);
+      // verify
+      assertUnit(tree.height() > 1);
+      assertUnit((uintptr_t)&tree.root->key(0) % 64 == 0);
+      for (auto it = tree.begin(); it != tree.end(); ++it)
+         assertUnit((uintptr_t)&it.pNode->key(0) % 64 == 0);
+   }  // teardown
+
+   /***************************************
+    * FIND
+    ***************************************/
+
+   // every key is found, wherever it lives
+   void test_find_standard()
+   {  // setup
+      Tree tree;
+      for (int i = 0; i < 1000; i++)
+         tree.insert((i * 7) % 1000, true);
+      // exercise and verify
+      for (int i = 0; i < 1000; i++)
+      {
+         auto it = tree.find(i);
+         assertUnit(it != tree.end() && *it == i);
+      }
+   }  // teardown
+
+   // keys between the ones there are not found
+   void test_find_missing()
+   {  // setup
+      Tree tree;
+      for (int i = 0; i < 500; i++)
+         tree.insert(i * 2, true);
+      // exercise and verify
+      for (int i = -1; i < 1000; i += 2)
+         assertUnit(tree.find(i) == tree.end());
+   }  // teardown
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // walk back from the largest to the smallest
+   void test_iterator_decrement()
+   {  // setup
+      Tree tree;
+      for (int i = 0; i < 500; i++)
+         tree.insert(i, true);
+      auto it = tree.find(499);
+      // exercise
+      int expected = 499;
+      for (; it != tree.end(); --it)
+         assertUnit(*it == expected--);
+      // verify
+      assertUnit(expected == -1);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // erase out of the middle of the tree
+   void test_erase_one()
+   {  // setup
+      Tree tree;
+      for (int i = 0; i < 500; i++)
+         tree.insert(i, true);
+      auto it = tree.find(250);
+      // exercise
+      auto itNext = tree.erase(it);
+      // verify
+      assertUnit(tree.size() == 499);
+      assertUnit(itNext != tree.end() && *itNext == 251);
+      assertUnit(tree.find(250) == tree.end());
+      assertUnit(isValid(tree));
+   }  // teardown
+
+   // erase everything, leaves and inner keys alike
+   void test_erase_every()
+   {  // setup
+      Tree tree;
+      for (int i = 0; i < 1000; i++)
+         tree.insert(i, true);
+      // exercise
+      for (int i = 0; i < 1000; i++)
+      {
+         auto it = tree.find((i * 7) % 1000);
+         tree.erase(it);
+         if (i % 100 == 0)
+            assertUnit(isValid(tree));
+      }
+      // verify
+      assertUnit(tree.size() == 0);
+      assertUnit(tree.root == nullptr);
+      assertUnit(tree.begin() == tree.end());
+   }  // teardown
+
+   // erase walks the whole tree in order when fed its own return value
+   void test_erase_returnsNext()
+   {  // setup
+      Tree tree;
+      for (int i = 0; i < 500; i++)
+         tree.insert(i, true);
+      // exercise
+      int expected = 0;
+      for (auto it = tree.begin(); it != tree.end(); expected++)
+      {
+         assertUnit(*it == expected);
+         it = tree.erase(it);
+      }
+      // verify
+      assertUnit(expected == 500);
+      assertUnit(tree.empty());
+   }  // teardown
+
+   // clear frees everything
+   void test_clear_standard()
+   {  // setup
+      Tree tree;
+      for (int i = 0; i < 500; i++)
+         tree.insert(i, true);
+      // exercise
+      tree.clear();
+      // verify
+      assertUnit(tree.empty());
+      assertUnit(tree.root == nullptr);
+   }  // teardown
+
+   /*************************************************************
+    * COUNTED
+    * A key with no default constructor that keeps track of
+    * how many of it are alive
+    *************************************************************/
+   struct Counted
+   {
+      Counted(int value)           : value(value)     { numLive()++; }
+      Counted(const Counted & rhs) : value(rhs.value) { numLive()++; }
+      ~Counted()                                      { numLive()--; }
+      Counted & operator = (const Counted & rhs)      { value = rhs.value; return *this; }
+      bool operator <  (const Counted & rhs) const    { return value <  rhs.value;       }
+      bool operator == (const Counted & rhs) const    { return value == rhs.value;       }
+      static int & numLive()                          { static int num = 0; return num;  }
+      int value;
+   };
+
+   /*************************************************************
+    * IS VALID
+    * Every node but the root is at least half full, the keys are
+    * in order, the parent links are right, and the leaves line up
+    *************************************************************/
+   template <class TreeType>
+   bool isValid(const TreeType & tree)
+   {
+      int depthLeaf = -1;
+      return tree.root == nullptr ||
+             isValid<TreeType>(tree.root, nullptr, 0, depthLeaf);
+   }
+
+   template <class TreeType>
+   bool isValid(const typename TreeType::Node * pNode, const typename TreeType::Inner * pParent,
+                int depth, int & depthLeaf)
+   {
+      if (pNode->pParent != pParent)
+         return false;
+      if (pParent && (pNode->numKeys < TreeType::MIN_KEYS || pNode->numKeys > TreeType::MAX_KEYS))
+         return false;
+      for (size_t i = 1; i < pNode->numKeys; i++)
+         if (!(pNode->key(i - 1) < pNode->key(i)))
+            return false;
+      if (pNode->isLeaf)
+      {
+         if (depthLeaf < 0)
+            depthLeaf = depth;
+         return depth == depthLeaf;
+      }
+      auto pInner = static_cast<const typename TreeType::Inner *>(pNode);
+      for (size_t i = 0; i <= pNode->numKeys; i++)
+         if (!isValid<TreeType>(pInner->children[i], pInner, depth + 1, depthLeaf))
+            return false;
+      return true;
+   }
+};
+
+#endif // DEBUG
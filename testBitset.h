@@ -0,0 +1,301 @@
+/***********************************************************************
+ * Header:
+ *    TEST BITSET
+ * Summary:
+ *    Unit tests for bitset
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "bitset.h"
+#include "unitTest.h"
+
+#include <cstdint>
+
+/***********************************************
+ * TEST BITSET
+ * Unit tests for the Bitset class
+ ***********************************************/
+class TestBitset : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_small();
+      test_constructCopy_standard();
+
+      // Insert
+      test_insert_bits();
+      test_insert_duplicate();
+      test_insert_outside();
+
+      // Find
+      test_lowerBound_standard();
+
+      // Iterator
+      test_iterator_sparse();
+      test_iterator_decrement();
+
+      // Remove
+      test_erase_every();
+
+      // Set Algebra
+      test_union_standard();
+      test_intersect_standard();
+      test_difference_standard();
+      test_algebra_empty();
+
+      report("Bitset");
+   }
+
+   typedef custom::Bitset <uint16_t, 16> Shards;
+   typedef custom::Bitset <uint8_t, 5>   Tiny;
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // default constructor
+   void test_construct_default()
+   {  // setup
+      // exercise
+      Shards s;
+      // verify
+      assertUnit(s.words == nullptr);
+      assertUnit(s.numElements == 0);
+      assertUnit(s.begin() == s.end());
+      assertUnit(s.find(0) == s.end());
+      assertUnit(s.height() == 0);
+   }  // teardown
+
+   // a universe smaller than a word still gets one word
+   void test_construct_small()
+   {  // setup
+      // exercise
+      Tiny s{ 0, 31, 7 };
+      // verify
+      assertUnit(Tiny::NUM_WORDS == 1);
+      assertUnit(Shards::NUM_WORDS == 1024);
+      assertUnit(s.words[0] == ((uint64_t)1 << 31 | 1 << 7 | 1));
+      assertUnit(s.size() == 3);
+   }  // teardown
+
+   // copy has its own words, with the same bits
+   void test_constructCopy_standard()
+   {  // setup
+      Shards sSrc{ 5, 700, 65535, 12 };
+      // exercise
+      Shards sDest(sSrc);
+      // verify
+      assertUnit(sDest.size() == 4);
+      assertUnit(sDest.words != sSrc.words);
+      for (size_t w = 0; w < Shards::NUM_WORDS; w++)
+         assertUnit(sDest.words[w] == sSrc.words[w]);
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // each key is one bit, in the word of its high bits
+   void test_insert_bits()
+   {  // setup
+      Shards s;
+      // exercise
+      auto result = s.insert(130);
+      // verify
+      assertUnit(result.second == true);
+      assertUnit(*result.first == 130);
+      assertUnit(s.words[2] == (uint64_t)1 << 2);
+      assertUnit(s.words[0] == 0 && s.words[1] == 0 && s.words[3] == 0);
+      assertUnit(s.size() == 1);
+   }  // teardown
+
+   // something already there stays as it is
+   void test_insert_duplicate()
+   {  // setup
+      Shards s{ 10, 20, 30 };
+      // exercise
+      auto result = s.insert(20);
+      // verify
+      assertUnit(result.second == false);
+      assertUnit(*result.first == 20);
+      assertUnit(s.size() == 3);
+   }  // teardown
+
+   // nothing past the universe goes in
+   void test_insert_outside()
+   {  // setup
+      Tiny s{ 1 };
+      // exercise
+      auto result = s.insert(32);
+      // verify
+      assertUnit(result.second == false);
+      assertUnit(result.first == s.end());
+      assertUnit(s.size() == 1);
+      assertUnit(s.find(32) == s.end());
+   }  // teardown
+
+   /***************************************
+    * FIND
+    ***************************************/
+
+   // the first element not less than the key, across words
+   void test_lowerBound_standard()
+   {  // setup
+      Shards s{ 10, 64, 65, 60000 };
+      // exercise and verify
+      assertUnit(*s.lower_bound(0) == 10);
+      assertUnit(*s.lower_bound(10) == 10);
+      assertUnit(*s.lower_bound(11) == 64);
+      assertUnit(*s.upper_bound(64) == 65);
+      assertUnit(*s.lower_bound(66) == 60000);
+      assertUnit(s.lower_bound(60001) == s.end());
+      assertUnit(s.upper_bound(60000) == s.end());
+      assertUnit(s.upper_bound(65535) == s.end());
+   }  // teardown
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // long runs of empty words are skipped over
+   void test_iterator_sparse()
+   {  // setup
+      Shards s{ 65535, 0, 63, 64, 30000 };
+      // exercise and verify
+      auto it = s.begin();
+      assertUnit(*it++ == 0);
+      assertUnit(*it++ == 63);
+      assertUnit(*it++ == 64);
+      assertUnit(*it++ == 30000);
+      assertUnit(*it++ == 65535);
+      assertUnit(it == s.end());
+      ++it;
+      assertUnit(it == s.end());
+   }  // teardown
+
+   // walk back from the largest to the smallest
+   void test_iterator_decrement()
+   {  // setup
+      Shards s;
+      for (uint32_t i = 0; i < 65536; i += 3)
+         s.insert((uint16_t)i);
+      auto it = s.find(65535);
+      // exercise
+      int expected = 65535;
+      for (; it != s.end(); --it, expected -= 3)
+         assertUnit(*it == expected);
+      // verify
+      assertUnit(expected == -3);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // erase everything, and the words are gone
+   void test_erase_every()
+   {  // setup
+      Shards s;
+      for (uint32_t i = 0; i < 1000; i++)
+         s.insert((uint16_t)(i * 65));
+      // exercise
+      for (uint32_t i = 0; i < 1000; i++)
+      {
+         auto it = s.find((uint16_t)(((i * 7) % 1000) * 65));
+         assertUnit(it != s.end());
+         s.erase(it);
+         assertUnit(s.size() == 999 - i);
+      }
+      // verify
+      assertUnit(s.words == nullptr);
+      assertUnit(s.begin() == s.end());
+   }  // teardown
+
+   /***************************************
+    * SET ALGEBRA
+    ***************************************/
+
+   // everything in either, counted
+   void test_union_standard()
+   {  // setup
+      Shards sEven;
+      Shards sThree;
+      for (uint32_t i = 0; i < 65536; i += 2)
+         sEven.insert((uint16_t)i);
+      for (uint32_t i = 0; i < 65536; i += 3)
+         sThree.insert((uint16_t)i);
+      // exercise
+      sEven |= sThree;
+      // verify
+      assertUnit(sEven.size() == 32768 + 21846 - 10923);
+      assertUnit(sEven.size() == sEven._count());
+      for (uint32_t i = 0; i < 100; i++)
+         assertUnit((sEven.find((uint16_t)i) != sEven.end()) == (i % 2 == 0 || i % 3 == 0));
+   }  // teardown
+
+   // only what is in both
+   void test_intersect_standard()
+   {  // setup
+      Shards sEven;
+      Shards sThree;
+      for (uint32_t i = 0; i < 65536; i += 2)
+         sEven.insert((uint16_t)i);
+      for (uint32_t i = 0; i < 65536; i += 3)
+         sThree.insert((uint16_t)i);
+      // exercise
+      sEven &= sThree;
+      // verify
+      assertUnit(sEven.size() == 10923);
+      assertUnit(sEven.size() == sEven._count());
+      uint32_t expected = 0;
+      for (auto it = sEven.begin(); it != sEven.end(); ++it, expected += 6)
+         assertUnit(*it == expected);
+   }  // teardown
+
+   // what is here but not there
+   void test_difference_standard()
+   {  // setup
+      Shards sEven;
+      Shards sThree;
+      for (uint32_t i = 0; i < 65536; i += 2)
+         sEven.insert((uint16_t)i);
+      for (uint32_t i = 0; i < 65536; i += 3)
+         sThree.insert((uint16_t)i);
+      // exercise
+      sEven -= sThree;
+      // verify
+      assertUnit(sEven.size() == 32768 - 10923);
+      assertUnit(sEven.size() == sEven._count());
+      for (uint32_t i = 0; i < 100; i++)
+         assertUnit((sEven.find((uint16_t)i) != sEven.end()) == (i % 2 == 0 && i % 3 != 0));
+   }  // teardown
+
+   // an empty side, or nothing left, needs no words
+   void test_algebra_empty()
+   {  // setup
+      Shards sEmpty;
+      Shards s{ 1, 2, 3 };
+      Shards sOther{ 4, 5 };
+      // exercise and verify
+      sEmpty |= s;
+      assertUnit(sEmpty.size() == 3 && sEmpty.words != s.words);
+      sEmpty -= s;
+      assertUnit(sEmpty.empty() && sEmpty.words == nullptr);
+      s &= sEmpty;
+      assertUnit(s.empty() && s.words == nullptr);
+      sOther &= Shards{ 1, 2, 3 };
+      assertUnit(sOther.empty() && sOther.words == nullptr);
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,220 @@
+/***********************************************************************
+ * Header:
+ *    TEST BLOOM FILTER
+ * Summary:
+ *    Unit tests for bloomFilter
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "bloomFilter.h"
+#include "unitTest.h"
+
+#include <cstdint>
+#include <string>
+
+/***********************************************
+ * TEST BLOOM FILTER
+ * Unit tests for the BloomFilter class
+ ***********************************************/
+class TestBloomFilter : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_constructCopy_standard();
+      test_reset_sized();
+
+      // Add and ask
+      test_add_oneBlock();
+      test_mayContain_every();
+      test_mayContain_rate();
+
+      // Upkeep
+      test_needsRebuild_erased();
+      test_needsRebuild_full();
+
+      // Hash
+      test_hash_usable();
+
+      report("BloomFilter");
+   }
+
+   typedef custom::BloomFilter Filter;
+
+   // a plain type std::hash knows nothing of
+   struct Opaque { int x; };
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // default constructor, no allocations
+   void test_construct_default()
+   {  // setup
+      // exercise
+      Filter f;
+      // verify
+      assertUnit(f.bitsPerElement == 10);
+      assertUnit(f.numBlocks == 0);
+      assertUnit(f.blocks == nullptr);
+      assertUnit(f.mayContain(12345));
+      assertUnit(f.false_positive_rate() == 0.0);
+   }  // teardown
+
+   // copy has its own blocks, with the same bits and counts
+   void test_constructCopy_standard()
+   {  // setup
+      Filter fSrc;
+      fSrc.reset(100);
+      for (uint64_t i = 0; i < 50; i++)
+         fSrc.add(custom::BloomHash<uint64_t>::of(i));
+      fSrc.countNegative();
+      fSrc.countFalsePositive();
+      // exercise
+      Filter fDest(fSrc);
+      // verify
+      assertUnit(fDest.blocks != fSrc.blocks);
+      assertUnit(fDest.numBlocks == fSrc.numBlocks);
+      assertUnit(fDest.capacity == 100);
+      assertUnit(fDest.numAdded == 50);
+      assertUnit(fDest.false_positive_rate() == 0.5);
+      for (size_t w = 0; w < fDest.numBlocks * Filter::WORDS_PER_BLOCK; w++)
+         assertUnit(fDest.blocks[w] == fSrc.blocks[w]);
+   }  // teardown
+
+   // ten bits an element, in whole blocks on a cache line
+   void test_reset_sized()
+   {  // setup
+      Filter f;
+      // exercise
+      f.reset(1000);
+      // verify
+      assertUnit(f.numBlocks == (1000 * 10 + 511) / 512);
+      assertUnit(((uintptr_t)f.blocks & 63) == 0);
+      assertUnit(f.bytes() == f.numBlocks * 64);
+      for (size_t w = 0; w < f.numBlocks * Filter::WORDS_PER_BLOCK; w++)
+         assertUnit(f.blocks[w] == 0);
+   }  // teardown
+
+   /***************************************
+    * ADD AND ASK
+    ***************************************/
+
+   // one bit in each word of one block, and nowhere else
+   void test_add_oneBlock()
+   {  // setup
+      Filter f;
+      f.reset(1000);
+      uint64_t hash = custom::BloomHash<uint64_t>::of(7);
+      // exercise
+      f.add(hash);
+      // verify
+      size_t numBlocksTouched = 0;
+      for (size_t b = 0; b < f.numBlocks; b++)
+      {
+         bool touched = false;
+         for (size_t w = 0; w < Filter::WORDS_PER_BLOCK; w++)
+            if (f.blocks[b * Filter::WORDS_PER_BLOCK + w])
+            {
+               touched = true;
+               assertUnit((f.blocks[b * Filter::WORDS_PER_BLOCK + w] & (f.blocks[b * Filter::WORDS_PER_BLOCK + w] - 1)) == 0);
+            }
+         numBlocksTouched += touched;
+      }
+      assertUnit(numBlocksTouched == 1);
+      assertUnit(f.numAdded == 1);
+   }  // teardown
+
+   // no false negatives
+   void test_mayContain_every()
+   {  // setup
+      Filter f;
+      f.reset(10000);
+      // exercise
+      for (uint64_t i = 0; i < 10000; i++)
+         f.add(custom::BloomHash<uint64_t>::of(i * 3));
+      // verify
+      for (uint64_t i = 0; i < 10000; i++)
+         assertUnit(f.mayContain(custom::BloomHash<uint64_t>::of(i * 3)));
+   }  // teardown
+
+   // full at ten bits an element, about one in a hundred get through
+   void test_mayContain_rate()
+   {  // setup
+      Filter f;
+      f.reset(10000);
+      for (uint64_t i = 0; i < 10000; i++)
+         f.add(custom::BloomHash<uint64_t>::of(i));
+      // exercise
+      size_t numMaybe = 0;
+      for (uint64_t i = 10000; i < 110000; i++)
+         numMaybe += f.mayContain(custom::BloomHash<uint64_t>::of(i));
+      // verify
+      assertUnit(numMaybe < 3000);
+   }  // teardown
+
+   /***************************************
+    * UPKEEP
+    ***************************************/
+
+   // past a quarter erased, it wants rebuilding
+   void test_needsRebuild_erased()
+   {  // setup
+      Filter f;
+      f.reset(100);
+      for (uint64_t i = 0; i < 40; i++)
+         f.add(custom::BloomHash<uint64_t>::of(i));
+      // exercise and verify
+      for (int i = 0; i < 10; i++)
+         f.erased();
+      assertUnit(!f.needsRebuild());
+      f.erased();
+      assertUnit(f.needsRebuild());
+      // exercise and verify
+      f.reset(100);
+      assertUnit(!f.needsRebuild());
+      f.invalidate();
+      assertUnit(f.needsRebuild());
+   }  // teardown
+
+   // as many as it was sized for, it wants rebuilding bigger
+   void test_needsRebuild_full()
+   {  // setup
+      Filter f;
+      f.reset(3);
+      f.add(1);
+      f.add(2);
+      assertUnit(!f.full());
+      // exercise
+      f.add(3);
+      // verify
+      assertUnit(f.full());
+      assertUnit(f.needsRebuild());
+   }  // teardown
+
+   /***************************************
+    * HASH
+    ***************************************/
+
+   // std::hash types get one, and the rest do not
+   void test_hash_usable()
+   {  // setup
+      // exercise and verify
+      assertUnit(custom::BloomHash<int>::usable);
+      assertUnit(custom::BloomHash<std::string>::usable);
+      assertUnit(!custom::BloomHash<Opaque>::usable);
+      assertUnit(custom::BloomHash<int>::of(1) != custom::BloomHash<int>::of(2));
+      assertUnit((custom::BloomHash<int>::of(1) >> 32) != 0);
+   }  // teardown
+};
+
+#endif // DEBUG
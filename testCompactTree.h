@@ -0,0 +1,349 @@
+/***********************************************************************
+ * Header:
+ *    TEST COMPACT TREE
+ * Summary:
+ *    Unit tests for compactTree
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "compactTree.h"
+#include "unitTest.h"
+
+#include <cstdint>
+#include <random>
+#include <set>
+#include <string>
+
+/***********************************************
+ * TEST COMPACT TREE
+ * Unit tests for the CompactTree class
+ ***********************************************/
+class TestCompactTree : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_nodeSize();
+      test_constructCopy_standard();
+      test_constructMove_standard();
+
+      // Insert
+      test_insert_ascending();
+      test_insert_unique();
+
+      // Find
+      test_find_standard();
+      test_bounds_standard();
+
+      // Iterator
+      test_iterator_decrement();
+      test_iterator_grow();
+
+      // Remove
+      test_erase_reuse();
+      test_erase_random();
+      test_erase_strings();
+      test_clear_standard();
+
+      report("CompactTree");
+   }
+
+   typedef custom::CompactTree <int> Tree;
+
+   // no red node with a red child, the same blacks on every path,
+   // each child pointing back at its parent. Returns the black height
+   template <class TT>
+   int blackHeight(const custom::CompactTree <TT> & tree, uint32_t i, uint32_t iParent = Tree::NIL)
+   {
+      if (i == Tree::NIL)
+         return 1;
+      assertUnit(tree._parent(i) == iParent);
+      if (tree._isRed(i))
+      {
+         assertUnit(!tree._isRed(tree.nodes[i].left));
+         assertUnit(!tree._isRed(tree.nodes[i].right));
+      }
+      int heightLeft  = blackHeight(tree, tree.nodes[i].left,  i);
+      int heightRight = blackHeight(tree, tree.nodes[i].right, i);
+      assertUnit(heightLeft == heightRight);
+      return heightLeft + (tree._isRed(i) ? 0 : 1);
+   }
+   template <class TT>
+   void assertValid(const custom::CompactTree <TT> & tree)
+   {
+      assertUnit(!tree._isRed(tree.root));
+      blackHeight(tree, tree.root);
+   }
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // default constructor, no allocations
+   void test_construct_default()
+   {  // setup
+      // exercise
+      Tree tree;
+      // verify
+      assertUnit(tree.empty());
+      assertUnit(tree.nodes.capacity() == 0);
+      assertUnit(tree.root == Tree::NIL);
+      assertUnit(tree.begin() == tree.end());
+      assertUnit(tree.find(0) == tree.end());
+   }  // teardown
+
+   // an int and three 32-bit links, the color riding on the parent
+   void test_construct_nodeSize()
+   {  // setup
+      // exercise and verify
+      assertUnit(sizeof(Tree::Node) == 16);
+      assertUnit(sizeof(custom::CompactTree<uint64_t>::Node) == 24);
+   }  // teardown
+
+   // a copy is the same vector, so the same indices
+   void test_constructCopy_standard()
+   {  // setup
+      Tree treeSrc;
+      for (int i = 0; i < 100; i++)
+         treeSrc.insert(i * 3);
+      // exercise
+      Tree treeDest(treeSrc);
+      // verify
+      assertUnit(treeDest.size() == 100);
+      assertUnit(treeDest.root == treeSrc.root);
+      assertUnit(treeDest.nodes.data() != treeSrc.nodes.data());
+      assertValid(treeDest);
+      treeDest.insert(1);
+      assertUnit(treeSrc.find(1) == treeSrc.end());
+      assertUnit(treeDest.find(1) != treeDest.end());
+   }  // teardown
+
+   // move constructor takes the vector and leaves nothing behind
+   void test_constructMove_standard()
+   {  // setup
+      Tree treeSrc{ 5, 3, 8 };
+      // exercise
+      Tree treeDest(std::move(treeSrc));
+      // verify
+      assertUnit(treeSrc.empty());
+      assertUnit(treeSrc.root == Tree::NIL);
+      assertUnit(treeSrc.begin() == treeSrc.end());
+      assertUnit(treeDest.size() == 3);
+      assertUnit(*treeDest.begin() == 3);
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // in order, kept balanced, each node next to the last in the vector
+   void test_insert_ascending()
+   {  // setup
+      Tree tree;
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         tree.insert(i);
+      // verify
+      assertUnit(tree.size() == 1000);
+      assertUnit(tree.nodes.size() == 1000);
+      assertUnit(tree.height() <= 2 * 10);
+      assertValid(tree);
+      for (uint32_t i = 0; i < 1000; i++)
+         assertUnit(tree.nodes[i].data == (int)i);
+   }  // teardown
+
+   // a repeat is turned away when asked, and kept when not
+   void test_insert_unique()
+   {  // setup
+      Tree tree{ 1, 2, 3 };
+      // exercise
+      auto result = tree.insert(2, true);
+      // verify
+      assertUnit(result.second == false);
+      assertUnit(*result.first == 2);
+      assertUnit(tree.size() == 3);
+      // exercise
+      result = tree.insert(2);
+      // verify
+      assertUnit(result.second == true);
+      assertUnit(tree.size() == 4);
+      assertValid(tree);
+   }  // teardown
+
+   /***************************************
+    * FIND
+    ***************************************/
+
+   // everything there is found, and nothing between
+   void test_find_standard()
+   {  // setup
+      Tree tree;
+      for (int i = 0; i < 500; i++)
+         tree.insert((i * 37) % 500 * 2);
+      // exercise and verify
+      for (int i = 0; i < 1000; i++)
+      {
+         auto it = tree.find(i);
+         if (i % 2 == 0)
+            assertUnit(it != tree.end() && *it == i);
+         else
+            assertUnit(it == tree.end());
+      }
+   }  // teardown
+
+   // the first not less, and the first greater
+   void test_bounds_standard()
+   {  // setup
+      Tree tree{ 10, 20, 30, 40 };
+      // exercise and verify
+      assertUnit(*tree.lower_bound(5)  == 10);
+      assertUnit(*tree.lower_bound(20) == 20);
+      assertUnit(*tree.upper_bound(20) == 30);
+      assertUnit(*tree.lower_bound(35) == 40);
+      assertUnit(tree.lower_bound(41) == tree.end());
+      assertUnit(tree.upper_bound(40) == tree.end());
+   }  // teardown
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // back from end() to the first
+   void test_iterator_decrement()
+   {  // setup
+      Tree tree;
+      for (int i = 0; i < 100; i++)
+         tree.insert(99 - i);
+      auto it = tree.end();
+      // exercise
+      --it;
+      // verify
+      int expected = 99;
+      for (; it != tree.end(); --it)
+         assertUnit(*it == expected--);
+      assertUnit(expected == -1);
+   }  // teardown
+
+   // an iterator is an index, so it lives through the vector growing
+   void test_iterator_grow()
+   {  // setup
+      Tree tree{ 50 };
+      auto it = tree.find(50);
+      const void * pBefore = tree.nodes.data();
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         tree.insert(i + 100);
+      // verify
+      assertUnit(tree.nodes.data() != pBefore);
+      assertUnit(*it == 50);
+      ++it;
+      assertUnit(*it == 100);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // an erased slot is the next one filled
+   void test_erase_reuse()
+   {  // setup
+      Tree tree;
+      for (int i = 0; i < 10; i++)
+         tree.insert(i);
+      auto it = tree.find(4);
+      uint32_t iErased = it.index;
+      // exercise
+      auto itNext = tree.erase(it);
+      // verify
+      assertUnit(*itNext == 5);
+      assertUnit(tree.freeHead == iErased);
+      assertUnit(tree.find(4) == tree.end());
+      // exercise
+      auto result = tree.insert(100);
+      // verify
+      assertUnit(result.first.index == iErased);
+      assertUnit(tree.freeHead == Tree::NIL);
+      assertUnit(tree.nodes.size() == 10);
+      assertValid(tree);
+   }  // teardown
+
+   // many inserts and erases, checked against std::set
+   void test_erase_random()
+   {  // setup
+      Tree tree;
+      std::set<int> expected;
+      std::mt19937 random(17);
+      std::uniform_int_distribution<int> any(0, 999);
+      // exercise
+      for (int i = 0; i < 20000; i++)
+      {
+         int value = any(random);
+         if (i % 3 == 2)
+         {
+            auto it = tree.find(value);
+            if (it != tree.end())
+               tree.erase(it);
+            expected.erase(value);
+         }
+         else
+         {
+            tree.insert(value, true);
+            expected.insert(value);
+         }
+      }
+      // verify
+      assertValid(tree);
+      assertUnit(tree.size() == expected.size());
+      assertUnit(tree.nodes.size() <= 1000);
+      auto itExpected = expected.begin();
+      for (auto it = tree.begin(); it != tree.end(); ++it, ++itExpected)
+         assertUnit(itExpected != expected.end() && *it == *itExpected);
+      assertUnit(itExpected == expected.end());
+   }  // teardown
+
+   // an erased string lets go of its buffer, and a move takes it
+   void test_erase_strings()
+   {  // setup
+      custom::CompactTree <std::string> tree;
+      tree.insert(std::string(100, 'a'));
+      tree.insert(std::string(100, 'b'));
+      auto it = tree.begin();
+      uint32_t iErased = it.index;
+      // exercise
+      tree.erase(it);
+      // verify
+      assertUnit(tree.nodes[iErased].data.empty());
+      assertUnit(tree.size() == 1);
+      assertUnit(*tree.begin() == std::string(100, 'b'));
+      assertValid(tree);
+   }  // teardown
+
+   // clear empties the vector but keeps its room
+   void test_clear_standard()
+   {  // setup
+      Tree tree;
+      for (int i = 0; i < 100; i++)
+         tree.insert(i);
+      size_t capacity = tree.nodes.capacity();
+      // exercise
+      tree.clear();
+      // verify
+      assertUnit(tree.empty());
+      assertUnit(tree.nodes.empty());
+      assertUnit(tree.nodes.capacity() == capacity);
+      assertUnit(tree.begin() == tree.end());
+      tree.insert(7);
+      assertUnit(*tree.begin() == 7);
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,256 @@
+/***********************************************************************
+ * Header:
+ *    TEST ELIAS FANO
+ * Summary:
+ *    Unit tests for eliasFano
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "eliasFano.h"
+#include "unitTest.h"
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************
+ * TEST ELIAS FANO
+ * Unit tests for the elias_fano_set class
+ ***********************************************/
+class TestEliasFano : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_bits();
+      test_construct_set();
+      test_construct_dense();
+      test_construct_compact();
+
+      // Select
+      test_at_standard();
+
+      // Find
+      test_find_standard();
+      test_lowerBound_standard();
+      test_lowerBound_sameHigh();
+      test_rank_standard();
+
+      // Iterator
+      test_iterator_inOrder();
+      test_iterator_decrement();
+
+      report("EliasFano");
+   }
+
+   typedef custom::elias_fano_set <uint64_t> IDs;
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // default constructor
+   void test_construct_default()
+   {  // setup
+      // exercise
+      IDs s;
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.highs.empty());
+      assertUnit(s.begin() == s.end());
+      assertUnit(s.find(0) == s.end());
+      assertUnit(s.lower_bound(0) == s.end());
+      assertUnit(s.rank(100) == 0);
+   }  // teardown
+
+   // the low bits as they are, the high ones in unary
+   void test_construct_bits()
+   {  // setup
+      //   5 = 00101, 8 = 01000, 9 = 01001, 30 = 11110, n = 4, L = 2
+      //   lows   01 00 01 10
+      //   highs  0:  01  2: 1 3: 0  ... 7: 1
+      std::vector<uint64_t> v{ 5, 8, 9, 30 };
+      // exercise
+      IDs s(v.begin(), v.end());
+      // verify
+      assertUnit(s.size() == 4);
+      assertUnit(s.numLowBits == 2);
+      assertUnit(s.lows[0] == (1 | 0 << 2 | 1 << 4 | 2 << 6));
+      // 5 has high 1 at bit 1+0, 8 and 9 have high 2 at bits 2+1 and 2+2, 30 has high 7 at bit 7+3
+      assertUnit(s.highs[0] == (1 << 1 | 1 << 3 | 1 << 4 | 1 << 10));
+      assertUnit(s.largest == 30);
+   }  // teardown
+
+   // built straight from a set
+   void test_construct_set()
+   {  // setup
+      custom::set <uint64_t> ids;
+      for (uint64_t i = 0; i < 5000; i++)
+         ids.insert(i * i * 31);
+      // exercise
+      IDs s(ids);
+      // verify
+      assertUnit(s.size() == 5000);
+      auto it = s.begin();
+      for (auto itSet = ids.begin(); itSet != ids.end(); ++itSet, ++it)
+         assertUnit(it != s.end() && *it == *itSet);
+      assertUnit(it == s.end());
+   }  // teardown
+
+   // more elements than the universe is wide leaves no low bits
+   void test_construct_dense()
+   {  // setup
+      std::vector<uint64_t> v;
+      for (uint64_t i = 0; i < 1000; i++)
+         v.push_back(i);
+      // exercise
+      IDs s(v.begin(), v.end());
+      // verify
+      assertUnit(s.numLowBits == 0);
+      assertUnit(s.lows.size() == 1);
+      assertUnit(*s.find(0) == 0);
+      assertUnit(*s.find(999) == 999);
+      assertUnit(*s.lower_bound(500) == 500);
+      assertUnit(s.find(1000) == s.end());
+   }  // teardown
+
+   // about 2 + log2(U/n) bits an element, and a little for the samples
+   void test_construct_compact()
+   {  // setup
+      std::vector<uint64_t> v;
+      for (uint64_t i = 0; i < 100000; i++)
+         v.push_back(i * 1100 + (i * 7919) % 1100);
+      // exercise
+      IDs s(v.begin(), v.end());
+      // verify
+      assertUnit(s.numLowBits == 10);
+      assertUnit(s.bytes() * 8 < 100000 * (2 + 10 + 1));
+   }  // teardown
+
+   /***************************************
+    * SELECT
+    ***************************************/
+
+   // the element of each rank, past many samples
+   void test_at_standard()
+   {  // setup
+      std::vector<uint64_t> v;
+      for (uint64_t i = 0; i < 10000; i++)
+         v.push_back(i * 5 + (i % 5));
+      IDs s(v.begin(), v.end());
+      // exercise and verify
+      for (size_t i = 0; i < v.size(); i++)
+         assertUnit(s.at(i) == v[i]);
+   }  // teardown
+
+   /***************************************
+    * FIND
+    ***************************************/
+
+   // every element is found, and nothing between them
+   void test_find_standard()
+   {  // setup
+      std::vector<uint64_t> v;
+      for (uint64_t i = 0; i < 5000; i++)
+         v.push_back(i * 1000003ull + ((uint64_t)1 << 40));
+      IDs s(v.begin(), v.end());
+      // exercise and verify
+      for (auto x : v)
+      {
+         assertUnit(s.find(x) != s.end() && *s.find(x) == x);
+         assertUnit(s.find(x + 1) == s.end());
+      }
+      assertUnit(s.find(0) == s.end());
+   }  // teardown
+
+   // the first element not less than the key
+   void test_lowerBound_standard()
+   {  // setup
+      std::vector<uint64_t> v{ 10, 70000, 70001, 3000000000ull, 0xFFFFFFFFFFFFFFFFull };
+      IDs s(v.begin(), v.end());
+      // exercise and verify
+      assertUnit(*s.lower_bound(0) == 10);
+      assertUnit(*s.lower_bound(10) == 10);
+      assertUnit(*s.lower_bound(11) == 70000);
+      assertUnit(*s.lower_bound(70001) == 70001);
+      assertUnit(*s.lower_bound(70002) == 3000000000ull);
+      assertUnit(*s.lower_bound(3000000001ull) == 0xFFFFFFFFFFFFFFFFull);
+   }  // teardown
+
+   // many elements with one high part, then a bigger one
+   void test_lowerBound_sameHigh()
+   {  // setup
+      std::vector<uint64_t> v{ 0, 1, 2, 3, 1000, 1001, 1002, 1003, 5000 };
+      IDs s(v.begin(), v.end());
+      // exercise and verify
+      for (uint64_t x = 0; x <= 5000; x++)
+      {
+         auto it = s.lower_bound(x);
+         uint64_t expected = (x <= 3 ? x : x <= 1000 ? 1000 : x <= 1003 ? x : 5000);
+         assertUnit(it != s.end() && *it == expected);
+      }
+      assertUnit(s.lower_bound(5001) == s.end());
+   }  // teardown
+
+   // how many come before, and at() undoes it
+   void test_rank_standard()
+   {  // setup
+      std::vector<uint64_t> v;
+      for (uint64_t i = 0; i < 3000; i++)
+         v.push_back(i * 10);
+      IDs s(v.begin(), v.end());
+      // exercise and verify
+      assertUnit(s.rank(0) == 0);
+      assertUnit(s.rank(1) == 1);
+      assertUnit(s.rank(10) == 1);
+      assertUnit(s.rank(15000) == 1500);
+      assertUnit(s.rank(29990) == 2999);
+      assertUnit(s.rank(30000) == 3000);
+      assertUnit(s.at(s.rank(12340)) == 12340);
+      assertUnit(s.lower_bound(12345).index() == 1235);
+   }  // teardown
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // walking the bits in order gives the sorted elements
+   void test_iterator_inOrder()
+   {  // setup
+      std::vector<uint64_t> v;
+      for (uint64_t i = 0; i < 20000; i++)
+         v.push_back(i * i);
+      IDs s(v.begin(), v.end());
+      // exercise and verify
+      size_t i = 0;
+      for (auto it = s.begin(); it != s.end(); it++, i++)
+         assertUnit(*it == v[i]);
+      assertUnit(i == v.size());
+   }  // teardown
+
+   // walk back from the largest to the smallest
+   void test_iterator_decrement()
+   {  // setup
+      std::vector<uint64_t> v;
+      for (uint64_t i = 0; i < 1000; i++)
+         v.push_back(i * 7);
+      IDs s(v.begin(), v.end());
+      auto it = s.find(6993);
+      // exercise
+      long long expected = 6993;
+      for (; it != s.end(); --it, expected -= 7)
+         assertUnit((long long)*it == expected);
+      // verify
+      assertUnit(expected == -7);
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,252 @@
+/***********************************************************************
+ * Header:
+ *    TEST FLAT SET
+ * Summary:
+ *    Unit tests for flatSet
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "flatSet.h"
+#include "unitTest.h"
+
+#include <vector>
+
+/***********************************************
+ * TEST FLAT SET
+ * Unit tests for the flat_set class
+ ***********************************************/
+class TestFlatSet : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_constructInit_unsorted();
+      test_constructCopy_standard();
+
+      // Iterator
+      test_iterator_pointer();
+
+      // Find
+      test_find_standard();
+      test_find_missing();
+
+      // Insert
+      test_insert_one();
+      test_insert_duplicate();
+      test_insertRange_empty();
+      test_insertRange_merge();
+      test_insertRange_duplicates();
+
+      // Remove
+      test_eraseIterator_standard();
+      test_eraseValue_missing();
+      test_eraseRange_standard();
+
+      // Compare
+      test_compare_standard();
+
+      report("FlatSet");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // default constructor
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::flat_set <int> s;
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.size() == 0);
+      assertUnit(s.begin() == s.end());
+   }  // teardown
+
+   // an initializer list comes out sorted and unique
+   void test_constructInit_unsorted()
+   {  // setup
+      // exercise
+      custom::flat_set <int> s{ 50, 30, 70, 30, 10 };
+      // verify
+      assertUnit(s.elements == std::vector<int>({ 10, 30, 50, 70 }));
+   }  // teardown
+
+   // copy has its own array
+   void test_constructCopy_standard()
+   {  // setup
+      custom::flat_set <int> sSrc{ 10, 20, 30 };
+      // exercise
+      custom::flat_set <int> sDest(sSrc);
+      // verify
+      assertUnit(sDest.elements == sSrc.elements);
+      assertUnit(sDest.begin() != sSrc.begin());
+   }  // teardown
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // the iterators are pointers into one array
+   void test_iterator_pointer()
+   {  // setup
+      custom::flat_set <int> s{ 10, 20, 30 };
+      // exercise
+      const int * p = s.begin();
+      // verify
+      assertUnit(p == s.elements.data());
+      assertUnit(s.end() - s.begin() == 3);
+      assertUnit(p[0] == 10);
+      assertUnit(p[1] == 20);
+      assertUnit(p[2] == 30);
+   }  // teardown
+
+   /***************************************
+    * FIND
+    ***************************************/
+
+   // every element is found where it is
+   void test_find_standard()
+   {  // setup
+      custom::flat_set <int> s{ 10, 20, 30, 40, 50 };
+      // exercise and verify
+      for (int i = 0; i < 5; i++)
+         assertUnit(s.find((i + 1) * 10) == s.begin() + i);
+   }  // teardown
+
+   // nothing between them is found
+   void test_find_missing()
+   {  // setup
+      custom::flat_set <int> s{ 10, 20, 30, 40, 50 };
+      // exercise and verify
+      for (int i = 5; i <= 55; i += 10)
+         assertUnit(s.find(i) == s.end());
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // one element goes in its place
+   void test_insert_one()
+   {  // setup
+      custom::flat_set <int> s{ 10, 30 };
+      // exercise
+      auto result = s.insert(20);
+      // verify
+      assertUnit(result.second == true);
+      assertUnit(result.first == s.begin() + 1);
+      assertUnit(s.elements == std::vector<int>({ 10, 20, 30 }));
+   }  // teardown
+
+   // something already there stays as it is
+   void test_insert_duplicate()
+   {  // setup
+      custom::flat_set <int> s{ 10, 20, 30 };
+      // exercise
+      auto result = s.insert(20);
+      // verify
+      assertUnit(result.second == false);
+      assertUnit(result.first == s.begin() + 1);
+      assertUnit(s.size() == 3);
+   }  // teardown
+
+   // an empty range changes nothing
+   void test_insertRange_empty()
+   {  // setup
+      custom::flat_set <int> s{ 10, 20 };
+      std::vector<int> v;
+      // exercise
+      s.insert(v.begin(), v.end());
+      // verify
+      assertUnit(s.elements == std::vector<int>({ 10, 20 }));
+   }  // teardown
+
+   // a batch lands in order among what is there
+   void test_insertRange_merge()
+   {  // setup
+      custom::flat_set <int> s{ 10, 40, 70 };
+      std::vector<int> v{ 80, 5, 50, 20 };
+      // exercise
+      s.insert(v.begin(), v.end());
+      // verify
+      assertUnit(s.elements == std::vector<int>({ 5, 10, 20, 40, 50, 70, 80 }));
+   }  // teardown
+
+   // repeats within the batch and with the set are dropped
+   void test_insertRange_duplicates()
+   {  // setup
+      custom::flat_set <int> s{ 10, 20, 30 };
+      std::vector<int> v{ 30, 25, 10, 25, 25, 40 };
+      // exercise
+      s.insert(v.begin(), v.end());
+      // verify
+      assertUnit(s.elements == std::vector<int>({ 10, 20, 25, 30, 40 }));
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // erase returns the one after
+   void test_eraseIterator_standard()
+   {  // setup
+      custom::flat_set <int> s{ 10, 20, 30 };
+      // exercise
+      auto it = s.erase(s.find(20));
+      // verify
+      assertUnit(it != s.end() && *it == 30);
+      assertUnit(s.elements == std::vector<int>({ 10, 30 }));
+   }  // teardown
+
+   // erasing something not there changes nothing
+   void test_eraseValue_missing()
+   {  // setup
+      custom::flat_set <int> s{ 10, 20, 30 };
+      // exercise
+      size_t num = s.erase(25);
+      // verify
+      assertUnit(num == 0);
+      assertUnit(s.size() == 3);
+   }  // teardown
+
+   // erase a run from the middle
+   void test_eraseRange_standard()
+   {  // setup
+      custom::flat_set <int> s{ 10, 20, 30, 40, 50 };
+      // exercise
+      auto it = s.erase(s.find(20), s.find(50));
+      // verify
+      assertUnit(it != s.end() && *it == 50);
+      assertUnit(s.elements == std::vector<int>({ 10, 50 }));
+   }  // teardown
+
+   /***************************************
+    * COMPARE
+    ***************************************/
+
+   // equal when the elements are, ordered like a dictionary
+   void test_compare_standard()
+   {  // setup
+      custom::flat_set <int> s1{ 10, 20, 30 };
+      custom::flat_set <int> s2{ 30, 20, 10 };
+      custom::flat_set <int> s3{ 10, 25 };
+      // exercise and verify
+      assertUnit(s1 == s2);
+      assertUnit(!(s1 != s2));
+      assertUnit(s1 != s3);
+      assertUnit(s1 < s3);
+      assertUnit(s3 > s1);
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,214 @@
+/***********************************************************************
+ * Header:
+ *    TEST FROZEN SET
+ * Summary:
+ *    Unit tests for frozenSet
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "frozenSet.h"
+#include "unitTest.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************
+ * TEST FROZEN SET
+ * Unit tests for the frozen_set class
+ ***********************************************/
+class TestFrozenSet : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_layout();
+      test_construct_unsorted();
+      test_construct_aligned();
+      test_constructCopy_standard();
+
+      // Iterator
+      test_iterator_inOrder();
+      test_iterator_decrement();
+
+      // Find
+      test_find_standard();
+      test_find_missing();
+      test_lowerBound_standard();
+      test_lowerBound_string();
+
+      report("FrozenSet");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // default constructor
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::frozen_set <int> s;
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.elements == nullptr);
+      assertUnit(s.begin() == s.end());
+      assertUnit(s.find(0) == s.end());
+      assertUnit(s.lower_bound(0) == s.end());
+   }  // teardown
+
+   // the elements are in breadth-first order of a balanced tree
+   void test_construct_layout()
+   {  // setup
+      //                 50
+      //          +-------+-------+
+      //         30              70
+      //     +----+----+     +----+
+      //    20        40    60
+      // exercise
+      custom::frozen_set <int> s{ 20, 30, 40, 50, 60, 70 };
+      // verify
+      assertUnit(s.size() == 6);
+      assertUnit(s.elements[1] == 50);
+      assertUnit(s.elements[2] == 30);
+      assertUnit(s.elements[3] == 70);
+      assertUnit(s.elements[4] == 20);
+      assertUnit(s.elements[5] == 40);
+      assertUnit(s.elements[6] == 60);
+   }  // teardown
+
+   // out of order with repeats comes out sorted and unique
+   void test_construct_unsorted()
+   {  // setup
+      std::vector<int> v{ 70, 20, 50, 20, 30, 70 };
+      // exercise
+      custom::frozen_set <int> s(v.begin(), v.end());
+      // verify
+      assertUnit(s.size() == 4);
+      assertUnit(s.elements[1] == 50);
+      assertUnit(s.elements[2] == 30);
+      assertUnit(s.elements[3] == 70);
+      assertUnit(s.elements[4] == 20);
+   }  // teardown
+
+   // the array starts on a cache line
+   void test_construct_aligned()
+   {  // setup
+      // exercise
+      custom::frozen_set <int> s{ 1, 2, 3 };
+      // verify
+      assertUnit((uintptr_t)s.elements % 64 == 0);
+      assertUnit(custom::frozen_set<int>::PER_LINE == 16);
+   }  // teardown
+
+   // copy has its own array
+   void test_constructCopy_standard()
+   {  // setup
+      custom::frozen_set <std::string> sSrc{ "b", "a", "c" };
+      // exercise
+      custom::frozen_set <std::string> sDest(sSrc);
+      // verify
+      assertUnit(sDest.size() == 3);
+      assertUnit(sDest.elements != sSrc.elements);
+      assertUnit(sDest.elements[1] == "b");
+      assertUnit(sDest.elements[2] == "a");
+      assertUnit(sDest.elements[3] == "c");
+   }  // teardown
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // walking the array in order gives the sorted elements
+   void test_iterator_inOrder()
+   {  // setup
+      std::vector<int> v;
+      for (int i = 0; i < 1000; i++)
+         v.push_back(i * 3);
+      custom::frozen_set <int> s(v.begin(), v.end());
+      // exercise and verify
+      int expected = 0;
+      for (auto it = s.begin(); it != s.end(); ++it, expected += 3)
+         assertUnit(*it == expected);
+      assertUnit(expected == 3000);
+   }  // teardown
+
+   // walk back from the largest to the smallest
+   void test_iterator_decrement()
+   {  // setup
+      std::vector<int> v;
+      for (int i = 0; i < 100; i++)
+         v.push_back(i);
+      custom::frozen_set <int> s(v.begin(), v.end());
+      auto it = s.find(99);
+      // exercise
+      int expected = 99;
+      for (; it != s.end(); --it)
+         assertUnit(*it == expected--);
+      // verify
+      assertUnit(expected == -1);
+   }  // teardown
+
+   /***************************************
+    * FIND
+    ***************************************/
+
+   // every element is found where it is
+   void test_find_standard()
+   {  // setup
+      std::vector<int> v;
+      for (int i = 0; i < 1000; i++)
+         v.push_back(i * 2);
+      custom::frozen_set <int> s(v.begin(), v.end());
+      // exercise and verify
+      for (int i = 0; i < 1000; i++)
+      {
+         auto it = s.find(i * 2);
+         assertUnit(it != s.end() && *it == i * 2);
+      }
+   }  // teardown
+
+   // nothing between them is found, nor past either end
+   void test_find_missing()
+   {  // setup
+      custom::frozen_set <int> s{ 20, 30, 40, 50, 60, 70 };
+      // exercise and verify
+      for (int i = 15; i <= 75; i += 10)
+         assertUnit(s.find(i) == s.end());
+   }  // teardown
+
+   // the first element not less than the key
+   void test_lowerBound_standard()
+   {  // setup
+      custom::frozen_set <int> s{ 20, 30, 40, 50, 60, 70 };
+      // exercise and verify
+      assertUnit(*s.lower_bound(0) == 20);
+      assertUnit(*s.lower_bound(20) == 20);
+      assertUnit(*s.lower_bound(21) == 30);
+      assertUnit(*s.lower_bound(45) == 50);
+      assertUnit(*s.lower_bound(70) == 70);
+      assertUnit(s.lower_bound(71) == s.end());
+   }  // teardown
+
+   // the same for elements that are not cheap to compare
+   void test_lowerBound_string()
+   {  // setup
+      custom::frozen_set <std::string> s{ "delta", "alpha", "charlie", "bravo" };
+      // exercise and verify
+      assertUnit(*s.lower_bound("b") == "bravo");
+      assertUnit(*s.lower_bound("charlie") == "charlie");
+      assertUnit(s.lower_bound("echo") == s.end());
+      assertUnit(s.find("char") == s.end());
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,257 @@
+/***********************************************************************
+ * Header:
+ *    TEST NODE POOL
+ * Summary:
+ *    Unit tests for nodePool
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "nodePool.h"
+#include "bst.h"
+#include "unitTest.h"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+/***********************************************
+ * TEST NODE POOL
+ * Unit tests for the NodePool class
+ ***********************************************/
+class TestNodePool : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Allocate
+      test_allocate_aligned();
+      test_allocate_slab();
+      test_deallocate_reuse();
+      test_deallocate_otherThread();
+      test_deallocate_threadEnded();
+
+      // Arena
+      test_arena_carve();
+      test_arena_block();
+      test_arena_release();
+
+      // BST
+      test_bst_fromPool();
+      test_bst_churn();
+
+      report("NodePool");
+   }
+
+   // a size no tree node has, so nothing else shares these slabs
+   typedef custom::NodePool <200, 8> Pool;
+
+   /***************************************
+    * ALLOCATE
+    ***************************************/
+
+   // each node is aligned, and apart from the others
+   void test_allocate_aligned()
+   {  // setup
+      // exercise
+      void * p1 = Pool::allocate();
+      void * p2 = Pool::allocate();
+      // verify
+      assertUnit(Pool::SLOT_BYTES == 200);
+      assertUnit(((uintptr_t)p1 & 7) == 0);
+      assertUnit(((uintptr_t)p2 & 7) == 0);
+      assertUnit((char *)p2 - (char *)p1 == 200);
+      // teardown
+      Pool::deallocate(p2);
+      Pool::deallocate(p1);
+   }
+
+   // a new slab only once the last is used up
+   void test_allocate_slab()
+   {  // setup
+      size_t numPerSlab = (Pool::SLAB_BYTES - Pool::HEADER_BYTES) / Pool::SLOT_BYTES;
+      std::vector<void *> nodes;
+      nodes.push_back(Pool::allocate());
+      size_t numSlabs = Pool::slabs();
+      // exercise
+      while (Pool::_local().pNext != Pool::_local().pEnd)
+         nodes.push_back(Pool::allocate());
+      // verify
+      assertUnit(Pool::slabs() == numSlabs);
+      nodes.push_back(Pool::allocate());
+      assertUnit(Pool::slabs() == numSlabs + 1);
+      assertUnit(Pool::_local().pEnd - Pool::_local().pNext == (ptrdiff_t)((numPerSlab - 1) * Pool::SLOT_BYTES));
+      // teardown
+      for (auto p : nodes)
+         Pool::deallocate(p);
+   }
+
+   // the last one freed is the next one handed out
+   void test_deallocate_reuse()
+   {  // setup
+      void * p1 = Pool::allocate();
+      void * p2 = Pool::allocate();
+      // exercise
+      Pool::deallocate(p1);
+      Pool::deallocate(p2);
+      // verify
+      assertUnit(Pool::allocate() == p2);
+      assertUnit(Pool::allocate() == p1);
+      // teardown
+      Pool::deallocate(p1);
+      Pool::deallocate(p2);
+   }
+
+   // made here and freed on another thread, they come back to us
+   void test_deallocate_otherThread()
+   {  // setup
+      size_t numPerSlab = (Pool::SLAB_BYTES - Pool::HEADER_BYTES) / Pool::SLOT_BYTES;
+      std::vector<void *> nodes;
+      size_t numSlabs = 0;
+      // exercise
+      for (int round = 0; round < 10; round++)
+      {
+         for (size_t i = 0; i < 4 * numPerSlab; i++)
+            nodes.push_back(Pool::allocate());
+         std::thread eraser([&nodes]()
+         {
+            for (auto p : nodes)
+               Pool::deallocate(p);
+         });
+         eraser.join();
+         nodes.clear();
+         if (round == 0)
+            numSlabs = Pool::slabs();
+      }
+      // verify
+      assertUnit(Pool::slabs() == numSlabs);
+   }  // teardown
+
+   // a thread's slabs outlive it until the last of its nodes is freed
+   void test_deallocate_threadEnded()
+   {  // setup
+      size_t numPerSlab = (Pool::SLAB_BYTES - Pool::HEADER_BYTES) / Pool::SLOT_BYTES;
+      size_t numSlabs = Pool::slabs();
+      std::vector<void *> nodes;
+      std::thread maker([&nodes, numPerSlab]()
+      {
+         for (size_t i = 0; i < 3 * numPerSlab; i++)
+            nodes.push_back(Pool::allocate());
+      });
+      maker.join();
+      assertUnit(Pool::slabs() == numSlabs + 3);
+      // exercise
+      for (size_t i = 1; i < nodes.size(); i++)
+         Pool::deallocate(nodes[i]);
+      // verify
+      assertUnit(Pool::slabs() == numSlabs + 3);
+      Pool::deallocate(nodes[0]);
+      assertUnit(Pool::slabs() == numSlabs);
+   }  // teardown
+
+   /***************************************
+    * ARENA
+    ***************************************/
+
+   // nodes one after another, in chunks that double, erased ones reused
+   void test_arena_carve()
+   {  // setup
+      custom::NodeArena arena(24, 8);
+      // exercise
+      char * p1 = (char *)arena.allocate();
+      char * p2 = (char *)arena.allocate();
+      // verify
+      assertUnit(arena.slotBytes == 24);
+      assertUnit(p2 - p1 == 24);
+      assertUnit(((uintptr_t)p1 & 7) == 0);
+      assertUnit(arena.bytes() == arena.headerBytes + (custom::NodeArena::CHUNK_BYTES_MIN - arena.headerBytes) / 24 * 24);
+      arena.deallocate(p1);
+      assertUnit(arena.allocate() == p1);
+      while (arena.pNext != arena.pEnd)
+         arena.allocate();
+      size_t numBytes = arena.bytes();
+      arena.allocate();
+      assertUnit(arena.bytes() - numBytes > numBytes);
+   }  // teardown
+
+   // a run of nodes has a chunk of its own
+   void test_arena_block()
+   {  // setup
+      custom::NodeArena arena(32, 8);
+      char * p1 = (char *)arena.allocate();
+      // exercise
+      char * pBlock = (char *)arena.allocate(1000);
+      // verify
+      assertUnit(arena.bytes() >= 1000 * 32);
+      assertUnit((char *)arena.allocate() == p1 + 32);
+      for (size_t i = 0; i < 1000 * 32; i++)
+         pBlock[i] = 1;
+   }  // teardown
+
+   // every chunk goes at once, and the arena can be used again
+   void test_arena_release()
+   {  // setup
+      custom::NodeArena arena(16, 8);
+      for (int i = 0; i < 100000; i++)
+         arena.allocate();
+      arena.deallocate(arena.allocate());
+      // exercise
+      arena.release();
+      // verify
+      assertUnit(arena.bytes() == 0);
+      assertUnit(arena.pChunks == nullptr);
+      assertUnit(arena.pFree == nullptr);
+      assertUnit(arena.allocate() != nullptr);
+   }  // teardown
+
+   /***************************************
+    * BST
+    ***************************************/
+
+   // new and delete of a node go through the pool
+   void test_bst_fromPool()
+   {  // setup
+      typedef custom::BST<int>::BNode BNode;
+      typedef custom::NodePool <sizeof(BNode), alignof(BNode)> BPool;
+      BNode * pNode = new BNode(50);
+      // exercise
+      delete pNode;
+      // verify
+      assertUnit(BPool::_local().pFree == (void *)pNode);
+      assertUnit(new BNode(60) == pNode);
+      delete pNode;
+   }  // teardown
+
+   // once a tree is full, erasing and inserting takes no new slabs
+   void test_bst_churn()
+   {  // setup
+      typedef custom::BST<int>::BNode BNode;
+      typedef custom::NodePool <sizeof(BNode), alignof(BNode)> BPool;
+      custom::BST<int> bst;
+      for (int i = 0; i < 20000; i++)
+         bst.insert((i * 7919) % 20000);
+      size_t numSlabs = BPool::slabs();
+      // exercise
+      for (int round = 0; round < 5; round++)
+      {
+         for (int i = 0; i < 20000; i += 2)
+         {
+            auto it = bst.find(i);
+            bst.erase(it);
+         }
+         for (int i = 0; i < 20000; i += 2)
+            bst.insert(i);
+      }
+      // verify
+      assertUnit(bst.size() == 20000);
+      assertUnit(BPool::slabs() == numSlabs);
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,234 @@
+/***********************************************************************
+ * Header:
+ *    TEST PERFECT SET
+ * Summary:
+ *    Unit tests for perfectSet
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "perfectSet.h"
+#include "unitTest.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************
+ * TEST PERFECT SET
+ * Unit tests for the perfect_set class
+ ***********************************************/
+class TestPerfectSet : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_set();
+      test_construct_slots();
+      test_construct_levels();
+      test_construct_compact();
+      test_constructCopy_standard();
+
+      // Find
+      test_contains_every();
+      test_contains_missing();
+      test_contains_string();
+      test_contains_leftovers();
+
+      report("PerfectSet");
+   }
+
+   typedef custom::perfect_set <uint64_t> AllowList;
+
+   // every element hashes the same, so none ever gets a bit of its own
+   struct SameHash
+   {
+      size_t operator () (uint64_t) const { return 42; }
+   };
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // default constructor
+   void test_construct_default()
+   {  // setup
+      // exercise
+      AllowList s;
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.levels.empty());
+      assertUnit(s.numBlocks == 0);
+      assertUnit(s.blocks == nullptr);
+      assertUnit(!s.contains(0));
+      assertUnit(s.count(7) == 0);
+   }  // teardown
+
+   // built straight from a set
+   void test_construct_set()
+   {  // setup
+      custom::set <uint64_t> ids;
+      for (uint64_t i = 0; i < 1000; i++)
+         ids.insert(i * 7919);
+      // exercise
+      AllowList s(ids);
+      // verify
+      assertUnit(s.size() == 1000);
+      for (auto it = ids.begin(); it != ids.end(); ++it)
+         assertUnit(s.contains(*it));
+   }  // teardown
+
+   // one slot for each element, and its bit leads to it
+   void test_construct_slots()
+   {  // setup
+      std::vector<uint64_t> v;
+      for (uint64_t i = 0; i < 5000; i++)
+         v.push_back(i);
+      // exercise
+      AllowList s(v.begin(), v.end());
+      // verify
+      assertUnit(s.elements.size() + s.leftovers.size() == 5000);
+      std::vector<bool> seen(5000, false);
+      for (size_t i = 0; i < s.elements.size(); i++)
+      {
+         assertUnit(!seen[s.elements[i]]);
+         seen[s.elements[i]] = true;
+      }
+      assertUnit(((uintptr_t)s.blocks & 63) == 0);
+      assertUnit(s.blocks[s.numBlocks - 1].rank <= s.elements.size());
+   }  // teardown
+
+   // each level is about twice as many bits as are left, and most stay on the first
+   void test_construct_levels()
+   {  // setup
+      std::vector<uint64_t> v;
+      for (uint64_t i = 0; i < 100000; i++)
+         v.push_back(i * i);
+      // exercise
+      AllowList s(v.begin(), v.end());
+      // verify
+      assertUnit(s.levels[0].firstBit == 0);
+      assertUnit(s.levels[0].numBits == 200000);
+      assertUnit(s.levels[1].firstBit == 200000);
+      assertUnit(s.levels[1].numBits < 100000);
+      assertUnit(s.levels.size() < 20);
+      assertUnit(s.leftovers.empty());
+      size_t numFirst = 0;
+      for (size_t b = 0; b * custom::perfect_set<uint64_t>::BITS_PER_BLOCK < 200000; b++)
+         for (size_t w = 0; w < custom::perfect_set<uint64_t>::WORDS_PER_BLOCK; w++)
+            if (b * custom::perfect_set<uint64_t>::BITS_PER_BLOCK + w * 64 < 200000)
+               numFirst += custom::popCount(s.blocks[b].bits[w]);
+      assertUnit(numFirst > 55000 && numFirst < 65000);
+   }  // teardown
+
+   // a few bits an element, beside the elements themselves, and a rank a block
+   void test_construct_compact()
+   {  // setup
+      std::vector<uint64_t> v;
+      for (uint64_t i = 0; i < 100000; i++)
+         v.push_back(i * 3);
+      // exercise
+      AllowList s(v.begin(), v.end());
+      // verify
+      size_t bitsEach = (s.bytes() - 100000 * sizeof(uint64_t)) * 8 / 100000;
+      assertUnit(bitsEach < 5);
+      assertUnit(s.numBlocks * custom::perfect_set<uint64_t>::WORDS_PER_BLOCK * 64 <
+                 s.levels.back().firstBit + s.levels.back().numBits + 448);
+   }  // teardown
+
+   // copy has its own blocks, on a cache line, and the same answers
+   void test_constructCopy_standard()
+   {  // setup
+      std::vector<uint64_t> v;
+      for (uint64_t i = 0; i < 3000; i++)
+         v.push_back(i * 11);
+      AllowList sSrc(v.begin(), v.end());
+      // exercise
+      AllowList sDest(sSrc);
+      // verify
+      assertUnit(sDest.blocks != sSrc.blocks);
+      assertUnit(((uintptr_t)sDest.blocks & 63) == 0);
+      assertUnit(sDest.numBlocks == sSrc.numBlocks);
+      assertUnit(sDest.size() == 3000);
+      for (auto x : v)
+         assertUnit(sDest.contains(x) && !sDest.contains(x + 1));
+      // exercise
+      AllowList sMoved(std::move(sSrc));
+      sSrc = sDest;
+      // verify
+      assertUnit(sMoved.contains(33));
+      assertUnit(sSrc.contains(33));
+      assertUnit(sSrc.blocks != sDest.blocks);
+   }  // teardown
+
+   /***************************************
+    * FIND
+    ***************************************/
+
+   // every element is there
+   void test_contains_every()
+   {  // setup
+      std::vector<uint64_t> v;
+      for (uint64_t i = 0; i < 50000; i++)
+         v.push_back(i * 1000003ull + ((uint64_t)1 << 40));
+      // exercise
+      AllowList s(v.begin(), v.end());
+      // verify
+      for (auto x : v)
+         assertUnit(s.contains(x));
+   }  // teardown
+
+   // nothing else is, even on a bit that is one
+   void test_contains_missing()
+   {  // setup
+      std::vector<uint64_t> v;
+      for (uint64_t i = 0; i < 50000; i++)
+         v.push_back(i * 2);
+      AllowList s(v.begin(), v.end());
+      // exercise and verify
+      for (uint64_t i = 0; i < 50000; i++)
+         assertUnit(!s.contains(i * 2 + 1));
+      assertUnit(!s.contains(100000));
+   }  // teardown
+
+   // anything std::hash knows
+   void test_contains_string()
+   {  // setup
+      std::vector<std::string> v;
+      for (int i = 0; i < 2000; i++)
+         v.push_back("tenant-" + std::to_string(i * 31));
+      // exercise
+      custom::perfect_set <std::string> s(v.begin(), v.end());
+      // verify
+      for (auto & name : v)
+         assertUnit(s.contains(name));
+      assertUnit(!s.contains("tenant-1"));
+      assertUnit(!s.contains(""));
+   }  // teardown
+
+   // those that never get a bit of their own are still found
+   void test_contains_leftovers()
+   {  // setup
+      std::vector<uint64_t> v{ 3, 1, 4, 15, 9 };
+      // exercise
+      custom::perfect_set <uint64_t, SameHash> s(v.begin(), v.end());
+      // verify
+      assertUnit(s.size() == 5);
+      assertUnit(s.elements.empty());
+      assertUnit(s.leftovers.size() == 5);
+      assertUnit(s.levels.size() == 32);
+      for (auto x : v)
+         assertUnit(s.contains(x));
+      assertUnit(!s.contains(2));
+   }  // teardown
+};
+
+#endif // DEBUG
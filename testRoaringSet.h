@@ -0,0 +1,362 @@
+/***********************************************************************
+ * Header:
+ *    TEST ROARING SET
+ * Summary:
+ *    Unit tests for roaringSet
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "roaringSet.h"
+#include "unitTest.h"
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************
+ * TEST ROARING SET
+ * Unit tests for the roaring_set class
+ ***********************************************/
+class TestRoaringSet : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Container
+      test_container_arrayToBitmap();
+      test_container_bitmapToArray();
+      test_container_fitRuns();
+      test_container_insertRun();
+      test_container_eraseRun();
+
+      // Construct
+      test_construct_default();
+      test_construct_chunks();
+
+      // Find
+      test_find_standard();
+      test_lowerBound_standard();
+
+      // Iterator
+      test_iterator_kinds();
+      test_iterator_decrement();
+
+      // Remove
+      test_erase_lastInChunk();
+
+      // Set Algebra
+      test_union_standard();
+      test_intersect_standard();
+      test_difference_standard();
+
+      report("RoaringSet");
+   }
+
+   typedef custom::RoaringContainer Container;
+   typedef custom::roaring_set <uint32_t> Postings;
+
+   /***************************************
+    * CONTAINER
+    ***************************************/
+
+   // past 4096 values, a bitmap is smaller
+   void test_container_arrayToBitmap()
+   {  // setup
+      Container c;
+      for (uint32_t x = 0; x < 8192; x += 2)
+         c.insert((uint16_t)x);
+      assertUnit(c.type() == Container::ARRAY);
+      assertUnit(c.size() == 4096);
+      // exercise
+      c.insert(1);
+      // verify
+      assertUnit(c.type() == Container::BITMAP);
+      assertUnit(c.size() == 4097);
+      assertUnit(c.words.size() == Container::NUM_WORDS);
+      assertUnit(c.values.empty());
+      assertUnit(c.contains(1) && c.contains(8190) && !c.contains(3));
+   }  // teardown
+
+   // down to 4096 values, the array is back
+   void test_container_bitmapToArray()
+   {  // setup
+      Container c;
+      for (uint32_t x = 0; x <= 4096; x++)
+         c.insert((uint16_t)(x * 3));
+      assertUnit(c.type() == Container::BITMAP);
+      // exercise
+      c.erase(300);
+      // verify
+      assertUnit(c.type() == Container::ARRAY);
+      assertUnit(c.size() == 4096);
+      assertUnit(c.values.size() == 4096);
+      assertUnit(c.values[100] == 303);
+   }  // teardown
+
+   // long stretches of values take one run each
+   void test_container_fitRuns()
+   {  // setup
+      Container c;
+      for (uint32_t x = 1000; x < 11000; x++)
+         c.insert((uint16_t)x);
+      c.insert(20000);
+      assertUnit(c.type() == Container::BITMAP);
+      // exercise
+      c.fit();
+      // verify
+      assertUnit(c.type() == Container::RUN);
+      assertUnit(c.values.size() == 4);
+      assertUnit(c.values[0] == 1000 && c.values[1] == 9999);
+      assertUnit(c.values[2] == 20000 && c.values[3] == 0);
+      assertUnit(c.size() == 10001);
+      assertUnit(c.contains(10999) && !c.contains(11000));
+      assertUnit(c.next(11000) == 20000);
+      assertUnit(c.last(19999) == 10999);
+      assertUnit(c.next(20001) == Container::NONE);
+   }  // teardown
+
+   // a value next to a run grows it, and closing a gap joins two
+   void test_container_insertRun()
+   {  // setup
+      Container c;
+      for (uint32_t x = 10; x < 20; x++)
+         c.insert((uint16_t)x);
+      for (uint32_t x = 21; x < 30; x++)
+         c.insert((uint16_t)x);
+      c.fit();
+      assertUnit(c.type() == Container::RUN && c.values.size() == 4);
+      // exercise
+      c.insert(9);
+      c.insert(20);
+      // verify
+      assertUnit(c.type() == Container::RUN);
+      assertUnit(c.values.size() == 2);
+      assertUnit(c.values[0] == 9 && c.values[1] == 20);
+      assertUnit(c.size() == 21);
+      assertUnit(c.insert(15) == false);
+   }  // teardown
+
+   // erasing in the middle cuts a run in two, and too many go back to an array
+   void test_container_eraseRun()
+   {  // setup
+      Container c;
+      for (uint32_t x = 0; x < 100; x++)
+         c.insert((uint16_t)x);
+      c.fit();
+      // exercise
+      c.erase(50);
+      // verify
+      assertUnit(c.type() == Container::RUN);
+      assertUnit(c.values.size() == 4);
+      assertUnit(c.values[1] == 49 && c.values[2] == 51 && c.values[3] == 48);
+      assertUnit(c.size() == 99);
+      // exercise
+      for (uint32_t x = 1; x < 100; x += 2)
+         c.erase((uint16_t)x);
+      // verify
+      assertUnit(c.type() == Container::ARRAY);
+      assertUnit(c.size() == 49);
+      assertUnit(c.values[0] == 0 && c.values[48] == 98);
+   }  // teardown
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // default constructor
+   void test_construct_default()
+   {  // setup
+      // exercise
+      Postings s;
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.highs.empty());
+      assertUnit(s.begin() == s.end());
+      assertUnit(s.find(0) == s.end());
+      assertUnit(s.lower_bound(0) == s.end());
+   }  // teardown
+
+   // one container for each high half, in order
+   void test_construct_chunks()
+   {  // setup
+      // exercise
+      Postings s{ 0x30005, 5, 0xFFFFFFFF, 0x30001 };
+      // verify
+      assertUnit(s.size() == 4);
+      assertUnit(s.highs.size() == 3);
+      assertUnit(s.highs[0] == 0 && s.highs[1] == 3 && s.highs[2] == 0xFFFF);
+      assertUnit(s.containers[1].size() == 2);
+      assertUnit(s.containers[1].values[0] == 1);
+   }  // teardown
+
+   /***************************************
+    * FIND
+    ***************************************/
+
+   // every element is found, and nothing between them
+   void test_find_standard()
+   {  // setup
+      Postings s;
+      for (uint32_t i = 0; i < 20000; i++)
+         s.insert(i * 977);
+      // exercise and verify
+      assertUnit(s.size() == 20000);
+      for (uint32_t i = 0; i < 20000; i++)
+      {
+         assertUnit(s.find(i * 977) != s.end() && *s.find(i * 977) == i * 977);
+         assertUnit(s.find(i * 977 + 1) == s.end());
+      }
+   }  // teardown
+
+   // the first element not less than the key, across containers
+   void test_lowerBound_standard()
+   {  // setup
+      Postings s{ 10, 70000, 70001, 3000000000u, 0xFFFFFFFF };
+      // exercise and verify
+      assertUnit(*s.lower_bound(0) == 10);
+      assertUnit(*s.lower_bound(10) == 10);
+      assertUnit(*s.lower_bound(11) == 70000);
+      assertUnit(*s.upper_bound(70000) == 70001);
+      assertUnit(*s.lower_bound(70002) == 3000000000u);
+      assertUnit(*s.upper_bound(3000000000u) == 0xFFFFFFFF);
+      assertUnit(s.upper_bound(0xFFFFFFFF) == s.end());
+   }  // teardown
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // in order through an array, a bitmap and runs
+   void test_iterator_kinds()
+   {  // setup
+      Postings s;
+      std::vector<uint32_t> expected;
+      for (uint32_t i = 0; i < 100; i++)
+         expected.push_back(i * 7);
+      for (uint32_t i = 0; i < 10000; i++)
+         expected.push_back(0x10000 + i * 3);
+      for (uint32_t i = 0; i < 5000; i++)
+         expected.push_back(0x20000 + i);
+      s.insert(expected.begin(), expected.end());
+      s.optimize();
+      assertUnit(s.containers[0].type() == Container::ARRAY);
+      assertUnit(s.containers[1].type() == Container::BITMAP);
+      assertUnit(s.containers[2].type() == Container::RUN);
+      // exercise and verify
+      size_t i = 0;
+      for (auto it = s.begin(); it != s.end(); ++it, ++i)
+         assertUnit(i < expected.size() && *it == expected[i]);
+      assertUnit(i == expected.size());
+   }  // teardown
+
+   // walk back from the largest to the smallest
+   void test_iterator_decrement()
+   {  // setup
+      Postings s;
+      for (uint32_t i = 0; i < 300000; i += 7)
+         s.insert(i);
+      auto it = s.find(299999);
+      // exercise
+      long long expected = 299999;
+      for (; it != s.end(); --it, expected -= 7)
+         assertUnit(*it == expected);
+      // verify
+      assertUnit(expected == -7);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // the container goes with its last element
+   void test_erase_lastInChunk()
+   {  // setup
+      Postings s{ 1, 0x50000, 0x90000 };
+      auto it = s.find(0x50000);
+      // exercise
+      auto itNext = s.erase(it);
+      // verify
+      assertUnit(itNext != s.end() && *itNext == 0x90000);
+      assertUnit(s.size() == 2);
+      assertUnit(s.highs.size() == 2);
+      assertUnit(s.highs[1] == 9);
+      assertUnit(s.erase(0x50000) == 0);
+   }  // teardown
+
+   /***************************************
+    * SET ALGEBRA
+    ***************************************/
+
+   // everything in either, whatever the containers
+   void test_union_standard()
+   {  // setup
+      Postings sEven;
+      Postings sThree;
+      for (uint32_t i = 0; i < 200000; i += 2)
+         sEven.insert(i);
+      for (uint32_t i = 0; i < 300000; i += 3)
+         sThree.insert(i);
+      sThree.optimize();
+      // exercise
+      sEven |= sThree;
+      // verify
+      assertUnit(sEven.size() == 100000 + 100000 - 33334);
+      for (uint32_t i = 0; i < 300000; i += 97)
+         assertUnit((sEven.find(i) != sEven.end()) == ((i < 200000 && i % 2 == 0) || i % 3 == 0));
+   }  // teardown
+
+   // only what is in both, down to nothing at all
+   void test_intersect_standard()
+   {  // setup
+      Postings sEven;
+      Postings sFew{ 4, 5, 100000, 1000000 };
+      Postings sRun;
+      for (uint32_t i = 0; i < 200000; i += 2)
+         sEven.insert(i);
+      for (uint32_t i = 50000; i < 60000; i++)
+         sRun.insert(i);
+      sRun.optimize();
+      // exercise
+      Postings sBoth = sEven & sFew;
+      sRun &= sEven;
+      // verify
+      assertUnit(sBoth.size() == 2);
+      assertUnit(*sBoth.begin() == 4);
+      assertUnit(sRun.size() == 5000);
+      assertUnit(*sRun.begin() == 50000);
+      // exercise
+      sBoth &= Postings{ 1 };
+      // verify
+      assertUnit(sBoth.empty() && sBoth.highs.empty());
+   }  // teardown
+
+   // what is here but not there
+   void test_difference_standard()
+   {  // setup
+      Postings sAll;
+      Postings sOdd;
+      for (uint32_t i = 0; i < 100000; i++)
+         sAll.insert(i);
+      for (uint32_t i = 1; i < 70000; i += 2)
+         sOdd.insert(i);
+      // exercise
+      sAll -= sOdd;
+      // verify
+      assertUnit(sAll.size() == 100000 - 35000);
+      assertUnit(sAll.find(69999) == sAll.end());
+      assertUnit(sAll.find(70001) != sAll.end());
+      assertUnit(sAll.find(68000) != sAll.end());
+      // exercise
+      sAll -= sAll;
+      // verify
+      assertUnit(sAll.empty());
+   }  // teardown
+};
+
+#endif // DEBUG
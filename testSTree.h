@@ -0,0 +1,305 @@
+/***********************************************************************
+ * Header:
+ *    TEST S TREE
+ * Summary:
+ *    Unit tests for sTree
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "sTree.h"
+#include "unitTest.h"
+
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+/***********************************************
+ * TEST S TREE
+ * Unit tests for the STree class
+ ***********************************************/
+class TestSTree : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_construct_layout();
+      test_construct_pmr();
+      test_construct_aligned();
+      test_constructCopy_standard();
+
+      // Rank
+      test_rank_kernels();
+      test_detect_standard();
+
+      // Lower Bound
+      test_lowerBound_standard();
+      test_lowerBound_pastLargest();
+      test_lowerBound_intMax();
+      test_contains_standard();
+
+      // Batch
+      test_lowerBoundBatch_standard();
+      test_containsBatch_standard();
+
+      report("STree");
+   }
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // default constructor
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::STree tree;
+      // verify
+      assertUnit(tree.empty());
+      assertUnit(tree.numNodes == 0);
+      assertUnit(tree.height() == 0);
+      assertUnit(tree.lower_bound(0) == nullptr);
+      assertUnit(!tree.contains(0));
+   }  // teardown
+
+   // the first child fills before its parent, and the rest is padding
+   void test_construct_layout()
+   {  // setup
+      custom::set <int> s;
+      for (int i = 1; i <= 20; i++)
+         s.insert(i);
+      // exercise
+      custom::STree tree(s);
+      // verify
+      assertUnit(tree.size() == 20);
+      assertUnit(tree.numNodes == 2);
+      assertUnit(tree.height() == 2);
+      assertUnit(tree.largest == 20);
+      for (int i = 0; i < 16; i++)
+         assertUnit(tree.nodes[16 + i] == i + 1);
+      for (int i = 0; i < 4; i++)
+         assertUnit(tree.nodes[i] == 17 + i);
+      for (int i = 4; i < 16; i++)
+         assertUnit(tree.nodes[i] == INT_MAX);
+   }  // teardown
+
+   // a set with an allocator of its own
+   void test_construct_pmr()
+   {
+#ifdef SET_HAS_PMR
+      // setup
+      std::pmr::monotonic_buffer_resource resource;
+      custom::pmr::set <int> s(&resource);
+      for (int i = 1; i <= 20; i++)
+         s.insert(i);
+      // exercise
+      custom::STree tree(s);
+      // verify
+      assertUnit(tree.size() == 20);
+      assertUnit(tree.largest == 20);
+      for (int i = 0; i < 16; i++)
+         assertUnit(tree.nodes[16 + i] == i + 1);
+#endif // SET_HAS_PMR
+   }  // teardown
+
+   // every node is one cache line
+   void test_construct_aligned()
+   {  // setup
+      custom::set <int> s{ 1, 2, 3 };
+      // exercise
+      custom::STree tree(s);
+      // verify
+      assertUnit((uintptr_t)tree.nodes % 64 == 0);
+      assertUnit(custom::STree::KEYS * sizeof(int) == 64);
+   }  // teardown
+
+   // copy has its own nodes
+   void test_constructCopy_standard()
+   {  // setup
+      custom::set <int> s;
+      for (int i = 0; i < 100; i++)
+         s.insert(i * 2);
+      custom::STree treeSrc(s);
+      // exercise
+      custom::STree treeDest(treeSrc);
+      // verify
+      assertUnit(treeDest.nodes != treeSrc.nodes);
+      assertUnit(treeDest.size() == 100);
+      assertUnit(treeDest.contains(198));
+      assertUnit(!treeDest.contains(199));
+   }  // teardown
+
+   /***************************************
+    * RANK
+    ***************************************/
+
+   // each instruction set counts the same keys
+   void test_rank_kernels()
+   {  // setup
+      custom::set <int> s;
+      for (int i = 0; i < 16; i++)
+         s.insert(i * 10 - 50);
+      custom::STree tree(s);
+      // exercise and verify
+      for (int key = -60; key <= 110; key++)
+      {
+         unsigned int expected = custom::STree::rankScalar(tree.nodes, key);
+         assertUnit(expected == (unsigned int)(key < -50 ? 0 : key > 100 ? 16 : (key + 59) / 10));
+#ifdef STREE_X86
+         assertUnit(custom::STree::rankSse2(tree.nodes, key) == expected);
+         if (custom::STree::detect() == custom::STree::AVX2)
+            assertUnit(custom::STree::rankAvx2(tree.nodes, key) == expected);
+#endif
+      }
+   }  // teardown
+
+   // the tree uses what the machine has
+   void test_detect_standard()
+   {  // setup
+      custom::set <int> s{ 1 };
+      // exercise
+      custom::STree tree(s);
+      // verify
+      assertUnit(tree.simdUsed() == custom::STree::detect());
+#ifdef STREE_X86
+      assertUnit(tree.simdUsed() != custom::STree::SCALAR);
+#endif
+      // exercise
+      tree.useSimd(custom::STree::SCALAR);
+      // verify
+      assertUnit(tree.simdUsed() == custom::STree::SCALAR);
+      // exercise
+      tree.useSimd(custom::STree::AVX2);
+      // verify
+      assertUnit(tree.simdUsed() == custom::STree::detect());
+   }  // teardown
+
+   /***************************************
+    * LOWER BOUND
+    ***************************************/
+
+   // the first element not less than the key, whatever searches the nodes
+   void test_lowerBound_standard()
+   {  // setup
+      custom::set <int> s;
+      for (int i = 0; i < 5000; i++)
+         s.insert(i * 3);
+      custom::STree tree(s);
+      // exercise and verify
+      for (auto simd : levels())
+      {
+         tree.simd = simd;
+         for (int key = -2; key <= 14997; key++)
+         {
+            const int * p = tree.lower_bound(key);
+            int expected = (key < 0 ? 0 : (key + 2) / 3 * 3);
+            assertUnit(p != nullptr && *p == expected);
+         }
+      }
+   }  // teardown
+
+   // past the largest element, there is nothing, padding or not
+   void test_lowerBound_pastLargest()
+   {  // setup
+      custom::set <int> s{ 10, 20, 30 };
+      custom::STree tree(s);
+      // exercise and verify
+      assertUnit(*tree.lower_bound(30) == 30);
+      assertUnit(tree.lower_bound(31) == nullptr);
+      assertUnit(tree.lower_bound(INT_MAX) == nullptr);
+   }  // teardown
+
+   // INT_MAX as an element is found in front of the padding
+   void test_lowerBound_intMax()
+   {  // setup
+      custom::set <int> s{ INT_MIN, 0, INT_MAX };
+      custom::STree tree(s);
+      // exercise and verify
+      const int * p = tree.lower_bound(1);
+      assertUnit(p == tree.nodes + 2);
+      assertUnit(tree.contains(INT_MAX));
+      assertUnit(tree.contains(INT_MIN));
+      assertUnit(*tree.lower_bound(INT_MIN + 1) == 0);
+   }  // teardown
+
+   // every element is there, and nothing between them
+   void test_contains_standard()
+   {  // setup
+      custom::set <int> s;
+      for (int i = 0; i < 1000; i++)
+         s.insert(i * 2);
+      custom::STree tree(s);
+      // exercise and verify
+      for (int i = -1; i < 2001; i++)
+         assertUnit(tree.contains(i) == (i >= 0 && i < 2000 && i % 2 == 0));
+   }  // teardown
+
+   /***************************************
+    * BATCH
+    ***************************************/
+
+   // side by side gives what one at a time does
+   void test_lowerBoundBatch_standard()
+   {  // setup
+      custom::set <int> s;
+      for (int i = 0; i < 3000; i++)
+         s.insert(i * 5);
+      custom::STree tree(s);
+      std::vector<int> keys;
+      for (int i = 0; i < 1001; i++)
+         keys.push_back((i * 7919) % 15100 - 50);
+      std::vector<const int *> results(keys.size());
+      // exercise and verify
+      for (auto simd : levels())
+      {
+         tree.simd = simd;
+         tree.lower_bound(keys.data(), keys.size(), results.data());
+         for (size_t i = 0; i < keys.size(); i++)
+            assertUnit(results[i] == tree.lower_bound(keys[i]));
+      }
+   }  // teardown
+
+   // the batch says which keys are there, and counts them
+   void test_containsBatch_standard()
+   {  // setup
+      custom::set <int> s;
+      for (int i = 0; i < 100; i++)
+         s.insert(i * 2);
+      custom::STree tree(s);
+      std::vector<int> keys;
+      for (int i = -10; i < 210; i++)
+         keys.push_back(i);
+      bool found[220];
+      // exercise
+      size_t numFound = tree.contains(keys.data(), keys.size(), found);
+      // verify
+      assertUnit(numFound == 100);
+      for (size_t i = 0; i < keys.size(); i++)
+         assertUnit(found[i] == tree.contains(keys[i]));
+   }  // teardown
+
+   /*************************************************************
+    * LEVELS
+    * The ways of searching a node this machine can run
+    *************************************************************/
+   std::vector<custom::STree::Simd> levels()
+   {
+      std::vector<custom::STree::Simd> simds{ custom::STree::SCALAR };
+#ifdef STREE_X86
+      simds.push_back(custom::STree::SSE2);
+      if (custom::STree::detect() == custom::STree::AVX2)
+         simds.push_back(custom::STree::AVX2);
+#endif
+      return simds;
+   }
+};
+
+#endif // DEBUG
@@ -16,7 +16,24 @@
 
 #include "testSet.h"        // for the set unit tests
 #include "testBST.h"        // for the BST unit tests
+#include "testBTree.h"      // for the B-tree unit tests
+#include "testBPlusTree.h"  // for the B+ tree unit tests
+#include "testSkipList.h"   // for the skip list unit tests
+#include "testCompactTree.h" // for the compact tree unit tests
+#include "testART.h"        // for the adaptive radix tree unit tests
+#include "testVEB.h"        // for the van Emde Boas tree unit tests
+#include "testBitset.h"     // for the bitset unit tests
+#include "testFlatSet.h"    // for the flat_set unit tests
+#include "testFrozenSet.h"  // for the frozen_set unit tests
+#include "testSTree.h"      // for the static search tree unit tests
+#include "testUnorderedSet.h" // for the unordered_set unit tests
+#include "testRoaringSet.h" // for the roaring_set unit tests
+#include "testEliasFano.h"  // for the elias_fano_set unit tests
+#include "testPerfectSet.h" // for the perfect_set unit tests
+#include "testBloomFilter.h" // for the Bloom filter unit tests
+#include "testNodePool.h"   // for the node pool unit tests
 #include "testSpy.h"        // for the spy unit tests
+#include "benchBST.h"       // for the BST benchmarks (build with -DBENCHMARK)
 int Spy::counters[] = {};
 
 /**********************************************************************
@@ -29,8 +46,29 @@ int main()
    // unit tests
    TestSpy().run();
    TestBST().run();
+   TestBTree().run();
+   TestBPlusTree().run();
+   TestSkipList().run();
+   TestCompactTree().run();
+   TestART().run();
+   TestVEB().run();
+   TestBitset().run();
+   TestBloomFilter().run();
+   TestNodePool().run();
    TestSet().run();
+   TestFlatSet().run();
+   TestFrozenSet().run();
+   TestSTree().run();
+   TestUnorderedSet().run();
+   TestRoaringSet().run();
+   TestEliasFano().run();
+   TestPerfectSet().run();
 #endif // DEBUG
+
+#ifdef BENCHMARK
+   // benchmarks
+   BenchBST().run();
+#endif // BENCHMARK
    
    return 0;
 }
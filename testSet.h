@@ -52,6 +52,7 @@ public:
       test_assign_oneToStandard();
       test_assign_standardToOne();
       test_assign_standardToStandard();
+      test_assign_compact();
       test_assignMove_emptyToEmpty();
       test_assignMove_standardToEmpty();
       test_assignMove_emptyToStandard();
@@ -104,6 +105,36 @@ public:
       test_insertInit_standardInsertNone();
       test_insertInit_standardInsertDuplicates();
       test_insertInit_manyInsertMany();
+      test_insert_balanceAscending();
+      test_insert_btree();
+      test_insert_bplustree();
+      test_insert_skipList();
+      test_insert_compact();
+      test_insert_art();
+      test_insert_veb();
+      test_insert_bitset();
+
+      // Split and Join
+      test_splitJoin_treap();
+
+      // Set Algebra
+      test_algebra_bitset();
+
+      // Freeze
+      test_freeze_standard();
+
+      // Bloom Filter
+      test_bloom_standard();
+      test_bloom_missSkipsTree();
+      test_bloom_grows();
+      test_bloom_eraseRebuilds();
+      test_bloom_copy();
+
+      // Allocator
+      test_alloc_pmr();
+      test_alloc_pmrCopy();
+      test_alloc_pmrSplit();
+      test_alloc_pmrJoin();
 
       // Remove
       test_clear_empty();
@@ -751,6 +782,27 @@ public:
       assertEmptyFixture(bstDest);
    }  // teardown
 
+   // assignment operator: the same, with its nodes in one vector
+   void test_assign_compact()
+   {  // setup
+      custom::set <int, custom::CompactEngine> sSrc{ 50, 30, 70, 20, 40, 60, 80 };
+      custom::set <int, custom::CompactEngine> sDest{ 1, 2 };
+      // exercise
+      sDest = sSrc;
+      // verify
+      assertUnit(sDest.size() == 7);
+      assertUnit(sSrc.size() == 7);
+      int expected = 20;
+      for (auto it = sDest.begin(); it != sDest.end(); ++it, expected += 10)
+         assertUnit(*it == expected);
+      assertUnit(expected == 90);
+      assertUnit(sDest.find(1) == sDest.end());
+      // exercise
+      sSrc.erase(50);
+      // verify
+      assertUnit(sDest.find(50) != sDest.end());
+   }  // teardown
+
    // assignment-move operator: empty = move(standard)
    void test_assignMove_standardToEmpty()
    {  // setup
@@ -1947,6 +1999,559 @@ public:
    }
 
 
+   // the same increasing values under each balancing policy
+   void test_insert_balanceAscending()
+   {  // setup
+      custom::set <int>                     sRedBlack;
+      custom::set <int, custom::AVL>        sAVL;
+      custom::set <int, custom::Unbalanced> sUnbalanced;
+      // exercise
+      for (int i = 0; i < 100; i++)
+      {
+         sRedBlack.insert(i);
+         sAVL.insert(i);
+         sUnbalanced.insert(i);
+      }
+      // verify
+      assertUnit(sRedBlack.size() == 100);
+      assertUnit(sAVL.size() == 100);
+      assertUnit(sUnbalanced.size() == 100);
+      assertUnit(sRedBlack.rotations() > 0);
+      assertUnit(sAVL.rotations() > 0);
+      assertUnit(sUnbalanced.rotations() == 0);
+      assertUnit(sAVL.bst.height() <= sRedBlack.bst.height());
+      assertUnit(sRedBlack.bst.height() < sUnbalanced.bst.height());
+      auto itRedBlack = sRedBlack.begin();
+      auto itAVL = sAVL.begin();
+      for (auto it = sUnbalanced.begin(); it != sUnbalanced.end(); ++it, ++itRedBlack, ++itAVL)
+      {
+         assertUnit(*it == *itRedBlack);
+         assertUnit(*it == *itAVL);
+      }
+   }  // teardown
+
+   // the same set, kept in a B-tree instead
+   void test_insert_btree()
+   {  // setup
+      custom::set <int, custom::BTreeEngine<1>> s;
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         s.insert((i * 7) % 1000);
+      // verify
+      assertUnit(s.size() == 1000);
+      assertUnit(s.bst.height() <= 4);
+      assertUnit(s.insert(500).second == false);
+      assertUnit(s.find(999) != s.end());
+      assertUnit(s.find(1000) == s.end());
+      int expected = 0;
+      for (auto it = s.begin(); it != s.end(); ++it)
+         assertUnit(*it == expected++);
+      assertUnit(expected == 1000);
+      // exercise
+      for (int i = 0; i < 1000; i += 2)
+         s.erase(i);
+      // verify
+      assertUnit(s.size() == 500);
+      expected = 1;
+      for (auto it = s.begin(); it != s.end(); ++it, expected += 2)
+         assertUnit(*it == expected);
+   }  // teardown
+
+   // the same set, kept in the leaves of a B+ tree
+   void test_insert_bplustree()
+   {  // setup
+      custom::set <int, custom::BPlusTreeEngine<1>> s;
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         s.insert((i * 7) % 1000);
+      // verify
+      assertUnit(s.size() == 1000);
+      assertUnit(s.bst.height() <= 4);
+      assertUnit(s.insert(500).second == false);
+      assertUnit(s.find(999) != s.end());
+      assertUnit(s.find(1000) == s.end());
+      int expected = 0;
+      for (auto it = s.begin(); it != s.end(); ++it)
+         assertUnit(*it == expected++);
+      assertUnit(expected == 1000);
+      // exercise
+      for (int i = 0; i < 1000; i += 2)
+         s.erase(i);
+      // verify
+      assertUnit(s.size() == 500);
+      expected = 1;
+      for (auto it = s.begin(); it != s.end(); ++it, expected += 2)
+         assertUnit(*it == expected);
+   }  // teardown
+
+   // the same set, kept in a skip list
+   void test_insert_skipList()
+   {  // setup
+      custom::set <int, custom::SkipListEngine<>> s;
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         s.insert((i * 7) % 1000);
+      // verify
+      assertUnit(s.size() == 1000);
+      assertUnit(s.insert(500).second == false);
+      assertUnit(s.find(999) != s.end());
+      assertUnit(s.find(1000) == s.end());
+      int expected = 0;
+      for (auto it = s.begin(); it != s.end(); ++it)
+         assertUnit(*it == expected++);
+      assertUnit(expected == 1000);
+      // exercise
+      for (int i = 0; i < 1000; i += 2)
+         s.erase(i);
+      // verify
+      assertUnit(s.size() == 500);
+      expected = 1;
+      for (auto it = s.begin(); it != s.end(); ++it, expected += 2)
+         assertUnit(*it == expected);
+   }  // teardown
+
+   // the same set, with its nodes in one vector
+   void test_insert_compact()
+   {  // setup
+      custom::set <int, custom::CompactEngine> s;
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         s.insert((i * 7) % 1000);
+      // verify
+      assertUnit(s.size() == 1000);
+      assertUnit(s.bst.height() <= 2 * 10);
+      assertUnit(s.insert(500).second == false);
+      assertUnit(s.find(999) != s.end());
+      assertUnit(s.find(1000) == s.end());
+      int expected = 0;
+      for (auto it = s.begin(); it != s.end(); ++it)
+         assertUnit(*it == expected++);
+      assertUnit(expected == 1000);
+      // exercise
+      for (int i = 0; i < 1000; i += 2)
+         s.erase(i);
+      // verify
+      assertUnit(s.size() == 500);
+      expected = 1;
+      for (auto it = s.begin(); it != s.end(); ++it, expected += 2)
+         assertUnit(*it == expected);
+   }  // teardown
+
+   // a set of strings, kept in a radix tree
+   void test_insert_art()
+   {  // setup
+      custom::set <std::string, custom::ArtEngine> s;
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         s.insert("key/" + std::to_string(i));
+      // verify
+      assertUnit(s.size() == 1000);
+      assertUnit(s.insert(std::string("key/500")).second == false);
+      assertUnit(s.find("key/999") != s.end());
+      assertUnit(s.find("key/1000") == s.end());
+      assertUnit(s.find("key/") == s.end());
+      std::string previous;
+      for (auto it = s.begin(); it != s.end(); ++it)
+      {
+         assertUnit(previous < *it);
+         previous = *it;
+      }
+      // exercise
+      for (int i = 0; i < 1000; i += 2)
+         s.erase("key/" + std::to_string(i));
+      // verify
+      assertUnit(s.size() == 500);
+      assertUnit(s.find("key/2") == s.end());
+      assertUnit(s.find("key/3") != s.end());
+   }  // teardown
+
+   // a bounded universe of unsigned keys picks the vEB engine
+   void test_insert_veb()
+   {  // setup
+      custom::set <uint32_t, custom::VebEngine<20>> s;
+      // exercise
+      for (uint32_t i = 0; i < 1000; i++)
+         s.insert(i * 1000);
+      // verify
+      assertUnit(s.size() == 1000);
+      assertUnit(s.insert(7000u).second == false);
+      assertUnit(s.insert(1u << 20).second == false);
+      assertUnit(s.find(999000) != s.end());
+      assertUnit(s.find(1) == s.end());
+      auto it = s.lower_bound(1);
+      assertUnit(it != s.end() && *it == 1000);
+      it = s.upper_bound(7000);
+      assertUnit(it != s.end() && *it == 8000);
+      uint32_t previous = 0;
+      size_t num = 0;
+      for (it = s.begin(); it != s.end(); ++it, num++)
+      {
+         assertUnit(num == 0 || previous < *it);
+         previous = *it;
+      }
+      assertUnit(num == 1000);
+      // exercise
+      for (uint32_t i = 0; i < 1000; i += 2)
+         s.erase(i * 1000);
+      // verify
+      assertUnit(s.size() == 500);
+      assertUnit(s.find(0) == s.end());
+      assertUnit(s.find(1000) != s.end());
+   }  // teardown
+
+   // a dense universe of small keys picks the bitset engine
+   void test_insert_bitset()
+   {  // setup
+      custom::set <uint16_t, custom::BitsetEngine<16>> s;
+      // exercise
+      for (uint32_t i = 0; i < 65536; i += 4)
+         s.insert((uint16_t)i);
+      // verify
+      assertUnit(s.size() == 16384);
+      assertUnit(s.insert((uint16_t)400).second == false);
+      assertUnit(s.find(65532) != s.end());
+      assertUnit(s.find(1) == s.end());
+      auto it = s.lower_bound(1);
+      assertUnit(it != s.end() && *it == 4);
+      it = s.upper_bound(400);
+      assertUnit(it != s.end() && *it == 404);
+      uint32_t expected = 0;
+      for (it = s.begin(); it != s.end(); ++it, expected += 4)
+         assertUnit(*it == expected);
+      assertUnit(expected == 65536);
+      // exercise
+      for (uint32_t i = 0; i < 65536; i += 8)
+         s.erase((uint16_t)i);
+      // verify
+      assertUnit(s.size() == 8192);
+      assertUnit(s.find(0) == s.end());
+      assertUnit(s.find(4) != s.end());
+   }  // teardown
+
+   /***************************************
+    * Split and Join
+    *    set::split(const T &)
+    *    set::join(set &, set &)
+    ***************************************/
+
+   // cut a set into shards and put them back together
+   void test_splitJoin_treap()
+   {  // setup
+      custom::set <int, custom::Treap> s;
+      for (int i = 0; i < 1000; i++)
+         s.insert(i);
+      // exercise
+      auto sHigh = s.split(600);
+      auto sMiddle = s.split(300);
+      // verify
+      assertUnit(s.size() == 300);
+      assertUnit(sMiddle.size() == 300);
+      assertUnit(sHigh.size() == 400);
+      assertUnit(s.find(300) == s.end());
+      assertUnit(sMiddle.find(300) != sMiddle.end());
+      assertUnit(sMiddle.find(600) == sMiddle.end());
+      assertUnit(sHigh.find(600) != sHigh.end());
+      // exercise
+      auto sLow = custom::set <int, custom::Treap> ::join(s, sMiddle);
+      auto sAll = custom::set <int, custom::Treap> ::join(sLow, sHigh);
+      // verify
+      assertUnit(s.empty());
+      assertUnit(sMiddle.empty());
+      assertUnit(sLow.empty());
+      assertUnit(sHigh.empty());
+      assertUnit(sAll.size() == 1000);
+      int expected = 0;
+      for (auto it = sAll.begin(); it != sAll.end(); ++it)
+         assertUnit(*it == expected++);
+      assertUnit(expected == 1000);
+   }  // teardown
+
+   /***************************************
+    * Set Algebra
+    *    set::operator|=(const set &)
+    *    set::operator&=(const set &)
+    *    set::operator-=(const set &)
+    ***************************************/
+
+   // shards that are live, minus those that are down, plus a new one
+   void test_algebra_bitset()
+   {  // setup
+      typedef custom::set <uint16_t, custom::BitsetEngine<16>> Shards;
+      Shards sLive;
+      Shards sRegion;
+      Shards sDown{ 3, 7, 1000 };
+      for (uint16_t i = 0; i < 2000; i++)
+         sLive.insert(i);
+      for (uint16_t i = 1000; i < 3000; i++)
+         sRegion.insert(i);
+      // exercise
+      sLive &= sRegion;
+      sLive -= sDown;
+      sLive |= Shards{ 5 };
+      // verify
+      assertUnit(sLive.size() == 1000);
+      auto it = sLive.begin();
+      assertUnit(*it == 5);
+      assertUnit(*++it == 1001);
+      assertUnit(sLive.find(1999) != sLive.end());
+      assertUnit(sLive.find(2000) == sLive.end());
+   }  // teardown
+
+   /***************************************
+    * Freeze
+    *    set::freeze()
+    ***************************************/
+
+   // a snapshot has the same elements and stays put as the set changes
+   void test_freeze_standard()
+   {  // setup
+      custom::set <int> s;
+      for (int i = 0; i < 1000; i++)
+         s.insert((i * 7) % 1000);
+      // exercise
+      custom::frozen_set <int> frozen = s.freeze();
+      s.erase(500);
+      s.insert(5000);
+      // verify
+      assertUnit(frozen.size() == 1000);
+      assertUnit(frozen.find(500) != frozen.end());
+      assertUnit(frozen.find(5000) == frozen.end());
+      int expected = 0;
+      for (auto it = frozen.begin(); it != frozen.end(); ++it)
+         assertUnit(*it == expected++);
+      assertUnit(expected == 1000);
+   }  // teardown
+
+   /***************************************
+    * Bloom Filter
+    *    set::use_bloom_filter()
+    *    set::bloom_false_positive_rate()
+    ***************************************/
+
+   // everything there is still found, with the filter built from what was there
+   void test_bloom_standard()
+   {  // setup
+      custom::set <int> s;
+      for (int i = 0; i < 100; i++)
+         s.insert(i * 2);
+      // exercise
+      s.use_bloom_filter();
+      // verify
+      assertUnit(s.has_bloom_filter());
+      assertUnit(s.pBloom->capacity == 200);
+      for (int i = 0; i < 100; i++)
+         assertUnit(s.find(i * 2) != s.end());
+      assertUnit(s.bloom_false_positive_rate() == 0.0);
+   }  // teardown
+
+   // most misses never get to the tree, and those that do are counted
+   void test_bloom_missSkipsTree()
+   {  // setup
+      custom::set <int> s;
+      s.use_bloom_filter();
+      for (int i = 0; i < 1000; i++)
+         s.insert(i * 2);
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         assertUnit(s.find(i * 2 + 1) == s.end());
+      // verify
+      assertUnit(s.pBloom->numNegatives + s.pBloom->numFalsePositives == 1000);
+      assertUnit(s.pBloom->numNegatives > 900);
+      assertUnit(s.bloom_false_positive_rate() < 0.1);
+      assertUnit(s.bloom_false_positive_rate() ==
+                 (double)s.pBloom->numFalsePositives / 1000.0);
+   }  // teardown
+
+   // inserting past what it was sized for builds it again, bigger
+   void test_bloom_grows()
+   {  // setup
+      custom::set <int> s;
+      s.use_bloom_filter();
+      assertUnit(s.pBloom->capacity == 64);
+      // exercise
+      for (int i = 0; i < 100; i++)
+         s.insert(i);
+      // verify
+      assertUnit(s.pBloom->capacity == 128);
+      assertUnit(s.pBloom->numAdded == 100);
+      for (int i = 0; i < 100; i++)
+         assertUnit(s.find(i) != s.end());
+   }  // teardown
+
+   // after enough erases, the next find starts over from what is left
+   void test_bloom_eraseRebuilds()
+   {  // setup
+      custom::set <int> s;
+      for (int i = 0; i < 1000; i++)
+         s.insert(i);
+      s.use_bloom_filter();
+      auto it = s.begin();
+      // exercise
+      for (int i = 0; i < 300; i++)
+         it = s.erase(it);
+      // verify
+      assertUnit(*it == 300);
+      assertUnit(s.pBloom->numErased == 300);
+      assertUnit(s.find(0) == s.end());
+      assertUnit(s.pBloom->numErased == 0);
+      assertUnit(s.pBloom->numAdded == 700);
+      assertUnit(s.find(500) != s.end());
+      // exercise
+      s.clear();
+      // verify
+      assertUnit(s.has_bloom_filter());
+      assertUnit(s.find(500) == s.end());
+      s.insert(500);
+      assertUnit(s.find(500) != s.end());
+   }  // teardown
+
+   // a copy has a filter of its own, and a move takes it along
+   void test_bloom_copy()
+   {  // setup
+      custom::set <int> sSrc{ 1, 2, 3 };
+      sSrc.use_bloom_filter();
+      // exercise
+      custom::set <int> sDest(sSrc);
+      custom::set <int> sMoved(std::move(sSrc));
+      // verify
+      assertUnit(sDest.has_bloom_filter());
+      assertUnit(sDest.pBloom != sMoved.pBloom);
+      assertUnit(sMoved.has_bloom_filter());
+      assertUnit(!sSrc.has_bloom_filter());
+      sDest.insert(4);
+      assertUnit(sDest.find(4) != sDest.end());
+      assertUnit(sMoved.find(4) == sMoved.end());
+   }  // teardown
+
+   /***************************************
+    * Allocator
+    *    set::set(alloc)
+    *    pmr::set
+    ***************************************/
+
+   // every node comes from the buffer, and nothing from the heap
+   void test_alloc_pmr()
+   {
+#ifdef SET_HAS_PMR
+      // setup
+      static char buffer[64 * 1024];
+      std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer),
+                                                   std::pmr::null_memory_resource());
+      // exercise
+      custom::pmr::set <int> s(&resource);
+      for (int i = 0; i < 1000; i++)
+         s.insert(i);
+      // verify
+      assertUnit(s.get_allocator().resource() == &resource);
+      assertUnit(s.size() == 1000);
+      int expected = 0;
+      for (auto it = s.begin(); it != s.end(); ++it)
+      {
+         assertUnit(*it == expected++);
+         assertUnit((const char *)&*it >= buffer && (const char *)&*it < buffer + sizeof(buffer));
+      }
+      assertUnit(expected == 1000);
+#endif // SET_HAS_PMR
+   }  // teardown
+
+   // a move keeps the resource; a copy uses the default one, as std::pmr does
+   void test_alloc_pmrCopy()
+   {
+#ifdef SET_HAS_PMR
+      // setup
+      std::pmr::monotonic_buffer_resource resource;
+      custom::pmr::set <int> sSrc(&resource);
+      for (int i = 0; i < 100; i++)
+         sSrc.insert(i);
+      // exercise
+      custom::pmr::set <int> sCopy(sSrc);
+      custom::pmr::set <int> sMoved(std::move(sSrc));
+      // verify
+      assertUnit(sCopy.get_allocator().resource() == std::pmr::get_default_resource());
+      assertUnit(sMoved.get_allocator().resource() == &resource);
+      assertUnit(sSrc.empty());
+      assertUnit(sCopy.size() == 100);
+      assertUnit(sMoved.size() == 100);
+      // exercise
+      custom::pmr::set <int> sOther(&resource);
+      sOther = std::move(sCopy);
+      // verify
+      assertUnit(sOther.get_allocator().resource() == &resource);
+      assertUnit(sOther.size() == 100);
+      assertUnit(sCopy.empty());
+#endif // SET_HAS_PMR
+   }  // teardown
+
+   // both halves of a split, and the join of them, keep the resource
+   void test_alloc_pmrSplit()
+   {
+#ifdef SET_HAS_PMR
+      // setup
+      static char buffer[64 * 1024];
+      std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer),
+                                                   std::pmr::null_memory_resource());
+      typedef custom::set <int, custom::Treap, std::pmr::polymorphic_allocator<int>> PmrTreapSet;
+      PmrTreapSet s(&resource);
+      for (int i = 0; i < 100; i++)
+         s.insert(i);
+      // exercise
+      PmrTreapSet rest = s.split(50);
+      // verify
+      assertUnit(s.get_allocator().resource() == &resource);
+      assertUnit(rest.get_allocator().resource() == &resource);
+      assertUnit(s.size() == 50);
+      assertUnit(rest.size() == 50);
+      int expected = 50;
+      for (auto it = rest.begin(); it != rest.end(); ++it)
+      {
+         assertUnit(*it == expected++);
+         assertUnit((const char *)&*it >= buffer && (const char *)&*it < buffer + sizeof(buffer));
+      }
+      assertUnit(expected == 100);
+      // exercise
+      PmrTreapSet both = PmrTreapSet::join(s, rest);
+      // verify
+      assertUnit(both.get_allocator().resource() == &resource);
+      assertUnit(both.size() == 100);
+      for (auto it = both.begin(); it != both.end(); ++it)
+         assertUnit((const char *)&*it >= buffer && (const char *)&*it < buffer + sizeof(buffer));
+#endif // SET_HAS_PMR
+   }  // teardown
+
+   // a join of sets on different resources copies rhs into lhs's
+   void test_alloc_pmrJoin()
+   {
+#ifdef SET_HAS_PMR
+      // setup
+      static char bufferLhs[64 * 1024];
+      std::pmr::monotonic_buffer_resource resourceLhs(bufferLhs, sizeof(bufferLhs),
+                                                      std::pmr::null_memory_resource());
+      std::pmr::monotonic_buffer_resource resourceRhs;
+      typedef custom::set <int, custom::Treap, std::pmr::polymorphic_allocator<int>> PmrTreapSet;
+      PmrTreapSet lhs(&resourceLhs);
+      PmrTreapSet rhs(&resourceRhs);
+      for (int i = 0; i < 50; i++)
+      {
+         lhs.insert(i);
+         rhs.insert(50 + i);
+      }
+      // exercise
+      PmrTreapSet both = PmrTreapSet::join(lhs, rhs);
+      // verify
+      assertUnit(lhs.empty());
+      assertUnit(rhs.empty());
+      assertUnit(both.get_allocator().resource() == &resourceLhs);
+      assertUnit(both.size() == 100);
+      int expected = 0;
+      for (auto it = both.begin(); it != both.end(); ++it)
+      {
+         assertUnit(*it == expected++);
+         assertUnit((const char *)&*it >= bufferLhs && (const char *)&*it < bufferLhs + sizeof(bufferLhs));
+      }
+      assertUnit(expected == 100);
+#endif // SET_HAS_PMR
+   }  // teardown
+
    /***************************************
     * Erase Range
     *    set::erase(itBegin, itBEnd)
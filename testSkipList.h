@@ -0,0 +1,301 @@
+/***********************************************************************
+ * Header:
+ *    TEST SKIP LIST
+ * Summary:
+ *    Unit tests for skipList
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "skipList.h"
+#include "unitTest.h"
+
+/***********************************************
+ * TEST SKIP LIST
+ * Unit tests for the SkipList class
+ ***********************************************/
+class TestSkipList : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Construct
+      test_construct_default();
+      test_constructCopy_standard();
+
+      // Insert
+      test_insert_empty();
+      test_insert_duplicate();
+      test_insert_ascending();
+      test_insert_levels();
+
+      // Find
+      test_find_standard();
+      test_find_missing();
+
+      // Iterator
+      test_iterator_decrement();
+
+      // Remove
+      test_erase_one();
+      test_erase_every();
+      test_erase_duplicates();
+
+      report("SkipList");
+   }
+
+   typedef custom::SkipList <int> List;
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // default constructor
+   void test_construct_default()
+   {  // setup
+      // exercise
+      List list;
+      // verify
+      assertUnit(list.numElements == 0);
+      assertUnit(list.numLevels == 0);
+      assertUnit(list.head[0] == nullptr);
+      assertUnit(list.begin() == list.end());
+   }  // teardown
+
+   // copy has the same towers made of new nodes
+   void test_constructCopy_standard()
+   {  // setup
+      List listSrc;
+      for (int i = 0; i < 500; i++)
+         listSrc.insert(i * 3, true);
+      // exercise
+      List listDest(listSrc);
+      // verify
+      assertUnit(listDest.size() == 500);
+      assertUnit(listDest.numLevels == listSrc.numLevels);
+      assertUnit(isValid(listDest));
+      auto itSrc = listSrc.begin();
+      for (auto it = listDest.begin(); it != listDest.end(); ++it, ++itSrc)
+      {
+         assertUnit(it.pNode != itSrc.pNode);
+         assertUnit(it.pNode->numLevels == itSrc.pNode->numLevels);
+         assertUnit(*it == *itSrc);
+      }
+      assertUnit(itSrc == listSrc.end());
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // the first insert starts every level it stands on
+   void test_insert_empty()
+   {  // setup
+      List list;
+      // exercise
+      auto result = list.insert(50, true);
+      // verify
+      assertUnit(result.second == true);
+      assertUnit(*result.first == 50);
+      assertUnit(list.size() == 1);
+      assertUnit(list.numLevels == result.first.pNode->numLevels);
+      for (size_t i = 0; i < list.numLevels; i++)
+         assertUnit(list.head[i] == result.first.pNode);
+      assertUnit(result.first.pNode->pPrev == nullptr);
+   }  // teardown
+
+   // a unique insert of something already there changes nothing
+   void test_insert_duplicate()
+   {  // setup
+      List list;
+      for (int i = 0; i < 100; i++)
+         list.insert(i, true);
+      // exercise
+      auto result = list.insert(42, true);
+      // verify
+      assertUnit(result.second == false);
+      assertUnit(*result.first == 42);
+      assertUnit(list.size() == 100);
+   }  // teardown
+
+   // in order, whatever order they go in
+   void test_insert_ascending()
+   {  // setup
+      List list;
+      // exercise
+      for (int i = 0; i < 1000; i++)
+         list.insert((i * 7) % 1000, true);
+      // verify
+      assertUnit(list.size() == 1000);
+      assertUnit(isValid(list));
+      int expected = 0;
+      for (auto it = list.begin(); it != list.end(); ++it)
+         assertUnit(*it == expected++);
+      assertUnit(expected == 1000);
+   }  // teardown
+
+   // each level holds about a quarter of the one below
+   void test_insert_levels()
+   {  // setup
+      List list;
+      // exercise
+      for (int i = 0; i < 4096; i++)
+         list.insert(i, true);
+      // verify
+      size_t onLevel[3] = {};
+      for (auto it = list.begin(); it != list.end(); ++it)
+         for (size_t i = 0; i < 3 && i < it.pNode->numLevels; i++)
+            onLevel[i]++;
+      assertUnit(onLevel[0] == 4096);
+      assertUnit(onLevel[1] > 4096 / 8 && onLevel[1] < 4096 / 2);
+      assertUnit(onLevel[2] > 4096 / 32 && onLevel[2] < 4096 / 8);
+      assertUnit(list.height() > 4 && list.height() < 12);
+   }  // teardown
+
+   /***************************************
+    * FIND
+    ***************************************/
+
+   // every element is found
+   void test_find_standard()
+   {  // setup
+      List list;
+      for (int i = 0; i < 1000; i++)
+         list.insert((i * 7) % 1000, true);
+      // exercise and verify
+      for (int i = 0; i < 1000; i++)
+      {
+         auto it = list.find(i);
+         assertUnit(it != list.end() && *it == i);
+      }
+   }  // teardown
+
+   // nothing between them is found
+   void test_find_missing()
+   {  // setup
+      List list;
+      for (int i = 0; i < 500; i++)
+         list.insert(i * 2, true);
+      // exercise and verify
+      for (int i = -1; i < 1000; i += 2)
+         assertUnit(list.find(i) == list.end());
+   }  // teardown
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // walk back from the largest to the smallest
+   void test_iterator_decrement()
+   {  // setup
+      List list;
+      for (int i = 0; i < 500; i++)
+         list.insert(i, true);
+      auto it = list.find(499);
+      // exercise
+      int expected = 499;
+      for (; it != list.end(); --it)
+         assertUnit(*it == expected--);
+      // verify
+      assertUnit(expected == -1);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // erase out of the middle of the list
+   void test_erase_one()
+   {  // setup
+      List list;
+      for (int i = 0; i < 500; i++)
+         list.insert(i, true);
+      auto it = list.find(250);
+      // exercise
+      auto itNext = list.erase(it);
+      // verify
+      assertUnit(list.size() == 499);
+      assertUnit(itNext != list.end() && *itNext == 251);
+      assertUnit(list.find(250) == list.end());
+      assertUnit(isValid(list));
+   }  // teardown
+
+   // erase everything, and the levels go with it
+   void test_erase_every()
+   {  // setup
+      List list;
+      for (int i = 0; i < 1000; i++)
+         list.insert(i, true);
+      // exercise
+      for (int i = 0; i < 1000; i++)
+      {
+         auto it = list.find((i * 7) % 1000);
+         list.erase(it);
+         if (i % 100 == 0)
+            assertUnit(isValid(list));
+      }
+      // verify
+      assertUnit(list.size() == 0);
+      assertUnit(list.numLevels == 0);
+      assertUnit(list.begin() == list.end());
+   }  // teardown
+
+   // with repeats, erase takes out the very node it is given
+   void test_erase_duplicates()
+   {  // setup
+      List list;
+      for (int i = 0; i < 20; i++)
+         list.insert(7);
+      auto it = list.begin();
+      for (int i = 0; i < 10; i++)
+         ++it;
+      auto pNode = it.pNode;
+      // exercise
+      list.erase(it);
+      // verify
+      assertUnit(list.size() == 19);
+      assertUnit(isValid(list));
+      for (auto itCheck = list.begin(); itCheck != list.end(); ++itCheck)
+         assertUnit(itCheck.pNode != pNode);
+   }  // teardown
+
+   /*************************************************************
+    * IS VALID
+    * Every level is in order and only skips over nodes, the
+    * back links match level 0, and the count is right
+    *************************************************************/
+   bool isValid(const List & list)
+   {
+      size_t num = 0;
+      const List::Node * pPrev = nullptr;
+      for (const List::Node * p = list.head[0]; p; pPrev = p, p = p->next[0], num++)
+         if (p->pPrev != pPrev || (pPrev && p->data < pPrev->data))
+            return false;
+      if (num != list.numElements)
+         return false;
+
+      for (size_t i = 1; i < list.numLevels; i++)
+      {
+         // each node on level i is on level i - 1, in the same order
+         const List::Node * pBelow = list.head[i - 1];
+         for (const List::Node * p = list.head[i]; p; p = p->next[i])
+         {
+            if (p->numLevels <= i)
+               return false;
+            while (pBelow && pBelow != p)
+               pBelow = pBelow->next[i - 1];
+            if (pBelow == nullptr)
+               return false;
+         }
+      }
+      return list.numLevels == 0 || list.head[list.numLevels - 1] != nullptr;
+   }
+};
+
+#endif // DEBUG
@@ -0,0 +1,366 @@
+/***********************************************************************
+ * Header:
+ *    TEST UNORDERED SET
+ * Summary:
+ *    Unit tests for unorderedSet
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "unorderedSet.h"
+#include "unitTest.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************
+ * TEST UNORDERED SET
+ * Unit tests for the unordered_set class
+ ***********************************************/
+class TestUnorderedSet : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Group
+      test_group_match();
+      test_group_empty();
+
+      // Construct
+      test_construct_default();
+      test_construct_aligned();
+      test_constructCopy_standard();
+
+      // Insert
+      test_insert_empty();
+      test_insert_duplicate();
+      test_insert_grow();
+      test_insert_collide();
+
+      // Find
+      test_find_standard();
+      test_find_string();
+
+      // Iterator
+      test_iterator_every();
+
+      // Remove
+      test_erase_noTombstone();
+      test_erase_overflow();
+      test_erase_iterate();
+      test_clear_standard();
+
+      report("UnorderedSet");
+   }
+
+   /***************************************
+    * GROUP
+    ***************************************/
+
+   // one bit for every byte with this hash
+   void test_group_match()
+   {  // setup
+      alignas(16) int8_t bytes[16];
+      for (int i = 0; i < 16; i++)
+         bytes[i] = (int8_t)(i % 4 == 1 ? 0x25 : i);
+      // exercise
+      custom::SwissGroup group(bytes);
+      // verify
+      assertUnit(group.match(0x25) == 0x2222);
+      assertUnit(group.match(0) == 0x0001);
+      assertUnit(group.match(0x7F) == 0);
+      assertUnit(group.matchEmpty() == 0);
+      assertUnit(group.matchFull() == 0xFFFF);
+   }  // teardown
+
+   // the empty bytes are the ones with the high bit set
+   void test_group_empty()
+   {  // setup
+      alignas(16) int8_t bytes[16];
+      for (int i = 0; i < 16; i++)
+         bytes[i] = (i < 3 ? (int8_t)i : custom::SwissGroup::EMPTY);
+      // exercise
+      custom::SwissGroup group(bytes);
+      // verify
+      assertUnit(group.matchEmpty() == 0xFFF8);
+      assertUnit(group.matchFull() == 0x0007);
+      assertUnit(group.match(custom::SwissGroup::EMPTY) == 0xFFF8);
+   }  // teardown
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // default constructor
+   void test_construct_default()
+   {  // setup
+      // exercise
+      custom::unordered_set <int> s;
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.numGroups == 0);
+      assertUnit(s.pBuffer == nullptr);
+      assertUnit(s.begin() == s.end());
+      assertUnit(s.find(0) == s.end());
+      assertUnit(s.erase(0) == 0);
+   }  // teardown
+
+   // the control bytes can be loaded 16 at a time
+   void test_construct_aligned()
+   {  // setup
+      // exercise
+      custom::unordered_set <int> s{ 1, 2, 3 };
+      // verify
+      assertUnit(s.numGroups == 1);
+      assertUnit((uintptr_t)s.ctrl % 64 == 0);
+      assertUnit((uintptr_t)s.slots % 64 == 0);
+      assertUnit((void *)s.overflow == (void *)(s.ctrl + 16));
+   }  // teardown
+
+   // copy has its own buffer, with everything in the same slots
+   void test_constructCopy_standard()
+   {  // setup
+      custom::unordered_set <std::string> sSrc{ "alpha", "bravo", "charlie" };
+      // exercise
+      custom::unordered_set <std::string> sDest(sSrc);
+      // verify
+      assertUnit(sDest.size() == 3);
+      assertUnit(sDest.pBuffer != sSrc.pBuffer);
+      assertUnit(sDest == sSrc);
+      for (auto it = sSrc.begin(); it != sSrc.end(); ++it)
+         assertUnit(sDest.find(*it).i == it.i);
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // the first insert makes one group and marks one slot
+   void test_insert_empty()
+   {  // setup
+      custom::unordered_set <int> s;
+      // exercise
+      auto result = s.insert(50);
+      // verify
+      assertUnit(result.second == true);
+      assertUnit(*result.first == 50);
+      assertUnit(s.numGroups == 1);
+      assertUnit(s.size() == 1);
+      assertUnit(s.ctrl[result.first.i] == custom::unordered_set<int>::_h2(s._hash(50)));
+      assertUnit(countEmpty(s) == 15);
+   }  // teardown
+
+   // something already there stays as it is
+   void test_insert_duplicate()
+   {  // setup
+      custom::unordered_set <int> s{ 10, 20, 30 };
+      auto it = s.find(20);
+      // exercise
+      auto result = s.insert(20);
+      // verify
+      assertUnit(result.second == false);
+      assertUnit(result.first == it);
+      assertUnit(s.size() == 3);
+   }  // teardown
+
+   // the groups double before they are more than 7/8 full
+   void test_insert_grow()
+   {  // setup
+      custom::unordered_set <int> s;
+      for (int i = 0; i < 14; i++)
+         s.insert(i);
+      assertUnit(s.numGroups == 1);
+      // exercise
+      s.insert(14);
+      // verify
+      assertUnit(s.numGroups == 2);
+      assertUnit(s.size() == 15);
+      for (int i = 0; i <= 14; i++)
+         assertUnit(s.find(i) != s.end());
+      // exercise
+      for (int i = 15; i < 10000; i++)
+         s.insert(i);
+      // verify
+      assertUnit(s.size() == 10000);
+      assertUnit(s.numGroups == 1024);
+      assertUnit(s.load_factor() <= 7.0 / 8.0);
+   }  // teardown
+
+   // keys with one hash fill their group then go past it
+   void test_insert_collide()
+   {  // setup
+      custom::unordered_set <int, SameHash> s;
+      s.reserve(100);
+      // exercise
+      for (int i = 0; i < 40; i++)
+         s.insert(i);
+      // verify
+      size_t g = s._home(s._hash(0));
+      assertUnit(s.overflow[g] == 24);
+      assertUnit(countEmpty(s) == s.capacity() - 40);
+      for (int i = 0; i < 40; i++)
+         assertUnit(s.find(i) != s.end() && *s.find(i) == i);
+      assertUnit(s.find(40) == s.end());
+   }  // teardown
+
+   /***************************************
+    * FIND
+    ***************************************/
+
+   // every element is found, and nothing between them
+   void test_find_standard()
+   {  // setup
+      custom::unordered_set <int> s;
+      for (int i = 0; i < 5000; i++)
+         s.insert(i * 16);
+      // exercise and verify
+      for (int i = 0; i < 5000; i++)
+      {
+         auto it = s.find(i * 16);
+         assertUnit(it != s.end() && *it == i * 16);
+         assertUnit(s.find(i * 16 + 1) == s.end());
+      }
+   }  // teardown
+
+   // the same for elements that are not cheap to compare
+   void test_find_string()
+   {  // setup
+      custom::unordered_set <std::string> s{ "delta", "alpha", "charlie", "bravo" };
+      // exercise and verify
+      assertUnit(*s.find("charlie") == "charlie");
+      assertUnit(s.find("char") == s.end());
+      assertUnit(s.find("echo") == s.end());
+   }  // teardown
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // each element once, across groups
+   void test_iterator_every()
+   {  // setup
+      custom::unordered_set <int> s;
+      for (int i = 0; i < 1000; i++)
+         s.insert(i);
+      std::vector<int> seen(1000, 0);
+      // exercise
+      size_t num = 0;
+      for (auto it = s.begin(); it != s.end(); it++, num++)
+         seen[*it]++;
+      // verify
+      assertUnit(num == 1000);
+      for (int i = 0; i < 1000; i++)
+         assertUnit(seen[i] == 1);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // the slot is simply empty again, with no tombstone
+   void test_erase_noTombstone()
+   {  // setup
+      custom::unordered_set <int> s{ 10, 20, 30 };
+      size_t i = s.find(20).i;
+      // exercise
+      size_t numErased = s.erase(20);
+      // verify
+      assertUnit(numErased == 1);
+      assertUnit(s.size() == 2);
+      assertUnit(s.ctrl[i] == custom::SwissGroup::EMPTY);
+      assertUnit(countEmpty(s) == 14);
+      assertUnit(s.find(20) == s.end());
+      assertUnit(s.erase(20) == 0);
+   }  // teardown
+
+   // erasing what went past a group takes it off the count
+   void test_erase_overflow()
+   {  // setup
+      custom::unordered_set <int, SameHash> s;
+      s.reserve(100);
+      for (int i = 0; i < 40; i++)
+         s.insert(i);
+      size_t g = s._home(s._hash(0));
+      // exercise
+      for (int i = 39; i >= 16; i--)
+         assertUnit(s.erase(i) == 1);
+      // verify
+      assertUnit(s.overflow[g] == 0);
+      for (size_t gOther = 0; gOther < s.numGroups; gOther++)
+         assertUnit(s.overflow[gOther] == 0);
+      for (int i = 0; i < 16; i++)
+         assertUnit(s.find(i) != s.end());
+      // exercise
+      s.erase(3);
+      s.insert(99);
+      // verify
+      assertUnit(s.find(99).i / 16 == g);
+      assertUnit(s.overflow[g] == 0);
+   }  // teardown
+
+   // erasing while walking visits the rest
+   void test_erase_iterate()
+   {  // setup
+      custom::unordered_set <int> s;
+      for (int i = 0; i < 500; i++)
+         s.insert(i);
+      // exercise
+      for (auto it = s.begin(); it != s.end(); )
+         if (*it % 2)
+            it = s.erase(it);
+         else
+            ++it;
+      // verify
+      assertUnit(s.size() == 250);
+      for (int i = 0; i < 500; i++)
+         assertUnit((s.find(i) != s.end()) == (i % 2 == 0));
+   }  // teardown
+
+   // clear keeps the room but not the elements
+   void test_clear_standard()
+   {  // setup
+      custom::unordered_set <std::string> s;
+      for (int i = 0; i < 100; i++)
+         s.insert(std::to_string(i));
+      size_t numGroups = s.numGroups;
+      // exercise
+      s.clear();
+      // verify
+      assertUnit(s.empty());
+      assertUnit(s.numGroups == numGroups);
+      assertUnit(countEmpty(s) == s.capacity());
+      assertUnit(s.begin() == s.end());
+      assertUnit(s.find("7") == s.end());
+   }  // teardown
+
+   /*************************************************************
+    * SAME HASH
+    * Every key hashes alike, so they all share a home group
+    *************************************************************/
+   struct SameHash
+   {
+      size_t operator()(int) const { return 42; }
+   };
+
+   /*************************************************************
+    * COUNT EMPTY
+    * Slots whose control byte says empty
+    *************************************************************/
+   template <class Set>
+   size_t countEmpty(const Set & s)
+   {
+      size_t num = 0;
+      for (size_t i = 0; i < s.capacity(); i++)
+         num += (s.ctrl[i] == custom::SwissGroup::EMPTY);
+      return num;
+   }
+};
+
+#endif // DEBUG
@@ -0,0 +1,279 @@
+/***********************************************************************
+ * Header:
+ *    TEST VEB
+ * Summary:
+ *    Unit tests for veb
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#ifdef DEBUG
+
+#include "veb.h"
+#include "unitTest.h"
+
+#include <cstdint>
+
+/***********************************************
+ * TEST VEB
+ * Unit tests for the VEB class
+ ***********************************************/
+class TestVEB : public UnitTest
+{
+public:
+   void run()
+   {
+      reset();
+
+      // Node
+      test_node_split();
+      test_node_word();
+
+      // Construct
+      test_construct_default();
+      test_constructCopy_standard();
+
+      // Insert
+      test_insert_empty();
+      test_insert_duplicate();
+      test_insert_outside();
+      test_insert_newSmallest();
+
+      // Find
+      test_find_standard();
+      test_lowerBound_standard();
+
+      // Iterator
+      test_iterator_decrement();
+
+      // Remove
+      test_erase_smallest();
+      test_erase_every();
+
+      report("VEB");
+   }
+
+   typedef custom::VEB <uint32_t, 32> Tree;
+   typedef custom::VEB <uint16_t, 12> SmallTree;
+
+   /***************************************
+    * NODE
+    ***************************************/
+
+   // a universe splits in half until the clusters are words
+   void test_node_split()
+   {  // setup
+      typedef custom::VebNode <32> Node32;
+      typedef custom::VebNode <12> Node12;
+      // exercise and verify
+      assertUnit(Node32::LOW == 16 && Node32::HIGH == 16);
+      assertUnit(Node32::Cluster::LOW == 8);
+      assertUnit(Node12::LOW == 6 && Node12::HIGH == 6);
+      assertUnit(Node32::DEPTH == 4);
+      assertUnit(Node12::DEPTH == 2);
+   }  // teardown
+
+   // up to 64 keys is one word
+   void test_node_word()
+   {  // setup
+      custom::VebNode <6> node;
+      // exercise
+      node.insert(3);
+      node.insert(63);
+      node.insert(0);
+      // verify
+      assertUnit(node.word == ((uint64_t)1 << 63 | 8 | 1));
+      assertUnit(node.first() == 0);
+      assertUnit(node.last() == 63);
+      assertUnit(node.successor(3) == 63);
+      assertUnit(node.successor(63) == custom::VEB_NONE);
+      assertUnit(node.predecessor(3) == 0);
+      assertUnit(node.predecessor(0) == custom::VEB_NONE);
+   }  // teardown
+
+   /***************************************
+    * CONSTRUCT
+    ***************************************/
+
+   // default constructor
+   void test_construct_default()
+   {  // setup
+      // exercise
+      Tree tree;
+      // verify
+      assertUnit(tree.root == nullptr);
+      assertUnit(tree.numElements == 0);
+      assertUnit(tree.begin() == tree.end());
+      assertUnit(tree.height() == 0);
+   }  // teardown
+
+   // copy has its own nodes, with the same elements
+   void test_constructCopy_standard()
+   {  // setup
+      Tree treeSrc{ 5, 70000, 4000000000u, 12 };
+      // exercise
+      Tree treeDest(treeSrc);
+      // verify
+      assertUnit(treeDest.size() == 4);
+      assertUnit(treeDest.root != treeSrc.root);
+      assertUnit(treeDest.root->clusters.get(0) != treeSrc.root->clusters.get(0));
+      auto itSrc = treeSrc.begin();
+      for (auto it = treeDest.begin(); it != treeDest.end(); ++it, ++itSrc)
+         assertUnit(*it == *itSrc);
+      assertUnit(itSrc == treeSrc.end());
+   }  // teardown
+
+   /***************************************
+    * INSERT
+    ***************************************/
+
+   // the first element is the smallest and largest, and nothing more
+   void test_insert_empty()
+   {  // setup
+      Tree tree;
+      // exercise
+      auto result = tree.insert(50);
+      // verify
+      assertUnit(result.second == true);
+      assertUnit(*result.first == 50);
+      assertUnit(tree.root->smallest == 50);
+      assertUnit(tree.root->largest == 50);
+      assertUnit(tree.root->summary.empty());
+      assertUnit(tree.height() == 4);
+   }  // teardown
+
+   // something already there stays as it is
+   void test_insert_duplicate()
+   {  // setup
+      Tree tree{ 10, 20, 30 };
+      // exercise
+      auto result = tree.insert(20);
+      // verify
+      assertUnit(result.second == false);
+      assertUnit(*result.first == 20);
+      assertUnit(tree.size() == 3);
+   }  // teardown
+
+   // nothing past the universe goes in
+   void test_insert_outside()
+   {  // setup
+      SmallTree tree{ 1 };
+      // exercise
+      auto result = tree.insert(4096);
+      // verify
+      assertUnit(result.second == false);
+      assertUnit(result.first == tree.end());
+      assertUnit(tree.size() == 1);
+      assertUnit(tree.find(4096) == tree.end());
+   }  // teardown
+
+   // a new smallest pushes the old one down into its cluster
+   void test_insert_newSmallest()
+   {  // setup
+      SmallTree tree{ 200, 300 };
+      assertUnit(tree.root->smallest == 200);
+      // exercise
+      tree.insert(100);
+      // verify
+      assertUnit(tree.root->smallest == 100);
+      assertUnit(tree.root->largest == 300);
+      assertUnit(tree.root->summary.word == ((1 << (200 >> 6)) | (1 << (300 >> 6))));
+      assertUnit(tree.root->clusters.get(100 >> 6) == nullptr);
+      assertUnit(tree.root->clusters.get(200 >> 6) != nullptr);
+   }  // teardown
+
+   /***************************************
+    * FIND
+    ***************************************/
+
+   // every element is found, and nothing between them
+   void test_find_standard()
+   {  // setup
+      Tree tree;
+      for (uint32_t i = 0; i < 1000; i++)
+         tree.insert(i * 4000037u);
+      // exercise and verify
+      for (uint32_t i = 0; i < 1000; i++)
+      {
+         auto it = tree.find(i * 4000037u);
+         assertUnit(it != tree.end() && *it == i * 4000037u);
+         assertUnit(tree.find(i * 4000037u + 1) == tree.end());
+      }
+   }  // teardown
+
+   // the first element not less than the key, across clusters
+   void test_lowerBound_standard()
+   {  // setup
+      Tree tree{ 10, 70000, 70001, 3000000000u };
+      // exercise and verify
+      assertUnit(*tree.lower_bound(0) == 10);
+      assertUnit(*tree.lower_bound(10) == 10);
+      assertUnit(*tree.lower_bound(11) == 70000);
+      assertUnit(*tree.upper_bound(70000) == 70001);
+      assertUnit(*tree.lower_bound(70002) == 3000000000u);
+      assertUnit(tree.lower_bound(3000000001u) == tree.end());
+      assertUnit(tree.upper_bound(3000000000u) == tree.end());
+   }  // teardown
+
+   /***************************************
+    * ITERATOR
+    ***************************************/
+
+   // walk back from the largest to the smallest
+   void test_iterator_decrement()
+   {  // setup
+      SmallTree tree;
+      for (uint16_t i = 0; i < 4096; i += 3)
+         tree.insert(i);
+      auto it = tree.find(4095);
+      // exercise
+      int expected = 4095;
+      for (; it != tree.end(); --it, expected -= 3)
+         assertUnit(*it == expected);
+      // verify
+      assertUnit(expected == -3);
+   }  // teardown
+
+   /***************************************
+    * REMOVE
+    ***************************************/
+
+   // the first key of the first cluster moves up to take its place
+   void test_erase_smallest()
+   {  // setup
+      SmallTree tree{ 100, 200, 300 };
+      auto it = tree.begin();
+      // exercise
+      auto itNext = tree.erase(it);
+      // verify
+      assertUnit(itNext != tree.end() && *itNext == 200);
+      assertUnit(tree.root->smallest == 200);
+      assertUnit(tree.root->clusters.get(200 >> 6) == nullptr);
+      assertUnit(tree.root->summary.word == (1 << (300 >> 6)));
+      assertUnit(tree.size() == 2);
+   }  // teardown
+
+   // erase everything, and the tree is gone
+   void test_erase_every()
+   {  // setup
+      Tree tree;
+      for (uint32_t i = 0; i < 1000; i++)
+         tree.insert(i * 65537u);
+      // exercise
+      for (uint32_t i = 0; i < 1000; i++)
+      {
+         auto it = tree.find(((i * 7) % 1000) * 65537u);
+         assertUnit(it != tree.end());
+         tree.erase(it);
+         assertUnit(tree.find(((i * 7) % 1000) * 65537u) == tree.end());
+      }
+      // verify
+      assertUnit(tree.size() == 0);
+      assertUnit(tree.root == nullptr);
+      assertUnit(tree.begin() == tree.end());
+   }  // teardown
+};
+
+#endif // DEBUG
@@ -0,0 +1,578 @@
+/***********************************************************************
+ * Header:
+ *    UNORDERED SET
+ * Summary:
+ *    A hash set with open addressing in the style of the Swiss table.
+ *    Beside each slot is one control byte: empty, or seven bits of
+ *    the hash of what is there. The control bytes come in groups of
+ *    16, so one SSE2 compare tells which of 16 slots might hold the
+ *    key, and we only look at the elements themselves for those.
+ *    For call sites that find, insert and erase but never need
+ *    the elements in order, this is O(1) rather than O(log n)
+ *
+ *    This will contain the class definition of:
+ *        unordered_set           : A class that represents a hash Set
+ *        unordered_set::iterator : An iterator through unordered_set
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#include <cstddef>    // for size_t
+#include <cstdint>    // for int8_t, uint8_t, uint64_t and uintptr_t
+#include <cstring>    // for std::memset and std::memcpy
+#include <functional> // for std::hash
+#include <new>        // for placement new
+#include <utility>    // for std::pair, std::swap and std::forward
+#include <initializer_list>
+#include "bitOps.h"   // for lowestBit
+
+// SSE2 is always there on x86-64, and on 32-bit x86 only when the compiler says so
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UNORDERED_SET_SSE2
+#include <emmintrin.h> // for the SSE2 intrinsics
+#endif
+
+class TestUnorderedSet;  // forward declaration for unit tests
+
+namespace custom
+{
+
+/************************************************
+ * SWISS GROUP
+ * Sixteen control bytes, and the questions we ask of
+ * them. Each answer is a mask with bit i standing for
+ * byte i. A full slot's byte is the low seven bits of
+ * its hash; an empty one has the high bit set
+ ***********************************************/
+class SwissGroup
+{
+public:
+   static const size_t WIDTH = 16;
+   static const int8_t EMPTY = -128;
+
+   explicit SwissGroup(const int8_t * pCtrl)
+   {
+#ifdef UNORDERED_SET_SSE2
+      bytes = _mm_load_si128((const __m128i *)pCtrl);
+#else
+      for (size_t i = 0; i < WIDTH; i++)
+         bytes[i] = pCtrl[i];
+#endif
+   }
+
+   // the slots whose hash might be this one
+   uint32_t match(int8_t h2) const
+   {
+#ifdef UNORDERED_SET_SSE2
+      return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), bytes));
+#else
+      uint32_t mask = 0;
+      for (size_t i = 0; i < WIDTH; i++)
+         mask |= (uint32_t)(bytes[i] == h2) << i;
+      return mask;
+#endif
+   }
+
+   // the empty slots, whose bytes are the only negative ones
+   uint32_t matchEmpty() const
+   {
+#ifdef UNORDERED_SET_SSE2
+      return (uint32_t)_mm_movemask_epi8(bytes);
+#else
+      uint32_t mask = 0;
+      for (size_t i = 0; i < WIDTH; i++)
+         mask |= (uint32_t)(bytes[i] < 0) << i;
+      return mask;
+#endif
+   }
+
+   uint32_t matchFull() const { return ~matchEmpty() & 0xFFFFu; }
+
+private:
+#ifdef UNORDERED_SET_SSE2
+   __m128i bytes;
+#else
+   int8_t bytes[WIDTH];
+#endif
+};
+
+/************************************************
+ * UNORDERED SET
+ * The same interface as set, less the order. There is a
+ * power-of-two number of groups, and a key probes them
+ * starting from the one its hash picks, stepping 1, 2,
+ * 3, ... groups at a time until it finds a group with room.
+ *
+ * Deleting leaves no tombstone. Each group counts the keys
+ * that went past it because it was full, so a search stops
+ * at the first group with no match and no such keys, and
+ * an erased slot can go straight back to empty
+ ***********************************************/
+template <typename T, typename Hash = std::hash<T>>
+class unordered_set
+{
+   friend class ::TestUnorderedSet; // give unit tests access to the privates
+public:
+   //
+   // Construct
+   //
+
+   unordered_set() : numGroups(0), numElements(0), pBuffer(nullptr),
+                     ctrl(nullptr), overflow(nullptr), slots(nullptr) { }
+   unordered_set(const unordered_set & rhs);
+   unordered_set(unordered_set && rhs) : unordered_set() { swap(rhs); }
+   unordered_set(const std::initializer_list<T> & il) : unordered_set()
+   {
+      insert(il.begin(), il.end());
+   }
+   template <class Iterator>
+   unordered_set(Iterator first, Iterator last) : unordered_set()
+   {
+      insert(first, last);
+   }
+   ~unordered_set() { _release(); }
+
+   //
+   // Assign
+   //
+
+   unordered_set & operator = (const unordered_set & rhs)
+   {
+      unordered_set copy(rhs);
+      swap(copy);
+      return *this;
+   }
+   unordered_set & operator = (unordered_set && rhs)
+   {
+      _release();
+      swap(rhs);
+      return *this;
+   }
+   unordered_set & operator = (const std::initializer_list<T> & il)
+   {
+      clear();
+      insert(il.begin(), il.end());
+      return *this;
+   }
+   void swap(unordered_set & rhs) noexcept
+   {
+      std::swap(numGroups,   rhs.numGroups);
+      std::swap(numElements, rhs.numElements);
+      std::swap(pBuffer,     rhs.pBuffer);
+      std::swap(ctrl,        rhs.ctrl);
+      std::swap(overflow,    rhs.overflow);
+      std::swap(slots,       rhs.slots);
+      std::swap(hasher,      rhs.hasher);
+   }
+
+   //
+   // Iterator. In slot order, which is no order at all
+   //
+
+   class iterator;
+   iterator begin() const noexcept { return iterator(this, _nextFull(0)); }
+   iterator end()   const noexcept { return iterator(this, capacity());   }
+
+   //
+   // Access
+   //
+
+   iterator find(const T & t) const
+   {
+      return iterator(this, _find(t, _hash(t)));
+   }
+
+   //
+   // Status
+   //
+
+   bool   empty()    const noexcept { return (numElements == 0);          }
+   size_t size()     const noexcept { return numElements;                 }
+   size_t capacity() const noexcept { return numGroups * SwissGroup::WIDTH; }
+   double load_factor() const noexcept
+   {
+      return numGroups ? (double)numElements / (double)capacity() : 0.0;
+   }
+
+   //
+   // Insert. Growing moves the elements, so it invalidates iterators
+   //
+
+   std::pair<iterator, bool> insert(const T & t)  { return _insert(t);            }
+   std::pair<iterator, bool> insert(T && t)       { return _insert(std::move(t)); }
+   void insert(const std::initializer_list<T> & il)
+   {
+      insert(il.begin(), il.end());
+   }
+   template <class Iterator>
+   void insert(Iterator first, Iterator last)
+   {
+      for (; first != last; ++first)
+         insert(*first);
+   }
+   void reserve(size_t num);
+
+   //
+   // Remove. Nothing moves, so only iterators to what goes are invalid
+   //
+
+   void clear() noexcept;
+   iterator erase(iterator it);
+   size_t erase(const T & t)
+   {
+      size_t i = _find(t, _hash(t));
+      if (i == capacity())
+         return 0;
+      _erase(i);
+      return 1;
+   }
+   iterator erase(iterator itBegin, iterator itEnd)
+   {
+      while (itBegin != itEnd)
+         itBegin = erase(itBegin);
+      return itEnd;
+   }
+
+private:
+
+   // a full group holds at most this many before we grow: a load of 7/8
+   static const size_t MAX_PER_GROUP = SwissGroup::WIDTH * 7 / 8;
+   // an overflow count this high is stuck there until the next rehash
+   static const uint8_t OVERFLOW_STUCK = 255;
+
+   uint64_t _hash(const T & t) const;
+   static int8_t _h2(uint64_t hash)           { return (int8_t)(hash & 0x7F); }
+   size_t _home(uint64_t hash) const          { return (size_t)(hash >> 7) & (numGroups - 1); }
+
+   template <class U>
+   std::pair<iterator, bool> _insert(U && t);
+   size_t _find(const T & t, uint64_t hash) const;
+   size_t _claim(uint64_t hash);
+   void   _erase(size_t i);
+   size_t _nextFull(size_t i) const;
+   void   _rehash(size_t numGroupsNew);
+   void   _allocate(size_t numGroupsNew);
+   void   _release();
+
+   size_t numGroups;          // a power of two, or 0 before the first insert
+   size_t numElements;        // how many slots are full
+   void * pBuffer;            // what was allocated, before alignment
+   int8_t * ctrl;             // one control byte per slot, 16 to a group
+   uint8_t * overflow;        // per group, keys that probed past it
+   T * slots;                 // the elements, constructed only where full
+   Hash hasher;               // std::hash or what the user gave us
+};
+
+/**************************************************
+ * UNORDERED SET ITERATOR
+ * A slot index. end() is one past the last slot
+ *************************************************/
+template <typename T, typename Hash>
+class unordered_set <T, Hash> :: iterator
+{
+   friend class ::TestUnorderedSet; // give unit tests access to the privates
+   friend class unordered_set <T, Hash>;
+public:
+   // constructors and assignment
+   iterator() : pSet(nullptr), i(0) { }
+   iterator(const unordered_set * pSet, size_t i) : pSet(pSet), i(i) { }
+
+   // compare
+   bool operator == (const iterator & rhs) const { return i == rhs.i;                            }
+   bool operator != (const iterator & rhs) const { return i != rhs.i;                            }
+
+   // de-reference. Cannot change because that would move it
+   const T & operator * () const                 { return pSet->slots[i];                        }
+
+   // increment
+   iterator & operator ++ ()
+   {
+      if (i < pSet->capacity())
+         i = pSet->_nextFull(i + 1);
+      return *this;
+   }
+   iterator   operator ++ (int postfix)          { iterator itOld(*this); ++*this; return itOld; }
+
+private:
+
+   const unordered_set * pSet; // the set we walk through
+   size_t i;                   // slot index, capacity() for end()
+};
+
+/*********************************************
+ * UNORDERED SET :: COPY CONSTRUCTOR
+ * The same groups, so every element lands in the same
+ * slot and the control bytes can be copied as they are
+ ********************************************/
+template <typename T, typename Hash>
+unordered_set <T, Hash> :: unordered_set(const unordered_set & rhs) : unordered_set()
+{
+   hasher = rhs.hasher;
+   if (rhs.numGroups == 0)
+      return;
+   _allocate(rhs.numGroups);
+   std::memcpy(ctrl,     rhs.ctrl,     capacity());
+   std::memcpy(overflow, rhs.overflow, numGroups);
+   for (size_t i = rhs._nextFull(0); i < capacity(); i = rhs._nextFull(i + 1))
+      new (slots + i) T(rhs.slots[i]);
+   numElements = rhs.numElements;
+}
+
+/*********************************************
+ * UNORDERED SET :: HASH
+ * std::hash of an integer is often the integer, which
+ * would put 0, 16, 32 ... all in one group. Mix every
+ * bit into every other first (the MurmurHash3 finalizer)
+ ********************************************/
+template <typename T, typename Hash>
+uint64_t unordered_set <T, Hash> :: _hash(const T & t) const
+{
+   uint64_t hash = (uint64_t)hasher(t);
+   hash ^= hash >> 33;
+   hash *= 0xFF51AFD7ED558CCDull;
+   hash ^= hash >> 33;
+   hash *= 0xC4CEB9FE1A85EC53ull;
+   hash ^= hash >> 33;
+   return hash;
+}
+
+/*********************************************
+ * UNORDERED SET :: FIND
+ * The slot holding t, or capacity() if there is none.
+ * Only the slots whose control byte matches are compared
+ ********************************************/
+template <typename T, typename Hash>
+size_t unordered_set <T, Hash> :: _find(const T & t, uint64_t hash) const
+{
+   int8_t h2 = _h2(hash);
+   size_t g = _home(hash);
+   for (size_t step = 1; step <= numGroups; step++)
+   {
+      SwissGroup group(ctrl + g * SwissGroup::WIDTH);
+      for (uint32_t mask = group.match(h2); mask; mask &= mask - 1)
+      {
+         size_t i = g * SwissGroup::WIDTH + lowestBit(mask);
+         if (slots[i] == t)
+            return i;
+      }
+      if (overflow[g] == 0)
+         break;
+      g = (g + step) & (numGroups - 1);
+   }
+   return capacity();
+}
+
+/*********************************************
+ * UNORDERED SET :: INSERT
+ * Nothing happens if t is already there. Otherwise grow
+ * if that would put us over 7/8 full, then claim a slot
+ ********************************************/
+template <typename T, typename Hash>
+template <class U>
+std::pair<typename unordered_set <T, Hash> :: iterator, bool>
+unordered_set <T, Hash> :: _insert(U && t)
+{
+   uint64_t hash = _hash(t);
+   size_t i = _find(t, hash);
+   if (i != capacity())
+      return std::make_pair(iterator(this, i), false);
+
+   if (numElements + 1 > numGroups * MAX_PER_GROUP)
+      _rehash(numGroups ? numGroups * 2 : 1);
+
+   i = _claim(hash);
+   new (slots + i) T(std::forward<U>(t));
+   numElements++;
+   return std::make_pair(iterator(this, i), true);
+}
+
+/*********************************************
+ * UNORDERED SET :: CLAIM
+ * The first empty slot along the probe sequence, marked
+ * with the hash. Each full group we pass on the way
+ * counts one more key that went past it
+ ********************************************/
+template <typename T, typename Hash>
+size_t unordered_set <T, Hash> :: _claim(uint64_t hash)
+{
+   size_t g = _home(hash);
+   for (size_t step = 1; ; step++)
+   {
+      uint32_t mask = SwissGroup(ctrl + g * SwissGroup::WIDTH).matchEmpty();
+      if (mask)
+      {
+         size_t i = g * SwissGroup::WIDTH + lowestBit(mask);
+         ctrl[i] = _h2(hash);
+         return i;
+      }
+      if (overflow[g] != OVERFLOW_STUCK)
+         overflow[g]++;
+      g = (g + step) & (numGroups - 1);
+   }
+}
+
+/*********************************************
+ * UNORDERED SET :: ERASE
+ * Walk the probe sequence again to take this key off the
+ * count of each group it went past, then empty its slot
+ ********************************************/
+template <typename T, typename Hash>
+void unordered_set <T, Hash> :: _erase(size_t i)
+{
+   size_t gHere = i / SwissGroup::WIDTH;
+   size_t g = _home(_hash(slots[i]));
+   for (size_t step = 1; g != gHere; step++)
+   {
+      if (overflow[g] != OVERFLOW_STUCK)
+         overflow[g]--;
+      g = (g + step) & (numGroups - 1);
+   }
+
+   slots[i].~T();
+   ctrl[i] = SwissGroup::EMPTY;
+   numElements--;
+}
+
+template <typename T, typename Hash>
+typename unordered_set <T, Hash> :: iterator unordered_set <T, Hash> :: erase(iterator it)
+{
+   if (it.i >= capacity())
+      return end();
+   _erase(it.i);
+   return iterator(this, _nextFull(it.i + 1));
+}
+
+/*********************************************
+ * UNORDERED SET :: NEXT FULL
+ * The first full slot at i or after, a group at a time
+ ********************************************/
+template <typename T, typename Hash>
+size_t unordered_set <T, Hash> :: _nextFull(size_t i) const
+{
+   while (i < capacity())
+   {
+      size_t g = i / SwissGroup::WIDTH;
+      uint32_t mask = SwissGroup(ctrl + g * SwissGroup::WIDTH).matchFull()
+                    & (0xFFFFu << (i % SwissGroup::WIDTH));
+      if (mask)
+         return g * SwissGroup::WIDTH + lowestBit(mask);
+      i = (g + 1) * SwissGroup::WIDTH;
+   }
+   return capacity();
+}
+
+/*********************************************
+ * UNORDERED SET :: RESERVE
+ * Room for num elements without growing
+ ********************************************/
+template <typename T, typename Hash>
+void unordered_set <T, Hash> :: reserve(size_t num)
+{
+   size_t numGroupsNew = (numGroups ? numGroups : 1);
+   while (numGroupsNew * MAX_PER_GROUP < num)
+      numGroupsNew *= 2;
+   if (numGroupsNew != numGroups)
+      _rehash(numGroupsNew);
+}
+
+/*********************************************
+ * UNORDERED SET :: CLEAR
+ * Every slot empty again. We keep the room we had
+ ********************************************/
+template <typename T, typename Hash>
+void unordered_set <T, Hash> :: clear() noexcept
+{
+   for (size_t i = _nextFull(0); i < capacity(); i = _nextFull(i + 1))
+      slots[i].~T();
+   if (numGroups)
+   {
+      std::memset(ctrl, SwissGroup::EMPTY, capacity());
+      std::memset(overflow, 0, numGroups);
+   }
+   numElements = 0;
+}
+
+/*********************************************
+ * UNORDERED SET :: REHASH
+ * Move every element into a table of numGroupsNew groups.
+ * The overflow counts start over, which is what frees
+ * any that got stuck
+ ********************************************/
+template <typename T, typename Hash>
+void unordered_set <T, Hash> :: _rehash(size_t numGroupsNew)
+{
+   unordered_set old;
+   swap(old);
+   hasher = old.hasher;
+   _allocate(numGroupsNew);
+
+   for (size_t i = old._nextFull(0); i < old.capacity(); i = old._nextFull(i + 1))
+   {
+      new (slots + _claim(_hash(old.slots[i]))) T(std::move(old.slots[i]));
+      numElements++;
+   }
+}
+
+/*********************************************
+ * UNORDERED SET :: ALLOCATE
+ * One buffer on a 64-byte boundary: the control bytes,
+ * then the overflow counts, then the slots on a line of
+ * their own. Every slot starts empty
+ ********************************************/
+template <typename T, typename Hash>
+void unordered_set <T, Hash> :: _allocate(size_t numGroupsNew)
+{
+   size_t numSlots = numGroupsNew * SwissGroup::WIDTH;
+   size_t offsetSlots = (numSlots + numGroupsNew + 63) & ~(size_t)63;
+   pBuffer = ::operator new(offsetSlots + numSlots * sizeof(T) + 63);
+   char * pBase = (char *)(((uintptr_t)pBuffer + 63) & ~(uintptr_t)63);
+
+   numGroups = numGroupsNew;
+   ctrl      = (int8_t *)pBase;
+   overflow  = (uint8_t *)(pBase + numSlots);
+   slots     = (T *)(pBase + offsetSlots);
+   std::memset(ctrl, SwissGroup::EMPTY, numSlots);
+   std::memset(overflow, 0, numGroups);
+}
+
+/*********************************************
+ * UNORDERED SET :: RELEASE
+ * Destroy the elements and free the buffer
+ ********************************************/
+template <typename T, typename Hash>
+void unordered_set <T, Hash> :: _release()
+{
+   clear();
+   ::operator delete(pBuffer);
+   pBuffer  = nullptr;
+   ctrl     = nullptr;
+   overflow = nullptr;
+   slots    = nullptr;
+   numGroups = 0;
+}
+
+/***********************************************
+ * UNORDERED SET : EQUIVALENCE
+ * See if two sets hold the same elements, in whatever
+ * slots they happen to be
+ ***********************************************/
+template <typename T, typename Hash>
+bool operator == (const unordered_set <T, Hash> & lhs, const unordered_set <T, Hash> & rhs)
+{
+   if (lhs.size() != rhs.size())
+      return false;
+   for (auto it = lhs.begin(); it != lhs.end(); ++it)
+      if (rhs.find(*it) == rhs.end())
+         return false;
+   return true;
+}
+
+template <typename T, typename Hash>
+inline bool operator != (const unordered_set <T, Hash> & lhs, const unordered_set <T, Hash> & rhs)
+{
+   return !(lhs == rhs);
+}
+
+} // namespace custom
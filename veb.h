@@ -0,0 +1,600 @@
+/***********************************************************************
+ * Header:
+ *    VEB
+ * Summary:
+ *    A van Emde Boas tree to hold the elements of a set of unsigned
+ *    integers below 2^universeBits. Each level splits a key into a
+ *    high half that picks a cluster and a low half that lives in it,
+ *    so find, successor and predecessor take O(log log U) steps no
+ *    matter how many elements there are: for a 32-bit universe that
+ *    is 32, 16, 8 bits and then one 64-bit word
+ *
+ *    This will contain the class definition of:
+ *        VebNode             : A van Emde Boas tree over 2^bits keys
+ *        VEB                 : A class that represents a van Emde Boas tree
+ *        VEB::iterator       : An iterator through VEB
+ *        VebEngine           : Pick VEB as the engine behind a set
+ * Author
+ *    Joel Jossie and Gergo Medveczky
+ ************************************************************************/
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint64_t
+#include <type_traits> // for std::is_unsigned
+#include <utility>     // for std::pair and std::swap
+#include <initializer_list>
+#include "bitOps.h"    // for lowestBit and highestBit
+
+class TestVEB;         // forward declaration for unit tests
+
+namespace custom
+{
+
+/*****************************************************************
+ * VEB ENGINE
+ * Name this as the second parameter of a set of unsigned integers
+ * to keep its elements in a VEB. Every element must be below
+ * 2^universeBits:
+ *       custom::set <uint32_t, custom::VebEngine<20>>
+ *****************************************************************/
+template <unsigned int universeBits>
+struct VebEngine { };
+
+// what successor and predecessor return when there is nothing there
+const uint64_t VEB_NONE = ~(uint64_t)0;
+
+/*****************************************************************
+ * VEB CLUSTERS
+ * The clusters of a node. Small clusters are one word each and
+ * sit in the node; bigger ones are only made when something goes
+ * in them and are freed when they empty again
+ *****************************************************************/
+template <typename Cluster, size_t num, bool isWord>
+struct VebClusters
+{
+   VebClusters() { }
+   VebClusters(const VebClusters & rhs) = default;
+
+   Cluster * get (size_t h)             { return slots[h].empty() ? nullptr : &slots[h]; }
+   const Cluster * get (size_t h) const { return slots[h].empty() ? nullptr : &slots[h]; }
+   Cluster * make(size_t h)             { return &slots[h];                              }
+   void      drop(size_t h)             {                                                }
+
+   Cluster slots[num];
+};
+
+template <typename Cluster, size_t num>
+struct VebClusters <Cluster, num, false>
+{
+   VebClusters()
+   {
+      for (size_t h = 0; h < num; h++)
+         slots[h] = nullptr;
+   }
+   VebClusters(const VebClusters & rhs)
+   {
+      for (size_t h = 0; h < num; h++)
+         slots[h] = (rhs.slots[h] ? new Cluster(*rhs.slots[h]) : nullptr);
+   }
+   VebClusters & operator = (const VebClusters & rhs) = delete;
+   ~VebClusters()
+   {
+      for (size_t h = 0; h < num; h++)
+         delete slots[h];
+   }
+
+   Cluster * get (size_t h)             { return slots[h];                               }
+   const Cluster * get (size_t h) const { return slots[h];                               }
+   Cluster * make(size_t h)             { return slots[h] ? slots[h] : (slots[h] = new Cluster); }
+   void      drop(size_t h)             { delete slots[h]; slots[h] = nullptr;           }
+
+   Cluster * slots[num];
+};
+
+/*****************************************************************
+ * VEB NODE
+ * A van Emde Boas tree over the keys 0 ... 2^bits - 1. Up to 64
+ * keys it is one word with a bit for each key
+ *****************************************************************/
+template <unsigned int bits, bool isWord = (bits <= 6)>
+struct VebNode
+{
+   static const size_t DEPTH = 1;
+
+   VebNode() : word(0) { }
+
+   bool     empty() const { return word == 0;       }
+   uint64_t first() const { return lowestBit(word);  }
+   uint64_t last()  const { return highestBit(word); }
+
+   bool contains(uint64_t x) const { return (word >> x) & 1; }
+   uint64_t successor(uint64_t x) const
+   {
+      uint64_t above = (x >= 63 ? 0 : word & (~(uint64_t)0 << (x + 1)));
+      return above ? lowestBit(above) : VEB_NONE;
+   }
+   uint64_t predecessor(uint64_t x) const
+   {
+      uint64_t below = word & (((uint64_t)1 << x) - 1);
+      return below ? highestBit(below) : VEB_NONE;
+   }
+
+   void insert(uint64_t x) { word |=  ((uint64_t)1 << x); }
+   void erase (uint64_t x) { word &= ~((uint64_t)1 << x); }
+
+   uint64_t word;             // bit x is set when x is in the tree
+};
+
+/*****************************************************************
+ * VEB NODE
+ * Bigger than that, a key splits into a high part naming one of
+ * the clusters and a low part within it. The smallest key is kept
+ * here and nowhere below, which is what keeps an insert into an
+ * empty cluster from recursing twice. The summary says which
+ * clusters have anything in them
+ *****************************************************************/
+template <unsigned int bits>
+struct VebNode <bits, false>
+{
+   static const unsigned int LOW  = (bits / 2 < 6 ? 6 : bits / 2);
+   static const unsigned int HIGH = bits - LOW;
+   typedef VebNode <LOW>  Cluster;
+   typedef VebNode <HIGH> Summary;
+   static const size_t DEPTH = 1 + Cluster::DEPTH;
+
+   VebNode() : smallest(VEB_NONE), largest(VEB_NONE) { }
+
+   bool     empty() const { return smallest == VEB_NONE; }
+   uint64_t first() const { return smallest;             }
+   uint64_t last()  const { return largest;              }
+
+   bool contains(uint64_t x) const;
+   uint64_t successor  (uint64_t x) const;
+   uint64_t predecessor(uint64_t x) const;
+
+   void insert(uint64_t x);
+   void erase (uint64_t x);
+
+   uint64_t smallest;         // VEB_NONE when empty. Not in any cluster
+   uint64_t largest;          // VEB_NONE when empty
+   Summary summary;           // the clusters with something in them
+   VebClusters <Cluster, (size_t)1 << HIGH, Cluster::DEPTH == 1> clusters;
+
+private:
+   static uint64_t high(uint64_t x)               { return x >> LOW;                         }
+   static uint64_t low (uint64_t x)               { return x & (((uint64_t)1 << LOW) - 1);   }
+   static uint64_t index(uint64_t h, uint64_t l)  { return (h << LOW) | l;                   }
+};
+
+/*****************************************************************
+ * VEB
+ * The elements of a set of unsigned integers below 2^universeBits,
+ * by way of one VebNode covering the whole universe. Each key is
+ * held once, whatever keepUnique says. The nodes take room for the
+ * spread of the keys rather than their number: 2^(bits/2) cluster
+ * slots for every cluster in use, so a 32-bit universe costs half
+ * a megabyte at the root and 2KB for each 64K range with a key in it
+ *****************************************************************/
+template <typename T, unsigned int universeBits>
+class VEB
+{
+   static_assert(std::is_integral<T>::value && std::is_unsigned<T>::value,
+                 "VEB keys are unsigned integers");
+   static_assert(universeBits >= 1 && universeBits <= 32 && universeBits <= sizeof(T) * 8,
+                 "VEB universes are 1 to 32 bits, and no wider than the key");
+
+   friend class ::TestVEB; // give unit tests access to the privates
+public:
+   //
+   // Construct
+   //
+
+   VEB() : root(nullptr), numElements(0) { }
+   VEB(const VEB &  rhs) : root(nullptr), numElements(0) { *this = rhs;            }
+   VEB(      VEB && rhs) : root(nullptr), numElements(0) { *this = std::move(rhs); }
+   VEB(const std::initializer_list<T> & il) : root(nullptr), numElements(0)
+   {
+      for (auto & element : il)
+         insert(element);
+   }
+   ~VEB() { clear(); }
+
+   //
+   // Assign
+   //
+
+   VEB & operator = (const VEB &  rhs);
+   VEB & operator = (      VEB && rhs);
+   VEB & operator = (const std::initializer_list<T> & il);
+   void swap(VEB & rhs) noexcept
+   {
+      std::swap(root,        rhs.root);
+      std::swap(numElements, rhs.numElements);
+   }
+
+   //
+   // Iterator
+   //
+
+   class iterator;
+   iterator begin() const noexcept { return root ? iterator(this, (T)root->first()) : end(); }
+   iterator end()   const noexcept { return iterator(this);                                  }
+
+   //
+   // Access. Lower bound is the first element not less than t,
+   // upper bound the first one greater
+   //
+
+   iterator find       (const T & t) const;
+   iterator lower_bound(const T & t) const;
+   iterator upper_bound(const T & t) const;
+
+   //
+   // Insert. Nothing outside the universe goes in
+   //
+
+   std::pair<iterator, bool> insert(const T & t, bool keepUnique = false);
+   std::pair<iterator, bool> insert(T && t, bool keepUnique = false)
+   {
+      return insert((const T &)t, keepUnique);
+   }
+
+   //
+   // Remove
+   //
+
+   iterator erase(iterator & it);
+   void clear() noexcept
+   {
+      delete root;
+      root = nullptr;
+      numElements = 0;
+   }
+
+   //
+   // Status
+   //
+
+   bool   empty()  const noexcept { return (numElements == 0);       }
+   size_t size()   const noexcept { return numElements;              }
+   size_t height() const noexcept { return root ? Node::DEPTH : 0;   }
+
+private:
+
+   typedef VebNode <universeBits> Node;
+
+   static bool inUniverse(const T & t) { return ((uint64_t)t >> universeBits) == 0; }
+
+   Node * root;               // covers the whole universe. nullptr when empty
+   size_t numElements;        // number of elements currently in the tree
+};
+
+/**********************************************************
+ * VEB ITERATOR
+ * The element itself, so inserts and erases elsewhere never
+ * invalidate it. Moving on asks the tree for the successor
+ *********************************************************/
+template <typename T, unsigned int universeBits>
+class VEB <T, universeBits> :: iterator
+{
+   friend class ::TestVEB; // give unit tests access to the privates
+   friend class VEB <T, universeBits>;
+public:
+   // constructors and assignment
+   iterator() : pTree(nullptr), value(), isEnd(true) { }
+   iterator(const VEB * pTree) : pTree(pTree), value(), isEnd(true) { }
+   iterator(const VEB * pTree, const T & t) : pTree(pTree), value(t), isEnd(false) { }
+
+   // compare
+   bool operator == (const iterator & rhs) const
+   {
+      return isEnd == rhs.isEnd && (isEnd || value == rhs.value);
+   }
+   bool operator != (const iterator & rhs) const { return !(*this == rhs);                       }
+
+   // de-reference. Cannot change because it will invalidate the VEB
+   const T & operator * () const                 { return value;                                 }
+
+   // increment and decrement
+   iterator & operator ++ ();
+   iterator   operator ++ (int postfix)          { iterator itOld(*this); ++*this; return itOld; }
+   iterator & operator -- ();
+   iterator   operator -- (int postfix)          { iterator itOld(*this); --*this; return itOld; }
+
+private:
+
+   const VEB * pTree;         // the tree we walk through
+   T value;                   // the element we are on
+   bool isEnd;                // past the last element
+};
+
+/*********************************************
+ *********************************************
+ ***************** VEB NODE ******************
+ *********************************************
+ *********************************************/
+
+/*********************************************
+ * VEB NODE :: CONTAINS
+ * Is x here or in its cluster?
+ ********************************************/
+template <unsigned int bits>
+bool VebNode <bits, false> :: contains(uint64_t x) const
+{
+   if (x == smallest || x == largest)
+      return true;
+   const Cluster * pCluster = clusters.get(high(x));
+   return pCluster && pCluster->contains(low(x));
+}
+
+/*********************************************
+ * VEB NODE :: SUCCESSOR
+ * The smallest key greater than x. Either it is in the
+ * cluster of x, or it is the first key of the next cluster
+ * with anything in it. Only one of the two recurses
+ ********************************************/
+template <unsigned int bits>
+uint64_t VebNode <bits, false> :: successor(uint64_t x) const
+{
+   if (empty() || x >= largest)
+      return VEB_NONE;
+   if (x < smallest)
+      return smallest;
+
+   uint64_t h = high(x);
+   const Cluster * pCluster = clusters.get(h);
+   if (pCluster && low(x) < pCluster->last())
+      return index(h, pCluster->successor(low(x)));
+
+   uint64_t hNext = summary.successor(h);
+   return index(hNext, clusters.get(hNext)->first());
+}
+
+/*********************************************
+ * VEB NODE :: PREDECESSOR
+ * The largest key less than x. The mirror image, except
+ * that the smallest key is here rather than in a cluster
+ ********************************************/
+template <unsigned int bits>
+uint64_t VebNode <bits, false> :: predecessor(uint64_t x) const
+{
+   if (empty() || x <= smallest)
+      return VEB_NONE;
+   if (x > largest)
+      return largest;
+
+   uint64_t h = high(x);
+   const Cluster * pCluster = clusters.get(h);
+   if (pCluster && low(x) > pCluster->first())
+      return index(h, pCluster->predecessor(low(x)));
+
+   uint64_t hPrev = summary.predecessor(h);
+   if (hPrev == VEB_NONE)
+      return smallest;
+   return index(hPrev, clusters.get(hPrev)->last());
+}
+
+/*********************************************
+ * VEB NODE :: INSERT
+ * Add x, which is not already here. A new smallest key
+ * pushes the old one down into the clusters. Putting the
+ * first key in an empty cluster is constant time, so at
+ * most one of the summary and the cluster really recurses
+ ********************************************/
+template <unsigned int bits>
+void VebNode <bits, false> :: insert(uint64_t x)
+{
+   if (empty())
+   {
+      smallest = largest = x;
+      return;
+   }
+   if (x < smallest)
+      std::swap(x, smallest);
+   if (x > largest)
+      largest = x;
+
+   uint64_t h = high(x);
+   Cluster * pCluster = clusters.get(h);
+   if (pCluster == nullptr)
+   {
+      summary.insert(h);
+      pCluster = clusters.make(h);
+   }
+   pCluster->insert(low(x));
+}
+
+/*********************************************
+ * VEB NODE :: ERASE
+ * Take out x, which is here. Erasing the smallest key pulls
+ * the first key of the first cluster up to take its place.
+ * A cluster that empties is freed and leaves the summary
+ ********************************************/
+template <unsigned int bits>
+void VebNode <bits, false> :: erase(uint64_t x)
+{
+   if (smallest == largest)
+   {
+      smallest = largest = VEB_NONE;
+      return;
+   }
+   if (x == smallest)
+   {
+      uint64_t hFirst = summary.first();
+      x = smallest = index(hFirst, clusters.get(hFirst)->first());
+   }
+
+   uint64_t h = high(x);
+   Cluster * pCluster = clusters.get(h);
+   pCluster->erase(low(x));
+   if (pCluster->empty())
+   {
+      clusters.drop(h);
+      summary.erase(h);
+      if (x == largest)
+         largest = summary.empty() ? smallest
+                                   : index(summary.last(), clusters.get(summary.last())->last());
+   }
+   else if (x == largest)
+      largest = index(h, pCluster->last());
+}
+
+/*********************************************
+ *********************************************
+ ******************** VEB ********************
+ *********************************************
+ *********************************************/
+
+/*********************************************
+ * VEB :: ASSIGNMENT OPERATOR
+ * Copy one tree to another
+ ********************************************/
+template <typename T, unsigned int universeBits>
+VEB <T, universeBits> & VEB <T, universeBits> :: operator = (const VEB & rhs)
+{
+   if (this != &rhs)
+   {
+      clear();
+      if (rhs.root)
+         root = new Node(*rhs.root);
+      numElements = rhs.numElements;
+   }
+   return *this;
+}
+
+/*********************************************
+ * VEB :: MOVE ASSIGNMENT
+ * Steal the nodes from another tree
+ ********************************************/
+template <typename T, unsigned int universeBits>
+VEB <T, universeBits> & VEB <T, universeBits> :: operator = (VEB && rhs)
+{
+   clear();
+   swap(rhs);
+   return *this;
+}
+
+/*********************************************
+ * VEB :: ASSIGNMENT with INITIALIZATION LIST
+ ********************************************/
+template <typename T, unsigned int universeBits>
+VEB <T, universeBits> & VEB <T, universeBits> :: operator = (const std::initializer_list<T> & il)
+{
+   clear();
+   for (auto & element : il)
+      insert(element);
+   return *this;
+}
+
+/*********************************************
+ * VEB :: FIND
+ * The element equal to t, or end()
+ ********************************************/
+template <typename T, unsigned int universeBits>
+typename VEB <T, universeBits> :: iterator VEB <T, universeBits> :: find(const T & t) const
+{
+   if (root && inUniverse(t) && root->contains((uint64_t)t))
+      return iterator(this, t);
+   return end();
+}
+
+/*********************************************
+ * VEB :: LOWER BOUND and UPPER BOUND
+ * The first element not less than t, and the first
+ * one greater than t
+ ********************************************/
+template <typename T, unsigned int universeBits>
+typename VEB <T, universeBits> :: iterator VEB <T, universeBits> :: lower_bound(const T & t) const
+{
+   if (root && inUniverse(t) && root->contains((uint64_t)t))
+      return iterator(this, t);
+   return upper_bound(t);
+}
+
+template <typename T, unsigned int universeBits>
+typename VEB <T, universeBits> :: iterator VEB <T, universeBits> :: upper_bound(const T & t) const
+{
+   if (root == nullptr || !inUniverse(t))
+      return end();
+   uint64_t next = root->successor((uint64_t)t);
+   return next == VEB_NONE ? end() : iterator(this, (T)next);
+}
+
+/*********************************************
+ * VEB :: INSERT
+ * Add t unless it is already there, or is outside the
+ * universe. Returns where t is and whether it went in
+ ********************************************/
+template <typename T, unsigned int universeBits>
+std::pair<typename VEB <T, universeBits> :: iterator, bool>
+   VEB <T, universeBits> :: insert(const T & t, bool keepUnique)
+{
+   if (!inUniverse(t))
+      return std::make_pair(end(), false);
+   if (root == nullptr)
+      root = new Node;
+   else if (root->contains((uint64_t)t))
+      return std::make_pair(iterator(this, t), false);
+
+   root->insert((uint64_t)t);
+   numElements++;
+   return std::make_pair(iterator(this, t), true);
+}
+
+/*********************************************
+ * VEB :: ERASE
+ * Take out the element the iterator is on, returning the
+ * one after it. The last one out frees the root
+ ********************************************/
+template <typename T, unsigned int universeBits>
+typename VEB <T, universeBits> :: iterator VEB <T, universeBits> :: erase(iterator & it)
+{
+   if (it.isEnd)
+      return end();
+   iterator itNext = it;
+   ++itNext;
+
+   root->erase((uint64_t)it.value);
+   if (--numElements == 0)
+      clear();
+   return itNext;
+}
+
+/**************************************************
+ * VEB ITERATOR :: INCREMENT PREFIX
+ * On to the successor, or off the end
+ *************************************************/
+template <typename T, unsigned int universeBits>
+typename VEB <T, universeBits> :: iterator & VEB <T, universeBits> :: iterator :: operator ++ ()
+{
+   if (isEnd)
+      return *this;
+   uint64_t next = pTree->root->successor((uint64_t)value);
+   if (next == VEB_NONE)
+      isEnd = true;
+   else
+      value = (T)next;
+   return *this;
+}
+
+/**************************************************
+ * VEB ITERATOR :: DECREMENT PREFIX
+ * Back to the predecessor, or off the front
+ *************************************************/
+template <typename T, unsigned int universeBits>
+typename VEB <T, universeBits> :: iterator & VEB <T, universeBits> :: iterator :: operator -- ()
+{
+   if (isEnd)
+      return *this;
+   uint64_t prev = pTree->root->predecessor((uint64_t)value);
+   if (prev == VEB_NONE)
+      isEnd = true;
+   else
+      value = (T)prev;
+   return *this;
+}
+
+} // namespace custom